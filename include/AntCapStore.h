@@ -0,0 +1,79 @@
+#ifndef __ANTCAP_STORE_H
+#define __ANTCAP_STORE_H
+
+#include "StationData.h"
+#include "StoreBase.h"
+#include "StoreFlashLog.h"
+
+// Antenna kapacitás tábla méretei
+#define ANTCAP_MAX_BANDS 30      // A bandTable elemszáma legfeljebb ennyi lehet
+#define ANTCAP_POINTS_PER_BAND 4 // Sávonként ennyi, egyenletesen elosztott mérési pont
+#define ANTCAP_NOT_TUNED 0       // 0: a pont nincs behangolva (a chipnek 0 = automatikus)
+
+// Sávonként ANTCAP_POINTS_PER_BAND kapacitás érték, a pontok frekvenciája a sávhatárokból adódik
+struct AntCapTable_t {
+    uint16_t caps[ANTCAP_MAX_BANDS][ANTCAP_POINTS_PER_BAND];
+};
+
+// EEPROM cím: az AM állomások után
+constexpr uint16_t EEPROM_ANTCAP_ADDR = EEPROM_AM_STATIONS_ADDR + AM_STATIONS_REQUIRED_SIZE;
+constexpr size_t ANTCAP_REQUIRED_SIZE = StoreEepromBase<AntCapTable_t>::getRequiredSize();
+
+static_assert(EEPROM_ANTCAP_ADDR + ANTCAP_REQUIRED_SIZE <= EEPROM_SIZE, "EEPROM layout exceeds EEPROM_SIZE. Check AntCapTable_t size or EEPROM_SIZE.");
+
+/**
+ * @brief Sávonkénti antenna kapacitás tábla
+ *
+ * A behangolt értékeket sávonként 4 pontban tárolja, köztük lineárisan interpolál, így egy
+ * újrahangoláskor a kapacitás O(1) idő alatt, mérés nélkül kikereshető.
+ */
+class AntCapStore : public StoreBase<AntCapTable_t> {
+
+  public:
+    AntCapTable_t data;
+
+  protected:
+    const char *getClassName() const override { return "AntCapStore"; }
+
+    AntCapTable_t &getData() override { return data; };
+    const AntCapTable_t &getData() const override { return data; };
+
+    uint16_t performSave() override { return StoreFlashLog<AntCapTable_t>::save(getData(), FLASH_STORE_ANTCAP, EEPROM_ANTCAP_ADDR, getClassName()); }
+    uint16_t performLoad() override { return StoreFlashLog<AntCapTable_t>::load(getData(), FLASH_STORE_ANTCAP, EEPROM_ANTCAP_ADDR, getClassName()); }
+
+  public:
+    AntCapStore() : StoreBase<AntCapTable_t>() { memset(&data, 0, sizeof(data)); }
+
+    void loadDefaults() override {
+        memset(&data, 0, sizeof(data));
+        markDirty();
+        DEBUG("AntCap defaults loaded.\n");
+    }
+
+    /**
+     * Kapacitás kikeresése (két szomszédos pont közötti lineáris interpolációval)
+     * @param bandIdx a sáv indexe
+     * @param minFreq, maxFreq a sáv határai
+     * @param freq a frekvencia
+     * @param defaultCap ha egyik szomszédos pont sincs behangolva
+     */
+    uint16_t lookup(uint8_t bandIdx, uint16_t minFreq, uint16_t maxFreq, uint16_t freq, uint16_t defaultCap) const;
+
+    /**
+     * Egy mért érték rögzítése a frekvenciához legközelebbi pontba
+     */
+    void record(uint8_t bandIdx, uint16_t minFreq, uint16_t maxFreq, uint16_t freq, uint16_t cap);
+
+    /**
+     * Egy sáv pontjainak törlése
+     */
+    inline void clearBand(uint8_t bandIdx) {
+        memset(data.caps[bandIdx], 0, sizeof(data.caps[bandIdx]));
+        markDirty();
+    }
+};
+
+// Globális példány (AntCapStore.cpp)
+extern AntCapStore antCapStore;
+
+#endif // __ANTCAP_STORE_H
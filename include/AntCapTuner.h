@@ -0,0 +1,50 @@
+#ifndef __ANTCAP_TUNER_H
+#define __ANTCAP_TUNER_H
+
+#include "Band.h"
+#include "Si4735Ext.h"
+
+// Antenna kapacitás hangolás
+#define ANTCAP_MAX_FM 191         // FM: 0..191 (0 = automatikus)
+#define ANTCAP_MAX_AM 6143        // AM: 0..6143 (0 = automatikus)
+#define ANTCAP_COARSE_STEPS 16    // A durva keresés ennyi részre osztja a tartományt
+#define ANTCAP_TUNE_TIMEOUT 150   // Egy mérési pont hangolásának maximális ideje (ms)
+#define ANTCAP_SETTLE_TIME 15     // A hangolás után ennyit várunk az RSQ mérés előtt (ms)
+
+/**
+ * @brief Antenna kapacitás automatikus behangolása
+ *
+ * Egy frekvencián némítva végigsöpri a kapacitás tartományt (durva lépés, majd felezéses finomítás a
+ * legjobb pont körül) és azt az értéket választja, ahol az RSSI/SNR a legjobb. Az eredményt a sáv
+ * AntCapStore táblájának legközelebbi pontjába írja, így a későbbi hangolások mérés nélkül,
+ * interpolációval kapják meg a kapacitást. Blokkoló, csak felhasználói kérésre futtatandó.
+ */
+class AntCapTuner {
+
+  private:
+    Si4735Ext &si4735;
+    Band &band;
+
+    uint16_t measureCount = 0; // Az utolsó behangolás mérési pontjainak száma
+
+    uint16_t measure(uint16_t freq, uint16_t antCap);
+    uint16_t sweep(uint16_t freq);
+
+  public:
+    AntCapTuner(Si4735Ext &si4735, Band &band);
+
+    /**
+     * Az aktuális frekvencia behangolása és rögzítése a táblában
+     * @return a legjobb kapacitás érték
+     */
+    uint16_t tuneCurrentFrequency();
+
+    /**
+     * Az aktuális sáv összes táblapontjának behangolása, a végén vissza az eredeti frekvenciára
+     */
+    void tuneCurrentBand();
+
+    inline uint16_t getMeasureCount() const { return measureCount; }
+};
+
+#endif // __ANTCAP_TUNER_H
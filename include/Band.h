@@ -1,9 +1,9 @@
 #ifndef __BAND_H
 #define __BAND_H
 
-#include <SI4735.h>
-
+#include "AntCapStore.h"
 #include "Config.h"
+#include "Si4735Ext.h"
 #include "defines.h"
 #include "rtVars.h"
 
@@ -20,6 +20,11 @@
 #define AM 3
 #define CW 4
 
+// Chip mód családok (ezek között a váltás a legdrágább)
+#define BAND_MODE_FAMILY_FM 0
+#define BAND_MODE_FAMILY_AM 1
+#define BAND_MODE_FAMILY_SSB 2 // SSB patch kell hozzá
+
 // Egységes BandTable struktúra
 struct BandTable {
     const char *bandName; // Sáv neve
@@ -40,6 +45,17 @@ struct BandTable {
     int16_t lastmanuBFO; // Utolsó manuális BFO érték X-Tal segítségével
 };
 
+// Egy sáv chip konfigurációja (band váltáskor csak az eltérő részeket küldjük ki)
+struct BandChipState {
+    uint8_t modeFamily;     // BAND_MODE_FAMILY_xxx
+    uint8_t modulation;     // FM, AM, LSB, USB, CW
+    uint16_t minimumFreq;   // A chipre beállított sávhatárok
+    uint16_t maximumFreq;
+    uint8_t step;           // A chipre beállított lépésköz
+    uint8_t bandwidthIndex; // A chipre beállított sávszélesség index
+    uint16_t antCap;        // Antenna Tuning Capacitor
+};
+
 // Sávszélesség struktúra (Címke és Érték)
 struct BandWidth {
     const char *label; // Megjelenítendő felirat
@@ -58,7 +74,7 @@ struct FrequencyStep {
 class Band {
   private:
     // Si4735 referencia
-    SI4735 &si4735;
+    Si4735Ext &si4735;
 
     // Config referencia
     Config &configRef;
@@ -66,8 +82,29 @@ class Band {
     // SSB betöltve?
     bool ssbLoaded = false;
 
+    // Sávonként előre kiszámított chip konfiguráció (a változó részeket váltáskor frissítjük)
+    static BandChipState chipStates[];
+
+    // A chipen ténylegesen beállított konfiguráció (a chip csak egy van, ezért statikus)
+    static BandChipState appliedState;
+    static int8_t appliedBandIdx; // -1: ismeretlen (reset után)
+
+    // Band váltás statisztika
+    uint32_t lastSwitchMicros = 0;
+    uint32_t maxDeltaSwitchMicros = 0;
+    uint32_t maxFullSwitchMicros = 0;
+
+    // Memória állomás behívás statisztika
+    uint32_t lastRecallMicros = 0;
+    uint32_t maxFastRecallMicros = 0;
+
     void setBandWidth();
+    void setSsbBandWidth();
     void loadSSB();
+    void updateCurrentStep();
+    void updateChipState(uint8_t bandIdx);
+    void applyChipStateDelta(const BandChipState &target);
+    void storeAppliedState();
 
   public:
     // BandMode description
@@ -84,7 +121,7 @@ class Band {
 
     static const FrequencyStep stepSizeBFO[4];
 
-    Band(SI4735 &si4735, Config &configRef);
+    Band(Si4735Ext &si4735, Config &configRef);
     virtual ~Band() = default;
 
     /**
@@ -98,6 +135,37 @@ class Band {
      */
     void bandSet(bool useDefaults = false);
 
+    /**
+     * Band váltás
+     * FM <-> AM váltáskor teljes chip reset (bandInit), egyébként csak az eltérő parancsokat küldjük ki
+     * @param bandIdx az új sáv indexe
+     * @param useDefaults a sáv preferált demodulációját töltsük be?
+     */
+    void switchBand(uint8_t bandIdx, bool useDefaults = false);
+
+    /**
+     * Az utolsó band váltás ideje (us)
+     */
+    inline uint32_t getLastSwitchMicros() const { return lastSwitchMicros; }
+
+    /**
+     * Az utolsó memória állomás behívás ideje (us)
+     */
+    inline uint32_t getLastRecallMicros() const { return lastRecallMicros; }
+
+    /**
+     * A chip mód család meghatározása a demoduláció alapján
+     */
+    static inline uint8_t getModeFamily(uint8_t modulation) {
+        if (modulation == FM) {
+            return BAND_MODE_FAMILY_FM;
+        }
+        if (modulation == LSB or modulation == USB or modulation == CW) {
+            return BAND_MODE_FAMILY_SSB;
+        }
+        return BAND_MODE_FAMILY_AM;
+    }
+
     /**
      * A Default Antenna Tuning Capacitor értékének lekérdezése
      * @return Az alapértelmezett antenna tuning capacitor értéke
@@ -118,6 +186,20 @@ class Band {
         }
     }
 
+    /**
+     * Antenna Tuning Capacitor értéke egy frekvencián
+     * Az AntCapStore behangolt pontjai közötti interpolációval, ha nincs behangolva, akkor az alapértelmezett
+     * @param freq a frekvencia az aktuális sávban
+     */
+    uint16_t getAntCapValue(uint16_t freq);
+
+    /**
+     * Antenna Tuning Capacitor előkészítése az aktuális sáv egy frekvenciájához
+     * A chip könyvtár csak eltárolja, a következő setFrequency()-vel megy ki, így I2C forgalom nincs
+     * @param freq az új frekvencia
+     */
+    void applyAntCap(uint16_t freq);
+
     /**
      * Band beállítása
      */
@@ -141,6 +223,15 @@ class Band {
      */
     int8_t getBandIdxByBandName(const char *bandName);
 
+    /**
+     * A Band indexének elkérése frekvencia alapján
+     *
+     * @param freq A frekvencia (FM esetén 10kHz, egyébként kHz egységben)
+     * @param isFm FM frekvencia?
+     * @return A frekvenciát tartalmazó (legkeskenyebb) BandTable rekord indexe, vagy -1, ha nem található
+     */
+    int8_t getBandIdxByFrequency(uint16_t freq, bool isFm);
+
     /**
      * Demodulációs mód index szerinti elkérése (FM, AM, LSB, USB, CW)
      * @param demodIndex A demodulációs mód indexe
@@ -328,9 +419,27 @@ class Band {
     /**
      * Band nevek lekérdezése
      */
-    const char **getBandNames(uint8_t &count, bool isHamFilter);
+    const char *const *getBandNames(uint8_t &count, bool isHamFilter);
 
+    /**
+     * Memória állomás behangolása (azonos sáv/mód/sávszélesség esetén csak a frekvencia megy ki)
+     */
     void tuneMemoryStation(uint16_t frequency, int16_t bfoOffset, uint8_t bandIndex, uint8_t demodModIndex, uint8_t bandwidthIndex);
+
+    /**
+     * Ideiglenes SSB/CW hangolás egy másik sáv frekvenciájára (pl. beacon figyelés)
+     * Csak a chipet állítja be, a konfigot és a band táblát nem módosítja; visszatérés: restoreCurrentBand()
+     * @param modulation LSB, USB vagy CW
+     */
+    void tuneTemporarySsb(uint8_t bandIndex, uint16_t frequency, uint8_t modulation, int16_t bfoOffset);
+
+    /**
+     * Vissza a konfig szerinti sávra, frekvenciára és modulációra (egy ideiglenes hangolás után)
+     */
+    void restoreCurrentBand();
 };
 
+// A globális sáv kezelő (main.cpp)
+extern Band band;
+
 #endif // __BAND_H
\ No newline at end of file
@@ -0,0 +1,158 @@
+#ifndef __BAND_ACTIVITY_RECORDER_H
+#define __BAND_ACTIVITY_RECORDER_H
+
+#include "Band.h"
+#include "Si4735Ext.h"
+
+// Csatorna kiosztás és időbeosztás
+#define ACTIVITY_MAX_CHANNELS 64    // Egy sávon legfeljebb ennyi csatornát figyelünk
+#define ACTIVITY_BINS_PER_DAY 48    // Napon belüli időrések száma (30 perc)
+#define ACTIVITY_ARENA_SIZE 3072    // A tömörített sorok RAM kerete (byte)
+#define ACTIVITY_RSSI_SHIFT 1       // A tárolt szint RSSI >> 1 (2dB lépés), így kisebbek a különbségek
+#define ACTIVITY_MERGE_WEIGHT 3     // Egy időrés régi értéke ennyiszer számít az új nap méréséhez képest
+
+// Időzítések
+#define ACTIVITY_IDLE_TIMEOUT 120000    // Ennyi idő felhasználói tétlenség után kezdünk mérni (ms)
+#define ACTIVITY_PROBE_INTERVAL 1000    // Két csatorna mérés közötti idő (ms)
+#define ACTIVITY_PROBE_BUDGET 60        // Egy hangolás (oda vagy vissza) maximális ideje (ms)
+#define ACTIVITY_FLUSH_INTERVAL 1800000 // Ilyen sűrűn írjuk ki a változásokat a flash-re (ms)
+
+#define ACTIVITY_FILE_NAME "/activity.bin"
+
+/**
+ * @brief Sáv aktivitás rögzítő (heat-map)
+ *
+ * Tétlen időszakban (nincs touch/rotary, seek, scan) a beállított sáv csatornáit egyenként, rövid némított
+ * szünetekben végigméri (oda-hangolás, RSSI, vissza-hangolás). A mintákat a napon belüli időrésenként átlagolja,
+ * majd az időrés zárásakor egy sorba tömöríti: csatornánként az előzőhöz képesti különbség zigzag varint-ként,
+ * a nulla különbség-sorozatok egyetlen tokenként. A sorok egy fix méretű arénában vannak, a flash-re így,
+ * tömörítve kerülnek. A kijelző a RowCursor-ral soronként, kitömörítés nélkül olvas.
+ */
+class BandActivityRecorder {
+
+  public:
+    /**
+     * Egy tömörített sor szekvenciális olvasója
+     */
+    class RowCursor {
+      private:
+        const uint8_t *pos = nullptr;
+        const uint8_t *end = nullptr;
+        uint8_t remaining = 0; // Hátralévő csatornák
+        uint8_t zeroRun = 0;   // Hátralévő nulla különbségek
+        int16_t level = 0;     // Az aktuális szint
+
+        uint32_t readVarint();
+
+      public:
+        RowCursor() = default;
+        RowCursor(const uint8_t *data, uint8_t length, uint8_t channelCount) : pos(data), end(data + length), remaining(channelCount) {}
+
+        /**
+         * A következő csatorna szintje (RSSI >> ACTIVITY_RSSI_SHIFT)
+         * @return false, ha elfogyott
+         */
+        bool next(uint8_t &value);
+    };
+
+  private:
+    // A flash fájl fejléce
+    struct FileHeader {
+        uint32_t magic;
+        uint8_t version;
+        uint8_t bandIdx;
+        uint8_t channelCount;
+        uint8_t binCount;
+        uint16_t firstFreq;
+        uint16_t spacing;
+        uint16_t arenaUsed;
+        uint16_t rowOffset[ACTIVITY_BINS_PER_DAY];
+        uint8_t rowLength[ACTIVITY_BINS_PER_DAY];
+    };
+
+    Si4735Ext &si4735;
+    Band &band;
+
+    bool enabled = false;
+
+    // Csatorna kiosztás (a bandTable alapján)
+    int8_t bandIdx = -1;
+    uint16_t firstFreq = 0;
+    uint16_t spacing = 0;
+    uint8_t channelCount = 0;
+    uint8_t nextChannel = 0;
+
+    // Az aktuális időrés gyűjtője
+    int8_t currentBin = -1;
+    uint16_t rssiSum[ACTIVITY_MAX_CHANNELS];
+    uint8_t sampleCount[ACTIVITY_MAX_CHANNELS];
+
+    // Tömörített sorok
+    uint8_t arena[ACTIVITY_ARENA_SIZE];
+    uint16_t arenaUsed = 0;
+    uint16_t rowOffset[ACTIVITY_BINS_PER_DAY];
+    uint8_t rowLength[ACTIVITY_BINS_PER_DAY]; // 0: nincs adat
+
+    bool dirty = false;
+    uint16_t revision = 0; // Minden sor- vagy kiosztás változáskor nő (a kijelző ebből tudja, hogy rajzolnia kell)
+    uint16_t layoutRevision = 0; // A sáv (csatorna kiosztás) utolsó változásakor érvényes revision
+    uint16_t rowRevision[ACTIVITY_BINS_PER_DAY]; // Az egyes sorok utolsó változásakor érvényes revision
+    uint32_t lastProbe = 0;
+    uint32_t lastFlush = 0;
+
+    // Statisztika
+    uint32_t probeCount = 0;
+    uint16_t droppedRows = 0;
+
+    void resetAccumulator();
+    bool isIdle() const;
+    void probeNext();
+    bool measure(uint16_t freq, uint8_t &rssi);
+    void commitBin();
+    uint8_t encodeRow(const uint8_t *levels, uint8_t *out) const;
+    bool storeRow(uint8_t bin, const uint8_t *data, uint8_t length);
+    bool load();
+
+    static uint8_t writeVarint(uint32_t value, uint8_t *out);
+
+  public:
+    BandActivityRecorder(Si4735Ext &si4735, Band &band);
+
+    /**
+     * A figyelt sáv beállítása: a csatornák a sáv lépésközével (legfeljebb ACTIVITY_MAX_CHANNELS)
+     * A korábban rögzített adatokat a flash-ről tölti be, ha ugyanehhez a kiosztáshoz tartoznak
+     */
+    void configure(uint8_t bandIdx);
+
+    /**
+     * Rögzítés ki/bekapcsolása (a mérés rövid némított szünetekkel jár)
+     */
+    inline void setEnabled(bool enable) { enabled = enable; }
+    inline bool isEnabled() const { return enabled; }
+
+    /**
+     * Arduino loop
+     */
+    void loop();
+
+    /**
+     * A változások kiírása a flash-re
+     */
+    bool flush();
+
+    /**
+     * Egy időrés tömörített sorának olvasója
+     * @return false, ha az időrésre még nincs adat
+     */
+    bool getRow(uint8_t bin, RowCursor &cursor) const;
+
+    inline uint8_t getChannelCount() const { return channelCount; }
+    inline uint16_t getChannelFrequency(uint8_t channel) const { return firstFreq + channel * spacing; }
+    inline uint16_t getArenaUsed() const { return arenaUsed; }
+    inline uint16_t getDroppedRows() const { return droppedRows; }
+    inline uint16_t getRevision() const { return revision; }
+    inline uint16_t getLayoutRevision() const { return layoutRevision; }
+    inline uint16_t getRowRevision(uint8_t bin) const { return rowRevision[bin]; }
+};
+
+#endif // __BAND_ACTIVITY_RECORDER_H
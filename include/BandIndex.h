@@ -0,0 +1,248 @@
+#ifndef __BAND_INDEX_H
+#define __BAND_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BAND_INDEX_NOT_FOUND -1
+#define BAND_INDEX_MAX_SEED 4096 // Ennyi hash seed-et próbálunk a ütközésmentes név táblához
+
+/**
+ * @brief Fordítási időben generált keresőtáblák a bandTable fölé
+ *
+ * - frekvencia -> sáv: rendezett, diszjunkt intervallumok (átfedésnél a keskenyebb sáv nyer), bináris kereséssel
+ * - név -> sáv: ütközésmentes (perfect) hash tábla, a seed-et a fordító keresi meg
+ * - HAM és műsorszóró sáv név listák
+ *
+ * Az FM sávok frekvenciája 10kHz, a többié kHz egységben van, ezért ezek külön intervallum listában vannak.
+ */
+namespace BandIndex {
+
+// A bandTable konstans része
+struct BandRange {
+    const char *name;
+    bool fmUnits; // 10kHz egység (FM)?
+    uint16_t minimumFreq;
+    uint16_t maximumFreq;
+    uint16_t defFreq;
+    bool isHam;
+};
+
+/**
+ * FNV-1a hash, seed-del
+ */
+constexpr uint32_t nameHash(const char *s, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    while (*s) {
+        hash ^= (uint8_t)*s++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * A név tábla mérete: a sávok számának legalább négyszerese, 2 hatvány (így hamar van ütközésmentes seed)
+ */
+constexpr size_t nameSlotCount(size_t bandCount) {
+    size_t slots = 1;
+    while (slots < bandCount * 4) {
+        slots <<= 1;
+    }
+    return slots;
+}
+
+template <size_t N> struct Index {
+    static constexpr size_t MAX_SEGMENTS = 2 * N;
+    static constexpr size_t NAME_SLOTS = nameSlotCount(N);
+
+    // Diszjunkt frekvencia szegmensek: [start[i], start[i + 1]) -> bandIdx[i] (-1: egyik sávba sem esik)
+    struct Segments {
+        uint16_t start[MAX_SEGMENTS] = {};
+        int8_t bandIdx[MAX_SEGMENTS] = {};
+        uint8_t count = 0;
+    };
+
+    Segments fm;
+    Segments am;
+
+    int8_t nameSlots[NAME_SLOTS] = {};
+    uint32_t nameSeed = 0;
+
+    const char *hamNames[N] = {};
+    uint8_t hamCount = 0;
+    const char *broadcastNames[N] = {};
+    uint8_t broadcastCount = 0;
+
+    // Fordítási idejű ellenőrzések eredményei
+    bool ambiguous = false;     // Két azonos szélességű sáv fedi egymást, nem dönthető el, melyik nyer
+    bool shadowed = false;      // Van olyan sáv, amelyik egyetlen frekvencián sem nyer
+    bool nameCollision = false; // Nem találtunk ütközésmentes seed-et (pl. duplikált név)
+
+    /**
+     * Frekvencia -> sáv index, O(log n)
+     */
+    constexpr int8_t findByFrequency(uint16_t freq, bool fmUnits) const {
+        const Segments &segments = fmUnits ? fm : am;
+        int16_t lo = 0, hi = (int16_t)segments.count - 1, found = -1;
+        while (lo <= hi) {
+            int16_t mid = (lo + hi) / 2;
+            if (segments.start[mid] <= freq) {
+                found = mid;
+                lo = mid + 1;
+            } else {
+                hi = mid - 1;
+            }
+        }
+        return found < 0 ? BAND_INDEX_NOT_FOUND : segments.bandIdx[found];
+    }
+
+    /**
+     * Név -> jelölt sáv index, O(1) (a nevet a hívónak még össze kell hasonlítania)
+     */
+    constexpr int8_t findNameSlot(const char *name) const { return nameSlots[nameHash(name, nameSeed) & (NAME_SLOTS - 1)]; }
+};
+
+/**
+ * Egy mértékegység (FM/AM) szegmenseinek felépítése
+ */
+template <size_t N> constexpr void buildSegments(const BandRange (&bands)[N], bool fmUnits, typename Index<N>::Segments &segments, bool &ambiguous) {
+
+    // Sávhatárok: minden sáv [min, max] zárt intervallum -> min és max + 1
+    uint32_t bounds[2 * N] = {};
+    size_t boundCount = 0;
+    for (size_t i = 0; i < N; i++) {
+        if (bands[i].fmUnits == fmUnits) {
+            bounds[boundCount++] = bands[i].minimumFreq;
+            bounds[boundCount++] = (uint32_t)bands[i].maximumFreq + 1;
+        }
+    }
+
+    // Rendezés (beszúrásos) és duplikátumok kiszűrése
+    for (size_t i = 1; i < boundCount; i++) {
+        uint32_t value = bounds[i];
+        size_t j = i;
+        for (; j > 0 && bounds[j - 1] > value; j--) {
+            bounds[j] = bounds[j - 1];
+        }
+        bounds[j] = value;
+    }
+    size_t uniqueCount = 0;
+    for (size_t i = 0; i < boundCount; i++) {
+        if (uniqueCount == 0 || bounds[uniqueCount - 1] != bounds[i]) {
+            bounds[uniqueCount++] = bounds[i];
+        }
+    }
+
+    // Minden elemi szakaszhoz a legkeskenyebb lefedő sáv, az azonos sávú szomszédokat összevonjuk
+    for (size_t i = 0; i < uniqueCount; i++) {
+        uint32_t start = bounds[i];
+        int8_t best = BAND_INDEX_NOT_FOUND;
+        uint16_t bestWidth = 0;
+
+        for (size_t b = 0; b < N; b++) {
+            if (bands[b].fmUnits != fmUnits || start < bands[b].minimumFreq || start > bands[b].maximumFreq) {
+                continue;
+            }
+            uint16_t width = bands[b].maximumFreq - bands[b].minimumFreq;
+            if (best == BAND_INDEX_NOT_FOUND || width < bestWidth) {
+                best = (int8_t)b;
+                bestWidth = width;
+            } else if (width == bestWidth) {
+                // Azonos szélesség: csak a határon érintkezhetnek, ott a később kezdődő sáv nyer
+                const BandRange &current = bands[best];
+                if (bands[b].minimumFreq < current.maximumFreq && current.minimumFreq < bands[b].maximumFreq) {
+                    ambiguous = true;
+                } else if (bands[b].minimumFreq > current.minimumFreq) {
+                    best = (int8_t)b;
+                }
+            }
+        }
+
+        if (segments.count > 0 && segments.bandIdx[segments.count - 1] == best) {
+            continue;
+        }
+        segments.start[segments.count] = (uint16_t)start;
+        segments.bandIdx[segments.count] = best;
+        segments.count++;
+    }
+}
+
+/**
+ * A keresőtáblák felépítése (fordítási időben)
+ */
+template <size_t N> constexpr Index<N> build(const BandRange (&bands)[N]) {
+    Index<N> index{};
+
+    buildSegments<N>(bands, true, index.fm, index.ambiguous);
+    buildSegments<N>(bands, false, index.am, index.ambiguous);
+
+    // Minden sávnak legalább egy szegmensben nyernie kell
+    for (size_t b = 0; b < N; b++) {
+        const typename Index<N>::Segments &segments = bands[b].fmUnits ? index.fm : index.am;
+        bool owns = false;
+        for (size_t i = 0; i < segments.count; i++) {
+            owns |= segments.bandIdx[i] == (int8_t)b;
+        }
+        index.shadowed |= !owns;
+    }
+
+    // Ütközésmentes név hash seed keresése
+    index.nameCollision = true;
+    for (uint32_t seed = 0; seed < BAND_INDEX_MAX_SEED && index.nameCollision; seed++) {
+        for (size_t s = 0; s < Index<N>::NAME_SLOTS; s++) {
+            index.nameSlots[s] = BAND_INDEX_NOT_FOUND;
+        }
+        bool collision = false;
+        for (size_t b = 0; b < N && !collision; b++) {
+            size_t slot = nameHash(bands[b].name, seed) & (Index<N>::NAME_SLOTS - 1);
+            collision = index.nameSlots[slot] != BAND_INDEX_NOT_FOUND;
+            index.nameSlots[slot] = (int8_t)b;
+        }
+        if (!collision) {
+            index.nameSeed = seed;
+            index.nameCollision = false;
+        }
+    }
+
+    // HAM és műsorszóró név listák (a bandTable sorrendjében)
+    for (size_t b = 0; b < N; b++) {
+        if (bands[b].isHam) {
+            index.hamNames[index.hamCount++] = bands[b].name;
+        } else {
+            index.broadcastNames[index.broadcastCount++] = bands[b].name;
+        }
+    }
+
+    return index;
+}
+
+/**
+ * Sávhatárok ellenőrzése: min < max és min <= def <= max
+ */
+template <size_t N> constexpr bool rangesValid(const BandRange (&bands)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        if (bands[i].minimumFreq >= bands[i].maximumFreq || bands[i].defFreq < bands[i].minimumFreq || bands[i].defFreq > bands[i].maximumFreq) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * A HAM sávok nem fedhetik egymást (a határon érintkezhetnek)
+ */
+template <size_t N> constexpr bool hamBandsDisjoint(const BandRange (&bands)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = i + 1; j < N; j++) {
+            if (bands[i].isHam && bands[j].isHam && bands[i].fmUnits == bands[j].fmUnits && bands[i].minimumFreq < bands[j].maximumFreq &&
+                bands[j].minimumFreq < bands[i].maximumFreq) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace BandIndex
+
+#endif // __BAND_INDEX_H
@@ -12,133 +12,420 @@
  * Közös funkcionalitás FM és AM állomás tárolókhoz.
  * Eliminálja a kód duplikációt.
  *
+ * A tárolt tömb rögzített helyű slotokból áll (szabad slot: frequency == 0), egy állomás
+ * azonosítója (StationId) a slotja, ami törléskor/beszúráskor nem változik; a törlés nem tol el
+ * elemeket, csak a slotot szabadítja fel. A RAM-ban (betöltéskor felépített) indexek:
+ *  - nyílt címzésű hash tábla a (bandIndex, frequency, bfoOffset) kulcsra: O(1) duplikátum keresés,
+ *  - a szabad slotok verme: O(1) beszúrás,
+ *  - frekvencia szerint rendezett azonosító lista: a getStationByIndex() ebben a sorrendben ad,
+ *    a következő/előző memória keresése O(log n).
+ *
  * @tparam StationListType FmStationList_t vagy AmStationList_t
  * @tparam MaxStations MAX_FM_STATIONS vagy MAX_AM_STATIONS
  */
 template <typename StationListType, uint8_t MaxStations>
 class BaseStationStore : public StoreBase<StationListType> {
  public:
+  /// @brief Állomás azonosító: a slot sorszáma
+  typedef uint8_t StationId;
+  static constexpr StationId NO_STATION = 0xFF;
+  static_assert(MaxStations < NO_STATION, "Station ids must fit into a byte");
+
   StationListType data;
 
+ private:
+  /**
+   * @brief A hash tábla mérete: legalább kétszeres, 2 hatványa
+   */
+  static constexpr uint16_t hashSizeFor(uint16_t count) {
+    uint16_t size = 1;
+    while (size < count * 2) {
+      size <<= 1;
+    }
+    return size;
+  }
+  static constexpr uint16_t HASH_SIZE = hashSizeFor(MaxStations);
+
+  StationId hashTable[HASH_SIZE];     // Slot azonosítók, NO_STATION: üres
+  StationId sortedIds[MaxStations];   // Foglalt slotok frekvencia szerint
+  StationId freeSlots[MaxStations];   // Szabad slotok verme
+  uint8_t indexedCount = 0;
+  uint8_t freeCount = 0;
+
  protected:
   StationListType& getData() override { return data; }
   const StationListType& getData() const override { return data; }
 
+  /// @brief Kötegelt módosítás alatt (> 0) a PersistenceScheduler nem ment
+  uint8_t batchDepth = 0;
+
  public:
   /**
    * @brief Új állomás hozzáadása
+   *
+   * A RAM-ba a tárolható (tömörítés utáni) alak kerül: nagybetűs, rövidített név, kerekített BFO.
    */
-  bool addStation(const StationData& newStation) {
-    if (data.count >= MaxStations) {
+  bool addStation(const StationData& station) {
+    if (data.count >= MaxStations || freeCount == 0) {
       DEBUG("%s Memory full. Cannot add station.\n", this->getClassName());
       return false;
     }
 
+    // A 0 frekvencia a szabad slot jele
+    if (station.frequency == 0) {
+      return false;
+    }
+    StationData newStation = station;
+    StationPacking::normalize(newStation);
+
     // Duplikátum ellenőrzés
     if (isStationExists(newStation)) {
       return false;
     }
 
-    data.stations[data.count] = newStation;
+    StationId id = freeSlots[--freeCount];
+    data.stations[id] = newStation;
     data.count++;
+    this->markDirty();
+    indexStation(id);
 
-    DEBUG("%s Station added: %s (Freq: %d, BFO: %d)\n", this->getClassName(),
-          newStation.name, newStation.frequency, newStation.bfoOffset);
+    DEBUG("%s Station added: %s (Freq: %d, BFO: %d, Id: %d)\n",
+          this->getClassName(), newStation.name, newStation.frequency,
+          newStation.bfoOffset, id);
 
-    this->checkSave();
     return true;
   }
 
   /**
-   * @brief Állomás frissítése
+   * @brief Állomás frissítése (index: a frekvencia szerinti sorrendben)
    */
   bool updateStation(uint8_t index, const StationData& updatedStation) {
-    if (index >= data.count) {
+    if (index >= indexedCount) {
       DEBUG("Invalid index for %s station update: %d\n", this->getClassName(),
             index);
       return false;
     }
+    return updateStationById(sortedIds[index], updatedStation);
+  }
+
+  /**
+   * @brief Állomás frissítése azonosító alapján
+   *
+   * Ha az új kulcs (sáv, frekvencia, BFO) egy másik állomásé, a frissítés elmarad.
+   */
+  bool updateStationById(StationId id, const StationData& station) {
+    if (!isUsedSlot(id) || station.frequency == 0) {
+      DEBUG("Invalid id for %s station update: %d\n", this->getClassName(),
+            id);
+      return false;
+    }
+    StationData updatedStation = station;
+    StationPacking::normalize(updatedStation);
 
-    data.stations[index] = updatedStation;
-    DEBUG("%s Station updated at index %d: %s\n", this->getClassName(), index,
+    // A saját régi kulcsa nem számít duplikátumnak, ezért előbb kivesszük az indexből
+    unindexStation(id);
+    if (isStationExists(updatedStation)) {
+      indexStation(id);  // A régi adat még a slotban van
+      return false;
+    }
+    data.stations[id] = updatedStation;
+    indexStation(id);
+    this->markDirty();
+    DEBUG("%s Station updated (Id: %d): %s\n", this->getClassName(), id,
           updatedStation.name);
-    this->checkSave();
     return true;
   }
 
   /**
-   * @brief Állomás törlése
+   * @brief Állomás törlése (index: a frekvencia szerinti sorrendben)
    */
   bool deleteStation(uint8_t index) {
-    if (index >= data.count) {
+    if (index >= indexedCount) {
       DEBUG("Invalid index for %s station delete: %d\n", this->getClassName(),
             index);
       return false;
     }
+    return deleteStationById(sortedIds[index]);
+  }
 
-    // Elemek eltolása
-    for (uint8_t i = index; i < data.count - 1; ++i) {
-      data.stations[i] = data.stations[i + 1];
+  /**
+   * @brief Állomás törlése azonosító alapján: csak a slot szabadul fel, nincs eltolás
+   */
+  bool deleteStationById(StationId id) {
+    if (!isUsedSlot(id)) {
+      DEBUG("Invalid id for %s station delete: %d\n", this->getClassName(),
+            id);
+      return false;
     }
-    data.count--;
 
-    // Utolsó elem nullázása
-    memset(&data.stations[data.count], 0, sizeof(StationData));
+    unindexStation(id);
+    memset(&data.stations[id], 0, sizeof(StationData));
+    freeSlots[freeCount++] = id;
+    data.count--;
+    this->markDirty();
 
-    DEBUG("%s Station deleted at index %d.\n", this->getClassName(), index);
-    this->checkSave();
+    DEBUG("%s Station deleted (Id: %d).\n", this->getClassName(), id);
     return true;
   }
 
   /**
-   * @brief Állomás keresése
+   * @brief Kötegelt módosítás kezdete
+   *
+   * Az endBatch()-ig a PersistenceScheduler nem menti a félkész listát, utána
+   * a végeredmény egyetlen commit-tal kerül a flash-re.
+   */
+  void beginBatch() { batchDepth++; }
+
+  /**
+   * @brief Kötegelt módosítás vége (a mentést az ütemező végzi)
+   */
+  void endBatch() {
+    if (batchDepth > 0) {
+      batchDepth--;
+    }
+  }
+
+  bool canSave() const override { return batchDepth == 0; }
+
+  /**
+   * @brief Az összes állomás törlése
+   */
+  void clearStations() {
+    memset(data.stations, 0, sizeof(data.stations));
+    data.count = 0;
+    rebuildIndex();
+    this->markDirty();
+    DEBUG("%s All stations cleared.\n", this->getClassName());
+  }
+
+  /**
+   * @brief Betöltés, utána az indexek felépítése
+   */
+  void load() override {
+    StoreBase<StationListType>::load();
+    rebuildIndex();
+  }
+
+  /**
+   * @brief Állomás keresése (O(1))
+   *
+   * SSB/CW állomásnál a BFO eltolásnak is egyeznie kell, AM/FM állomásnál
+   * elég a frekvencia és a sáv. A BFO-t a tárolt (kerekített) értékkel vetjük össze.
+   *
+   * @return Az állomás azonosítója, vagy -1
    */
   int findStation(uint16_t frequency, uint8_t bandIndex,
-                  int16_t bfoOffset = 0) {
-    for (uint8_t i = 0; i < data.count; ++i) {
-      if (data.stations[i].frequency == frequency &&
-          data.stations[i].bandIndex == bandIndex) {
-        // SSB/CW esetén BFO is kell
-        if (isSSBorCW(data.stations[i].modulation)) {
-          if (data.stations[i].bfoOffset == bfoOffset) return i;
-        } else {
-          return i;  // AM/FM esetén elég a frekvencia és sáv
-        }
+                  int16_t bfoOffset = 0) const {
+    bfoOffset = StationPacking::normalizeBfo(bfoOffset);
+    StationId id = lookup(bandIndex, frequency, bfoOffset);
+    if (id == NO_STATION && bfoOffset != 0) {
+      id = lookup(bandIndex, frequency, 0);
+      if (id != NO_STATION && isSSBorCW(data.stations[id].modulation)) {
+        id = NO_STATION;
       }
     }
-    return -1;
+    return id == NO_STATION ? -1 : id;
+  }
+
+  /**
+   * @brief A következő (vagy előző) tárolt állomás a frekvencia szerinti sorrendben
+   *
+   * Bináris kereséssel, O(log n); a lista végén körbefordul.
+   *
+   * @param frequency A jelenlegi frekvencia
+   * @param up true: a nagyobb frekvenciájú következő, false: a kisebb előző
+   * @return Az állomás azonosítója, vagy NO_STATION, ha üres a tároló
+   */
+  StationId findNextStation(uint16_t frequency, bool up) const {
+    if (indexedCount == 0) {
+      return NO_STATION;
+    }
+    // Az első, frequency-nél nem kisebb (up: nagyobb) frekvenciájú elem helye
+    uint8_t low = 0, high = indexedCount;
+    while (low < high) {
+      uint8_t mid = (low + high) / 2;
+      uint16_t midFrequency = data.stations[sortedIds[mid]].frequency;
+      if (up ? midFrequency <= frequency : midFrequency < frequency) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    if (up) {
+      return sortedIds[low < indexedCount ? low : 0];
+    }
+    return sortedIds[low > 0 ? low - 1 : indexedCount - 1];
   }
 
   // Inline helper metódusok
   inline uint8_t getStationCount() const { return data.count; }
 
+  /**
+   * @brief Az index. állomás a frekvencia szerinti sorrendben
+   */
   inline const StationData* getStationByIndex(uint8_t index) const {
-    return (index < data.count) ? &data.stations[index] : nullptr;
+    return (index < indexedCount) ? &data.stations[sortedIds[index]] : nullptr;
+  }
+
+  /**
+   * @brief Az index. állomás azonosítója a frekvencia szerinti sorrendben
+   */
+  inline StationId getStationId(uint8_t index) const {
+    return (index < indexedCount) ? sortedIds[index] : NO_STATION;
+  }
+
+  inline const StationData* getStationById(StationId id) const {
+    return isUsedSlot(id) ? &data.stations[id] : nullptr;
+  }
+
+ protected:
+  /**
+   * @brief Az indexek felépítése a tárolt slotokból (betöltés, alapértékek után)
+   *
+   * A régebbi, tömörített (eltolásos törlésű) lista is érvényes slot kiosztás.
+   */
+  void rebuildIndex() {
+    memset(hashTable, NO_STATION, sizeof(hashTable));
+    indexedCount = 0;
+    freeCount = 0;
+    // Visszafelé, hogy a verem tetején a legkisebb szabad slot legyen
+    for (int16_t id = MaxStations - 1; id >= 0; id--) {
+      if (data.stations[id].frequency == 0) {
+        freeSlots[freeCount++] = id;
+      }
+    }
+    for (uint8_t id = 0; id < MaxStations; id++) {
+      if (data.stations[id].frequency != 0) {
+        indexStation(id);
+      }
+    }
+    if (data.count != indexedCount) {
+      data.count = indexedCount;
+      this->markDirty();
+    }
   }
 
  private:
+  inline bool isUsedSlot(StationId id) const {
+    return id < MaxStations && data.stations[id].frequency != 0;
+  }
+
   /**
-   * @brief Ellenőrzi, hogy az állomás már létezik-e
+   * @brief A hash kulcsban a BFO csak SSB/CW esetén számít
    */
-  bool isStationExists(const StationData& newStation) {
-    for (uint8_t i = 0; i < data.count; ++i) {
-      if (data.stations[i].frequency == newStation.frequency &&
-          data.stations[i].bandIndex == newStation.bandIndex) {
-        // SSB/CW esetén BFO is kell egyeznie
-        if (isSSBorCW(newStation.modulation)) {
-          if (data.stations[i].bfoOffset == newStation.bfoOffset) {
-            DEBUG("Station already exists (Freq: %d, Band: %d, BFO: %d).\n",
-                  newStation.frequency, newStation.bandIndex,
-                  newStation.bfoOffset);
-            return true;
-          }
-        } else {
-          DEBUG("Station already exists (Freq: %d, Band: %d).\n",
-                newStation.frequency, newStation.bandIndex);
-          return true;
-        }
+  inline int16_t keyBfo(const StationData& station) const {
+    return isSSBorCW(station.modulation) ? station.bfoOffset : 0;
+  }
+
+  static inline uint16_t hashOf(uint8_t bandIndex, uint16_t frequency,
+                                int16_t bfo) {
+    uint32_t h = (uint32_t)frequency * 40503u ^ (uint32_t)bandIndex * 2654435761u ^
+                 (uint16_t)bfo * 97u;
+    return (h ^ (h >> 16)) & (HASH_SIZE - 1);
+  }
+
+  StationId lookup(uint8_t bandIndex, uint16_t frequency, int16_t bfo) const {
+    for (uint16_t pos = hashOf(bandIndex, frequency, bfo);;
+         pos = (pos + 1) & (HASH_SIZE - 1)) {
+      StationId id = hashTable[pos];
+      if (id == NO_STATION) {
+        return NO_STATION;
+      }
+      const StationData& station = data.stations[id];
+      if (station.frequency == frequency && station.bandIndex == bandIndex &&
+          keyBfo(station) == bfo) {
+        return id;
       }
     }
+  }
+
+  /**
+   * @brief Rendezési sorrend: frekvencia, sáv, BFO
+   */
+  inline bool isBefore(StationId a, StationId b) const {
+    const StationData& sa = data.stations[a];
+    const StationData& sb = data.stations[b];
+    if (sa.frequency != sb.frequency) return sa.frequency < sb.frequency;
+    if (sa.bandIndex != sb.bandIndex) return sa.bandIndex < sb.bandIndex;
+    return sa.bfoOffset < sb.bfoOffset;
+  }
+
+  /**
+   * @brief Az első hely a rendezett listában, amely nincs az id előtt (bináris keresés)
+   */
+  uint8_t sortedPosition(StationId id) const {
+    uint8_t low = 0, high = indexedCount;
+    while (low < high) {
+      uint8_t mid = (low + high) / 2;
+      if (isBefore(sortedIds[mid], id)) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+
+  /**
+   * @brief Felvétel a hash táblába és a rendezett listába (a count nő)
+   */
+  void indexStation(StationId id) {
+    const StationData& station = data.stations[id];
+    uint16_t pos = hashOf(station.bandIndex, station.frequency, keyBfo(station));
+    while (hashTable[pos] != NO_STATION) {
+      pos = (pos + 1) & (HASH_SIZE - 1);
+    }
+    hashTable[pos] = id;
+
+    uint8_t low = sortedPosition(id);
+    memmove(&sortedIds[low + 1], &sortedIds[low], indexedCount - low);
+    sortedIds[low] = id;
+    indexedCount++;
+  }
+
+  /**
+   * @brief Eltávolítás a hash táblából (visszaléptetéses törlés, sírkő nélkül)
+   * és a rendezett listából
+   */
+  void unindexStation(StationId id) {
+    const StationData& station = data.stations[id];
+    uint16_t pos = hashOf(station.bandIndex, station.frequency, keyBfo(station));
+    while (hashTable[pos] != id) {
+      pos = (pos + 1) & (HASH_SIZE - 1);
+    }
+    // A lánc további elemeit visszaléptetjük, ha a saját helyük nem esik a lyuk és közéjük
+    uint16_t hole = pos;
+    for (uint16_t next = (hole + 1) & (HASH_SIZE - 1); hashTable[next] != NO_STATION;
+         next = (next + 1) & (HASH_SIZE - 1)) {
+      const StationData& other = data.stations[hashTable[next]];
+      uint16_t home = hashOf(other.bandIndex, other.frequency, keyBfo(other));
+      if (((next - home) & (HASH_SIZE - 1)) >= ((next - hole) & (HASH_SIZE - 1))) {
+        hashTable[hole] = hashTable[next];
+        hole = next;
+      }
+    }
+    hashTable[hole] = NO_STATION;
+
+    // Egyenlő sorrendű elem csak régi, duplikátumot tartalmazó listában lehet: azok között lépkedünk
+    uint8_t i = sortedPosition(id);
+    while (i < indexedCount && sortedIds[i] != id && !isBefore(id, sortedIds[i])) {
+      i++;
+    }
+    if (i < indexedCount && sortedIds[i] == id) {
+      memmove(&sortedIds[i], &sortedIds[i + 1], indexedCount - i - 1);
+      indexedCount--;
+    }
+  }
+
+  /**
+   * @brief Ellenőrzi, hogy az állomás már létezik-e
+   */
+  bool isStationExists(const StationData& newStation) const {
+    if (lookup(newStation.bandIndex, newStation.frequency, keyBfo(newStation)) != NO_STATION) {
+      DEBUG("Station already exists (Freq: %d, Band: %d, BFO: %d).\n",
+            newStation.frequency, newStation.bandIndex, newStation.bfoOffset);
+      return true;
+    }
     return false;
   }
 
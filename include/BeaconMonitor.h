@@ -0,0 +1,124 @@
+#ifndef __BEACON_MONITOR_H
+#define __BEACON_MONITOR_H
+
+#include <functional>
+
+#include "Band.h"
+#include "Si4735Ext.h"
+
+// NCDXF/IARU International Beacon Project menetrend
+#define BEACON_COUNT 18           // Beaconok száma
+#define BEACON_BAND_COUNT 5       // 20m, 17m, 15m, 12m, 10m
+#define BEACON_SLOT_MS 10000      // Egy beacon ennyi ideig ad egy sávon (ms), a teljes ciklus 18 x 10s = 3 perc
+
+// Mérés időzítése a slot elejéhez képest
+#define BEACON_RETUNE_LEAD 500    // A slot határa előtt ennyivel hangolunk át (ms)
+#define BEACON_MEASURE_START 1000 // A hívójel kezdete után kezdünk mérni (ms)
+#define BEACON_MEASURE_END 9500   // Eddig mérünk (ms), utána jöhet az áthangolás
+
+#define BEACON_HISTORY_DEPTH 8    // Beacon x sáv páronként ennyi korábbi mérés (egy pár ~15 percenként kerül sorra)
+#define BEACON_NOT_MEASURED 0xFF
+
+/**
+ * @brief NCDXF/IARU beacon figyelő
+ *
+ * A 18 beacon 10 másodpercenként lép a következő sávra (14100, 18110, 21150, 24930, 28200 kHz), így az s. slotban
+ * a b. sávon az (s - b) mod 18 indexű beacon ad. A monitor minden slot előtt BEACON_RETUNE_LEAD-del átvált a következő
+ * slot sávjára, a slotban mért legnagyobb RSSI/SNR kerül a beacon x sáv mátrixba. A jelszintet a közös
+ * SignalQualitySampler mintáiból vesszük (az áthangolás alatt a hangoló foglalt, a régi minták nem számítanak). A sávot ciklusonként eltolja,
+ * így 5 ciklus (15 perc) alatt minden beacon x sáv pár sorra kerül. Pontos UTC idő kell (RadioClock).
+ * Csak a chipet hangolja át (Band::tuneTemporarySsb), a konfig és a band tábla a figyelés alatt változatlan marad.
+ */
+class BeaconMonitor {
+
+  public:
+    // Egy beacon x sáv pár utolsó mérése
+    struct Measurement {
+        uint8_t rssi;         // Csúcs RSSI (dBuV), BEACON_NOT_MEASURED: még nem mértük
+        uint8_t snr;          // Csúcs SNR (dB)
+        uint16_t minuteOfDay; // A mérés ideje (UTC perc)
+    };
+
+    // Mért slot esemény (a kijelző frissítéséhez)
+    using MeasurementCallback = std::function<void(uint8_t beacon, uint8_t bandSlot, const Measurement &measurement)>;
+
+    static const char *const beaconCallsigns[BEACON_COUNT];
+    static const uint16_t beaconFrequencies[BEACON_BAND_COUNT];
+
+  private:
+    Si4735Ext &si4735;
+    Band &band;
+
+    bool running = false;
+    int8_t bandIndexes[BEACON_BAND_COUNT]; // A beacon frekvenciák bandTable indexei
+
+    // Slot állapot
+    int32_t tunedSlot = -1; // A napon belüli slot, amire hangolva vagyunk (-1: nincs)
+    uint8_t tunedBandSlot = 0;
+    uint8_t peakRssi = 0;
+    uint8_t peakSnr = 0;
+    bool peakValid = false;
+    uint32_t retunedAt = 0;     // millis() az áthangolás végén, ennél régebbi minta még a régi frekvenciáé
+    uint32_t lastSampledAt = 0; // A legutóbb feldolgozott minta ideje
+
+    // Propagációs mátrix
+    Measurement latest[BEACON_COUNT][BEACON_BAND_COUNT];
+    uint8_t snrHistory[BEACON_COUNT][BEACON_BAND_COUNT][BEACON_HISTORY_DEPTH];
+    uint8_t historyHead[BEACON_COUNT][BEACON_BAND_COUNT];
+
+    // Statisztika
+    int32_t maxRetuneLateMs = 0; // A legkésőbb befejezett áthangolás a slot határához képest (ms, negatív: időben)
+
+    MeasurementCallback measurementCallback = nullptr;
+
+    static uint8_t bandSlotFor(uint32_t slot);
+    void retune(uint32_t slot);
+    void finishSlot();
+
+  public:
+    BeaconMonitor(Si4735Ext &si4735, Band &band);
+
+    /**
+     * Figyelés indítása (szinkronizált RadioClock és a beacon frekvenciákat tartalmazó sávok kellenek)
+     * @return true, ha elindult
+     */
+    bool start();
+
+    /**
+     * Leállítás, vissza a konfig szerinti sávra/frekvenciára/modulációra
+     */
+    void stop();
+
+    /**
+     * Arduino loop
+     */
+    void loop();
+
+    /**
+     * Az s. slotban a b. sávon adó beacon indexe
+     */
+    static inline uint8_t beaconFor(uint32_t slot, uint8_t bandSlot) { return (slot + BEACON_COUNT - bandSlot % BEACON_COUNT) % BEACON_COUNT; }
+
+    inline bool isRunning() const { return running; }
+    inline const Measurement &getLatest(uint8_t beacon, uint8_t bandSlot) const { return latest[beacon][bandSlot]; }
+
+    /**
+     * Korábbi SNR mérés
+     * @param age 0: a legfrissebb
+     */
+    inline uint8_t getSnrHistory(uint8_t beacon, uint8_t bandSlot, uint8_t age) const {
+        return snrHistory[beacon][bandSlot][(historyHead[beacon][bandSlot] + BEACON_HISTORY_DEPTH - 1 - age) % BEACON_HISTORY_DEPTH];
+    }
+
+    /**
+     * Az éppen figyelt beacon hívójele és frekvenciája (a kijelzőnek)
+     * @return nullptr, ha még nem hangoltunk rá egyik slotra sem
+     */
+    inline const char *getTunedCallsign() const { return running && tunedSlot >= 0 ? beaconCallsigns[beaconFor(tunedSlot, tunedBandSlot)] : nullptr; }
+    inline uint16_t getTunedFrequency() const { return beaconFrequencies[tunedBandSlot]; }
+
+    inline int32_t getMaxRetuneLateMs() const { return maxRetuneLateMs; }
+    inline void setMeasurementCallback(MeasurementCallback callback) { measurementCallback = callback; }
+};
+
+#endif // __BEACON_MONITOR_H
@@ -2,8 +2,11 @@
 #define __CONFIG_H
 
 #include "ConfigData.h"
+#include "ConfigSchema.h"
 #include "DebugDataInspector.h" // Szükséges a debug kiíratáshoz
 #include "StoreBase.h"
+#include "StoreFlashLog.h"
+#include "rtVars.h"
 
 // Alapértelmezett konfigurációs adatok (readonly, const)
 extern const Config_t DEFAULT_CONFIG;
@@ -18,6 +21,12 @@ class Config : public StoreBase<Config_t> {
     Config_t data;
 
   protected:
+    // Az utoljára mentett (vagy betöltött) állapot: a 'data' közvetlen módosításait ehhez hasonlítjuk
+    Config_t savedData;
+
+    // Az rtv::lastUserActivity utoljára látott értéke: ha azóta nem változott, nincs mit összehasonlítani
+    uint32_t activitySeen = 0;
+
     const char *getClassName() const override { return "Config"; }
 
     /**
@@ -30,28 +39,82 @@ class Config : public StoreBase<Config_t> {
      */
     const Config_t &getData() const override { return data; };
 
+    /**
+     * A 'data' mezőit a program közvetlenül írja: a háttérben futó írók (sávváltás, memória
+     * szkenner, hangolás) markDirty()-t hívnak, a képernyők beállításait pedig itt vesszük észre.
+     * Összehasonlítani csak akkor kell, ha a legutóbbi hívás óta volt felhasználói esemény,
+     * így a tétlen lekérdezések nem futják végig a teljes struktúrát.
+     */
+    void collectUntrackedChanges() override {
+        if (rtv::lastUserActivity == activitySeen) {
+            return;
+        }
+        activitySeen = rtv::lastUserActivity;
+        if (memcmp(&data, &savedData, sizeof(Config_t)) != 0) {
+            markDirty();
+            savedData = data;
+        }
+    }
+
+    /**
+     * A tárolt konfig betöltése: a tag-es rekord mezői közvetlenül a 'data'-ba kerülnek,
+     * a hiányzók alapértékek maradnak. Ha még nincs ilyen rekord, a korábbi nyers
+     * Config_t képet (flash log, majd EEPROM) veszi át, és tag-es formában menti.
+     */
+    uint16_t loadRecord() {
+        memcpy(&data, &DEFAULT_CONFIG, sizeof(Config_t));
+        if (!flashRecordStore.isReady()) {
+            return StoreEepromBase<Config_t>::load(data, 0, getClassName());
+        }
+
+        ConfigRecord_t record;
+        uint16_t crc = StoreFlashLog<ConfigRecord_t>::read(record, FLASH_STORE_CONFIG, getClassName());
+        if (crc != 0 && ConfigSchema::decode(record, data)) {
+            return crc;
+        }
+        memcpy(&data, &DEFAULT_CONFIG, sizeof(Config_t)); // A hibás rekord részben már felülírhatta
+
+        // Átállás a korábbi (0. verziójú) nyers képről: a régi kép csak változatlan Config_t méret mellett olvasható
+        bool valid = StoreFlashLog<Config_t>::read(data, FLASH_STORE_CONFIG, getClassName()) != 0;
+        if (!valid) {
+            memcpy(&data, &DEFAULT_CONFIG, sizeof(Config_t));
+            StoreEepromBase<Config_t>::getIfValid(data, valid, 0, getClassName());
+        }
+        DEBUG("[%s] %s mentése tag-es rekordként\n", getClassName(), valid ? "Régi konfig kép" : "Alapértékek");
+        ConfigSchema::encode(data, record);
+        return StoreFlashLog<ConfigRecord_t>::save(record, FLASH_STORE_CONFIG, 0, getClassName());
+    }
+
     // Felülírjuk a mentést/betöltést a debug kiíratás hozzáadásához
     uint16_t performSave() override {
-        uint16_t savedCrc = StoreEepromBase<Config_t>::save(getData(), 0, getClassName());
-#ifdef __DEBUG
+        uint16_t savedCrc;
+        if (flashRecordStore.isReady()) {
+            ConfigRecord_t record;
+            ConfigSchema::encode(data, record);
+            savedCrc = StoreFlashLog<ConfigRecord_t>::save(record, FLASH_STORE_CONFIG, 0, getClassName());
+        } else {
+            // A 2K-s EEPROM kiosztás a nyers Config_t képre készült
+            savedCrc = StoreEepromBase<Config_t>::save(data, 0, getClassName());
+        }
         if (savedCrc != 0) {
+            savedData = data; // A jelzett módosítások se jelenjenek meg újra a következő összehasonlításnál
+#ifdef __DEBUG
             DebugDataInspector::printConfigData(getData());
-        }
 #endif
+        }
         return savedCrc;
     }
 
     uint16_t performLoad() override {
-        uint16_t loadedCrc = StoreEepromBase<Config_t>::load(getData(), 0, getClassName());
+        uint16_t loadedCrc = loadRecord();
 #ifdef __DEBUG
         DebugDataInspector::printConfigData(getData()); // Akkor is kiírjuk, ha defaultot töltött
 #endif
+        savedData = data;
         uint8_t currentTimeout = data.screenSaverTimeoutMinutes;
         if (currentTimeout < SCREEN_SAVER_TIMEOUT_MIN || currentTimeout > SCREEN_SAVER_TIMEOUT_MAX) {
             data.screenSaverTimeoutMinutes = SCREEN_SAVER_TIMEOUT;
-            // A 'data' módosítása miatt a checkSave() később észlelni fogja az
-            // eltérést a lastCRC-hez képest (amit a loadedCrc alapján állít be a
-            // StoreBase), és menteni fogja a javított adatot.
+            markDirty(); // A javított adatot a következő checkSave() menti
         }
         return loadedCrc;
     }
@@ -61,13 +124,14 @@ class Config : public StoreBase<Config_t> {
      * Konstruktor
      * @param pData Pointer a konfigurációs adatokhoz
      */
-    Config() : StoreBase<Config_t>(), data(DEFAULT_CONFIG) {}
+    Config() : StoreBase<Config_t>(), data(DEFAULT_CONFIG), savedData(DEFAULT_CONFIG) {}
 
     /**
      * Alapértelmezett adatok betöltése
      */
     void loadDefaults() override {
         memcpy(&data, &DEFAULT_CONFIG, sizeof(Config_t));
+        markDirty(); // A tárolt példányt is felül kell írni, akkor is, ha a RAM-ban már az alapértékek voltak
         analogWrite(PIN_TFT_BACKGROUND_LED,
                     data.tftBackgroundBrightness); // Háttérvilágítás beállítása
     }
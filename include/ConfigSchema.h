@@ -0,0 +1,131 @@
+#ifndef __CONFIG_SCHEMA_H
+#define __CONFIG_SCHEMA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ConfigData.h"
+
+#define CONFIG_SCHEMA_VERSION 1 // A tárolt formátum verziója (0: a korábbi nyers Config_t kép)
+#define CONFIG_RECORD_SIZE 256  // A tárolt rekord fix mérete: firmware verziók között nem változhat!
+
+/**
+ * @brief A Config_t mezőnkénti (tag-hossz-érték) tárolási sémája
+ *
+ * Minden mező egy állandó tag számot kap, a rekordba [tag][hossz][érték] formában kerül.
+ * Így egy új mező hozzáadása nem teszi érvénytelenné a korábban mentett konfigot:
+ *  - az ismeretlen tag-eket (újabb firmware mezői) átugorjuk,
+ *  - a rekordból hiányzó mezők az alapértéküket kapják,
+ *  - a mező átnevezése nem számít (csak a tag), a szélesebb/keskenyebb egész típusra
+ *    váltott mezőt átváltjuk, az áthelyezett mezőt a currentTag() képezi le.
+ * A tag-eket tilos újraszámozni vagy újra felhasználni; törölt mező helyén CONFIG_FIELD_REMOVED marad.
+ */
+namespace ConfigSchema {
+
+enum class Kind : uint8_t { Unsigned, Signed, Float, Raw, Removed };
+
+struct Field {
+    uint8_t tag;
+    Kind kind;
+    uint8_t size;
+    uint16_t offset;
+};
+
+#define CONFIG_FIELD(tagNum, kind, field) {tagNum, ConfigSchema::Kind::kind, sizeof(Config_t::field), offsetof(Config_t, field)}
+#define CONFIG_FIELD_REMOVED(tagNum) {tagNum, ConfigSchema::Kind::Removed, 0, 0}
+
+// A tag az 1-től induló sorszám (a tábla indexe + 1), így a keresés O(1)
+inline constexpr Field fields[] = {
+    CONFIG_FIELD(1, Unsigned, bandIdx),
+    CONFIG_FIELD(2, Unsigned, bwIdxAM),
+    CONFIG_FIELD(3, Unsigned, bwIdxFM),
+    CONFIG_FIELD(4, Unsigned, bwIdxMW),
+    CONFIG_FIELD(5, Unsigned, bwIdxSSB),
+    CONFIG_FIELD(6, Unsigned, ssIdxMW),
+    CONFIG_FIELD(7, Unsigned, ssIdxAM),
+    CONFIG_FIELD(8, Unsigned, ssIdxFM),
+    CONFIG_FIELD(9, Signed, currentBFO),
+    CONFIG_FIELD(10, Unsigned, currentBFOStep),
+    CONFIG_FIELD(11, Signed, currentBFOmanu),
+    CONFIG_FIELD(12, Unsigned, currentSquelch),
+    CONFIG_FIELD(13, Unsigned, squelchUsesRSSI),
+    CONFIG_FIELD(14, Unsigned, rdsEnabled),
+    CONFIG_FIELD(15, Unsigned, currVolume),
+    CONFIG_FIELD(16, Unsigned, agcGain),
+    CONFIG_FIELD(17, Unsigned, currentAGCgain),
+    CONFIG_FIELD(18, Raw, tftCalibrateData),
+    CONFIG_FIELD(19, Unsigned, tftBackgroundBrightness),
+    CONFIG_FIELD(20, Unsigned, tftDigitLigth),
+    CONFIG_FIELD(21, Unsigned, screenSaverTimeoutMinutes),
+    CONFIG_FIELD(22, Unsigned, beeperEnabled),
+    CONFIG_FIELD(23, Unsigned, miniAudioFftModeAm),
+    CONFIG_FIELD(24, Unsigned, miniAudioFftModeFm),
+    CONFIG_FIELD(25, Float, miniAudioFftConfigAm),
+    CONFIG_FIELD(26, Float, miniAudioFftConfigFm),
+    CONFIG_FIELD(27, Float, miniAudioFftConfigAnalyzer),
+    CONFIG_FIELD(28, Float, miniAudioFftConfigRtty),
+    CONFIG_FIELD(29, Unsigned, cwReceiverOffsetHz),
+    CONFIG_FIELD(30, Float, rttyMarkFrequencyHz),
+    CONFIG_FIELD(31, Float, rttyShiftHz),
+};
+inline constexpr uint8_t FIELD_COUNT = sizeof(fields) / sizeof(fields[0]);
+
+// A rekord fejléce
+struct Header {
+    uint8_t version;  // CONFIG_SCHEMA_VERSION a mentéskor
+    uint8_t reserved; // 0
+    uint16_t length;  // A hasznos (tag) rész hossza
+};
+
+/**
+ * A kódolt mezők összes mérete
+ */
+constexpr size_t encodedSize() {
+    size_t size = 0;
+    for (uint8_t i = 0; i < FIELD_COUNT; i++) {
+        size += fields[i].kind == Kind::Removed ? 0 : 2 + fields[i].size;
+    }
+    return size;
+}
+
+/**
+ * A tábla sorrendjének ellenőrzése (tag == index + 1)
+ */
+constexpr bool tagsAreDense() {
+    for (uint8_t i = 0; i < FIELD_COUNT; i++) {
+        if (fields[i].tag != i + 1) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(tagsAreDense(), "Config schema tags must be numbered 1..N in table order");
+
+} // namespace ConfigSchema
+
+// A tárolt rekord: fejléc + tag-ek, a maradék 0
+struct ConfigRecord_t {
+    ConfigSchema::Header header;
+    uint8_t payload[CONFIG_RECORD_SIZE - sizeof(ConfigSchema::Header)];
+};
+static_assert(sizeof(ConfigRecord_t) == CONFIG_RECORD_SIZE, "ConfigRecord_t must have a fixed size");
+static_assert(ConfigSchema::encodedSize() <= sizeof(ConfigRecord_t::payload), "Config schema does not fit into CONFIG_RECORD_SIZE");
+static_assert(sizeof(ConfigRecord_t) != sizeof(Config_t), "The record must be distinguishable from the legacy raw image");
+
+namespace ConfigSchema {
+
+/**
+ * A konfig kódolása a rekordba
+ */
+void encode(const Config_t &config, ConfigRecord_t &record);
+
+/**
+ * A rekord egyszeri bejárása, a mezők közvetlenül a 'config'-ba kerülnek
+ * A rekordban nem szereplő mezők értéke nem változik (a hívó előtte az alapértékeket állítja be).
+ * @return false, ha a rekord szerkezete hibás
+ */
+bool decode(const ConfigRecord_t &record, Config_t &config);
+
+} // namespace ConfigSchema
+
+#endif // __CONFIG_SCHEMA_H
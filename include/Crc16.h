@@ -0,0 +1,50 @@
+#ifndef __CRC16_H
+#define __CRC16_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Ettől a mérettől (byte) a DMA sniffer számol, alatta a táblázatos CPU változat gyorsabb (a DMA beállítás ideje miatt)
+#define CRC16_DMA_THRESHOLD 256
+
+/**
+ * @brief CRC16-CCITT (0x1021, MSB first) számítás
+ *
+ * Három, azonos eredményt adó változat:
+ *  - bitwise: az eredeti bitenkénti ciklus (referencia)
+ *  - table: byte-onkénti, fordítási időben generált 256 elemű táblával
+ *  - dma: az RP2040 DMA sniffer CRC-16-CCITT módjával, a CPU helyett a DMA olvassa végig a puffert
+ * A calc() a méret alapján választ; a DMA utat az init() egy önteszt után engedélyezi.
+ * A Crc16.cpp az RP2040-en kívül függőség nélkül fordul (natív teszt: test/test_crc16, mérés: test/test_crc16_benchmark).
+ */
+namespace Crc16 {
+
+/**
+ * DMA csatorna foglalása és önteszt (a setup()-ban egyszer)
+ * @return true, ha a DMA út használható
+ */
+bool init();
+
+/**
+ * Használható-e a DMA út
+ */
+bool isDmaReady();
+
+uint16_t bitwise(const uint8_t *data, size_t length, uint16_t crc = 0xFFFF);
+uint16_t table(const uint8_t *data, size_t length, uint16_t crc = 0xFFFF);
+uint16_t dma(const uint8_t *data, size_t length, uint16_t crc = 0xFFFF);
+
+/**
+ * A méret alapján a leggyorsabb változat
+ */
+uint16_t calc(const uint8_t *data, size_t length, uint16_t crc = 0xFFFF);
+
+/**
+ * Mérés a konfig és az állomáslisták méretével: byte / órajel változatonként (debug kimenetre)
+ * Külön fordítási egységben (Crc16Benchmark.cpp), mert a tárolt struktúrákhoz az Arduino környezet kell
+ */
+void benchmark();
+
+} // namespace Crc16
+
+#endif // __CRC16_H
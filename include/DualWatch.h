@@ -0,0 +1,109 @@
+#ifndef __DUAL_WATCH_H
+#define __DUAL_WATCH_H
+
+#include "Band.h"
+#include "Si4735Ext.h"
+
+// Időzítések
+#define DUALWATCH_DEFAULT_INTERVAL 2000 // Alapértelmezett próba időköz (ms)
+#define DUALWATCH_MIN_INTERVAL 250      // Ennél sűrűbben nem próbálunk, különben szaggat a hang (ms)
+#define DUALWATCH_PROBE_BUDGET 40       // Egy hangolás (oda vagy vissza) maximális ideje (ms)
+#define DUALWATCH_HANG_TIME 3000        // A másodlagos csatornán maradunk ennyi ideig az utolsó aktív mérés után (ms)
+#define DUALWATCH_CHECK_INTERVAL 200    // A másodlagos csatornán ilyen sűrűn mérünk (ms)
+
+// Aktivitás küszöbök (ha nincs squelch beállítva)
+#define DUALWATCH_ACTIVE_RSSI 20 // dBuV
+#define DUALWATCH_ACTIVE_SNR 8   // dB
+#define DUALWATCH_CONFIRM_COUNT 2 // Ennyi egymást követő aktív próba után váltunk át
+
+/**
+ * @brief Időosztásos kettős figyelés (Dual-Watch)
+ *
+ * Az elsődleges frekvencián hallgatva, beállítható időközönként egy rövid némított szünetre
+ * átáll a másodlagos frekvenciára, a hangolás végén kapott RSSI/SNR-rel (külön RSQ parancs nélkül)
+ * eldönti, hogy aktív-e, majd visszaáll. Mindkét frekvencia ugyanabban a sávban és módban van,
+ * így a chip állapota (mód, sávszélesség, BFO, AGC) marad, csak a frekvencia és az előre számolt
+ * antenna kapacitás változik - ez a legolcsóbb áthangolás. Ha a másodlagos csatorna aktív,
+ * átvált rá, és addig marad, amíg a jel a tartási időn belül újra megjelenik. A band rekord (és a konfig)
+ * közben végig az elsődleges frekvencián áll, a másodlagosra csak a chip hangol át.
+ */
+class DualWatch {
+
+  public:
+    enum class State : uint8_t {
+        Off,       // Nem fut
+        Primary,   // Az elsődlegest hallgatjuk, a másodlagost próbáljuk
+        Secondary, // A másodlagos aktív, azt hallgatjuk
+    };
+
+  private:
+    Si4735Ext &si4735;
+    Band &band;
+
+    State state = State::Off;
+
+    uint8_t bandIdx = 0;
+    uint16_t primaryFreq = 0;
+    uint16_t secondaryFreq = 0;
+    uint16_t interval = DUALWATCH_DEFAULT_INTERVAL;
+
+    uint8_t activeCount = 0;
+    uint32_t lastProbe = 0;
+    uint32_t lastActive = 0;
+
+    // Utolsó mérés a másodlagos csatornán
+    uint8_t secondaryRssi = 0;
+    uint8_t secondarySnr = 0;
+
+    // Statisztika
+    uint32_t probeCount = 0;
+    uint32_t lastGapMicros = 0;
+    uint32_t maxGapMicros = 0;
+
+    bool isTunerFree() const;
+    bool isActive(uint8_t rssi, uint8_t snr) const;
+    bool tune(uint16_t freq, uint8_t &rssi, uint8_t &snr);
+    void probe();
+    void checkSecondary();
+    void listenTo(uint16_t freq);
+
+  public:
+    DualWatch(Si4735Ext &si4735, Band &band);
+
+    /**
+     * Indítás: az elsődleges az aktuális frekvencia, a másodlagos ugyanabban a sávban van
+     * @return false, ha a másodlagos frekvencia a sávon kívül esik
+     */
+    bool start(uint16_t secondary);
+
+    /**
+     * Leállítás, vissza az elsődleges frekvenciára
+     */
+    void stop();
+
+    /**
+     * Arduino loop
+     */
+    void loop();
+
+    /**
+     * Próba időköz (ms), legalább DUALWATCH_MIN_INTERVAL
+     */
+    inline void setInterval(uint16_t ms) { interval = max(ms, (uint16_t)DUALWATCH_MIN_INTERVAL); }
+    inline uint16_t getInterval() const { return interval; }
+
+    inline State getState() const { return state; }
+    inline bool isRunning() const { return state != State::Off; }
+    inline uint16_t getPrimaryFrequency() const { return primaryFreq; }
+    inline uint16_t getSecondaryFrequency() const { return secondaryFreq; }
+    inline uint8_t getSecondaryRssi() const { return secondaryRssi; }
+    inline uint8_t getSecondarySnr() const { return secondarySnr; }
+
+    /**
+     * A némított szünet hossza (us): az utolsó és a leghosszabb
+     */
+    inline uint32_t getLastGapMicros() const { return lastGapMicros; }
+    inline uint32_t getMaxGapMicros() const { return maxGapMicros; }
+};
+
+#endif // __DUAL_WATCH_H
@@ -1,6 +1,9 @@
 #ifndef __FM_SCREEN_H
 #define __FM_SCREEN_H
 
+#include "Si4735Utils.h"
+#include "StationDatabase.h"
+#include "uicomponents/ActivityHeatMap.h"
 #include "uicomponents/UIButton.h"    // Hozzáadva a UIButton definíciójához
 #include "uicomponents/UIComponent.h" // Szükséges a ColorScheme-hez és Rect-hez
 #include "uicomponents/UIScreen.h"
@@ -12,141 +15,98 @@ struct FMScreenParams {
     String stationName;
 };
 
-class FMScreen : public UIScreen {
+/**
+ * @brief A rádió fő képernyője
+ *
+ * A Si4735Utils-ból örököl, így amíg a képernyő él, a chip kezelés (squelch, RDS, háttér funkciók) is fut.
+ * A drawSelf() minden képkockában lefut, ezért a szöveges sorokat csak akkor rajzoljuk újra, ha változtak.
+ */
+class FMScreen : public UIScreen, public Si4735Utils {
 
   public:
     // Képernyő neve konstansként
     static constexpr const char *SCREEN_NAME = "FMScreen";
 
   private:
+    // Gomb azonosítók
+    enum ButtonId : uint8_t {
+        BUTTON_ID_SCAN = 1,
+        BUTTON_ID_SEEK_DOWN,
+        BUTTON_ID_SEEK_UP,
+        BUTTON_ID_ANTCAP,
+        BUTTON_ID_ACTIVITY,
+        BUTTON_ID_BEACON,
+        BUTTON_ID_AUTOSTORE,
+        BUTTON_ID_DUALWATCH,
+        BUTTON_ID_ALTFREQ,
+    };
+
+    // Képernyő elrendezés
+    static constexpr int16_t LINE_BAND_Y = 20;      // Sáv és moduláció sor
+    static constexpr int16_t LINE_FREQUENCY_Y = 65; // Frekvencia sor
+    static constexpr int16_t LINE_RDS_Y = 105;      // RDS PS név sor
+    static constexpr int16_t LINE_STATUS_Y = 135;   // Állapot sor (scan, jelminőség)
+    static constexpr int16_t HEAT_MAP_Y = 150;      // Aktivitás heat-map (az állapot sor és a gombok között)
+    static constexpr int16_t HEAT_MAP_HEIGHT = 85;  // Aktivitás heat-map magassága
+    static constexpr int16_t BUTTON_GAP = 3;        // Rés a gombok között
+    static constexpr int16_t BUTTON_MARGIN = 5;     // Szegély a képernyő szélétől
+    static constexpr uint8_t BUTTON_ROWS = 2;       // A gombsorok száma a képernyő alján
+
     // UI komponens példányok
-    std::shared_ptr<UIButton> button1;
-    std::shared_ptr<UIButton> button2;
-    std::shared_ptr<UIButton> button3;
+    std::shared_ptr<UIButton> scanButton;
+    std::shared_ptr<UIButton> antCapButton;
+    std::shared_ptr<UIButton> activityButton;
+    std::shared_ptr<UIButton> beaconButton;
+    std::shared_ptr<UIButton> autoStoreButton;
+    std::shared_ptr<UIButton> dualWatchButton;
+    uint16_t dualWatchSecondary = 0; // A kettős figyelés másodlagos frekvenciája (hosszú nyomással tárolt), 0: nincs
+    std::shared_ptr<ActivityHeatMap> activityHeatMap; // Csak bekapcsolt aktivitás rögzítésnél látszik
+    uint8_t buttonCount = 0; // Az eddig elhelyezett gombok (a következő gomb helye)
+
+    // Az állomás adatbázis szerint az aktuális (AM) frekvencián most adó állomás
+    char dbStationName[STATION_DB_NAME_LEN + 1] = "";
+    uint16_t dbLookupFreq = 0;        // A legutóbbi lekérdezés frekvenciája (0: nincs)
+    uint16_t dbLookupMinute = 0xFFFF; // A legutóbbi lekérdezés ideje (a nap perce), percenként frissítünk
+
+    // A kirajzolt szövegek (csak változáskor rajzolunk újra)
+    char drawnBand[24] = "";
+    char drawnFrequency[24] = "";
+    char drawnRds[STATION_DB_NAME_LEN + 1] = ""; // RDS PS név vagy a (hosszabb) adatbázis név
+    char drawnStatus[48] = "";
+
+    std::shared_ptr<UIButton> addButton(uint8_t id, const char *label, UIButton::ButtonType type = UIButton::ButtonType::Pushable);
+    void layoutComponents();
+    void handleButtonEvent(const UIButton::ButtonEvent &event);
+    void updateButtonStates();
+    void stopBackgroundTuning();
+    void updateDatabaseStation();
+    void tuneAlternativeFrequency();
+
+    void formatFrequency(char *buffer, size_t size);
+    void formatStatus(char *buffer, size_t size);
+    void drawLine(char *drawn, size_t drawnSize, const char *text, int16_t y, uint8_t textSize, uint16_t color);
 
   public:
-    FMScreen(TFT_eSPI &tft) : UIScreen(tft, FMScreen::SCREEN_NAME) { layoutComponents(); }
+    FMScreen(TFT_eSPI &tft);
     virtual ~FMScreen() = default;
 
     // Rotary encoder eseménykezelés felülírása
-    virtual bool handleRotary(const RotaryEvent &event) override {
-        DEBUG("FMScreen handleRotary: direction=%d, button=%d\n", (int)event.direction, (int)event.buttonState);
-
-        // Frekvencia állítás forgatással
-        if (event.direction == RotaryEvent::Direction::Up) {
-            DEBUG("FMScreen: Rotary Up\n");
-            return true;
-        } else if (event.direction == RotaryEvent::Direction::Down) {
-            DEBUG("FMScreen: Rotary Down\n");
-            return true;
-        }
-
-        // Rotary gombnyomás kezelése
-        if (event.buttonState == RotaryEvent::ButtonState::Clicked) {
-            DEBUG("FMScreen: Rotary Clicked\n");
-            return true;
-        }
-
-        // Ha nem kezeltük, továbbítjuk a szülő implementációnak (gyerekkomponenseknek)
-        return UIScreen::handleRotary(event);
-    }
-
-    // loop hívás felülírása
-    virtual void handleOwnLoop() override {
-        // Saját loop logika
-    }
+    virtual bool handleRotary(const RotaryEvent &event) override;
+
+    // Teljes újrarajzoláskor a szöveg gyorsítótárat is ürítjük
+    virtual void draw() override;
+
+  protected:
+    // Érintés: egy futó seek-et megszakít (az esemény nem jut tovább a gombokhoz)
+    virtual bool handleOwnTouch(const TouchEvent &event) override;
+
+    // loop hívás felülírása (a chip kezelés loop-ja)
+    virtual void handleOwnLoop() override;
 
     /**
-     * @brief Kirajzolja a képernyő saját tartalmát.
-     * Ez a metódus arra szolgál, hogy a kompozit komponens maga rajzoljon ki tartalmat, mielőtt a gyerekkomponenseit kirajzolná.
+     * @brief Kirajzolja a képernyő saját tartalmát (frekvencia, RDS, állapot).
      */
-    virtual void drawSelf() override {
-        // Szöveg középre igazítása
-        tft.setTextDatum(MC_DATUM);                        // Middle Center datum
-        tft.setTextColor(TFT_WHITE, TFT_COLOR_BACKGROUND); // Fehér szöveg, fekete háttérrel
-        tft.setTextSize(2);                                // Tetszőleges méret
-
-        // Szöveg kirajzolása a képernyő közepére
-        tft.drawString(SCREEN_NAME, tft.width() / 2, tft.height() / 2);
-
-        // Alapértelmezett szöveg igazítás visszaállítása, ha szükséges más komponenseknek
-        // tft.setTextDatum(TL_DATUM); // Top Left datum (gyakori alapértelmezés)
-    }
-
-   private:
-    void handleButton1Event(const UIButton::ButtonEvent &event) {
-        DEBUG("FMScreen: Button 1 event! ID: %d, Label: '%s', State: %s\n",
-              event.id, event.label.c_str(), UIButton::buttonStateToString(event.state));
-
-        if (event.state == UIButton::ButtonState::Pressed) {
-            // Gomb 1 megnyomva
-            tft.setTextColor(TFT_YELLOW); // Csak példa, a drawSelf felülírhatja
-            tft.drawString("Gomb 1 megnyomva!", tft.width() / 2, tft.height() / 2 + 20);
-            // Itt végezheted el a kívánt műveletet
-            // Fontos: Ha a UI-t módosítod, lehet, hogy markForRedraw()-t kell hívnod
-            // a gombon vagy a képernyőn, hogy a változások megjelenjenek.
-            // Ebben az esetben a drawString közvetlenül a tft-re ír, ami nem ideális,
-            // jobb lenne egy UI Label komponenst frissíteni.
-        }
-    }
-
-    void handleButton2Event(const UIButton::ButtonEvent &event) {
-        DEBUG("FMScreen: Button 2 event! ID: %d, Label: '%s', State: %s\n",
-              event.id, event.label.c_str(), UIButton::buttonStateToString(event.state));
-        if (event.state == UIButton::ButtonState::Pressed) { /* Gomb 2 akció */ }
-    }
-
-    void handleButton3Event(const UIButton::ButtonEvent &event) {
-        DEBUG("FMScreen: Button 3 event! ID: %d, Label: '%s', State: %s\n",
-              event.id, event.label.c_str(), UIButton::buttonStateToString(event.state));
-        if (event.state == UIButton::ButtonState::Pressed) {
-            tft.drawString("Gomb 3 megnyomva!", tft.width() / 2, tft.height() / 2 + 60);
-        }
-    }
-
-  private:
-    // UI komponensek létrehozása és elhelyezése
-    void layoutComponents() {
-        //const int16_t screenWidth = tft.width();
-        const int16_t screenHeight = tft.height();
-        const int16_t buttonHeight = UIButton::DEFAULT_BUTTON_HEIGHT; // Gombok magassága
-        const int16_t gap = 3;                                        // Rés a gombok között
-        const int16_t margin = 5;                                     // Szegély a képernyő szélétől
-
-        // Teljes használható szélesség a gomboknak és réseknek, figyelembe véve a margókat
-        // const int16_t totalUsableWidth = screenWidth - (2 * margin);
-
-        // Egy gomb szélessége
-        // 3 gomb + 2 rés = totalUsableWidth
-        // const int16_t buttonWidth = (totalUsableWidth - (2 * gap)) / 3;
-        const int16_t buttonWidth = UIButton::DEFAULT_BUTTON_WIDTH; // Alapértelmezett gomb szélesség
-
-        // Gombok Y pozíciója (pl. a képernyő aljához közel)
-        const int16_t buttonY = screenHeight - buttonHeight - margin;
-
-        // Első gomb X pozíciója
-        int16_t currentX = margin;
-
-        // Gombok ID-jának beállítása (opcionális, de hasznos lehet az eseménykezelőben)
-        const uint8_t BUTTON1_ID = 1;
-        const uint8_t BUTTON2_ID = 2;
-        const uint8_t BUTTON3_ID = 3;
-
-        button1 = std::make_shared<UIButton>(tft, BUTTON1_ID, Rect(currentX, buttonY), "Gomb1");
-        button1->setEventCallback([this](const UIButton::ButtonEvent &event) { this->handleButton1Event(event); });
-        addChild(button1);
-
-        currentX += buttonWidth + gap;
-        button2 = std::make_shared<UIButton>(tft, BUTTON2_ID, Rect(currentX, buttonY), "Gomb2");
-        button2->setEventCallback([this](const UIButton::ButtonEvent &event) { this->handleButton2Event(event); });
-        addChild(button2);
-
-        currentX += buttonWidth + gap;
-        Rect button3Bounds(currentX, buttonY, buttonWidth, buttonHeight);
-        button3 = std::make_shared<UIButton>(tft, BUTTON3_ID, button3Bounds, "Gomb3");
-        button3->setEventCallback([this](const UIButton::ButtonEvent &event) { this->handleButton3Event(event); });
-        addChild(button3);
-    }
+    virtual void drawSelf() override;
 };
 
-#endif // __FM_SCREEN_H
\ No newline at end of file
+#endif // __FM_SCREEN_H
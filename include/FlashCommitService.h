@@ -0,0 +1,126 @@
+#ifndef __FLASH_COMMIT_SERVICE_H
+#define __FLASH_COMMIT_SERVICE_H
+
+#include <Arduino.h>
+#include <hardware/flash.h>
+
+#define FLASH_COMMIT_QUEUE_SIZE 32      // Várakozó műveletek (lap programozás / szektor törlés)
+#define FLASH_COMMIT_PAGE_IMAGES 12     // RAM-ban előkészített lap képek (FLASH_PAGE_SIZE byte-osak)
+#define FLASH_COMMIT_SLICE_BUDGET 2000  // Egy ütemezett ablakban ennyi us után nem kezdünk újabb lap programozást
+#define FLASH_COMMIT_ERASE_IDLE 1000    // Szektor törlés csak ennyi ms felhasználói tétlenség után...
+#define FLASH_COMMIT_MAX_DELAY 5000     // ...vagy ha a művelet már ennyi ms óta vár
+
+/**
+ * @brief Ütemezett flash írások a felhasználói felület megakasztása nélkül
+ *
+ * A flash törlés/programozás alatt az XIP mindkét magon áll, ezért a hívó nem közvetlenül ír:
+ * a programozandó lapok képe a RAM-ban készül el (az ugyanarra a lapra eső írások egy képbe
+ * olvadnak), a műveletek sorba kerülnek, és a loop() a kijelző két frissítése között, időkerettel
+ * hajtja végre őket. Egy ablakban legfeljebb FLASH_COMMIT_SLICE_BUDGET us-ig programozunk (laponként),
+ * a 4K-s szektor törlés (a legnagyobb akadás) egyedül fut, és csak tétlen felhasználónál (vagy ha már
+ * régóta vár). Minden művelet a másik mag leállítása és a megszakítások tiltása mellett, RAM-ból
+ * futó kódból indul; az akadások idejét mérjük.
+ *
+ * A még ki nem írt adatot a read() a sorban álló képekből adja, így a hívók számára az írás azonnal látszik.
+ *
+ * Az EEPROM commit a puffer sorba állításkori pillanatképét írja ki, a törlést és a lapokat egyetlen
+ * műveletben, megszakítás nélkül (a törölt, de még nem programozott szektor nem maradhat a flash-en).
+ */
+class FlashCommitService {
+
+  public:
+    /**
+     * A művelet végrehajtása után hívódik (pl. a törölt szektor újra használható)
+     */
+    typedef void (*Callback)(void *context, uint32_t flashOffset);
+
+    struct Stats {
+        uint32_t pagesProgrammed;
+        uint32_t pagesMerged;    // Már sorban álló lap képbe olvasztott írások
+        uint32_t sectorsErased;
+        uint32_t forcedOps;      // Betelt sor vagy flush() miatt azonnal végrehajtott műveletek
+        uint32_t maxProgramStallUs;
+        uint32_t maxEraseStallUs;
+        uint32_t maxSliceUs;     // Egy ütemezett ablak leghosszabb ideje
+        uint32_t totalStallUs;
+    };
+
+  private:
+    enum class OpType : uint8_t { Program, Erase, EepromCommit };
+
+    struct Op {
+        OpType type;
+        int8_t image;          // A saját lap kép sorszáma (-1: nincs)
+        uint32_t flashOffset;  // A flash elejétől (lap, ill. szektor igazított)
+        const uint8_t *source; // Programozásnál a lap, EEPROM commit-nál a szektor tartalma (RAM)
+        uint32_t queuedAt;
+        Callback done;
+        void *context;
+    };
+
+    Op queue[FLASH_COMMIT_QUEUE_SIZE];
+    uint8_t queueHead = 0;
+    uint8_t queueCount = 0;
+
+    uint8_t images[FLASH_COMMIT_PAGE_IMAGES][FLASH_PAGE_SIZE];
+    bool imageUsed[FLASH_COMMIT_PAGE_IMAGES] = {};
+
+    uint8_t *eepromSnapshot = nullptr; // Az EEPROM puffer pillanatképe (az első commit-nál foglaljuk)
+    uint16_t eepromLength = 0;         // A pillanatkép mérete (lap igazított, az arduino-pico így foglalja)
+    bool eepromCommitQueued = false;   // Az EEPROM commit még sorban áll (az újabb kérés a pillanatképet frissíti)
+    Stats stats = {};
+
+    inline Op &queueAt(uint8_t n) { return queue[(queueHead + n) % FLASH_COMMIT_QUEUE_SIZE]; }
+    inline const Op &queueAt(uint8_t n) const { return queue[(queueHead + n) % FLASH_COMMIT_QUEUE_SIZE]; }
+
+    void enqueue(const Op &op);
+    int8_t allocImage();
+    void runNext();
+    uint32_t execute(const Op &op);
+    static inline bool isEraseLike(const Op &op) { return op.type != OpType::Program; }
+
+  public:
+    /**
+     * Egy teljes lap programozásának sorba állítása (a lap 0xFF byte-jai nem változtatnak a flash-en)
+     * Ha a lap már sorban áll, az írás abba olvad.
+     */
+    void queueProgram(uint32_t flashOffset, const uint8_t *page);
+
+    /**
+     * Egy szektor törlésének sorba állítása (a sorrend megmarad: a korábbi programozások előbb futnak)
+     */
+    void queueErase(uint32_t flashOffset, Callback done = nullptr, void *context = nullptr);
+
+    /**
+     * Azonnali szektor törlés (induláskor, amikor még nincs felület)
+     */
+    void eraseNow(uint32_t flashOffset);
+
+    /**
+     * Az EEPROM puffer kiírása (a StoreEepromBase mentése, az EEPROM.commit() helyett)
+     * A puffer aktuális tartalmát másoljuk, az EEPROM saját "módosult" jelzőjét töröljük.
+     */
+    void commitEeprom();
+
+    /**
+     * Olvasás a flash-ről, a még sorban álló írásokkal együtt
+     */
+    void read(uint32_t flashOffset, void *data, uint16_t length) const;
+
+    /**
+     * Ütemezett végrehajtás időkerettel (a fő ciklusból, a kijelző frissítése után)
+     */
+    void loop();
+
+    /**
+     * Minden várakozó művelet azonnali végrehajtása (sürgős törlés, képernyővédő, újraindítás előtt)
+     */
+    void flush();
+
+    inline bool isIdle() const { return queueCount == 0; }
+    inline const Stats &getStats() const { return stats; }
+};
+
+extern FlashCommitService flashCommitService;
+
+#endif // __FLASH_COMMIT_SERVICE_H
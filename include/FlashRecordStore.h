@@ -0,0 +1,141 @@
+#ifndef __FLASH_RECORD_STORE_H
+#define __FLASH_RECORD_STORE_H
+
+#include <Arduino.h>
+#include <hardware/flash.h>
+
+#include "FlashCommitService.h"
+
+// Flash terület: a LittleFS előtti utolsó szektorok
+#define FLASH_LOG_SECTORS 8           // Fenntartott szektorok száma (4K-s szektorok, az A/B példányok miatt kétszeres élő adat)
+#define FLASH_LOG_SPARE_SECTORS 2     // Ennyi törölt szektort tartunk tartalékban (egy a váltáshoz, egy a tömörítéshez)
+#define FLASH_LOG_MAX_KEYS 256        // Különböző rekord kulcsok maximális száma
+#define FLASH_LOG_MAX_RECORD_SIZE 128 // Egy rekord maximális hasznos mérete (byte)
+
+// Rekord kulcs: a felső byte a tároló azonosítója, az alsó a tárolón belüli rekord sorszáma
+#define FLASH_LOG_KEY(storeId, recordIdx) ((uint16_t)(((uint16_t)(storeId) << 8) | (uint8_t)(recordIdx)))
+
+/**
+ * @brief Log-szerkezetű, kopáskiegyenlített rekord tároló a flash-en
+ *
+ * A rekordok (kulcs, hossz, sorszám, CRC + adat) egy szektor gyűrű végére kerülnek, csak a ténylegesen
+ * megváltozottak (a legutóbbi változattal megegyező írás kimarad). Egy írás így csak a rekord
+ * által érintett 256 byte-os lapo(ka)t programozza, a teljes szektor törlése nélkül.
+ * A szektorokat körbe használjuk, így a törlések egyenletesen oszlanak el. Ha a tartalék
+ * törölt szektorok száma fogy, a loop() a legrégebbi szektor élő rekordjait átmásolja a
+ * gyűrű végére, majd a szektor törlését a FlashCommitService-re bízza (tömörítés). A programozás is
+ * a FlashCommitService során át, a felület két frissítése között történik. Induláskor a szektorok bejárásával épül fel
+ * a kulcs -> legfrissebb rekord index; a félbeszakadt (CRC hibás) írás a szektor végét jelenti.
+ */
+class FlashRecordStore {
+
+  public:
+    struct Stats {
+        uint32_t recordsWritten; // Kiírt rekordok
+        uint32_t recordsSkipped; // Változatlan tartalom miatt kihagyott írások
+        uint32_t bytesWritten;   // Kiírt byte-ok (fejléccel)
+        uint32_t pagesProgrammed;
+        uint32_t sectorsErased;
+        uint32_t compactions;
+    };
+
+  private:
+    // Szektor fejléc (a szektor elején, a megnyitáskor írjuk)
+    struct SectorHeader {
+        uint32_t magic;
+        uint32_t sequence;   // Monoton növekvő, a szektorok sorrendje
+        uint32_t eraseCount; // Kopás statisztika
+        uint16_t crc;
+        uint16_t reserved;
+    };
+
+    // Rekord fejléc, utána az adat, 4 byte-ra igazítva
+    struct RecordHeader {
+        uint16_t key;
+        uint16_t length;
+        uint32_t sequence;
+        uint16_t crc; // A fejléc első 8 byte-ja + az adat
+        uint16_t reserved;
+    };
+
+    // Index bejegyzés (nyílt címzésű hash tábla)
+    struct IndexEntry {
+        uint16_t key;
+        uint16_t offset; // A rekord fejléce a log területen belül
+    };
+
+    bool ready = false;
+    uint32_t flashOffset = 0; // A log terület kezdete a flash elejétől
+
+    // Szektorok állapota
+    uint32_t sectorSequence[FLASH_LOG_SECTORS]; // 0: törölt
+    uint32_t eraseCounts[FLASH_LOG_SECTORS];
+    uint8_t headSector = 0;
+    uint16_t headOffset = 0; // Az első szabad byte a fej szektorban
+    bool headClosed = true;  // Új rekord előtt új szektort kell nyitni
+    bool compacting = false;
+    uint32_t nextSectorSequence = 1;
+    uint32_t nextRecordSequence = 1;
+
+    IndexEntry index[FLASH_LOG_MAX_KEYS];
+    uint16_t indexCount = 0;
+
+    Stats stats = {};
+
+    bool erasePending[FLASH_LOG_SECTORS] = {}; // Tömörítve, a törlése a FlashCommitService sorában vár
+
+    // Olvasás a log területről (a még ki nem írt, sorban álló lapokkal együtt)
+    inline void readFlash(uint16_t offset, void *data, uint16_t length) const { flashCommitService.read(flashOffset + offset, data, length); }
+    static inline uint16_t alignedSize(uint16_t length) { return (sizeof(RecordHeader) + length + 3) & ~3; }
+
+    IndexEntry *findEntry(uint16_t key);
+    bool putEntry(uint16_t key, uint16_t offset);
+
+    uint8_t erasedSectorCount() const;
+    uint8_t pendingEraseCount() const;
+    bool hasLiveRecords(uint8_t sector) const;
+    bool isBlank(uint16_t offset, uint16_t length) const;
+    void scanSector(uint8_t sector);
+    bool validRecordAt(uint16_t offset, RecordHeader &header) const;
+
+    void programBytes(uint16_t offset, const uint8_t *data, uint16_t length);
+    void eraseSector(uint8_t sector);
+    void requestErase(uint8_t sector);
+    static void onSectorErased(void *context, uint32_t flashOffset);
+    bool openNextSector();
+    bool append(uint16_t key, const uint8_t *data, uint16_t length);
+    void compact();
+
+  public:
+    /**
+     * A log terület felmérése és az index felépítése (a setup()-ban egyszer)
+     * @return false, ha a terület nem használható (ütközik a programmal)
+     */
+    bool begin();
+
+    inline bool isReady() const { return ready; }
+
+    /**
+     * Egy rekord legfrissebb változatának olvasása
+     * @return false, ha nincs ilyen rekord vagy eltér a hossza
+     */
+    bool read(uint16_t key, void *data, uint16_t length) const;
+
+    /**
+     * Egy rekord írása, ha eltér a legutóbb tárolt változattól
+     * @return false, ha az írás nem sikerült
+     */
+    bool write(uint16_t key, const void *data, uint16_t length);
+
+    /**
+     * Háttér tömörítés, ha fogy a törölt szektorok száma (a fő loop()-ból)
+     */
+    void loop();
+
+    inline const Stats &getStats() const { return stats; }
+    inline uint32_t getEraseCount(uint8_t sector) const { return sector < FLASH_LOG_SECTORS ? eraseCounts[sector] : 0; }
+};
+
+extern FlashRecordStore flashRecordStore;
+
+#endif // __FLASH_RECORD_STORE_H
@@ -0,0 +1,125 @@
+#ifndef __FM_AUTO_STORE_H
+#define __FM_AUTO_STORE_H
+
+#include "Band.h"
+#include "RdsDecoder.h"
+#include "Si4735Ext.h"
+#include "StationData.h"
+
+// Sáv végigmérés
+#define AUTOSTORE_MAX_CANDIDATES 48 // A küszöb feletti csatornák közül legfeljebb ennyit tartunk meg
+#define AUTOSTORE_TUNE_BUDGET 60    // Egy csatorna hangolásának maximális ideje (ms)
+#define AUTOSTORE_POLL_INTERVAL 5   // A hangolás végének lekérdezési gyakorisága (ms), a loop() közben nem vár
+#define AUTOSTORE_MIN_RSSI 20       // Ez alatt (dBuV) nem állomás
+#define AUTOSTORE_MIN_SNR 8         // Ez alatt (dB) nem állomás
+
+// RDS név gyűjtés
+#define AUTOSTORE_RDS_TIMEOUT 2500   // Egy állomás PS nevére eddig várunk (ms)
+#define AUTOSTORE_NAMING_BUDGET 30000 // Az összes állomás PS nevére összesen eddig várunk (ms)
+
+/**
+ * @brief FM állomáslista automatikus feltöltése
+ *
+ * Az FM sávot (bandTable FM sora) a sáv lépésközével, némítva végigméri (csatornánként RSSI/SNR,
+ * fix hangolási időkerettel, a loop() nem vár a hangolásra), a szomszédos csatornák áthallásait kiszűri, majd a legerősebb
+ * MAX_FM_STATIONS állomásra egyenként ráhangol és korlátozott ideig várja a teljes RDS PS nevet.
+ * Ahol nincs (időben) név, ott a frekvencia lesz a név. Az eredményt frekvencia sorrendben,
+ * egyetlen kötegelt módosítással, így egyetlen EEPROM commit-tal írja az FM állomás listába.
+ * Ha egy állomást sem talált, a korábbi lista megmarad.
+ * A művelet alatt a rtv::SCANbut jelzi a háttér feladatoknak, hogy a tuner foglalt.
+ */
+class FmAutoStore {
+
+  public:
+    enum class State : uint8_t {
+        Idle,     // Nem fut
+        Scanning, // Sáv végigmérés
+        Naming,   // RDS nevek gyűjtése
+    };
+
+    // Egy megtalált állomás
+    struct Candidate {
+        uint16_t frequency; // 10kHz egységben
+        uint8_t rssi;
+        uint8_t snr;
+        char name[STATION_NAME_BUFFER_SIZE];
+    };
+
+  private:
+    Si4735Ext &si4735;
+    Band &band;
+    RdsDecoder &rdsDecoder;
+
+    State state = State::Idle;
+
+    // A sáv adatai
+    uint8_t fmBandIdx = 0;
+    uint16_t minFreq = 0;
+    uint16_t scanFreq = 0;
+    uint16_t stepSize = 0;
+    uint16_t maxFreq = 0;
+    uint16_t homeFreq = 0; // Indítás előtti frekvencia, ide térünk vissza
+
+    // A folyamatban lévő hangolás (a végét a loop() kérdezi le)
+    bool tunePending = false;
+    uint32_t tuneStarted = 0;
+    uint32_t lastPoll = 0;
+
+    Candidate candidates[AUTOSTORE_MAX_CANDIDATES];
+    uint8_t candidateCount = 0;
+
+    // Név gyűjtés
+    uint8_t namingIdx = 0;
+    uint32_t namingStarted = 0;
+    uint32_t namingBudgetStarted = 0;
+
+    // Statisztika
+    uint32_t scanStarted = 0;
+    uint32_t lastDurationMs = 0;
+    uint8_t lastStoredCount = 0;
+
+    static uint16_t score(const Candidate &c) { return c.rssi * 2 + c.snr; }
+
+    bool pollMeasurement(bool &complete, uint8_t &rssi, uint8_t &snr);
+    void addCandidate(uint16_t freq, uint8_t rssi, uint8_t snr);
+    void dropAdjacentSpurs();
+    void keepStrongest();
+    void scanNext();
+    void startNaming(uint8_t idx);
+    void namingStep();
+    void storeResults();
+    void finish(bool restoreTuning = true);
+
+  public:
+    FmAutoStore(Si4735Ext &si4735, Band &band, RdsDecoder &rdsDecoder);
+
+    /**
+     * Indítás (csak FM sávon)
+     * @return false, ha nem indítható
+     */
+    bool start();
+
+    /**
+     * Megszakítás, a lista érintetlen marad
+     * @param restoreTuning vissza az indítás előtti frekvenciára? (sávváltáskor már nem kell)
+     */
+    void cancel(bool restoreTuning = true);
+
+    /**
+     * Arduino loop - a Si4735Utils loop()-jából, az RDS dekóder után hívandó (nem blokkol)
+     */
+    void loop();
+
+    inline bool isRunning() const { return state != State::Idle; }
+    inline State getState() const { return state; }
+
+    /**
+     * Előrehaladás (0..100%), a kijelzőhöz
+     */
+    uint8_t getProgress() const;
+
+    inline uint8_t getLastStoredCount() const { return lastStoredCount; }
+    inline uint32_t getLastDurationMs() const { return lastDurationMs; }
+};
+
+#endif // __FM_AUTO_STORE_H
@@ -0,0 +1,149 @@
+#ifndef __MEMORY_SCANNER_H
+#define __MEMORY_SCANNER_H
+
+#include <SI4735.h>
+
+#include "Band.h"
+#include "SignalQualitySampler.h"
+#include "StationStore.h"
+#include "rtVars.h"
+
+// Scanner időzítések
+#define SCAN_SETTLE_TIME_FM 40        // FM hangolás utáni jelminőség mérés késleltetése (ms)
+#define SCAN_SETTLE_TIME_AM 80        // AM/SSB hangolás utáni jelminőség mérés késleltetése (ms)
+#define SCAN_RESUME_DELAY 2000        // Ennyi ideig kell zárva lennie a squelch-nek a folytatáshoz (ms)
+#define SCAN_DWELL_CHECK_INTERVAL 100 // Megállás (dwell) közben ilyen sűrűn mérünk jelminőséget (ms)
+#define SCAN_DEFAULT_PRIORITY_HOPS 5  // Alapértelmezés szerint ennyi ugrásonként nézzük meg a prioritásos csatornát
+#define SCAN_RATE_REPORT_INTERVAL 10000
+
+/**
+ * @brief Memória csatorna scanner
+ *
+ * Az FM és AM állomás tárolók memóriáin lépked végig, a squelch alapján megáll (dwell) vagy továbblép.
+ * Az indításkor minden memóriához előre kiszámítjuk a chip konfigurációt, és sáv/moduláció szerint
+ * rendezzük őket, így a lépkedés során csak a sávhatárokon van szükség teljes sávváltásra, egyébként
+ * egyetlen setFrequency() elég.
+ *
+ * Minden N. ugrás után a prioritásos csatornát is megnézi.
+ */
+class MemoryScanner {
+
+  public:
+    // Egy memória előre kiszámított chip konfigurációja
+    struct ScanChannel {
+        uint16_t frequency;     // Frekvencia (kHz vagy 10kHz, a bandType alapján)
+        int16_t bfoOffset;      // BFO eltolás SSB/CW esetén
+        uint8_t bandIndex;      // BandTable index
+        uint8_t modulation;     // Demoduláció (FM, AM, LSB, USB, CW)
+        uint8_t bandwidthIndex; // Sávszélesség index
+        uint8_t modeFamily;     // Chip mód család (FM / AM / SSB patch) a rendezéshez
+        uint8_t stationId;      // Az állomás (stabil) azonosítója a forrás tárolóban
+        bool fromFmStore;       // Melyik tárolóból jött?
+        bool sameConfigAsPrev;  // Ugyanaz a chip konfiguráció, mint az előző csatornán -> elég a setFrequency()
+    };
+
+    // A scanner állapotai
+    enum class State : uint8_t {
+        Idle,     // Nem fut
+        Settling, // Áthangoltunk, várjuk a jel beállását
+        Dwelling, // Nyitott squelch, a csatornán maradunk
+        Paused    // Felhasználó által szüneteltetve
+    };
+
+    // Az SCANbut/SCANpause flag-ek a rtv-ben is jelzik az állapotot
+    static constexpr uint8_t MAX_CHANNELS = MAX_FM_STATIONS + MAX_AM_STATIONS;
+    static constexpr int16_t NO_PRIORITY_CHANNEL = -1;
+
+  private:
+    SI4735 &si4735;
+    Band &band;
+    FmStationStore &fmStore;
+    AmStationStore &amStore;
+
+    ScanChannel channels[MAX_CHANNELS];
+    uint8_t channelCount = 0;
+
+    State state = State::Idle;
+    uint8_t currentIdx = 0;         // Az aktuális csatorna indexe a channels tömbben
+    int16_t tunedIdx = -1;          // A chipre ténylegesen beállított csatorna (-1: ismeretlen)
+    bool onPriority = false;        // Épp a prioritásos csatornán vagyunk?
+    int16_t priorityIdx = NO_PRIORITY_CHANNEL;
+    uint8_t priorityHops = SCAN_DEFAULT_PRIORITY_HOPS;
+    uint8_t hopsSincePriority = 0;
+
+    uint32_t stateStartTime = 0;    // Az aktuális állapot kezdete
+    uint32_t settledAt = 0;         // A beállási idő vége: ennél régebbi jelminőség minta még az előző csatornáé
+    uint32_t lastSignalTime = 0;    // Utolsó nyitott squelch időpont (dwell alatt)
+    uint32_t lastDwellCheck = 0;
+
+    // Statisztika
+    uint32_t hopCount = 0;          // Összes ugrás
+    uint32_t scanActiveMillis = 0;  // Tényleges lépkedéssel (nem dwell/pause) töltött idő
+    uint32_t activeSince = 0;       // Az aktuális lépkedési szakasz kezdete
+
+    static bool isLessThan(const ScanChannel &a, const ScanChannel &b);
+
+    void tuneChannel(uint8_t idx);
+    bool isSquelchOpen(const SignalQualitySampler::Snapshot &quality);
+    void nextChannel();
+    void accumulateActiveTime();
+
+  public:
+    MemoryScanner(SI4735 &si4735, Band &band, FmStationStore &fmStore, AmStationStore &amStore);
+
+    /**
+     * Csatornalista előkészítése a tárolókból (chip konfiguráció előszámítás + rendezés)
+     * @return A scannelhető csatornák száma
+     */
+    uint8_t prepare();
+
+    /**
+     * Scan indítása az első (vagy az aktuálishoz legközelebbi) csatornától
+     */
+    bool start();
+
+    /**
+     * Scan leállítása
+     */
+    void stop();
+
+    /**
+     * Szüneteltetés / folytatás
+     */
+    void setPaused(bool paused);
+
+    /**
+     * Prioritásos csatorna beállítása
+     * @param fromFmStore melyik tárolóban van az állomás
+     * @param stationId az állomás azonosítója a tárolóban
+     * @return true, ha a csatorna benne van az előkészített listában
+     */
+    bool setPriorityChannel(bool fromFmStore, uint8_t stationId);
+    inline void clearPriorityChannel() { priorityIdx = NO_PRIORITY_CHANNEL; }
+
+    /**
+     * Hány ugrásonként nézzük meg a prioritásos csatornát (0: soha)
+     */
+    inline void setPriorityInterval(uint8_t hops) { priorityHops = hops; }
+
+    /**
+     * Arduino loop - nem blokkoló állapotgép
+     */
+    void loop();
+
+    /**
+     * Effektív scan sebesség: csatorna/másodperc (a dwell és a pause idő nélkül)
+     */
+    float getChannelsPerSecond() const;
+
+    inline bool isRunning() const { return state != State::Idle; }
+    inline State getState() const { return state; }
+    inline uint8_t getChannelCount() const { return channelCount; }
+
+    /**
+     * Az aktuális csatorna (vagy nullptr, ha nem fut a scan)
+     */
+    const ScanChannel *getCurrentChannel() const;
+};
+
+#endif // __MEMORY_SCANNER_H
@@ -0,0 +1,88 @@
+#ifndef __PERSISTENCE_SCHEDULER_H
+#define __PERSISTENCE_SCHEDULER_H
+
+#include <Arduino.h>
+
+#include "StoreBase.h"
+
+#define PERSISTENCE_MAX_STORES 6
+#define PERSISTENCE_POLL_INTERVAL 250              // A tárolók módosítás számlálóinak figyelése (ms)
+#define PERSISTENCE_QUIET_PERIOD 5000              // Ennyi ideje nem változott -> mentjük (ms)
+#define PERSISTENCE_MAX_DELAY (60 * 1000UL)        // Folyamatos változás mellett is legfeljebb ennyi késleltetés (ms)
+#define PERSISTENCE_MIN_WRITE_INTERVAL (30 * 1000UL) // Egy tároló két mentése között legalább ennyi idő telik el (ms)
+
+/**
+ * @brief Késleltetett (write-behind) mentés ütemező a tárolókhoz
+ *
+ * A tárolók a módosításaikat a markDirty()-vel jelzik, az ütemező a módosítás számlálójukból látja,
+ * mikor változtak utoljára. Egy tárolót akkor ment, ha PERSISTENCE_QUIET_PERIOD ideje nem változott
+ * (vagy a legrégebbi mentetlen módosítás óta eltelt PERSISTENCE_MAX_DELAY), így a gyors egymásutáni
+ * módosítások (görgetés, hangerő, kötegelt állomás felvétel) egyetlen írássá olvadnak össze.
+ * A flash kímélése miatt egy tároló legfeljebb PERSISTENCE_MIN_WRITE_INTERVAL-onként íródik.
+ * A flushAll() minden mentetlen módosítást azonnal kiír (képernyővédő, alvás, újraindítás előtt).
+ *
+ * A statisztika a markDirty() hívásokat számolja, nem a mezők írásait. A Config a képernyők közvetlen
+ * írásait összehasonlítással veszi észre: a két összehasonlítás között (egy felhasználói esemény után)
+ * végzett írások egyetlen módosításnak számítanak, így a writesAvoided ott alsó becslés.
+ */
+class PersistenceScheduler {
+
+  public:
+    struct Stats {
+        uint32_t changes;       // Jelzett módosítások (markDirty hívások, ld. az osztály leírását)
+        uint32_t writes;        // Elvégzett mentések
+        uint32_t writesAvoided; // Összevonás miatt elmaradt mentések: a mentésenként összevont jelzések száma mínusz egy
+        uint32_t rateLimited;   // A minimális mentési időköz miatt elhalasztott mentések
+        uint32_t forcedFlushes; // flushAll() hívások
+        uint32_t failures;      // Sikertelen mentések
+    };
+
+  private:
+    struct Entry {
+        PersistentStore *store;
+        uint16_t changeCount;       // A tároló módosítás számlálója a legutóbbi figyeléskor
+        uint16_t pendingChanges;    // A legutóbbi mentés óta jelzett módosítások
+        uint32_t firstChangeTime;   // A legrégebbi mentetlen módosítás ideje
+        uint32_t lastChangeTime;    // A legutóbbi módosítás ideje
+        uint32_t lastWriteTime;     // A legutóbbi mentés ideje
+        bool written;               // Volt-e már mentés (a lastWriteTime érvényes-e)
+        bool deferred;              // A mentés a minimális időköz miatt várakozik
+    };
+
+    Entry entries[PERSISTENCE_MAX_STORES];
+    uint8_t entryCount = 0;
+    uint32_t lastPollTime = 0;
+    bool idleFlushed = false;
+    Stats stats = {};
+
+    void poll(Entry &entry, uint32_t now);
+    bool write(Entry &entry, uint32_t now);
+
+  public:
+    /**
+     * Tároló felvétele (a load() után)
+     * @return false, ha nincs több hely
+     */
+    bool registerStore(PersistentStore &store);
+
+    /**
+     * Időzített mentések (a fő ciklusból hívva)
+     */
+    void loop();
+
+    /**
+     * Az összes mentetlen módosítás azonnali kiírása (a csendes időszak és a ritkítás figyelmen kívül hagyásával)
+     */
+    void flushAll(const char *reason);
+
+    /**
+     * Van-e még mentetlen módosítás
+     */
+    bool hasPendingWrites() const;
+
+    inline const Stats &getStats() const { return stats; }
+};
+
+extern PersistenceScheduler persistenceScheduler;
+
+#endif // __PERSISTENCE_SCHEDULER_H
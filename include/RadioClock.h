@@ -0,0 +1,56 @@
+#ifndef __RADIO_CLOCK_H
+#define __RADIO_CLOCK_H
+
+#include <Arduino.h>
+
+#define RADIO_CLOCK_MS_PER_DAY 86400000UL
+#define RADIO_CLOCK_WEEKDAY_UNKNOWN 0xFF // A getWeekday() értéke, ha még nem kaptunk dátumot
+
+/**
+ * @brief UTC napon belüli idő a millis() alapján
+ *
+ * Nincs RTC, ezért az időt az RDS CT (4A) csoportból (vagy kézi beállításból) szinkronizáljuk, és a
+ * millis()-szel visszük tovább. Szinkron nélkül a bekapcsolás óta eltelt időt adja (napon belül).
+ */
+class RadioClock {
+
+  private:
+    uint32_t syncMillis = 0;   // millis() a szinkron pillanatában
+    uint32_t syncMsOfDay = 0;  // A napon belüli UTC idő (ms) a szinkron pillanatában
+    bool synced = false;
+    uint8_t syncWeekday = RADIO_CLOCK_WEEKDAY_UNKNOWN; // A szinkron napja (0: hétfő)
+
+  public:
+    /**
+     * Szinkronizálás egy ismert UTC időponthoz
+     * @param atMillis a millis() értéke, amikor az idő érvényes volt (pl. az RDS csoport vétele)
+     */
+    void syncUtc(uint8_t hour, uint8_t minute, uint8_t second, uint32_t atMillis);
+
+    /**
+     * A dátum megadása (a syncUtc() után, ugyanarra az időpontra), ebből számoljuk a hét napját
+     */
+    void syncDate(uint16_t year, uint8_t month, uint8_t day);
+
+    inline bool isSynced() const { return synced; }
+
+    /**
+     * A hét napja UTC szerint (0: hétfő ... 6: vasárnap), RADIO_CLOCK_WEEKDAY_UNKNOWN, ha nincs dátum
+     */
+    uint8_t getWeekday() const;
+
+    /**
+     * A napon belüli UTC idő (ms, 0 .. RADIO_CLOCK_MS_PER_DAY - 1)
+     */
+    uint32_t getMillisOfDay() const;
+
+    /**
+     * Hány ms múlva lesz a napon belüli msOfDay időpont (0 .. RADIO_CLOCK_MS_PER_DAY - 1)
+     */
+    uint32_t millisUntil(uint32_t msOfDay) const;
+};
+
+// A globális óra (RadioClock.cpp)
+extern RadioClock radioClock;
+
+#endif // __RADIO_CLOCK_H
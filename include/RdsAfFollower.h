@@ -0,0 +1,125 @@
+#ifndef __RDS_AF_FOLLOWER_H
+#define __RDS_AF_FOLLOWER_H
+
+#include "Band.h"
+#include "RdsDecoder.h"
+#include "Si4735Ext.h"
+
+// AF követés időzítések és küszöbök
+#define AF_CHECK_INTERVAL 1000          // Az aktuális frekvencia jelminőségének mérése (ms)
+#define AF_PROBE_INTERVAL 15000         // Jó vétel mellett ilyen sűrűn mérünk meg egy AF-et (ms)
+#define AF_PROBE_INTERVAL_WEAK 2000     // Gyenge vétel mellett ilyen sűrűn (ms)
+#define AF_PROBE_BUDGET 40              // Egy hangolás (oda vagy vissza) maximális ideje a próba alatt (ms)
+#define AF_PI_CHECK_TIMEOUT 300         // Átváltás előtt eddig várunk a PI kód egyezésére (ms)
+#define AF_RETURN_RETRY_INTERVAL 100    // Sikertelen visszahangolás után ilyen időközönként próbáljuk újra (ms)
+#define AF_CANDIDATE_MAX_AGE 60000      // Ennél régebbi mérés alapján nem váltunk (ms)
+#define AF_WEAK_RSSI 20                 // Ez alatt (dBuV) gyenge a vétel
+#define AF_WEAK_SNR 8                   // Ez alatt (dB) gyenge a vétel
+#define AF_WEAK_CONFIRM_COUNT 3         // Ennyi egymást követő gyenge mérés után váltunk
+#define AF_SWITCH_MARGIN_RSSI 6         // Az AF-nek legalább ennyivel (dBuV) erősebbnek kell lennie
+#define AF_PI_MISMATCH_HOLDOFF 120000   // A rossz PI-jű AF-et eddig nem próbáljuk újra (ms)
+
+/**
+ * @brief RDS alternatív frekvencia (AF) követés
+ *
+ * A dekóder által a 0A csoportokból gyűjtött AF listát háttérben, rövid némított szünetekben
+ * végigméri (oda-hangolás, RSSI/SNR, vissza-hangolás, mindkét irány fix időkerettel).
+ * Ha az aktuális frekvencia vétele tartósan a küszöb alá esik, akkor a legjobb friss mérésű AF-re
+ * hangol, de csak akkor marad ott, ha a PI kód megegyezik, különben visszaáll.
+ * A PI ellenőrzés nem blokkol: az RDS dekóder PI ellenőrző módban dolgozik az AF-en (az otthoni
+ * állomás adatai közben megmaradnak), a loop() pedig az így kapott PI kódot figyeli. Ha a visszahangolás nem fejeződik be időben, a hang némítva marad,
+ * és a loop() addig próbálkozik, amíg vissza nem ért (vagy a felhasználó máshova nem hangolt).
+ */
+class RdsAfFollower {
+
+  public:
+    // Egy AF jelölt utolsó mérése
+    struct AfCandidate {
+        uint16_t frequency;    // 10kHz egységben
+        uint8_t rssi;
+        uint8_t snr;
+        uint32_t measuredAt;   // millis() a mérés pillanatában (0: még nem mértük)
+        uint32_t piMismatchAt; // millis() a PI eltérés pillanatában (0: nem volt)
+    };
+
+    // Az átváltás állapotai
+    enum class State : uint8_t {
+        Idle,        // Az otthoni frekvencián vagyunk
+        VerifyingPi, // Az AF-en várjuk a PI kódot
+        Returning    // A visszahangolás nem fejeződött be, újrapróbáljuk
+    };
+
+  private:
+    Si4735Ext &si4735;
+    Band &band;
+    RdsDecoder &rdsDecoder;
+
+    State state = State::Idle;
+    uint8_t verifyIdx = 0;      // Az ellenőrzés alatt álló jelölt
+    uint8_t verifyRssi = 0;     // A jelölt mérése az átváltáskor
+    uint8_t verifySnr = 0;
+    uint32_t stateStartTime = 0;
+
+    AfCandidate candidates[RDS_MAX_AF];
+    uint8_t candidateCount = 0;
+    uint8_t nextProbeIdx = 0;
+
+    uint16_t homeFrequency = 0; // Az aktuális (követett) frekvencia
+    uint16_t homePi = 0;        // Az aktuális állomás PI kódja
+
+    bool enabled = true;
+    uint8_t weakCount = 0;
+    uint8_t homeRssi = 0;
+    uint8_t homeSnr = 0;
+    uint32_t lastCheck = 0;
+    uint32_t lastProbe = 0;
+
+    // Statisztika
+    uint32_t probeCount = 0;
+    uint32_t switchCount = 0;
+    uint32_t maxProbeMicros = 0;
+
+    void clear();
+    void syncCandidates();
+    void checkHomeQuality();
+    void probeNext();
+    bool tuneMuted(uint16_t freq, uint8_t &rssi, uint8_t &snr);
+    bool returnHome();
+    void finishSwitch();
+    void loopVerify();
+    int8_t findBestCandidate();
+    void switchTo(uint8_t idx);
+
+  public:
+    RdsAfFollower(Si4735Ext &si4735, Band &band, RdsDecoder &rdsDecoder);
+
+    /**
+     * Arduino loop - csak FM módban, az RDS dekóder után hívandó
+     */
+    void loop();
+
+    /**
+     * AF követés ki/bekapcsolása
+     */
+    inline void setEnabled(bool enable) {
+        enabled = enable;
+        clear();
+    }
+    inline bool isEnabled() const { return enabled; }
+
+    /**
+     * Folyamatban van egy átváltás (PI ellenőrzés vagy visszahangolás)?
+     */
+    inline bool isSwitching() const { return state != State::Idle; }
+
+    inline uint8_t getCandidateCount() const { return candidateCount; }
+    inline const AfCandidate &getCandidate(uint8_t idx) const { return candidates[idx]; }
+    inline uint32_t getSwitchCount() const { return switchCount; }
+
+    /**
+     * A leghosszabb némított próba szünet (us)
+     */
+    inline uint32_t getMaxProbeMicros() const { return maxProbeMicros; }
+};
+
+#endif // __RDS_AF_FOLLOWER_H
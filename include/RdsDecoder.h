@@ -0,0 +1,173 @@
+#ifndef __RDS_DECODER_H
+#define __RDS_DECODER_H
+
+#include <functional>
+
+#include "Si4735Ext.h"
+
+// RDS időzítések és korlátok
+#define RDS_POLL_INTERVAL 40         // FIFO ürítés gyakorisága (ms), egy csoport ~87.6ms alatt érkezik
+#define RDS_MAX_GROUPS_PER_DRAIN 8   // Egy ürítéskor legfeljebb ennyi csoportot dolgozunk fel
+#define RDS_MAX_BLOCK_ERRORS 1       // Ennél több javított bithiba esetén a szöveges blokkot eldobjuk
+#define RDS_CHAR_CONFIRM_VOTES 2     // Ennyi egyező szavazat kell egy karakter elfogadásához
+#define RDS_CHAR_MAX_VOTES 4         // A szavazatszám felső korlátja (ennyi eltérés kell a cseréhez)
+
+#define RDS_PS_LENGTH 8
+#define RDS_RT_LENGTH 64
+#define RDS_MAX_AF 25
+
+// Változás események (bitmaszk)
+#define RDS_EVENT_PI (1 << 0)
+#define RDS_EVENT_PS (1 << 1)
+#define RDS_EVENT_RT (1 << 2)
+#define RDS_EVENT_CT (1 << 3)
+#define RDS_EVENT_PTY (1 << 4)
+#define RDS_EVENT_AF (1 << 5)
+
+/**
+ * @brief Esemény vezérelt RDS csoport dekóder
+ *
+ * A chip RDS FIFO-ját üríti, a 0A/0B (PS, AF), 2A/2B (RadioText) és 4A (CT) csoportokat fix méretű
+ * bufferekbe dekódolja. Minden karakter pozícióhoz szavazás tartozik, így egy-egy hibás csoport nem
+ * rontja el a kijelzett szöveget. Eseményt csak akkor küld, ha a PS, RT, CT vagy PTY ténylegesen változott,
+ * így a képernyőknek csak ilyenkor kell újrarajzolniuk, és nincs String/heap foglalás sem.
+ */
+class RdsDecoder {
+
+  public:
+    // Az RDS CT (4A) csoportból dekódolt idő (UTC)
+    struct RdsClock {
+        uint16_t year;
+        uint8_t month;
+        uint8_t day;
+        uint8_t hour;   // UTC óra
+        uint8_t minute; // UTC perc
+        int8_t localOffsetHalfHours; // Helyi idő eltolása fél órákban
+        uint32_t receivedAt;          // millis() a vétel pillanatában
+        bool valid;
+    };
+
+    // Esemény callback: a paraméter a változott mezők bitmaszkja (RDS_EVENT_xxx)
+    using EventCallback = std::function<void(uint8_t events)>;
+
+  private:
+    // Karakter pozíció szavazással
+    struct VotedChar {
+        char candidate; // Az aktuális jelölt
+        uint8_t votes;  // A jelölt szavazatai
+    };
+
+    Si4735Ext &si4735;
+
+    uint16_t pi = 0;
+    uint8_t pty = 0;
+    bool ptyValid = false;
+
+    VotedChar psVotes[RDS_PS_LENGTH];
+    char ps[RDS_PS_LENGTH + 1];        // Elfogadott (kijelezhető) PS
+    uint8_t psValidMask = 0;           // Melyik PS karakter pozíció elfogadott
+
+    VotedChar rtVotes[RDS_RT_LENGTH];
+    char rt[RDS_RT_LENGTH + 1];        // Elfogadott (kijelezhető) RadioText
+    uint64_t rtValidMask = 0;          // Melyik RT karakter pozíció elfogadott
+    uint8_t rtLength = RDS_RT_LENGTH;  // Az RT hossza (0x0D lezáró alapján)
+    int8_t rtAbFlag = -1;              // Az utolsó RT A/B flag (-1: még nem volt)
+
+    RdsClock clock;
+
+    uint16_t afList[RDS_MAX_AF];       // Alternatív frekvenciák (10kHz egységben, mint a bandTable FM)
+    uint8_t afCount = 0;
+
+    // PI ellenőrzés (AF próba): a csoportokból csak a PI-t nézzük, az állomás adatai megmaradnak
+    bool piCheckActive = false;
+    uint16_t checkedPi = 0;
+
+    uint8_t pendingEvents = 0;
+    EventCallback eventCallback = nullptr;
+    uint32_t lastPoll = 0;
+
+    // Statisztika
+    uint32_t groupCount = 0;
+    uint32_t droppedGroups = 0;
+
+    void decodeGroup(const Si4735Ext::RdsGroup &group);
+    void decodeGroup0(const Si4735Ext::RdsGroup &group, bool versionB);
+    void decodeGroup2(const Si4735Ext::RdsGroup &group, bool versionB);
+    void decodeGroup4A(const Si4735Ext::RdsGroup &group);
+    void decodeAfCode(uint8_t code);
+
+    bool voteChar(VotedChar *votes, char *text, uint8_t pos, char c);
+    static char sanitizeChar(uint8_t c);
+    void clearRadioText();
+
+  public:
+    RdsDecoder(Si4735Ext &si4735);
+
+    /**
+     * Minden RDS állapot törlése (frekvencia váltáskor hívandó)
+     */
+    void reset();
+
+    /**
+     * PI ellenőrzés indítása egy idegen (AF) frekvencián
+     * Amíg tart, a csoportokból csak az A blokk PI kódját vesszük ki (getCheckedPi()),
+     * a PS, RT, AF lista és a saját PI érintetlen marad, így sikertelen próba után sem vész el.
+     */
+    inline void beginPiCheck() {
+        piCheckActive = true;
+        checkedPi = 0;
+    }
+
+    /**
+     * PI ellenőrzés vége, a dekódolás a megőrzött állapottal folytatódik
+     */
+    inline void endPiCheck() { piCheckActive = false; }
+
+    /**
+     * A PI ellenőrzés alatt az első hibátlan A blokk PI kódja (0: még nem jött)
+     */
+    inline uint16_t getCheckedPi() const { return checkedPi; }
+
+    /**
+     * A chip FIFO-jának kiürítése és a csoportok dekódolása
+     * @param intAck az RDS megszakítás nyugtázása
+     * @return a feldolgozott csoportok száma
+     */
+    uint8_t drainFifo(bool intAck = false);
+
+    /**
+     * Arduino loop: időzített FIFO ürítés, majd az események kiküldése
+     */
+    void loop();
+
+    /**
+     * Esemény callback beállítása
+     */
+    inline void setEventCallback(EventCallback callback) { eventCallback = callback; }
+
+    /**
+     * A callback nélküli (polling) felhasználóknak: a legutóbbi lekérdezés óta változott mezők
+     */
+    inline uint8_t consumeEvents() {
+        uint8_t events = pendingEvents;
+        pendingEvents = 0;
+        return events;
+    }
+
+    // Getterek - fix bufferek, nincs másolás
+    inline uint16_t getPI() const { return pi; }
+    inline uint8_t getPTY() const { return pty; }
+    inline bool isPtyValid() const { return ptyValid; }
+    inline const char *getProgramService() const { return ps; }
+    inline bool isProgramServiceComplete() const { return psValidMask == 0xFF; }
+    inline const char *getRadioText() const { return rt; }
+    inline const RdsClock &getClock() const { return clock; }
+    inline const uint16_t *getAfList(uint8_t &count) const {
+        count = afCount;
+        return afList;
+    }
+    inline uint32_t getGroupCount() const { return groupCount; }
+    inline uint32_t getDroppedGroupCount() const { return droppedGroups; }
+};
+
+#endif // __RDS_DECODER_H
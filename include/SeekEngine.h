@@ -0,0 +1,76 @@
+#ifndef __SEEK_ENGINE_H
+#define __SEEK_ENGINE_H
+
+#include <functional>
+
+#include "Band.h"
+#include "Si4735Ext.h"
+
+// Seek időzítések
+#define SEEK_POLL_INTERVAL 20   // Ilyen sűrűn kérdezzük a köztes frekvenciát (ms)
+#define SEEK_TIMEOUT 30000      // Ennyi idő után mindenképp leállítjuk (ms)
+#define SEEK_FM_SPACING 10      // FM seek lépésköz (10kHz egységben -> 100kHz)
+
+/**
+ * @brief Nem blokkoló seek
+ *
+ * A chip seek parancsát indítja, majd időzítve kérdezi a tune státuszt. A köztes frekvenciákat
+ * a callbacken (és a band rekord currFreq mezőjén) keresztül adja tovább a kijelzőnek, így a UI
+ * a seek alatt is teljes sebességgel fut. Bármikor megszakítható (rotary/touch), ilyenkor a chip
+ * az épp aktuális frekvencián marad. A bandTable sávhatárainál átfordul.
+ */
+class SeekEngine {
+
+  public:
+    enum class State : uint8_t {
+        Idle,      // Nem fut
+        Seeking,   // A chip keres
+        Cancelling // Megszakítást kértünk, a chip STC-jére várunk
+    };
+
+    // Seek esemény: a köztes/végső frekvencia, és hogy véget ért-e (found: érvényes állomáson állt meg)
+    using ProgressCallback = std::function<void(uint16_t frequency, bool finished, bool found)>;
+
+  private:
+    Si4735Ext &si4735;
+    Band &band;
+
+    State state = State::Idle;
+    bool seekUp = true;
+    uint16_t startFrequency = 0;
+    uint16_t lastFrequency = 0;
+    uint32_t startTime = 0;
+    uint32_t lastPoll = 0;
+
+    ProgressCallback progressCallback = nullptr;
+
+    void finish(uint16_t frequency, bool found);
+
+  public:
+    SeekEngine(Si4735Ext &si4735, Band &band);
+
+    /**
+     * Seek indítása az aktuális sávban (SSB/CW módban a chip nem tud seekelni)
+     * @param up felfelé keresünk?
+     * @return true, ha elindult
+     */
+    bool start(bool up);
+
+    /**
+     * Seek megszakítása
+     * @return true, ha futott a seek (a rotary/touch eseményt ezzel "elfogyasztottuk")
+     */
+    bool abort();
+
+    /**
+     * Arduino loop - időzített státusz lekérdezés
+     */
+    void loop();
+
+    inline void setProgressCallback(ProgressCallback callback) { progressCallback = callback; }
+    inline bool isRunning() const { return state != State::Idle; }
+    inline State getState() const { return state; }
+    inline uint16_t getCurrentFrequency() const { return lastFrequency; }
+};
+
+#endif // __SEEK_ENGINE_H
@@ -0,0 +1,162 @@
+#ifndef __SI4735EXT_H
+#define __SI4735EXT_H
+
+#include <SI4735.h>
+
+// Megszakítás források (GET_INT_STATUS bitek)
+#define SI4735_INT_STC (1 << 0) // Seek/Tune Complete
+#define SI4735_INT_RDS (1 << 2) // RDS FIFO
+#define SI4735_INT_RSQ (1 << 3) // Jelminőség küszöb átlépés
+
+// RDS megszakítás: ennyi csoport után jelez a chip
+#define SI4735_RDS_INT_FIFO_COUNT 4
+
+// Megszakítás felügyelet
+#define SI4735_IRQ_SELFTEST_TIMEOUT 100 // Indításkori teszt: eddig várunk, hogy az STC a GPO2/INT lábon is megjelenjen (ms)
+#define SI4735_IRQ_SAFETY_POLL 10       // Megszakításos módban is ennyi időnként lekérdezzük a tune státuszt (elveszett él ellen, ms)
+#define SI4735_RDS_IRQ_WATCHDOG 500     // Ha ennyi ideig nem jött RDS megszakítás, akkor is ürítjük a FIFO-t (ms)
+#define SI4735_RSQ_HYSTERESIS 3         // Az RSQ alsó küszöbe ennyivel (dB / dBuV) a felső alatt van
+
+/**
+ * @brief Az SI4735 könyvtár kiterjesztése
+ *
+ * A PU2CLR SI4735 osztály néhány szükséges adatát (RDS blokkok, FIFO állapot) csak protected
+ * tagokon keresztül lehet elérni, ezeket itt tesszük publikussá, heap foglalás nélkül.
+ */
+class Si4735Ext : public SI4735 {
+
+  private:
+    // A GPO2/INT lábról érkező megszakítás jelzője, az ISR csak ezt állítja
+    static volatile bool irqPending;
+    static void irqHandler();
+
+    int8_t interruptPin = -1;      // -1: nincs megszakítás láb, polling
+    uint8_t savedPinFunction = 0;  // A láb beginInterrupts() előtti beállítása, a polling módra visszaálláskor visszaállítjuk
+    bool savedPinOutput = false;
+    bool savedPinPullUp = false;
+    bool savedPinPullDown = false;
+    bool interruptLineChecked = false; // Lefutott már az indításkori megszakítás teszt?
+    bool stcLatched = false;       // A serviceInterrupts() nyugtázott egy STC-t (a seek ebből is látja a véget)
+    bool rdsLatched = false;       // Jelzett RDS megszakítás, amíg a FIFO ürítés nyugtázza
+    bool interruptsActive = false; // A chipen be vannak kapcsolva a megszakítások?
+    bool rsqUsesRssi = true;       // RSQ megszakítás metrikája
+    uint8_t rsqThreshold = 0;      // RSQ megszakítás küszöbe (0: kikapcsolva)
+    bool rsqAbove = false;         // A jel a küszöb felett van? (ettől függ, melyik él van élesítve)
+
+    uint8_t readInterruptStatus();
+    void applyRsqThreshold();
+    bool verifyInterruptLine();
+    void releaseInterruptPin();
+
+  public:
+    // Egy RDS csoport nyers blokkjai és a blokkonkénti hibaszint (0: nincs hiba ... 3: javíthatatlan)
+    struct RdsGroup {
+        uint16_t blockA;
+        uint16_t blockB;
+        uint16_t blockC;
+        uint16_t blockD;
+        uint8_t errA;
+        uint8_t errB;
+        uint8_t errC;
+        uint8_t errD;
+    };
+
+    /**
+     * Az RDS FIFO-ban várakozó csoportok száma (a FIFO-t nem ürítjük)
+     * @param intAck az RDS megszakítás jelzőt is nyugtázzuk?
+     */
+    uint8_t getRdsFifoCount(bool intAck = false);
+
+    /**
+     * A legrégebbi RDS csoport kivétele a chip FIFO-jából
+     * @param group ide kerülnek a blokkok
+     * @return true, ha a dekóder szinkronban van (a blokkok értelmezhetők)
+     */
+    bool readRdsGroup(RdsGroup &group);
+
+    /**
+     * A chip RDS FIFO-jának törlése (pl. egy rövid AF próba után ne keveredjenek a csoportok)
+     */
+    inline void flushRdsFifo() { getRdsStatus(0, 1, 1); }
+
+    /**
+     * Frekvencia beállítása a könyvtár fix késleltetése nélkül
+     * A hangolás végét a waitTuneComplete()-tel kell megvárni
+     */
+    void setFrequencyNoWait(uint16_t freq);
+
+    /**
+     * Várakozás a hangolás végére (STC), legfeljebb timeoutMs ideig
+     * Siker esetén az STC megszakítást nyugtázzuk, az RSSI/SNR a getReceivedSignalStrengthIndicator()/getStatusSNR()-rel olvasható
+     * @return true, ha a hangolás befejeződött
+     */
+    bool waitTuneComplete(uint16_t timeoutMs);
+
+    /**
+     * Nem blokkoló seek indítása (FM_SEEK_START / AM_SEEK_START)
+     * A véget a pollTuneStatus() jelzi, a könyvtár seekStationProgress()-e helyett
+     * @param up felfelé keresünk?
+     * @param wrap a sávhatáron átfordul?
+     */
+    void seekStart(bool up, bool wrap);
+
+    /**
+     * A folyamatban lévő seek megszakítása (TUNE_STATUS CANCEL), a chip az aktuális frekvencián áll meg
+     */
+    inline void seekCancel() { getStatus(0, 1); }
+
+    /**
+     * Hangolás/seek állapot lekérdezése nyugtázás nélkül
+     * @param frequency az aktuális (seek közben a köztes) frekvencia
+     * @param valid érvényes állomás (seek végén)
+     * @param bandLimit a seek sávhatárt ért el (wrap nélkül)
+     * @return true, ha a hangolás/seek befejeződött (az STC-t ilyenkor nyugtázzuk)
+     */
+    bool pollTuneStatus(uint16_t &frequency, bool &valid, bool &bandLimit);
+
+    /**
+     * A GPO2/INT láb megszakításának bekötése (a setup()-ban, egyszer, csak ha a PIN_SI4735_INT definiálva van)
+     * A chip oldali engedélyezést a configureInterrupts() végzi minden power-up után
+     */
+    void beginInterrupts(uint8_t pin);
+
+    /**
+     * STC/RDS/RSQ megszakítások engedélyezése a chipen (GPO_IEN)
+     * Power-up után újra kell hívni, mert a chip elfelejti. Az SSB patch a GPO2 kimenetet letiltja,
+     * ilyenkor marad a polling. Az első hívás egy próba hangolással ellenőrzi, hogy a GPO2/INT láb
+     * tényleg jelez-e; ha nem (nincs bekötve, rossz láb), akkor végleg polling módban maradunk.
+     * @param patchLoaded SSB patch van betöltve?
+     */
+    void configureInterrupts(bool patchLoaded);
+
+    /**
+     * Megszakítás vezérelt módban vagyunk?
+     */
+    inline bool isInterruptDriven() const { return interruptsActive; }
+
+    /**
+     * A függő megszakítás feldolgozása: egyetlen GET_INT_STATUS, ha az ISR jelzett, egyébként nincs I2C
+     * Az STC-t és az RSQ-t itt nyugtázzuk; az RDS-t a FIFO ürítés (getRdsFifoCount(true)) nyugtázza,
+     * addig a visszaadott bitek között marad
+     * @return a jelzett források (SI4735_INT_xxx)
+     */
+    uint8_t serviceInterrupts();
+
+    /**
+     * RSQ megszakítás küszöb (pl. a squelch szintje), 0: kikapcsolva
+     * Egyszerre csak az egyik él van élesítve: a küszöb alatt a felső (threshold), felette az alsó
+     * (threshold - SI4735_RSQ_HYSTERESIS), így a küszöb körül ingadozó jel nem okoz megszakítás záport.
+     */
+    void setRsqThreshold(bool useRssi, uint8_t threshold);
+
+    /**
+     * A mért jelszint alapján az élesített RSQ él váltása (a jelminőség minta után hívandó)
+     * @param level az RSQ metrika szerinti érték (RSSI vagy SNR)
+     */
+    void trackRsqLevel(uint8_t level);
+};
+
+// A globális chip példány (main.cpp)
+extern Si4735Ext si4735;
+
+#endif // __SI4735EXT_H
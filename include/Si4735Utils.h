@@ -1,9 +1,19 @@
 #ifndef __SI4735UTILS_H
 #define __SI4735UTILS_H
 
-#include <SI4735.h>
-
+#include "AntCapTuner.h"
 #include "Band.h"
+#include "BandActivityRecorder.h"
+#include "BeaconMonitor.h"
+#include "DualWatch.h"
+#include "FmAutoStore.h"
+#include "MemoryScanner.h"
+#include "RdsAfFollower.h"
+#include "RdsDecoder.h"
+#include "SeekEngine.h"
+#include "Si4735Ext.h"
+#include "StationData.h"
+#include "TuningEngine.h"
 
 /**
  * si4735 utilities
@@ -19,6 +29,20 @@ class Si4735Utils {
     bool hardwareAudioMuteState;        // SI4735 hardware audio mute állapot
     uint32_t hardwareAudioMuteElapsed;  // SI4735 hardware audio mute állapot start ideje
     bool isSquelchMuted = false;        // Kezdetben nincs némítva a squelch miatt
+    uint8_t rsqThreshold = 0xFF;        // A chipre kiküldött RSQ megszakítás küszöb
+    bool rsqUsesRssi = false;
+    uint32_t lastRdsDrain = 0;          // Az utolsó RDS FIFO ürítés (megszakításos módban a watchdog-hoz)
+
+    // A legutóbb látott hangolás (sáv, band rekord és chip frekvencia), a változás figyeléséhez
+    int8_t tunedBandIdx = -1;
+    uint16_t tunedBandFreq = 0;
+    uint16_t tunedChipFreq = 0;
+    uint32_t seenAfSwitches = 0; // Az AF követő legutóbb látott váltás száma
+
+    /**
+     * Központi hangolás figyelés: bármelyik funkció hangolt át, az RDS állapot érvénytelen
+     */
+    void checkTuningChange();
 
     /**
      * Manage Audio Mute
@@ -28,11 +52,44 @@ class Si4735Utils {
 
    protected:
     // SI4735
-    SI4735 &si4735;
+    Si4735Ext &si4735;
 
     // Band objektum
     Band &band;
 
+    // RDS dekóder (csak FM módban fut)
+    RdsDecoder rdsDecoder;
+
+    // RDS AF követés (a dekóder AF listája alapján)
+    RdsAfFollower afFollower;
+
+    // Sáv aktivitás rögzítő (tétlen időszakban méri a sáv csatornáit)
+    BandActivityRecorder activityRecorder;
+
+    // FM állomáslista automatikus feltöltése (sáv végigmérés + RDS nevek)
+    FmAutoStore fmAutoStore;
+
+    // Időosztásos kettős figyelés (elsődleges + másodlagos frekvencia)
+    DualWatch dualWatch;
+
+    // Memória csatorna scanner (FM + AM tárolók)
+    MemoryScanner memoryScanner;
+
+    // Nem blokkoló seek (rotary/touch eseménnyel megszakítható)
+    SeekEngine seekEngine;
+
+    // A rotary lépéseit összevonó hangolás
+    TuningEngine tuningEngine;
+
+    // Antenna kapacitás behangolás (blokkoló, csak felhasználói kérésre)
+    AntCapTuner antCapTuner;
+
+    // NCDXF/IARU beacon figyelés (a chip a HAM sávok beacon frekvenciáin jár)
+    BeaconMonitor beaconMonitor;
+
+    // Az utoljára elfogadott RDS PS név (a szóközök levágva), csak PS változáskor frissül
+    char rdsProgramService[STATION_NAME_BUFFER_SIZE] = "";
+
     /**
      * Manage Squelch
      */
@@ -50,9 +107,9 @@ class Si4735Utils {
 
     /**
      * @brief Lekérdezi az aktuális RDS Program Service (PS) nevet.
-     * @return String Az állomásnév, vagy üres String, ha nem elérhető.
+     * @return Az állomásnév, vagy üres string, ha nem elérhető (fix buffer, nincs heap foglalás)
      */
-    String getCurrentRdsProgramService();
+    const char *getCurrentRdsProgramService();
 
    public:
     // AGC beállítási lehetőségek
@@ -65,7 +122,7 @@ class Si4735Utils {
     /**
      * Konstruktor
      */
-    Si4735Utils(SI4735 &si4735, Band &band);
+    Si4735Utils(Si4735Ext &si4735, Band &band);
 
     /**
      * Frequency Step set
@@ -0,0 +1,128 @@
+#ifndef __SIGNAL_QUALITY_SAMPLER_H
+#define __SIGNAL_QUALITY_SAMPLER_H
+
+#include <atomic>
+
+#include <SI4735.h>
+
+// Mintavételezés
+#define SQ_DEFAULT_INTERVAL 100 // Alapértelmezett mintavételi időköz (ms)
+#define SQ_MIN_INTERVAL 20      // Ennél sűrűbben nem kérdezzük a chipet (ms)
+#define SQ_EMA_SHIFT 2          // Exponenciális simítás: alpha = 1 / 2^SQ_EMA_SHIFT
+#define SQ_HISTORY_SIZE 32      // Előzmény ring buffer mérete (2 hatvány)
+
+// A hangolót foglaló funkciók (setTunerBusy tulajdonos bitjei)
+#define TUNER_OWNER_TUNING 0x01    // TuningEngine
+#define TUNER_OWNER_SEEK 0x02      // SeekEngine
+#define TUNER_OWNER_SCANNER 0x04   // MemoryScanner
+#define TUNER_OWNER_AUTOSTORE 0x08 // FmAutoStore
+#define TUNER_OWNER_ANTCAP 0x10    // AntCapTuner
+#define TUNER_OWNER_DUALWATCH 0x20 // DualWatch
+#define TUNER_OWNER_BEACON 0x40    // BeaconMonitor
+#define TUNER_OWNER_AF 0x80        // RdsAfFollower
+
+/**
+ * @brief Közös jelminőség mintavételező
+ *
+ * Egyetlen helyen, beállítható gyakorisággal olvassa a chip RSQ státuszát (RSSI, SNR, multipath,
+ * frekvencia eltérés), így az I2C terhelés állandó, akárhány widget vagy funkció (squelch, S-meter, log)
+ * használja is. Az utolsó mintát és az exponenciálisan simított értékeket seqlock-kal védett pillanatképben
+ * publikálja, ezt mindkét core zár nélkül olvashatja. Hangolás közben (tuner busy) nem mintavételez.
+ */
+class SignalQualitySampler {
+
+  public:
+    // A publikált pillanatkép
+    struct Snapshot {
+        uint8_t rssi;       // Utolsó minta (dBuV)
+        uint8_t snr;        // Utolsó minta (dB)
+        uint8_t multipath;  // Utolsó minta (0..100%, csak FM)
+        int8_t freqOffset;  // Utolsó minta (kHz, előjeles)
+        uint8_t rssiAvg;    // Simított RSSI
+        uint8_t snrAvg;     // Simított SNR
+        uint32_t sampledAt; // millis() a mintavétel pillanatában
+        bool valid;         // Van már minta az aktuális frekvencián?
+    };
+
+    // Egy előzmény bejegyzés
+    struct HistoryEntry {
+        uint8_t rssi;
+        uint8_t snr;
+    };
+
+  private:
+    SI4735 &si4735;
+
+    uint16_t interval = SQ_DEFAULT_INTERVAL;
+    uint32_t lastSample = 0;
+    volatile uint8_t tunerOwners = 0; // A hangolót éppen foglaló funkciók bitjei
+    bool sampleRequested = false; // RSQ megszakítás jött, soron kívüli mintavétel kell
+
+    // Simított értékek 4 bites törtrésszel
+    uint16_t rssiEma = 0;
+    uint16_t snrEma = 0;
+    bool emaSeeded = false;
+
+    // Előzmények (csak a core0 írja/olvassa)
+    HistoryEntry history[SQ_HISTORY_SIZE];
+    uint8_t historyHead = 0;
+    uint8_t historyCount = 0;
+
+    // Seqlock: páratlan érték alatt írás folyik
+    std::atomic<uint32_t> sequence{0};
+    Snapshot published;
+
+    void sample();
+    void publish(const Snapshot &snapshot);
+    static uint16_t updateEma(uint16_t ema, uint8_t value);
+
+  public:
+    SignalQualitySampler(SI4735 &si4735);
+
+    /**
+     * Arduino loop (core0) - az időköz lejártakor egy RSQ lekérdezés
+     */
+    void loop();
+
+    /**
+     * Soron kívüli mintavétel kérése (RSQ megszakításkor)
+     */
+    inline void requestSample() { sampleRequested = true; }
+
+    /**
+     * Mintavételi időköz beállítása (ms)
+     */
+    inline void setInterval(uint16_t ms) { interval = ms < SQ_MIN_INTERVAL ? SQ_MIN_INTERVAL : ms; }
+    inline uint16_t getInterval() const { return interval; }
+
+    /**
+     * Hangolás alatt a mintavétel szünetel, az utolsó foglaló elengedésekor a simítás újraindul
+     * Minden funkció a saját TUNER_OWNER_ bitjét állítja, így az egymásba ágyazott foglalások nem írják felül egymást
+     */
+    void setTunerBusy(uint8_t owner, bool busy);
+    inline bool isTunerBusy() const { return tunerOwners != 0; }
+    inline bool isTunerBusyBy(uint8_t owner) const { return (tunerOwners & owner) != 0; }
+
+    /**
+     * A simított értékek és az előzmények eldobása (pl. frekvencia váltáskor)
+     */
+    void invalidate();
+
+    /**
+     * Az utolsó pillanatkép - bármelyik core-ról hívható, zár nélkül
+     */
+    Snapshot getSnapshot() const;
+
+    /**
+     * Előzmények (csak core0)
+     * @param age 0: a legfrissebb minta
+     * @return false, ha nincs ennyi minta
+     */
+    bool getHistory(uint8_t age, HistoryEntry &entry) const;
+    inline uint8_t getHistoryCount() const { return historyCount; }
+};
+
+// A globális mintavételező (main.cpp)
+extern SignalQualitySampler signalQualitySampler;
+
+#endif // __SIGNAL_QUALITY_SAMPLER_H
@@ -4,9 +4,13 @@
 #include "StoreEepromBase.h" // Szükséges a StoreEepromBase<T>::getRequiredSize() miatt
 #include <Arduino.h>
 
-// Maximális állomásszámok
-#define MAX_FM_STATIONS 20
-#define MAX_AM_STATIONS 50 // AM/LW/SW/SSB/CW
+// Maximális állomásszámok (a tömörített tárolással kétszer annyi fér az EEPROM keretbe, mint korábban)
+#define MAX_FM_STATIONS 40
+#define MAX_AM_STATIONS 100 // AM/LW/SW/SSB/CW
+
+// A korábbi, tömörítetlen tárolás állomásszámai (az átálláshoz)
+#define LEGACY_MAX_FM_STATIONS 20
+#define LEGACY_MAX_AM_STATIONS 50
 
 // Maximális név hossz + null terminátor
 #define MAX_STATION_NAME_LEN 15
@@ -24,6 +28,40 @@ struct StationData {
     // int16_t bfoOffset;   // Opcionális: Ha a BFO eltolást is menteni akarod
 };
 
+// Tárolt (tömörített) állomás: 96 bit
+// név 10 x 6 bit (nagybetűs karakterkészlet) | frekvencia 15 | sáv 5 | moduláció 3 | sávszélesség 3 | BFO 10
+#define PACKED_STATION_NAME_LEN 10 // A tárolt név legfeljebb ennyi karakter
+#define PACKED_STATION_SIZE 12
+// A tárolt lista formátum jele: a korábbi, azonos méretű nyers képben ugyanezen a helyen az állomásszám áll,
+// ami legfeljebb LEGACY_MAX_AM_STATIONS lehet, így ezt az értéket sosem veheti fel
+#define PACKED_STATION_FORMAT 0xA5
+struct PackedStation {
+    uint8_t bits[PACKED_STATION_SIZE];
+};
+
+/**
+ * Állomás tömörítése / kibontása a tároló határán (a RAM-ban a StationData marad)
+ */
+namespace StationPacking {
+void pack(const StationData &station, PackedStation &packed);
+void unpack(const PackedStation &packed, StationData &station);
+void normalize(StationData &station);
+int16_t normalizeBfo(int16_t bfoOffset);
+} // namespace StationPacking
+
+// Tárolt állomás lista
+template <uint8_t N> struct PackedStationList_t {
+    PackedStation stations[N];
+    uint8_t format; // PACKED_STATION_FORMAT
+    uint8_t count;
+};
+
+// A korábbi, tömörítetlen tárolt lista
+template <uint8_t N> struct LegacyStationList_t {
+    StationData stations[N];
+    uint8_t count;
+};
+
 // FM állomások listája
 struct FmStationList_t {
     StationData stations[MAX_FM_STATIONS];
@@ -36,18 +74,31 @@ struct AmStationList_t {
     uint8_t count = 0; // Tárolt állomások száma
 };
 
-// EEPROM címek dinamikus meghatározása
+typedef PackedStationList_t<MAX_FM_STATIONS> PackedFmStationList_t;
+typedef PackedStationList_t<MAX_AM_STATIONS> PackedAmStationList_t;
+typedef LegacyStationList_t<LEGACY_MAX_FM_STATIONS> LegacyFmStationList_t;
+typedef LegacyStationList_t<LEGACY_MAX_AM_STATIONS> LegacyAmStationList_t;
+
+static_assert(sizeof(PackedStation) * 2 <= sizeof(StationData), "The packed station must be at most half the size");
+static_assert(PACKED_STATION_FORMAT > LEGACY_MAX_FM_STATIONS && PACKED_STATION_FORMAT > LEGACY_MAX_AM_STATIONS,
+              "The packed format marker must not be a valid legacy station count");
+
+// EEPROM címek dinamikus meghatározása (a tömörített listákkal)
 // A Config osztály a 0. címet használja a StoreBase<Config_t> alapértelmezett implementációja szerint.
 constexpr uint16_t EEPROM_CONFIG_START_ADDR = 0;
 constexpr size_t CONFIG_REQUIRED_SIZE = StoreEepromBase<Config_t>::getRequiredSize();
 
 constexpr uint16_t EEPROM_FM_STATIONS_ADDR = EEPROM_CONFIG_START_ADDR + CONFIG_REQUIRED_SIZE;
-constexpr size_t FM_STATIONS_REQUIRED_SIZE = StoreEepromBase<FmStationList_t>::getRequiredSize();
+constexpr size_t FM_STATIONS_REQUIRED_SIZE = StoreEepromBase<PackedFmStationList_t>::getRequiredSize();
 
 constexpr uint16_t EEPROM_AM_STATIONS_ADDR = EEPROM_FM_STATIONS_ADDR + FM_STATIONS_REQUIRED_SIZE;
-constexpr size_t AM_STATIONS_REQUIRED_SIZE = StoreEepromBase<AmStationList_t>::getRequiredSize();
+constexpr size_t AM_STATIONS_REQUIRED_SIZE = StoreEepromBase<PackedAmStationList_t>::getRequiredSize();
+
+// A korábbi EEPROM kiosztás (a régi képek átvételéhez)
+constexpr uint16_t LEGACY_EEPROM_FM_STATIONS_ADDR = EEPROM_CONFIG_START_ADDR + CONFIG_REQUIRED_SIZE;
+constexpr uint16_t LEGACY_EEPROM_AM_STATIONS_ADDR = LEGACY_EEPROM_FM_STATIONS_ADDR + StoreEepromBase<LegacyFmStationList_t>::getRequiredSize();
 
-// Fordítási idejű ellenőrzés, hogy a kiosztás nem lépi-e túl az EEPROM méretét.
+// Fordítási idejű ellenőrzés, hogy a kiosztás nem lépi-e túl az EEPROM méretét (az AntCapStore.h is ellenőrzi a teljes kiosztást).
 // Az EEPROM_SIZE makró a StoreEepromBase.h-ban van definiálva (alapértelmezetten 2048).
 static_assert(EEPROM_AM_STATIONS_ADDR + AM_STATIONS_REQUIRED_SIZE <= EEPROM_SIZE,
               "EEPROM layout exceeds EEPROM_SIZE. Check Config_t, FmStationList_t, AmStationList_t sizes or EEPROM_SIZE.");
@@ -0,0 +1,218 @@
+#ifndef __STATION_DATABASE_H
+#define __STATION_DATABASE_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+// Lapozás és kapacitás
+#define STATION_DB_PAGE_SIZE 512      // Egy lap mérete (byte), a fájl ilyen egységekben olvasható
+#define STATION_DB_CACHE_PAGES 4      // Ennyi lap van egyszerre a RAM-ban (LRU)
+#define STATION_DB_MAX_RECORDS 5120   // Kapacitás a 0.5 MB-os LittleFS partíción (lásd lent)
+#define STATION_DB_NAME_LEN 17        // Név hossz + null terminátor: 18 byte
+#define STATION_DB_NAME_KEY_LEN 6     // A név index kulcsa (nagybetűs név eleje)
+
+#define STATION_DB_FILE_NAME "/stations.db"
+#define STATION_DB_IMPORT_FILE "/eibi.csv" // Frekvencia szerint rendezett EiBi formátumú CSV
+#define STATION_DB_IMPORT_DIR "/eibi"      // Ugyanez sorhatáron darabolva, a darabok név szerinti sorrendben (pl. split -l 500 -d)
+#define STATION_DB_PATH_LEN 48
+#define STATION_DB_IMPORT_STEP_BUDGET 10   // Az import egy loop()-beli lépésének időkerete (ms), a felület közben él
+#define STATION_DB_RUN_SIZE 1024          // Név index rendezési futás (bejegyzés), az import idejére foglalt RAM: 8K
+#define STATION_DB_MAX_RUNS ((STATION_DB_MAX_RECORDS + STATION_DB_RUN_SIZE - 1) / STATION_DB_RUN_SIZE)
+
+// Helyigény rekordonként: CSV sor ~75 byte, adatbázis 40 byte (32 rekord + 8 név index), import közben
+// a név futások még 8 byte. A feldolgozott CSV darabokat az import azonnal törli, így egy frissen feltöltött
+// fájlrendszer képből a csúcs az import eleje (a teljes CSV): 5120 rekord ~375 KB. Ha a régi adatbázis is
+// a fájlrendszeren van, az import elején CSV + régi adatbázis ~115 byte/rekord kell, ez ~4000 rekord.
+/**
+ * @brief Nagy, flash-en tárolt állomás adatbázis (pl. teljes EiBi/HFCC műsorrend)
+ *
+ * A fájl fix méretű lapokból áll: fejléc, lap-könyvtár, a frekvencia szerint rendezett rekord lapok,
+ * végül a név szerint rendezett (kulcs, rekord sorszám) index lapok. Induláskor csak a fejléc és a
+ * könyvtár (laponként az első frekvencia / név kulcs) kerül a RAM-ba, a lapokat igény szerint egy
+ * kis LRU gyorsítótárba olvassuk. Egy frekvencia tartomány vagy név eleje szerinti lekérdezés a
+ * könyvtárban bináris kereséssel találja meg az első lapot, és csak az érintett lapokat olvassa.
+ * Az import lépésenként, időkerettel fut (beginImport() + importStep() a loop()-ból), közben az
+ * adatbázis nem kérdezhető le. A CSV egy fájl vagy egy könyvtárnyi darab lehet, a beolvasott
+ * darabokat azonnal töröljük, hogy az épülő adatbázisnak legyen helye.
+ */
+class StationDatabase {
+
+  public:
+    // Egy adatbázis rekord (32 byte, egy lapon 16)
+    struct Record {
+        uint16_t frequency;              // kHz
+        uint16_t startMinute;            // Adás kezdete (UTC, a nap perce)
+        uint16_t endMinute;              // Adás vége (UTC, a nap perce, 1440: éjfél)
+        uint8_t days;                    // Napok bitmaszkja (bit0: hétfő ... bit6: vasárnap)
+        uint8_t modulation;              // AM, LSB, USB, ...
+        char language[3];                // Nyelv kód (nem lezárt)
+        char itu[3];                     // Ország kód (nem lezárt)
+        char name[STATION_DB_NAME_LEN + 1]; // Állomás neve (lezárt)
+
+        /**
+         * Adásban van-e az adott időpontban
+         * @param weekday 0: hétfő ... 6: vasárnap, ismeretlen napnál (>= 7) csak az időt nézzük
+         */
+        bool isOnAir(uint16_t minuteOfDay, uint8_t weekday) const;
+    };
+
+    // Az import egy lépésének eredménye
+    enum class ImportStatus : uint8_t {
+        Running, // Még tart, a következő importStep() folytatja
+        Done,    // Kész, az új adatbázis használható
+        Failed,  // Sikertelen, a korábbi adatbázis maradt
+    };
+
+    /**
+     * Lekérdezés visszahívás
+     * @return false, ha nem kérünk több találatot
+     */
+    typedef bool (*Visitor)(const Record &record, uint16_t recordNo, void *context);
+
+    struct Stats {
+        uint32_t cacheHits;
+        uint32_t pageReads;
+    };
+
+  private:
+    // Az import fázisai
+    enum class ImportPhase : uint8_t {
+        Idle,
+        Records, // CSV sorok -> rekord lapok és rendezett név futások
+        Merge,   // A név futások összefésülése a név index lapokba
+    };
+
+    static constexpr uint16_t RECORDS_PER_PAGE = STATION_DB_PAGE_SIZE / sizeof(Record);
+
+    // Név index bejegyzés
+    struct NameEntry {
+        char key[STATION_DB_NAME_KEY_LEN];
+        uint16_t recordNo;
+    };
+    static constexpr uint16_t NAMES_PER_PAGE = STATION_DB_PAGE_SIZE / sizeof(NameEntry);
+
+    static constexpr uint16_t MAX_DATA_PAGES = (STATION_DB_MAX_RECORDS + RECORDS_PER_PAGE - 1) / RECORDS_PER_PAGE;
+    static constexpr uint16_t MAX_NAME_PAGES = (STATION_DB_MAX_RECORDS + NAMES_PER_PAGE - 1) / NAMES_PER_PAGE;
+    static constexpr uint16_t DIRECTORY_PAGES = (MAX_DATA_PAGES * sizeof(uint16_t) + MAX_NAME_PAGES * STATION_DB_NAME_KEY_LEN + STATION_DB_PAGE_SIZE - 1) / STATION_DB_PAGE_SIZE;
+    static constexpr uint16_t FIRST_DATA_PAGE = 1 + DIRECTORY_PAGES; // 0: fejléc
+
+    // A fájl fejléce (a 0. lap elején)
+    struct FileHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t pageSize;
+        uint16_t recordCount;
+        uint16_t dataPages;
+        uint16_t namePages;
+        uint16_t reserved;
+    };
+
+    // Gyorsítótár lap
+    struct CachedPage {
+        uint16_t pageNo; // 0xFFFF: üres
+        uint32_t lastUse;
+        uint8_t data[STATION_DB_PAGE_SIZE];
+    };
+
+    File file;
+    bool ready = false;
+    FileHeader header = {};
+
+    // Lap könyvtár: laponként az első frekvencia, ill. az első név kulcs
+    uint16_t frequencyFences[MAX_DATA_PAGES];
+    char nameFences[MAX_NAME_PAGES][STATION_DB_NAME_KEY_LEN];
+
+    CachedPage cache[STATION_DB_CACHE_PAGES];
+    uint32_t useCounter = 0;
+    Stats stats = {};
+
+    // Az import állapota a lépések között
+    ImportPhase importPhase = ImportPhase::Idle;
+    File importCsv;
+    char importSource[STATION_DB_PATH_LEN]; // A CSV fájl vagy a darabok könyvtára
+    char importChunk[STATION_DB_PATH_LEN];  // Az éppen olvasott darab
+    bool importChunked = false;
+    uint16_t importChunkTotal = 0;
+    uint16_t importChunksDone = 0;
+    uint32_t importTotalBytes = 0;
+    uint32_t importDoneBytes = 0;
+    File importOut;
+    File importRuns;
+    NameEntry *runBuffer = nullptr;
+    uint16_t importRecordCount = 0;
+    uint16_t runFill = 0;
+    uint16_t runCount = 0;
+    uint16_t previousFrequency = 0;
+    uint16_t mergedCount = 0;
+    uint32_t runPos[STATION_DB_MAX_RUNS];
+    uint32_t runEnd[STATION_DB_MAX_RUNS];
+
+    const uint8_t *getPage(uint16_t pageNo);
+    void invalidateCache();
+
+    bool openNextChunk();
+    void removeImportSource();
+    bool importRecords(uint32_t deadline);
+    bool startMerge();
+    bool mergeNames(uint32_t deadline);
+    ImportStatus finishImport();
+    ImportStatus abortImport();
+
+    static void makeNameKey(const char *name, char *key);
+    static bool parseCsvLine(char *line, Record &record);
+
+  public:
+    StationDatabase();
+
+    /**
+     * Az adatbázis megnyitása (a LittleFS.begin() után)
+     * @return false, ha nincs (érvényes) adatbázis
+     */
+    bool begin();
+
+    inline bool isReady() const { return ready; }
+    inline uint16_t getRecordCount() const { return ready ? header.recordCount : 0; }
+    inline const Stats &getStats() const { return stats; }
+
+    /**
+     * Egy rekord olvasása sorszám alapján (a frekvencia szerinti sorrendben)
+     */
+    bool getRecord(uint16_t recordNo, Record &record);
+
+    /**
+     * A [minFrequency, maxFrequency] tartomány rekordjai frekvencia szerint
+     * @return A visszaadott találatok száma
+     */
+    uint16_t findByFrequency(uint16_t minFrequency, uint16_t maxFrequency, Visitor visitor, void *context);
+
+    /**
+     * A név eleje szerint (kis/nagybetű független) egyező rekordok, név szerint rendezve
+     * @return A visszaadott találatok száma
+     */
+    uint16_t findByNamePrefix(const char *prefix, Visitor visitor, void *context);
+
+    /**
+     * Az adatbázis felépítésének indítása egy frekvencia szerint rendezett EiBi CSV-ből
+     * (kHz;Time(UTC);Days;ITU;Station;Lng;...), a név index külső összefésülő rendezéssel
+     * @param csvPath egy CSV fájl, vagy egy könyvtár, amelyben a CSV sorhatáron darabolva van
+     * A beolvasott darabokat töröljük; ha ezután az import meghiúsul, a maradékot is (a korábbi adatbázis megmarad)
+     * @return false, ha nem indítható (a korábbi adatbázis és a CSV megmarad)
+     */
+    bool beginImport(const char *csvPath);
+
+    /**
+     * Az import folytatása legfeljebb budgetMs ideig (a loop()-ból)
+     */
+    ImportStatus importStep(uint16_t budgetMs);
+
+    inline bool isImporting() const { return importPhase != ImportPhase::Idle; }
+
+    /**
+     * Az import előrehaladása (0..100%): a CSV beolvasása az első 80%, az összefésülés a maradék
+     */
+    uint8_t getImportProgress();
+};
+
+extern StationDatabase stationDatabase;
+
+#endif // __STATION_DATABASE_H
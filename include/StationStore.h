@@ -5,19 +5,78 @@
 #include "BaseStationStore.h"
 #include "DebugDataInspector.h"
 #include "StationData.h"
+#include "StoreFlashLog.h"
 
 // Üres alapértelmezett listák deklarációja (definíció a .cpp fájlban)
 extern const FmStationList_t DEFAULT_FM_STATIONS;
 extern const AmStationList_t DEFAULT_AM_STATIONS;
 
+/**
+ * @brief Az állomás listák tömörített tárolása
+ *
+ * A RAM-ban a teljes StationData lista marad, mentéskor/betöltéskor slotonként tömörítünk
+ * (a slot sorszáma, vagyis a StationId megmarad). A korábbi, tömörítetlen listát (flash log
+ * vagy régi EEPROM kiosztás) betöltéskor egyszer átvesszük.
+ */
+template <typename ListType, typename PackedListType, typename LegacyListType, uint8_t MaxStations> struct PackedStationStorage {
+
+    static uint16_t save(const ListType &list, uint8_t storeId, uint16_t eepromAddress, const char *className) {
+        PackedListType packed;
+        for (uint8_t i = 0; i < MaxStations; i++) {
+            StationPacking::pack(list.stations[i], packed.stations[i]);
+        }
+        packed.format = PACKED_STATION_FORMAT;
+        packed.count = list.count;
+        return StoreFlashLog<PackedListType>::save(packed, storeId, eepromAddress, className);
+    }
+
+    /**
+     * @return CRC16 ellenőrző összeg (0: nincs érvényes tárolt lista, vagy az átvett lista még nincs elmentve)
+     */
+    static uint16_t load(ListType &list, uint8_t storeId, uint16_t eepromAddress, uint16_t legacyEepromAddress, const char *className) {
+        PackedListType packed;
+        bool valid = false;
+        uint16_t crc = flashRecordStore.isReady() ? StoreFlashLog<PackedListType>::read(packed, storeId, className)
+                                                  : StoreEepromBase<PackedListType>::getIfValid(packed, valid, eepromAddress, className);
+        if (crc != 0 && packed.format == PACKED_STATION_FORMAT && packed.count <= MaxStations) {
+            for (uint8_t i = 0; i < MaxStations; i++) {
+                StationPacking::unpack(packed.stations[i], list.stations[i]);
+            }
+            list.count = packed.count;
+            return crc;
+        }
+
+        // Átállás a korábbi, tömörítetlen listáról (a slotok sorrendje megmarad)
+        LegacyListType legacy;
+        valid = StoreFlashLog<LegacyListType>::read(legacy, storeId, className) != 0;
+        if (!valid) {
+            StoreEepromBase<LegacyListType>::getIfValid(legacy, valid, legacyEepromAddress, className);
+        }
+        if (valid) {
+            // A RAM másolat is a tárolható alakra kerül, hogy újraindítás után ugyanazt lássuk
+            memcpy(list.stations, legacy.stations, sizeof(legacy.stations));
+            for (uint8_t i = 0; i < sizeof(legacy.stations) / sizeof(StationData); i++) {
+                StationPacking::normalize(list.stations[i]);
+            }
+            list.count = legacy.count;
+        }
+        DEBUG("[%s] %s mentése tömörítve\n", className, valid ? "Régi állomás lista" : "Alapértékek");
+
+        // EEPROM módban a régi kiosztás még olvasatlan része nem írható felül: a mentést a hívó jelzi
+        return flashRecordStore.isReady() ? save(list, storeId, eepromAddress, className) : 0;
+    }
+};
+
 // --- FM Station Store ---
 class FmStationStore : public BaseStationStore<FmStationList_t, MAX_FM_STATIONS> {
+    typedef PackedStationStorage<FmStationList_t, PackedFmStationList_t, LegacyFmStationList_t, MAX_FM_STATIONS> Storage;
+
   protected:
     const char *getClassName() const override { return "FmStationStore"; }
 
     // Felülírjuk a mentést/betöltést a helyes címmel és névvel
     uint16_t performSave() override {
-        uint16_t savedCrc = StoreEepromBase<FmStationList_t>::save(getData(), EEPROM_FM_STATIONS_ADDR, getClassName());
+        uint16_t savedCrc = Storage::save(getData(), FLASH_STORE_FM_STATIONS, EEPROM_FM_STATIONS_ADDR, getClassName());
 #ifdef __DEBUG
         if (savedCrc != 0)
             DebugDataInspector::printFmStationData(getData());
@@ -26,7 +85,10 @@ class FmStationStore : public BaseStationStore<FmStationList_t, MAX_FM_STATIONS>
     }
 
     uint16_t performLoad() override {
-        uint16_t loadedCrc = StoreEepromBase<FmStationList_t>::load(getData(), EEPROM_FM_STATIONS_ADDR, getClassName());
+        uint16_t loadedCrc = Storage::load(getData(), FLASH_STORE_FM_STATIONS, EEPROM_FM_STATIONS_ADDR, LEGACY_EEPROM_FM_STATIONS_ADDR, getClassName());
+        if (loadedCrc == 0) {
+            markDirty();
+        }
 #ifdef __DEBUG
         DebugDataInspector::printFmStationData(getData());
 #endif
@@ -34,28 +96,36 @@ class FmStationStore : public BaseStationStore<FmStationList_t, MAX_FM_STATIONS>
         if (data.count > MAX_FM_STATIONS) {
             DEBUG("[%s] Warning: FM station count corrected from %d to %d.\n", getClassName(), data.count, MAX_FM_STATIONS);
             data.count = MAX_FM_STATIONS;
+            markDirty();
         }
         return loadedCrc;
     }
 
   public:
-    FmStationStore() : BaseStationStore<FmStationList_t, MAX_FM_STATIONS>() { data = DEFAULT_FM_STATIONS; }
+    FmStationStore() : BaseStationStore<FmStationList_t, MAX_FM_STATIONS>() {
+        data = DEFAULT_FM_STATIONS;
+        rebuildIndex();
+    }
 
     void loadDefaults() override {
         memcpy(&data, &DEFAULT_FM_STATIONS, sizeof(FmStationList_t));
         data.count = 0;
+        rebuildIndex();
+        markDirty();
         DEBUG("FM Station defaults loaded.\n");
     }
 };
 
 // --- AM Station Store ---
 class AmStationStore : public BaseStationStore<AmStationList_t, MAX_AM_STATIONS> {
+    typedef PackedStationStorage<AmStationList_t, PackedAmStationList_t, LegacyAmStationList_t, MAX_AM_STATIONS> Storage;
+
   protected:
     const char *getClassName() const override { return "AmStationStore"; }
 
     // Felülírjuk a mentést/betöltést a helyes címmel és névvel
     uint16_t performSave() override {
-        uint16_t savedCrc = StoreEepromBase<AmStationList_t>::save(getData(), EEPROM_AM_STATIONS_ADDR, getClassName());
+        uint16_t savedCrc = Storage::save(getData(), FLASH_STORE_AM_STATIONS, EEPROM_AM_STATIONS_ADDR, getClassName());
 #ifdef __DEBUG
         if (savedCrc != 0)
             DebugDataInspector::printAmStationData(getData());
@@ -64,7 +134,10 @@ class AmStationStore : public BaseStationStore<AmStationList_t, MAX_AM_STATIONS>
     }
 
     uint16_t performLoad() override {
-        uint16_t loadedCrc = StoreEepromBase<AmStationList_t>::load(getData(), EEPROM_AM_STATIONS_ADDR, getClassName());
+        uint16_t loadedCrc = Storage::load(getData(), FLASH_STORE_AM_STATIONS, EEPROM_AM_STATIONS_ADDR, LEGACY_EEPROM_AM_STATIONS_ADDR, getClassName());
+        if (loadedCrc == 0) {
+            markDirty();
+        }
 #ifdef __DEBUG
         DebugDataInspector::printAmStationData(getData());
 #endif
@@ -72,16 +145,22 @@ class AmStationStore : public BaseStationStore<AmStationList_t, MAX_AM_STATIONS>
         if (data.count > MAX_AM_STATIONS) {
             DEBUG("[%s] Warning: AM station count corrected from %d to %d.\n", getClassName(), data.count, MAX_AM_STATIONS);
             data.count = MAX_AM_STATIONS;
+            markDirty();
         }
         return loadedCrc;
     }
 
   public:
-    AmStationStore() : BaseStationStore<AmStationList_t, MAX_AM_STATIONS>() { data = DEFAULT_AM_STATIONS; }
+    AmStationStore() : BaseStationStore<AmStationList_t, MAX_AM_STATIONS>() {
+        data = DEFAULT_AM_STATIONS;
+        rebuildIndex();
+    }
 
     void loadDefaults() override {
         memcpy(&data, &DEFAULT_AM_STATIONS, sizeof(AmStationList_t));
         data.count = 0;
+        rebuildIndex();
+        markDirty();
         DEBUG("AM Station defaults loaded.\n");
     }
 };
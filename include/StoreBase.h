@@ -4,9 +4,34 @@
 #include <Arduino.h>
 
 #include "StoreEepromBase.h"
+#include "StoreFlashLog.h"
 #include "defines.h"
 #include "utils.h"
 
+/**
+ * @brief A tárolók közös, nem template felülete
+ *
+ * A PersistenceScheduler ezen keresztül figyeli a módosításokat és indítja a mentést.
+ */
+class PersistentStore {
+ public:
+  /// @brief A tároló neve (debug üzenetekhez)
+  virtual const char* getStoreName() const = 0;
+
+  /// @brief A jelöletlen módosítások összegyűjtése, a módosítás számláló aktuális értéke
+  /// (egy összegyűjtés egy módosításnak számít, akárhány mező változott)
+  virtual uint16_t collectChanges() = 0;
+
+  /// @brief Van-e mentetlen módosítás
+  virtual bool needsSave() const = 0;
+
+  /// @brief Menthető-e most (pl. kötegelt módosítás közben nem)
+  virtual bool canSave() const { return true; }
+
+  /// @brief Mentés, ha van mentetlen módosítás
+  virtual void checkSave() = 0;
+};
+
 /**
  * @brief Generikus wrapper alaposztály EEPROM kezeléshez
  *
@@ -14,13 +39,38 @@
  * A leszármazott osztályok egyszerűen implementálhatják az EEPROM
  * funkcionalitást.
  *
+ * A módosításokat a markDirty() jelzi, így a checkSave()/needsSave() O(1).
+ * Mentéskor a StoreFlashLog a darabokat a nem aktív példánnyal veti össze, és
+ * csak az eltérőket írja a flash-re. A nem aktív példány két mentéssel korábbi,
+ * és a tárolt alak (tömörített lista, tag-es konfig) a RAM-beli struktúrától
+ * eltér, ezért a módosított mezőket nem tartjuk nyilván, elég a jelzés.
+ *
  * @tparam T A tárolandó struktúra típusa
  */
 template <typename T>
-class StoreBase {
+class StoreBase : public PersistentStore {
  protected:
   /// @brief Az utoljára mentett adatok CRC16 ellenőrző összege
   uint16_t lastCRC = 0;
+
+  /// @brief Van-e mentetlen módosítás
+  bool dirty = false;
+
+  /// @brief Minden markDirty() hívás növeli (körbefordulhat): ebből látja az ütemező, hogy mikor volt az utolsó módosítás
+  uint16_t changeCount = 0;
+
+  /**
+   * @brief Jelöletlen módosítások összegyűjtése mentés előtt
+   *
+   * Azok a leszármazottak írják felül, amelyek adatait a hívók közvetlenül
+   * (markDirty() nélkül) is módosíthatják.
+   */
+  virtual void collectUntrackedChanges() {}
+
+  /**
+   * @brief A módosítás jelzők törlése (sikeres mentés vagy betöltés után)
+   */
+  void clearDirty() { dirty = false; }
   /**
    * @brief Referencia a tárolt adatokra
    *
@@ -78,9 +128,11 @@ class StoreBase {
    */
   virtual void forceSave() {
     DEBUG("[%s] Kényszerített mentés...\n", getClassName());
+    markDirty();
     uint16_t savedCrc = performSave();
     if (savedCrc != 0) {
       lastCRC = savedCrc;
+      clearDirty();
     }
   }
 
@@ -91,9 +143,18 @@ class StoreBase {
    */
   virtual void load() {
     DEBUG("[%s] Betöltés...\n", getClassName());
+    clearDirty();  // A performLoad() javításai már jelzettek maradnak
     lastCRC = performLoad();
   }
 
+  /**
+   * @brief Az adatok módosításának jelzése (módosító műveletenként egyszer)
+   */
+  void markDirty() {
+    dirty = true;
+    changeCount++;
+  }
+
   /**
    * @brief Alapértelmezett értékek beállítása
    *
@@ -101,25 +162,24 @@ class StoreBase {
    */
   virtual void loadDefaults() = 0;
   /**
-   * @brief Automatikus mentés CRC ellenőrzés alapján
+   * @brief Automatikus mentés a módosítás jelzők alapján
    *
-   * Összehasonlítja a jelenlegi adatok CRC-jét az utoljára mentett értékkel.
-   * Ha különböznek, automatikusan menti az adatokat.
-   */
-  virtual void checkSave() {
-    uint16_t currentCrc = Utils::calcCRC16(
-        reinterpret_cast<const uint8_t*>(&getData()), sizeof(T));
-
-    if (lastCRC != currentCrc) {
-      DEBUG("[%s] CRC eltérés (RAM: %d != EEPROM: %d). Mentés...\n",
-            getClassName(), currentCrc, lastCRC);
-
-      uint16_t savedCrc = performSave();
-      if (savedCrc != 0) {
-        lastCRC = savedCrc;
-      } else {
-        DEBUG("[%s] Mentés SIKERTELEN!\n", getClassName());
-      }
+   * Ha volt jelzett (vagy összegyűjtött jelöletlen) módosítás, ment (a flash-re
+   * csak az eltérő darabok kerülnek). Módosítás nélkül nem számol CRC-t.
+   */
+  void checkSave() override {
+    collectUntrackedChanges();
+    if (!dirty) {
+      return;
+    }
+
+    DEBUG("[%s] Módosított adatok mentése...\n", getClassName());
+    uint16_t savedCrc = performSave();
+    if (savedCrc != 0) {
+      lastCRC = savedCrc;
+      clearDirty();
+    } else {
+      DEBUG("[%s] Mentés SIKERTELEN!\n", getClassName());
     }
   }
   /**
@@ -138,10 +198,21 @@ class StoreBase {
   }
 
   /**
-   * @brief Ellenőrzi, hogy szükséges-e mentés
-   * @return true Ha a jelenlegi CRC eltér az utoljára mentetttől
+   * @brief Ellenőrzi, hogy szükséges-e mentés (O(1))
+   * @return true Ha van jelzett, még nem mentett módosítás
+   */
+  bool needsSave() const override { return dirty; }
+
+  const char* getStoreName() const override { return getClassName(); }
+
+  /**
+   * @brief A jelöletlen módosítások összegyűjtése (mentés nélkül)
+   * @return uint16_t A módosítás számláló
    */
-  bool needsSave() const { return lastCRC != getCurrentCRC(); }
+  uint16_t collectChanges() override {
+    collectUntrackedChanges();
+    return changeCount;
+  }
 };
 
 #endif  // STORE_BASE_H
\ No newline at end of file
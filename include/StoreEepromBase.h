@@ -3,6 +3,7 @@
 
 #include <EEPROM.h>
 
+#include "FlashCommitService.h"
 #include "defines.h"
 #include "utils.h"
 
@@ -56,6 +57,9 @@ template <typename T> class StoreEepromBase {
     /**
      * @brief Adatok mentése az EEPROM-ba
      *
+     * Az EEPROM puffer azonnal frissül, a flash-re írást (törlés + programozás) a FlashCommitService
+     * ütemezi a felület két frissítése közé.
+     *
      * @param data Mentendő struktúra referencia
      * @param address EEPROM kezdőcím (alapértelmezett: 0)
      * @param className Osztálynév a debug üzenetekhez
@@ -68,14 +72,10 @@ template <typename T> class StoreEepromBase {
 
         EEPROM.put(address, data);
         EEPROM.put(address + sizeof(T), crc);
+        flashCommitService.commitEeprom();
 
-        if (EEPROM.commit()) {
-            DEBUG("Sikeres (CRC: %d)\n", crc);
-            return crc;
-        } else {
-            DEBUG("SIKERTELEN!\n");
-            return 0;
-        }
+        DEBUG("Ütemezve (CRC: %d)\n", crc);
+        return crc;
     }
 
     /**
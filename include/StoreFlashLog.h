@@ -0,0 +1,180 @@
+#ifndef __STORE_FLASH_LOG_H
+#define __STORE_FLASH_LOG_H
+
+#include "FlashRecordStore.h"
+#include "StoreEepromBase.h"
+
+// Tároló azonosítók a flash logban (a rekord kulcs felső byte-ja)
+#define FLASH_STORE_CONFIG 1
+#define FLASH_STORE_FM_STATIONS 2
+#define FLASH_STORE_AM_STATIONS 3
+#define FLASH_STORE_ANTCAP 4
+
+#define FLASH_LOG_CHUNK_SIZE 32      // A struktúrát ekkora darabokban (rekordokban) tároljuk
+#define FLASH_LOG_SLOT_SHIFT 7       // A rekord sorszám felső bitje az A/B példány
+#define FLASH_LOG_COMMIT_RECORD 0x7F // A lezáró rekord sorszáma a példányon belül (generáció + méret + teljes CRC)
+
+// Rekord sorszám egy példányon belül
+#define FLASH_LOG_SLOT_KEY(storeId, slot, recordIdx) FLASH_LOG_KEY(storeId, ((slot) << FLASH_LOG_SLOT_SHIFT) | (recordIdx))
+
+/**
+ * @brief Struktúrák tárolása a flash logban, a StoreEepromBase-zel azonos felülettel
+ *
+ * A struktúrát FLASH_LOG_CHUNK_SIZE méretű darabokra bontja, és darabonként egy rekordként írja,
+ * így egy állomás vagy egy beállítás módosításakor csak az érintett darab(ok) kerülnek a flash-re.
+ * Két példányt (A/B) tartunk: a mentés mindig a nem aktív példányba ír, majd a lezáró rekord
+ * (generáció + méret + a teljes struktúra CRC-je) kiírása lépteti elő aktívvá. Ha a mentés közben
+ * megszűnik a táp, az aktív példány érintetlen marad. Betöltéskor a két lezáró rekordból a nagyobb
+ * generációjú érvényes példányt választjuk (ha a CRC nem egyezik, a másikat) - a log újraolvasása nélkül.
+ * Ha a log nem használható, vagy még üres (firmware frissítés után), a régi EEPROM képet használja,
+ * és azt egyszer átmásolja a logba.
+ *
+ * @tparam T A tárolandó struktúra típusa
+ */
+template <typename T> class StoreFlashLog {
+
+    // A lezáró rekord
+    struct CommitRecord {
+        uint32_t generation; // Monoton növekvő, a nagyobb az újabb példány
+        uint16_t size;
+        uint16_t crc;
+    };
+
+    static uint16_t chunkLength(uint16_t i) { return min((size_t)FLASH_LOG_CHUNK_SIZE, sizeof(T) - i * FLASH_LOG_CHUNK_SIZE); }
+
+    /**
+     * Egy példány lezáró rekordja (generation 0: nincs)
+     */
+    static CommitRecord readCommit(uint8_t storeId, uint8_t slot) {
+        CommitRecord commit;
+        if (!flashRecordStore.read(FLASH_LOG_SLOT_KEY(storeId, slot, FLASH_LOG_COMMIT_RECORD), &commit, sizeof(commit)) || commit.size != sizeof(T)) {
+            commit = {0, 0, 0};
+        }
+        return commit;
+    }
+
+    /**
+     * Egy példány betöltése és ellenőrzése
+     */
+    static bool readSlot(T &data, uint8_t storeId, uint8_t slot, const CommitRecord &commit) {
+        if (commit.generation == 0) {
+            return false;
+        }
+        uint8_t *bytes = reinterpret_cast<uint8_t *>(&data);
+        for (uint16_t i = 0; i < chunkCount(); i++) {
+            if (!flashRecordStore.read(FLASH_LOG_SLOT_KEY(storeId, slot, i), bytes + i * FLASH_LOG_CHUNK_SIZE, chunkLength(i))) {
+                return false;
+            }
+        }
+        return Utils::calcCRC16(data) == commit.crc;
+    }
+
+  public:
+    /**
+     * A struktúra darabjainak száma
+     */
+    static constexpr uint16_t chunkCount() { return (sizeof(T) + FLASH_LOG_CHUNK_SIZE - 1) / FLASH_LOG_CHUNK_SIZE; }
+    static_assert(FLASH_LOG_CHUNK_SIZE <= FLASH_LOG_MAX_RECORD_SIZE, "The chunk must fit into one record");
+    static_assert((sizeof(T) + FLASH_LOG_CHUNK_SIZE - 1) / FLASH_LOG_CHUNK_SIZE < FLASH_LOG_COMMIT_RECORD, "Too many chunks for one store");
+
+    /**
+     * @brief Adatok mentése a flash log nem aktív példányába (csak a megváltozott darabok)
+     *
+     * A nem aktív példány két mentéssel korábbi állapotot tárol, ezért a legutóbbi módosítások
+     * bitmaszkja nem elég: minden darabot összevetünk vele, és csak az eltérők kerülnek a flash-re.
+     *
+     * @param data Mentendő struktúra referencia
+     * @param storeId A tároló azonosítója
+     * @param eepromAddress A régi EEPROM cím (ha a log nem használható)
+     * @param className Osztálynév a debug üzenetekhez
+     * @return CRC16 ellenőrző összeg (0 ha sikertelen)
+     */
+    static uint16_t save(const T &data, uint8_t storeId, uint16_t eepromAddress, const char *className = "Ismeretlen") {
+        if (!flashRecordStore.isReady()) {
+            return StoreEepromBase<T>::save(data, eepromAddress, className);
+        }
+
+        // A nagyobb generációjú példány az aktív, a másikat írjuk felül
+        CommitRecord commitA = readCommit(storeId, 0);
+        CommitRecord commitB = readCommit(storeId, 1);
+        uint8_t slot = commitA.generation > commitB.generation ? 1 : 0;
+        uint32_t generation = max(commitA.generation, commitB.generation) + 1;
+
+        // A nem aktív példány darabjai a korábbi mentésekből maradtak: a FlashRecordStore csak az eltérő
+        // (vagy hiányzó) darabokat írja ki, így ez a mentés után a RAM tartalommal egyezik
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&data);
+        uint32_t writtenBefore = flashRecordStore.getStats().recordsWritten;
+        for (uint16_t i = 0; i < chunkCount(); i++) {
+            if (!flashRecordStore.write(FLASH_LOG_SLOT_KEY(storeId, slot, i), bytes + i * FLASH_LOG_CHUNK_SIZE, chunkLength(i))) {
+                DEBUG("[%s] Flash log mentés SIKERTELEN (%d. darab)\n", className, i);
+                return 0;
+            }
+        }
+        CommitRecord commit = {generation, sizeof(T), Utils::calcCRC16(data)};
+
+        // Előléptetés: a lezáró rekorddal válik ez a példány aktívvá
+        if (!flashRecordStore.write(FLASH_LOG_SLOT_KEY(storeId, slot, FLASH_LOG_COMMIT_RECORD), &commit, sizeof(commit))) {
+            return 0;
+        }
+        DEBUG("[%s] Flash log mentés: %c példány, %lu. generáció, %lu rekord (CRC: %d)\n", className, 'A' + slot, generation,
+              flashRecordStore.getStats().recordsWritten - writtenBefore, commit.crc);
+        return commit.crc;
+    }
+
+    /**
+     * @brief A legfrissebb érvényes példány olvasása (átállás és mentés nélkül)
+     *
+     * Előbb a nagyobb generációjú példányt próbálja, ha az sérült (a mentése félbeszakadt), a másikat.
+     * Sikertelen olvasás után a 'data' tartalma meghatározatlan.
+     *
+     * @return CRC16 ellenőrző összeg (0 ha nincs érvényes példány)
+     */
+    static uint16_t read(T &data, uint8_t storeId, const char *className = "Ismeretlen") {
+        if (!flashRecordStore.isReady()) {
+            return 0;
+        }
+        CommitRecord commits[2] = {readCommit(storeId, 0), readCommit(storeId, 1)};
+        uint8_t newest = commits[1].generation > commits[0].generation ? 1 : 0;
+        for (uint8_t n = 0; n < 2; n++) {
+            uint8_t slot = n == 0 ? newest : 1 - newest;
+            if (readSlot(data, storeId, slot, commits[slot])) {
+                DEBUG("[%s] Flash log betöltés sikeres: %c példány, %lu. generáció (CRC: %d)\n", className, 'A' + slot, commits[slot].generation, commits[slot].crc);
+                return commits[slot].crc;
+            }
+            if (commits[slot].generation != 0) {
+                DEBUG("[%s] Flash log %c példány érvénytelen!\n", className, 'A' + slot);
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Adatok betöltése a flash logból
+     *
+     * Ha a logban nincs érvényes példány, a régi EEPROM képet próbálja (és átmásolja a logba),
+     * ha az sem érvényes, az alapértelmezett (a hívó által már beállított) adatokat menti.
+     *
+     * @return CRC16 ellenőrző összeg
+     */
+    static uint16_t load(T &data, uint8_t storeId, uint16_t eepromAddress, const char *className = "Ismeretlen") {
+        if (!flashRecordStore.isReady()) {
+            return StoreEepromBase<T>::load(data, eepromAddress, className);
+        }
+
+        // Sikertelen olvasásnál a 'data' alapértékei maradnak
+        T tempData;
+        uint16_t crc = read(tempData, storeId, className);
+        if (crc != 0) {
+            data = tempData;
+            return crc;
+        }
+
+        // Átállás a régi EEPROM képről
+        bool valid = false;
+        StoreEepromBase<T>::getIfValid(data, valid, eepromAddress, className);
+        DEBUG("[%s] %s mentése a flash logba\n", className, valid ? "EEPROM kép" : "Alapértékek");
+        return save(data, storeId, eepromAddress, className);
+    }
+};
+
+#endif // __STORE_FLASH_LOG_H
@@ -0,0 +1,72 @@
+#ifndef __TUNING_ENGINE_H
+#define __TUNING_ENGINE_H
+
+#include "Band.h"
+#include "Si4735Ext.h"
+
+// Hangolás időzítések
+#define TUNING_TICK_INTERVAL 10 // Legfeljebb ilyen sűrűn küldünk a chipnek (ms)
+#define TUNING_SETTLE_TIME 60   // Ennyi nyugalom után indul újra a jelminőség mintavétel (ms)
+#define TUNING_BFO_LIMIT 500    // A BFO eltolás tartománya (+/- Hz), ezen túl a vivőt léptetjük
+#define TUNING_BFO_MANU_LIMIT 999
+
+/**
+ * @brief Összevonó hangolás motor
+ *
+ * A rotary (gyorsított, előjeles) lépéseit összegyűjti, és csak a legutolsó célfrekvenciát küldi ki,
+ * hangolási ütemenként legfeljebb egyszer. SSB/CW módban a célt Hz-ben tartjuk, és kHz-es vivő lépésre
+ * és +/- TUNING_BFO_LIMIT Hz-es BFO eltolásra bontjuk. Így egy gyors tekerés azonnal a célra ugrik,
+ * és nem áll sorba több tucat I2C írás.
+ */
+class TuningEngine {
+
+  private:
+    Si4735Ext &si4735;
+    Band &band;
+
+    int32_t targetHz = 0;        // SSB/CW: a cél frekvencia Hz-ben
+    uint16_t targetFreq = 0;     // FM/AM: a cél frekvencia (a band egységében)
+    int16_t targetBfoManu = 0;   // SSB/CW: a cél manuális BFO (rtv::bfoOn esetén)
+    bool pending = false;        // Van még ki nem küldött cél?
+    bool targetValid = false;    // A cél a chipen lévő állapotból indult?
+    uint16_t appliedFreq = 0;    // Az utoljára általunk kiküldött vivő frekvencia
+    uint8_t appliedBandIdx = 0;  // Melyik sávban hangoltunk utoljára
+
+    uint32_t lastTick = 0;
+    uint32_t lastCarrierChange = 0;
+    bool tunerBusy = false;
+
+    // Statisztika
+    uint32_t stepsReceived = 0;
+    uint32_t chipUpdates = 0;
+
+    void syncFromBand();
+    uint16_t wrapFrequency(int32_t freq);
+
+  public:
+    TuningEngine(Si4735Ext &si4735, Band &band);
+
+    /**
+     * Rotary lépések hozzáadása (a RotaryEvent::value)
+     */
+    void addSteps(int16_t steps);
+
+    /**
+     * Arduino loop - ütemenként legfeljebb egy chip frissítés
+     */
+    void loop();
+
+    /**
+     * Külső hangolás (memória, seek, band váltás) után a célt újra a band rekordból vesszük
+     */
+    inline void invalidate() {
+        targetValid = false;
+        pending = false;
+    }
+
+    inline bool isPending() const { return pending; }
+    inline uint32_t getStepsReceived() const { return stepsReceived; }
+    inline uint32_t getChipUpdates() const { return chipUpdates; }
+};
+
+#endif // __TUNING_ENGINE_H
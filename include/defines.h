@@ -19,6 +19,7 @@
 #ifdef __DEBUG
 // #define SHOW_MEMORY_INFO
 #define MEMORY_INFO_INTERVAL 20 * 1000 // 20mp
+// #define SHOW_CRC_BENCHMARK // CRC16 változatok mérése induláskor
 
 // Soros portra várakozás a debug üzenetek előtt
 // #define DEBUG_WAIT_FOR_SERIAL
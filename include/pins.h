@@ -7,6 +7,7 @@
 #define PIN_SI4735_I2C_SDA 8
 #define PIN_SI4735_I2C_SCL 9
 #define PIN_SI4735_RESET 10
+// #define PIN_SI4735_INT 11 // Si4735 GPO2/INT megszakítás kimenet: csak ha be van kötve, különben polling
 
 // Feszültségmérés
 #define PIN_VBUS_INPUT A0 // A0/GPIO26 a VBUS bemenethez
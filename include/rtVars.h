@@ -45,9 +45,15 @@ extern bool SCANpause;
 // Seek
 extern bool SEEK;
 
+// NCDXF beacon figyelés (a tuner a monitoré)
+extern bool BEACON;
+
 // CW shift
 extern bool CWShift;
 
+// Az utolsó felhasználói (touch/rotary) esemény ideje (millis), a háttér feladatok ebből látják, hogy tétlen-e a rádió
+extern uint32_t lastUserActivity;
+
 }  // namespace rtv
 
 #endif  //__RTVARS_H
@@ -0,0 +1,99 @@
+#ifndef __ACTIVITY_HEAT_MAP_H
+#define __ACTIVITY_HEAT_MAP_H
+
+#include "BandActivityRecorder.h"
+#include "UIComponent.h"
+
+/**
+ * @brief Sáv aktivitás heat-map (vízszintesen a csatornák, függőlegesen a napon belüli időrések)
+ *
+ * Soronként, a tömörített reprezentációból rajzol (RowCursor), így nincs szükség a teljes mátrix
+ * kitömörítésére. Soronként megjegyzi a kirajzolt revision-t, így új mérés után csak a változott
+ * sorokat rajzolja újra, sávváltáskor (új csatorna kiosztás) az egészet.
+ */
+class ActivityHeatMap : public UIComponent {
+
+  private:
+    const BandActivityRecorder &recorder;
+    uint16_t drawnRevision = 0;                            // A legutóbb kirajzolt adatok változás számlálója
+    uint16_t drawnLayoutRevision = 0;                      // A legutóbb kirajzolt csatorna kiosztás
+    uint16_t drawnRowRevision[ACTIVITY_BINS_PER_DAY] = {}; // Soronként a legutóbb kirajzolt változat
+
+    /**
+     * Szint -> szín (sötétkék -> zöld -> sárga -> piros)
+     */
+    uint16_t levelToColor(uint8_t level) {
+        uint8_t v = min((uint16_t)level * 4, (uint16_t)255); // 0..63 -> 0..255
+        if (v < 85) {
+            return tft.color565(0, v * 3, 80 - v);
+        } else if (v < 170) {
+            return tft.color565((v - 85) * 3, 255, 0);
+        }
+        return tft.color565(255, 255 - (v - 170) * 3, 0);
+    }
+
+  public:
+    ActivityHeatMap(TFT_eSPI &tft, const Rect &bounds, const BandActivityRecorder &recorder, const ColorScheme &colors = ColorScheme::defaultScheme())
+        : UIComponent(tft, bounds, colors), recorder(recorder) {}
+
+    /**
+     * Egy időrés sorának kirajzolása
+     */
+    void drawRow(uint8_t bin) {
+        uint8_t channelCount = recorder.getChannelCount();
+        if (channelCount == 0) {
+            return;
+        }
+
+        int16_t y = bounds.y + (int32_t)bounds.height * bin / ACTIVITY_BINS_PER_DAY;
+        int16_t h = bounds.y + (int32_t)bounds.height * (bin + 1) / ACTIVITY_BINS_PER_DAY - y;
+
+        BandActivityRecorder::RowCursor cursor;
+        if (!recorder.getRow(bin, cursor)) {
+            tft.fillRect(bounds.x, y, bounds.width, h, colors.background);
+            return;
+        }
+
+        uint8_t level;
+        for (uint8_t ch = 0; ch < channelCount && cursor.next(level); ch++) {
+            int16_t x = bounds.x + (int32_t)bounds.width * ch / channelCount;
+            int16_t w = bounds.x + (int32_t)bounds.width * (ch + 1) / channelCount - x;
+            tft.fillRect(x, y, w, h, levelToColor(level));
+        }
+    }
+
+    virtual void draw() override {
+        if (!isVisible) {
+            return;
+        }
+        if (recorder.getLayoutRevision() != drawnLayoutRevision) {
+            drawnLayoutRevision = recorder.getLayoutRevision();
+            markForRedraw(); // Másik sáv: minden sor érvénytelen
+        }
+
+        if (needsRedraw) {
+            for (uint8_t bin = 0; bin < ACTIVITY_BINS_PER_DAY; bin++) {
+                drawRow(bin);
+                drawnRowRevision[bin] = recorder.getRowRevision(bin);
+            }
+            tft.drawRect(bounds.x - 1, bounds.y - 1, bounds.width + 2, bounds.height + 2, colors.border);
+            drawnRevision = recorder.getRevision();
+            needsRedraw = false;
+            return;
+        }
+
+        // Csak a változott időrés sorok (jellemzően az éppen lezárt egy)
+        if (recorder.getRevision() == drawnRevision) {
+            return;
+        }
+        drawnRevision = recorder.getRevision();
+        for (uint8_t bin = 0; bin < ACTIVITY_BINS_PER_DAY; bin++) {
+            if (recorder.getRowRevision(bin) != drawnRowRevision[bin]) {
+                drawRow(bin);
+                drawnRowRevision[bin] = recorder.getRowRevision(bin);
+            }
+        }
+    }
+};
+
+#endif // __ACTIVITY_HEAT_MAP_H
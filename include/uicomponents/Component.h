@@ -20,9 +20,10 @@ struct RotaryEvent {
 
     Direction direction;
     ButtonState buttonState;
+    int16_t value; // Előjeles (gyorsított) lépésszám
     uint32_t timestamp;
 
-    RotaryEvent(Direction dir, ButtonState btnState) : direction(dir), buttonState(btnState), timestamp(millis()) {}
+    RotaryEvent(Direction dir, ButtonState btnState, int16_t value = 0) : direction(dir), buttonState(btnState), value(value), timestamp(millis()) {}
 };
 
 // Téglalap struktúra
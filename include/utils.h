@@ -132,9 +132,10 @@ void trimSpaces(char *str);
  *
  * @param data Adat pointer
  * @param length Adat hossza bájtokban
+ * @param crc Kezdőérték (több darabban számolt CRC-nél az előző darab eredménye)
  * @return Számított CRC16 érték
  */
-uint16_t calcCRC16(const uint8_t *data, size_t length);
+uint16_t calcCRC16(const uint8_t *data, size_t length, uint16_t crc = 0xFFFF);
 /**
  * @brief CRC16 számítás típusos wrapper
  *
@@ -0,0 +1,52 @@
+#include "AntCapStore.h"
+
+// Globális példány definíciója
+AntCapStore antCapStore;
+
+/**
+ * Kapacitás kikeresése
+ */
+uint16_t AntCapStore::lookup(uint8_t bandIdx, uint16_t minFreq, uint16_t maxFreq, uint16_t freq, uint16_t defaultCap) const {
+    if (bandIdx >= ANTCAP_MAX_BANDS || maxFreq <= minFreq) {
+        return defaultCap;
+    }
+
+    // A pontok távolsága (ANTCAP_POINTS_PER_BAND - 1) szakasz a sávban
+    uint32_t span = maxFreq - minFreq;
+    uint32_t pos = (uint32_t)constrain(freq, minFreq, maxFreq) - minFreq;
+    uint32_t scaled = pos * (ANTCAP_POINTS_PER_BAND - 1); // A szakasz index és a szakaszon belüli pozíció egyben
+    uint8_t segment = min(scaled / span, (uint32_t)(ANTCAP_POINTS_PER_BAND - 2));
+    uint32_t offset = scaled - segment * span; // 0 ... span
+
+    uint16_t left = data.caps[bandIdx][segment];
+    uint16_t right = data.caps[bandIdx][segment + 1];
+
+    if (left == ANTCAP_NOT_TUNED && right == ANTCAP_NOT_TUNED) {
+        return defaultCap;
+    }
+    if (left == ANTCAP_NOT_TUNED) {
+        return right;
+    }
+    if (right == ANTCAP_NOT_TUNED) {
+        return left;
+    }
+
+    return left + (int32_t)(right - left) * (int32_t)offset / (int32_t)span;
+}
+
+/**
+ * Mért érték rögzítése
+ */
+void AntCapStore::record(uint8_t bandIdx, uint16_t minFreq, uint16_t maxFreq, uint16_t freq, uint16_t cap) {
+    if (bandIdx >= ANTCAP_MAX_BANDS || maxFreq <= minFreq) {
+        return;
+    }
+
+    uint32_t span = maxFreq - minFreq;
+    uint32_t pos = (uint32_t)constrain(freq, minFreq, maxFreq) - minFreq;
+    uint8_t point = (pos * (ANTCAP_POINTS_PER_BAND - 1) + span / 2) / span; // Kerekítés a legközelebbi pontra
+
+    data.caps[bandIdx][point] = cap == ANTCAP_NOT_TUNED ? 1 : cap;
+    markDirty();
+    DEBUG("AntCapStore::record() -> band %d, point %d: %d\n", bandIdx, point, data.caps[bandIdx][point]);
+}
@@ -0,0 +1,118 @@
+#include "AntCapTuner.h"
+
+#include "SignalQualitySampler.h"
+#include "defines.h"
+
+/**
+ * Konstruktor
+ */
+AntCapTuner::AntCapTuner(Si4735Ext &si4735, Band &band) : si4735(si4735), band(band) {}
+
+/**
+ * Egy kapacitás érték megmérése
+ * @return a pontszám (RSSI és SNR súlyozott összege), 0, ha a hangolás nem fejeződött be időben
+ */
+uint16_t AntCapTuner::measure(uint16_t freq, uint16_t antCap) {
+    measureCount++;
+
+    si4735.setTuneFrequencyAntennaCapacitor(antCap);
+    si4735.setFrequencyNoWait(freq);
+    if (!si4735.waitTuneComplete(ANTCAP_TUNE_TIMEOUT)) {
+        return 0;
+    }
+    delay(ANTCAP_SETTLE_TIME);
+
+    si4735.getCurrentReceivedSignalQuality(0);
+    return (uint16_t)si4735.getCurrentRSSI() * 2 + si4735.getCurrentSNR();
+}
+
+/**
+ * A kapacitás tartomány végigsöprése egy frekvencián
+ * @return a legjobb kapacitás érték (1..max)
+ */
+uint16_t AntCapTuner::sweep(uint16_t freq) {
+    uint16_t maxCap = band.getCurrentBandType() == FM_BAND_TYPE ? ANTCAP_MAX_FM : ANTCAP_MAX_AM;
+
+    // Kiindulópont: amit a chip automatikusan választ
+    measure(freq, 0);
+    uint16_t bestCap = constrain(si4735.getAntennaTuningCapacitor(), 1, maxCap);
+    uint16_t bestScore = measure(freq, bestCap);
+
+    // Durva keresés egyenletes lépésekkel
+    uint16_t step = max(maxCap / ANTCAP_COARSE_STEPS, 1);
+    for (uint16_t cap = step; cap <= maxCap; cap += step) {
+        uint16_t score = measure(freq, cap);
+        if (score > bestScore) {
+            bestScore = score;
+            bestCap = cap;
+        }
+    }
+
+    // Finomítás a legjobb pont körül, felező lépésközzel
+    for (step /= 2; step > 0; step /= 2) {
+        uint16_t center = bestCap;
+        for (int8_t dir = -1; dir <= 1; dir += 2) {
+            int32_t cap = (int32_t)center + dir * step;
+            if (cap < 1 || cap > maxCap) {
+                continue;
+            }
+            uint16_t score = measure(freq, cap);
+            if (score > bestScore) {
+                bestScore = score;
+                bestCap = cap;
+            }
+        }
+    }
+
+    DEBUG("AntCapTuner::sweep() -> freq: %u, best antCap: %u (score: %u, %u measures)\n", freq, bestCap, bestScore, measureCount);
+    return bestCap;
+}
+
+/**
+ * Az aktuális frekvencia behangolása
+ */
+uint16_t AntCapTuner::tuneCurrentFrequency() {
+    BandTable &currentBand = band.getCurrentBand();
+    uint16_t freq = currentBand.currFreq;
+
+    measureCount = 0;
+    si4735.setHardwareAudioMute(true);
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_ANTCAP, true);
+
+    uint16_t bestCap = sweep(freq);
+    antCapStore.record(config.data.bandIdx, currentBand.minimumFreq, currentBand.maximumFreq, freq, bestCap);
+
+    // A táblából interpolált érték a végleges, hogy a későbbi hangolások ugyanezt kapják
+    band.applyAntCap(freq);
+    si4735.setFrequency(freq);
+
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_ANTCAP, false);
+    si4735.setHardwareAudioMute(false);
+    return bestCap;
+}
+
+/**
+ * Az aktuális sáv összes táblapontjának behangolása
+ */
+void AntCapTuner::tuneCurrentBand() {
+    BandTable &currentBand = band.getCurrentBand();
+    uint16_t homeFreq = currentBand.currFreq;
+    uint16_t span = currentBand.maximumFreq - currentBand.minimumFreq;
+
+    measureCount = 0;
+    si4735.setHardwareAudioMute(true);
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_ANTCAP, true);
+
+    antCapStore.clearBand(config.data.bandIdx);
+    for (uint8_t point = 0; point < ANTCAP_POINTS_PER_BAND; point++) {
+        uint16_t freq = currentBand.minimumFreq + (uint32_t)span * point / (ANTCAP_POINTS_PER_BAND - 1);
+        antCapStore.record(config.data.bandIdx, currentBand.minimumFreq, currentBand.maximumFreq, freq, sweep(freq));
+    }
+
+    // Vissza az eredeti frekvenciára, már a táblából interpolált kapacitással
+    band.applyAntCap(homeFreq);
+    si4735.setFrequency(homeFreq);
+
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_ANTCAP, false);
+    si4735.setHardwareAudioMute(false);
+}
@@ -2,44 +2,66 @@
 
 #include <patch_full.h> // SSB patch for whole SSBRX full download
 
+#include "BandIndex.h"
+#include "pins.h"
 #include "rtVars.h"
 
-// Egyszerűsített BandTable tömb
-BandTable bandTable[] = {
-    {"FM", FM_BAND_TYPE, FM, 6400, 10800, 9390, 10, false, 0, 0, 0, 0, 0, 0},   //  FM          0   // 93.9MHz
-    {"LW", LW_BAND_TYPE, AM, 100, 514, 198, 9, false, 0, 0, 0, 0, 0, 0},        //  LW          1
-    {"MW", MW_BAND_TYPE, AM, 514, 1800, 540, 9, false, 0, 0, 0, 0, 0, 0},       //  MW          2   // 540kHz Kossuth
-    {"800m", SW_BAND_TYPE, AM, 280, 470, 284, 1, true, 0, 0, 0, 0, 0, 0},       // Ham  800M    3
-    {"630m", SW_BAND_TYPE, LSB, 470, 480, 475, 1, true, 0, 0, 0, 0, 0, 0},      // Ham  630M    4
-    {"160m", SW_BAND_TYPE, LSB, 1800, 2000, 1850, 1, true, 0, 0, 0, 0, 0, 0},   // Ham  160M    5
-    {"120m", SW_BAND_TYPE, AM, 2000, 3200, 2400, 5, false, 0, 0, 0, 0, 0, 0},   //      120M    6
-    {"90m", SW_BAND_TYPE, AM, 3200, 3500, 3300, 5, false, 0, 0, 0, 0, 0, 0},    //       90M    7
-    {"80m", SW_BAND_TYPE, LSB, 3500, 3900, 3630, 1, true, 0, 0, 0, 0, 0, 0},    // Ham   80M    8
-    {"75m", SW_BAND_TYPE, AM, 3900, 5300, 3950, 5, false, 0, 0, 0, 0, 0, 0},    //       75M    9
-    {"60m", SW_BAND_TYPE, USB, 5300, 5900, 5375, 1, true, 0, 0, 0, 0, 0, 0},    // Ham   60M   10
-    {"49m", SW_BAND_TYPE, AM, 5900, 7000, 6000, 5, false, 0, 0, 0, 0, 0, 0},    //       49M   11
-    {"40m", SW_BAND_TYPE, LSB, 7000, 7500, 7074, 1, true, 0, 0, 0, 0, 0, 0},    // Ham   40M   12
-    {"41m", SW_BAND_TYPE, AM, 7200, 9000, 7210, 5, false, 0, 0, 0, 0, 0, 0},    //       41M   13
-    {"31m", SW_BAND_TYPE, AM, 9000, 10000, 9600, 5, false, 0, 0, 0, 0, 0, 0},   //       31M   14
-    {"30m", SW_BAND_TYPE, USB, 10000, 10100, 10100, 1, true, 0, 0, 0, 0, 0, 0}, // Ham   30M   15
-    {"25m", SW_BAND_TYPE, AM, 10200, 13500, 11700, 5, false, 0, 0, 0, 0, 0, 0}, //       25M   16
-    {"22m", SW_BAND_TYPE, AM, 13500, 14000, 13700, 5, false, 0, 0, 0, 0, 0, 0}, //       22M   17
-    {"20m", SW_BAND_TYPE, USB, 14000, 14500, 14074, 1, true, 0, 0, 0, 0, 0, 0}, // Ham   20M   18
-    {"19m", SW_BAND_TYPE, AM, 14500, 17500, 15700, 5, false, 0, 0, 0, 0, 0, 0}, //       19M   19
-    {"17m", SW_BAND_TYPE, AM, 17500, 18000, 17600, 5, false, 0, 0, 0, 0, 0, 0}, //       17M   20
-    {"16m", SW_BAND_TYPE, USB, 18000, 18500, 18100, 1, true, 0, 0, 0, 0, 0, 0}, // Ham   16M   21
-    {"15m", SW_BAND_TYPE, AM, 18500, 21000, 18950, 5, false, 0, 0, 0, 0, 0, 0}, //       15M   22
-    {"14m", SW_BAND_TYPE, USB, 21000, 21500, 21074, 1, true, 0, 0, 0, 0, 0, 0}, // Ham   14M   23
-    {"13m", SW_BAND_TYPE, AM, 21500, 24000, 21500, 5, false, 0, 0, 0, 0, 0, 0}, //       13M   24
-    {"12m", SW_BAND_TYPE, USB, 24000, 25500, 24940, 1, true, 0, 0, 0, 0, 0, 0}, // Ham   12M   25
-    {"11m", SW_BAND_TYPE, AM, 25500, 26100, 25800, 5, false, 0, 0, 0, 0, 0, 0}, //       11M   26
-    {"CB", SW_BAND_TYPE, AM, 26100, 28000, 27200, 1, false, 0, 0, 0, 0, 0, 0},  // CB band     27
-    {"10m", SW_BAND_TYPE, USB, 28000, 30000, 28500, 1, true, 0, 0, 0, 0, 0, 0}, // Ham   10M   28
-    {"SW", SW_BAND_TYPE, AM, 100, 30000, 15500, 5, false, 0, 0, 0, 0, 0, 0}     // Whole SW    29
-};
+// A sávtábla egyetlen forrása: X(név, típus, preferált moduláció, min, max, alapértelmezett frekvencia, lépésköz, HAM)
+#define BAND_TABLE(X)                                                                              \
+    X("FM", FM_BAND_TYPE, FM, 6400, 10800, 9390, 10, false)   /* FM          0   93.9MHz */        \
+    X("LW", LW_BAND_TYPE, AM, 100, 514, 198, 9, false)        /* LW          1 */                  \
+    X("MW", MW_BAND_TYPE, AM, 514, 1800, 540, 9, false)       /* MW          2   540kHz Kossuth */ \
+    X("800m", SW_BAND_TYPE, AM, 280, 470, 284, 1, true)       /* Ham  800M    3 */                 \
+    X("630m", SW_BAND_TYPE, LSB, 470, 480, 475, 1, true)      /* Ham  630M    4 */                 \
+    X("160m", SW_BAND_TYPE, LSB, 1800, 2000, 1850, 1, true)   /* Ham  160M    5 */                 \
+    X("120m", SW_BAND_TYPE, AM, 2000, 3200, 2400, 5, false)   /* 120M    6 */                      \
+    X("90m", SW_BAND_TYPE, AM, 3200, 3500, 3300, 5, false)    /* 90M    7 */                       \
+    X("80m", SW_BAND_TYPE, LSB, 3500, 3900, 3630, 1, true)    /* Ham   80M    8 */                 \
+    X("75m", SW_BAND_TYPE, AM, 3900, 5300, 3950, 5, false)    /* 75M    9 */                       \
+    X("60m", SW_BAND_TYPE, USB, 5300, 5900, 5375, 1, true)    /* Ham   60M   10 */                 \
+    X("49m", SW_BAND_TYPE, AM, 5900, 7000, 6000, 5, false)    /* 49M   11 */                       \
+    X("40m", SW_BAND_TYPE, LSB, 7000, 7500, 7074, 1, true)    /* Ham   40M   12 */                 \
+    X("41m", SW_BAND_TYPE, AM, 7200, 9000, 7210, 5, false)    /* 41M   13 */                       \
+    X("31m", SW_BAND_TYPE, AM, 9000, 10000, 9600, 5, false)   /* 31M   14 */                       \
+    X("30m", SW_BAND_TYPE, USB, 10000, 10100, 10100, 1, true) /* Ham   30M   15 */                 \
+    X("25m", SW_BAND_TYPE, AM, 10200, 13500, 11700, 5, false) /* 25M   16 */                       \
+    X("22m", SW_BAND_TYPE, AM, 13500, 14000, 13700, 5, false) /* 22M   17 */                       \
+    X("20m", SW_BAND_TYPE, USB, 14000, 14500, 14074, 1, true) /* Ham   20M   18 */                 \
+    X("19m", SW_BAND_TYPE, AM, 14500, 17500, 15700, 5, false) /* 19M   19 */                       \
+    X("17m", SW_BAND_TYPE, AM, 17500, 18000, 17600, 5, false) /* 17M   20 */                       \
+    X("16m", SW_BAND_TYPE, USB, 18000, 18500, 18100, 1, true) /* Ham   16M   21 */                 \
+    X("15m", SW_BAND_TYPE, AM, 18500, 21000, 18950, 5, false) /* 15M   22 */                       \
+    X("14m", SW_BAND_TYPE, USB, 21000, 21500, 21074, 1, true) /* Ham   14M   23 */                 \
+    X("13m", SW_BAND_TYPE, AM, 21500, 24000, 21500, 5, false) /* 13M   24 */                       \
+    X("12m", SW_BAND_TYPE, USB, 24000, 25500, 24940, 1, true) /* Ham   12M   25 */                 \
+    X("11m", SW_BAND_TYPE, AM, 25500, 26100, 25800, 5, false) /* 11M   26 */                       \
+    X("CB", SW_BAND_TYPE, AM, 26100, 28000, 27200, 1, false)  /* CB band     27 */                 \
+    X("10m", SW_BAND_TYPE, USB, 28000, 30000, 28500, 1, true) /* Ham   10M   28 */                 \
+    X("SW", SW_BAND_TYPE, AM, 100, 30000, 15500, 5, false)    /* Whole SW    29 */
+
+// Egyszerűsített BandTable tömb (a változó adatok nullázva)
+#define BAND_TABLE_ROW(name, type, mod, minFreq, maxFreq, defFreq, step, ham) {name, type, mod, minFreq, maxFreq, defFreq, step, ham, 0, 0, 0, 0, 0, 0},
+BandTable bandTable[] = {BAND_TABLE(BAND_TABLE_ROW)};
+
+// A konstans rész a fordítási idejű keresőtáblákhoz
+#define BAND_RANGE_ROW(name, type, mod, minFreq, maxFreq, defFreq, step, ham) {name, type == FM_BAND_TYPE, minFreq, maxFreq, defFreq, ham},
+static constexpr BandIndex::BandRange bandRanges[] = {BAND_TABLE(BAND_RANGE_ROW)};
+static constexpr BandIndex::Index<ARRAY_ITEM_COUNT(bandRanges)> bandLookup = BandIndex::build(bandRanges);
+
+static_assert(BandIndex::rangesValid(bandRanges), "bandTable: minimumFreq < maximumFreq and minimumFreq <= defFreq <= maximumFreq required");
+static_assert(BandIndex::hamBandsDisjoint(bandRanges), "bandTable: HAM bands must not overlap");
+static_assert(!bandLookup.ambiguous, "bandTable: overlapping bands of equal width, frequency lookup is ambiguous");
+static_assert(!bandLookup.shadowed, "bandTable: a band is fully covered by narrower bands, it can never be found by frequency");
+static_assert(!bandLookup.nameCollision, "bandTable: no collision free name hash seed found (duplicate band name?)");
 
 /// Itt határozzuk meg a BAND_COUNT értékét!
 const size_t BANDTABLE_COUNT = ARRAY_ITEM_COUNT(bandTable);
+static_assert(BANDTABLE_COUNT <= ANTCAP_MAX_BANDS, "AntCapTable_t has fewer rows than bandTable. Increase ANTCAP_MAX_BANDS.");
+
+// Sávonkénti chip konfigurációk és a chipen épp beállított konfiguráció
+BandChipState Band::chipStates[BANDTABLE_COUNT];
+BandChipState Band::appliedState;
+int8_t Band::appliedBandIdx = -1;
 
 // BandMode description
 const char *Band::bandModeDesc[5] = {"FM", "LSB", "USB", "AM", "CW"};
@@ -74,7 +96,7 @@ const FrequencyStep Band::stepSizeBFO[] = {
 /**
  * Konstruktor
  */
-Band::Band(SI4735 &si4735, Config &configRef) : si4735(si4735), configRef(configRef) {
+Band::Band(Si4735Ext &si4735, Config &configRef) : si4735(si4735), configRef(configRef) {
 
     // A BandTable inicializálása - változó adatok beállítása, ha még nincsenek inicializálva
     for (uint8_t i = 0; i < BANDTABLE_COUNT; i++) {
@@ -95,6 +117,15 @@ Band::Band(SI4735 &si4735, Config &configRef) : si4735(si4735), configRef(config
             bandTable[i].lastBFO = 0;
             bandTable[i].lastmanuBFO = 0;
         }
+
+        // A chip konfiguráció állandó részei
+        chipStates[i].minimumFreq = bandTable[i].minimumFreq;
+        chipStates[i].maximumFreq = bandTable[i].maximumFreq;
+        chipStates[i].modulation = bandTable[i].currMod;
+        chipStates[i].modeFamily = getModeFamily(bandTable[i].currMod);
+        chipStates[i].step = bandTable[i].currStep;
+        chipStates[i].antCap = bandTable[i].antCap;
+        chipStates[i].bandwidthIndex = 0;
     }
 }
 
@@ -115,38 +146,40 @@ BandTable &Band::getBandByIdx(uint8_t bandIdx) {
 
 /**
  * A Band indexének elkérése a bandName alapján
+ * O(1): a fordítási időben generált ütközésmentes hash táblából, egyetlen strcmp-vel
  *
  * @param bandName A keresett sáv neve
  * @return A BandTable rekord indexe, vagy -1, ha nem található
  */
 int8_t Band::getBandIdxByBandName(const char *bandName) {
 
-    for (size_t i = 0; i < BANDTABLE_COUNT; i++) {
-        if (strcmp(bandName, bandTable[i].bandName) == 0) {
-            return i; // Megtaláltuk az indexet
-        }
+    int8_t idx = bandLookup.findNameSlot(bandName);
+    if (idx != BAND_INDEX_NOT_FOUND && strcmp(bandName, bandTable[idx].bandName) == 0) {
+        return idx;
     }
-    return -1; // Ha nem található
+    return BAND_INDEX_NOT_FOUND; // Ha nem található
 }
 
 /**
- * Sávok neveinek visszaadása tömbként
+ * A Band indexének elkérése frekvencia alapján
+ * O(log n): átfedő sávok esetén a keskenyebb (pl. a HAM sáv a műsorszóró sávon belül) nyer
+ */
+int8_t Band::getBandIdxByFrequency(uint16_t freq, bool isFm) { return bandLookup.findByFrequency(freq, isFm); }
+
+/**
+ * Sávok neveinek visszaadása tömbként (fordítási időben előállított listák)
  *
  * @param count talált elemek száma
  * @param isHamFilter HAM szűrő
  */
-const char **Band::getBandNames(uint8_t &count, bool isHamFilter) {
-
-    static const char *filteredNames[BANDTABLE_COUNT]; // Tároló a kiválasztott nevekre
-    count = 0;                                         // Kezdőérték
+const char *const *Band::getBandNames(uint8_t &count, bool isHamFilter) {
 
-    for (size_t i = 0; i < BANDTABLE_COUNT; i++) {
-        if (bandTable[i].isHam == isHamFilter) {            // HAM sáv szűrés
-            filteredNames[count++] = bandTable[i].bandName; // Közvetlen pointer hozzáadás
-        }
+    if (isHamFilter) {
+        count = bandLookup.hamCount;
+        return bandLookup.hamNames;
     }
-
-    return filteredNames; // A pointert visszaadjuk
+    count = bandLookup.broadcastCount;
+    return bandLookup.broadcastNames;
 }
 
 /**
@@ -185,101 +218,119 @@ void Band::loadSSB() {
 }
 
 /**
- * Band beállítása
+ * Az aktuális lépésköz beállítása a band rekordban a konfig indexek alapján
  */
-void Band::useBand() {
+void Band::updateCurrentStep() {
 
-    // Kikeressük az aktuális Band rekordot
     BandTable &currentBand = getCurrentBand();
-    uint8_t currentBandType = getCurrentBandType();
-
-    DEBUG("Band::useBand() -> bandName: %s currStep: %d, currentMode: %s\n", getCurrentBandName(), currentBand.currStep, getCurrentBandModeDesc());
-
-    //---- CurrentStep beállítása a band rekordban
+    uint8_t currentBandType = currentBand.bandType;
 
     // Index ellenőrzés (biztonsági okokból)
     uint8_t stepIndex;
 
     // AM esetén 1...1000Khz között bármi lehet - {"1kHz", "5kHz", "9kHz", "10kHz"};
     if (currentBandType == MW_BAND_TYPE or currentBandType == LW_BAND_TYPE) {
-        // currentBand.currentStep = static_cast<uint8_t>(atoi(Band::stepSizeAM[config.data.ssIdxMW]));
         stepIndex = config.data.ssIdxMW;
         // Határellenőrzés
         if (stepIndex >= ARRAY_ITEM_COUNT(stepSizeAM)) {
             DEBUG("Hiba: Érvénytelen ssIdxMW index: %d. Alapértelmezett használata.\n", stepIndex);
             stepIndex = 0;                   // Visszaállás alapértelmezettre (pl. 1kHz)
-            config.data.ssIdxMW = stepIndex; // Opcionális: Konfig frissítése        }
-            currentBand.currStep = stepSizeAM[stepIndex].value;
-        } else if (currentBandType == SW_BAND_TYPE) {
-            // currentBand.currentStep = static_cast<uint8_t>(atoi(Band::stepSizeAM[config.data.ssIdxAM]));
-            // AM/SSB/CW Shortwave esetén
-            stepIndex = config.data.ssIdxAM;
-            // Határellenőrzés
-            if (stepIndex >= ARRAY_ITEM_COUNT(stepSizeAM)) {
-                DEBUG("Hiba: Érvénytelen ssIdxAM index: %d. Alapértelmezett használata.\n", stepIndex);
-                stepIndex = 0;                   // Visszaállás alapértelmezettre
-                config.data.ssIdxAM = stepIndex; // Opcionális: Konfig frissítése
-            }
-            currentBand.currStep = stepSizeAM[stepIndex].value;
-        } else {
-            // FM esetén csak 3 érték lehet - {"50Khz", "100KHz", "1MHz"};
-            // static_cast<uint8_t>(atoi(Band::stepSizeFM[config.data.ssIdxFM]));
-            stepIndex = config.data.ssIdxFM;
-            // Határellenőrzés
-            if (stepIndex >= ARRAY_ITEM_COUNT(stepSizeFM)) {
-                DEBUG("Hiba: Érvénytelen ssIdxFM index: %d. Alapértelmezett használata.\n", stepIndex);
-                stepIndex = 0;                   // Visszaállás alapértelmezettre
-                config.data.ssIdxFM = stepIndex; // Opcionális: Konfig frissítése
-            }
-            currentBand.currStep = stepSizeFM[stepIndex].value;
+            config.data.ssIdxMW = stepIndex; // Opcionális: Konfig frissítése
+            config.markDirty();
         }
+        currentBand.currStep = stepSizeAM[stepIndex].value;
 
-        if (currentBandType == FM_BAND_TYPE) {
-            ssbLoaded = false;
-            rtv::bfoOn = false;
-            // Antenna tuning capacitor beállítása (FM esetén antenna tuning capacitor nem kell)
-            currentBand.antCap = getDefaultAntCapValue();
-            si4735.setTuneFrequencyAntennaCapacitor(currentBand.antCap);
-            // delay(100);
-
-            si4735.setFM(currentBand.minimumFreq, currentBand.maximumFreq, currentBand.currFreq, currentBand.currStep);
-            si4735.setFMDeEmphasis(1); // 1 = 50 μs. Usedin Europe, Australia, Japan;  2 = 75 μs. Used in USA (default)
-            si4735.RdsInit();
+    } else if (currentBandType == SW_BAND_TYPE) {
+        // AM/SSB/CW Shortwave esetén
+        stepIndex = config.data.ssIdxAM;
+        // Határellenőrzés
+        if (stepIndex >= ARRAY_ITEM_COUNT(stepSizeAM)) {
+            DEBUG("Hiba: Érvénytelen ssIdxAM index: %d. Alapértelmezett használata.\n", stepIndex);
+            stepIndex = 0;                   // Visszaállás alapértelmezettre
+            config.data.ssIdxAM = stepIndex; // Opcionális: Konfig frissítése
+            config.markDirty();
+        }
+        currentBand.currStep = stepSizeAM[stepIndex].value;
+
+    } else {
+        // FM esetén csak 3 érték lehet - {"50Khz", "100KHz", "1MHz"};
+        stepIndex = config.data.ssIdxFM;
+        // Határellenőrzés
+        if (stepIndex >= ARRAY_ITEM_COUNT(stepSizeFM)) {
+            DEBUG("Hiba: Érvénytelen ssIdxFM index: %d. Alapértelmezett használata.\n", stepIndex);
+            stepIndex = 0;                   // Visszaállás alapértelmezettre
+            config.data.ssIdxFM = stepIndex; // Opcionális: Konfig frissítése
+            config.markDirty();
+        }
+        currentBand.currStep = stepSizeFM[stepIndex].value;
+    }
+
+    // SSB/CW esetén a lépésköz a chipen mindig 1kHz, a finomhangolás BFO-val történik
+    if (ssbLoaded && getModeFamily(currentBand.currMod) == BAND_MODE_FAMILY_SSB) {
+        currentBand.currStep = 1;
+    }
+}
+
+/**
+ * Band beállítása
+ */
+void Band::useBand() {
+
+    // Kikeressük az aktuális Band rekordot
+    BandTable &currentBand = getCurrentBand();
+    uint8_t currentBandType = getCurrentBandType();
+
+    //---- CurrentStep beállítása a band rekordban
+    updateCurrentStep();
+
+    DEBUG("Band::useBand() -> bandName: %s currStep: %d, currentMode: %s\n", getCurrentBandName(), currentBand.currStep, getCurrentBandModeDesc());
+
+    if (currentBandType == FM_BAND_TYPE) {
+        ssbLoaded = false;
+        rtv::bfoOn = false;
+        // Antenna tuning capacitor beállítása (a behangolt tábla alapján, egyébként automatikus)
+        currentBand.antCap = getAntCapValue(currentBand.currFreq);
+        si4735.setTuneFrequencyAntennaCapacitor(currentBand.antCap);
+
+        si4735.setFM(currentBand.minimumFreq, currentBand.maximumFreq, currentBand.currFreq, currentBand.currStep);
+        si4735.setFMDeEmphasis(1); // 1 = 50 μs. Usedin Europe, Australia, Japan;  2 = 75 μs. Used in USA (default)
+        si4735.RdsInit();
 #define RDS_ENABLE 1
 #define RDS_BLOCK_ERROR_TRESHOLD 2
-            si4735.setRdsConfig(RDS_ENABLE, RDS_BLOCK_ERROR_TRESHOLD, RDS_BLOCK_ERROR_TRESHOLD, RDS_BLOCK_ERROR_TRESHOLD, RDS_BLOCK_ERROR_TRESHOLD);
-        } else {                                          // AM-ben vagyunk
-            currentBand.antCap = getDefaultAntCapValue(); // Sima AM esetén antenna tuning capacitor nem kell
-            si4735.setTuneFrequencyAntennaCapacitor(currentBand.antCap);
-
-            if (ssbLoaded) {
-                // SSB vagy CW mód
-                bool isCWMode = (currentBand.currMod == CW);
-
-                // Mód beállítása (LSB-t használunk alapnak CW-hez)
-                uint8_t modeForChip = isCWMode ? LSB : currentBand.currMod;
-                si4735.setSSB(currentBand.minimumFreq, currentBand.maximumFreq, currentBand.currFreq,
-                              1, // SSB/CW esetén a step mindig 1kHz a chipen belül
-                              modeForChip);
-
-                // BFO beállítása                        // CW mód: Fix BFO offset (pl. 700 Hz) + manuális finomhangolás
-                const int16_t cwBaseOffset = isCWMode ? configRef.data.cwReceiverOffsetHz : 0; // Alap CW eltolás a configból
-                si4735.setSSBBfo(cwBaseOffset + config.data.currentBFO + config.data.currentBFOmanu);
-                rtv::CWShift = isCWMode; // Jelezzük a kijelzőnek
-
-                // SSB/CW esetén a lépésköz a chipen mindig 1kHz, de a finomhangolás BFO-val történik
-                currentBand.currStep = 1;
-                si4735.setFrequencyStep(currentBand.currStep);
-
-            } else { // Sima AM mód
-                si4735.setAM(currentBand.minimumFreq, currentBand.maximumFreq, currentBand.currFreq, currentBand.currStep);
-                // si4735.setAutomaticGainControl(1, 0);
-                // si4735.setAmSoftMuteMaxAttenuation(0); // // Disable Soft Mute for AM
-                rtv::bfoOn = false;
-                rtv::CWShift = false; // AM módban biztosan nincs CW shift
-            }
+        si4735.setRdsConfig(RDS_ENABLE, RDS_BLOCK_ERROR_TRESHOLD, RDS_BLOCK_ERROR_TRESHOLD, RDS_BLOCK_ERROR_TRESHOLD, RDS_BLOCK_ERROR_TRESHOLD);
+    } else {                                          // AM-ben vagyunk
+        currentBand.antCap = getAntCapValue(currentBand.currFreq); // Behangolt érték vagy az alapértelmezett
+        si4735.setTuneFrequencyAntennaCapacitor(currentBand.antCap);
+
+        if (ssbLoaded) {
+            // SSB vagy CW mód
+            bool isCWMode = (currentBand.currMod == CW);
+
+            // Mód beállítása (LSB-t használunk alapnak CW-hez)
+            uint8_t modeForChip = isCWMode ? LSB : currentBand.currMod;
+            si4735.setSSB(currentBand.minimumFreq, currentBand.maximumFreq, currentBand.currFreq,
+                          1, // SSB/CW esetén a step mindig 1kHz a chipen belül
+                          modeForChip);
+
+            // BFO beállítása                        // CW mód: Fix BFO offset (pl. 700 Hz) + manuális finomhangolás
+            const int16_t cwBaseOffset = isCWMode ? configRef.data.cwReceiverOffsetHz : 0; // Alap CW eltolás a configból
+            si4735.setSSBBfo(cwBaseOffset + config.data.currentBFO + config.data.currentBFOmanu);
+            rtv::CWShift = isCWMode; // Jelezzük a kijelzőnek
+
+            // SSB/CW esetén a lépésköz a chipen mindig 1kHz, de a finomhangolás BFO-val történik
+            currentBand.currStep = 1;
+            si4735.setFrequencyStep(currentBand.currStep);
+
+        } else { // Sima AM mód
+            si4735.setAM(currentBand.minimumFreq, currentBand.maximumFreq, currentBand.currFreq, currentBand.currStep);
+            // si4735.setAutomaticGainControl(1, 0);
+            // si4735.setAmSoftMuteMaxAttenuation(0); // // Disable Soft Mute for AM
+            rtv::bfoOn = false;
+            rtv::CWShift = false; // AM módban biztosan nincs CW shift
         }
     }
+
+    storeAppliedState();
 }
 
 /**
@@ -317,16 +368,7 @@ void Band::setBandWidth() {
          *
          * @param AUDIOBW the valid values are 0, 1, 2, 3, 4 or 5; see description above
          */
-        si4735.setSSBAudioBandwidth(config.data.bwIdxSSB);
-
-        // If audio bandwidth selected is about 2 kHz or below, it is recommended to set Sideband Cutoff Filter to 0.
-        if (config.data.bwIdxSSB == 0 or config.data.bwIdxSSB == 4 or config.data.bwIdxSSB == 5) {
-            // Band pass filter to cutoff both the unwanted side band and high frequency components > 2.0 kHz of the wanted side band. (default)
-            si4735.setSSBSidebandCutoffFilter(0);
-        } else {
-            // Low pass filter to cutoff the unwanted side band.
-            si4735.setSSBSidebandCutoffFilter(1);
-        }
+        setSsbBandWidth();
 
     } else if (currMod == AM) {
         /**
@@ -365,6 +407,22 @@ void Band::setBandWidth() {
     }
 }
 
+/**
+ * SSB/CW sávszélesség beállítása a konfig szerint
+ */
+void Band::setSsbBandWidth() {
+    si4735.setSSBAudioBandwidth(config.data.bwIdxSSB);
+
+    // If audio bandwidth selected is about 2 kHz or below, it is recommended to set Sideband Cutoff Filter to 0.
+    if (config.data.bwIdxSSB == 0 or config.data.bwIdxSSB == 4 or config.data.bwIdxSSB == 5) {
+        // Band pass filter to cutoff both the unwanted side band and high frequency components > 2.0 kHz of the wanted side band. (default)
+        si4735.setSSBSidebandCutoffFilter(0);
+    } else {
+        // Low pass filter to cutoff the unwanted side band.
+        si4735.setSSBSidebandCutoffFilter(1);
+    }
+}
+
 /**
  * Band inicializálása konfig szerint
  */
@@ -373,8 +431,12 @@ void Band::bandInit(bool sysStart) {
     DEBUG("Band::BandInit() ->bandIdx: %d\n", config.data.bandIdx);
     BandTable &curretBand = getCurrentBand();
 
+    // A reset után a chip konfigurációja (és az SSB patch is) elveszik
+    appliedBandIdx = -1;
+    ssbLoaded = false;
+
     if (getCurrentBandType() == FM_BAND_TYPE) {
-        si4735.setup(PIN_SI4735_RESET, FM_BAND_TYPE);
+        si4735.setup(PIN_SI4735_RESET, -1, FM_BAND_TYPE, SI473X_ANALOG_AUDIO, XOSCEN_CRYSTAL, 1); // GPO2/INT kimenet engedélyezve
         si4735.setFM();
 
         // Seek beállítások
@@ -385,7 +447,7 @@ void Band::bandInit(bool sysStart) {
         si4735.setSeekFmLimits(curretBand.minimumFreq, curretBand.maximumFreq);
 
     } else {
-        si4735.setup(PIN_SI4735_RESET, MW_BAND_TYPE);
+        si4735.setup(PIN_SI4735_RESET, -1, MW_BAND_TYPE, SI473X_ANALOG_AUDIO, XOSCEN_CRYSTAL, 1); // GPO2/INT kimenet engedélyezve
         si4735.setAM();
 
         // Seek beállítások
@@ -434,13 +496,173 @@ void Band::bandSet(bool useDefaults) {
     setBandWidth();
     // Antenna Tunning Capacitor beállítása
     si4735.setTuneFrequencyAntennaCapacitor(currentBand.antCap);
+
+    // Power-up után a megszakítás beállítások elvesznek (SSB patch esetén polling marad)
+    si4735.configureInterrupts(ssbLoaded);
+
+    storeAppliedState();
 }
 
 /**
- *
+ * Egy sáv chip konfigurációjának változó részeinek frissítése (moduláció, lépésköz, sávszélesség, antCap)
+ */
+void Band::updateChipState(uint8_t bandIdx) {
+    const BandTable &b = bandTable[bandIdx];
+    BandChipState &state = chipStates[bandIdx];
+
+    state.modulation = b.currMod;
+    state.modeFamily = getModeFamily(b.currMod);
+    state.step = b.currStep;
+    state.antCap = b.antCap;
+    state.bandwidthIndex = (state.modeFamily == BAND_MODE_FAMILY_FM)   ? config.data.bwIdxFM
+                           : (state.modeFamily == BAND_MODE_FAMILY_AM) ? config.data.bwIdxAM
+                                                                       : config.data.bwIdxSSB;
+}
+
+/**
+ * Az aktuális sáv konfigurációjának megjegyzése, mint a chipen beállított állapot
+ */
+void Band::storeAppliedState() {
+    updateChipState(config.data.bandIdx);
+    appliedState = chipStates[config.data.bandIdx];
+    appliedBandIdx = config.data.bandIdx;
+}
+
+/**
+ * Antenna Tuning Capacitor értéke egy frekvencián
+ */
+uint16_t Band::getAntCapValue(uint16_t freq) {
+    const BandTable &currentBand = getCurrentBand();
+    return antCapStore.lookup(config.data.bandIdx, currentBand.minimumFreq, currentBand.maximumFreq, freq, getDefaultAntCapValue());
+}
+
+/**
+ * Antenna Tuning Capacitor előkészítése egy frekvenciához (hangoláskor)
+ */
+void Band::applyAntCap(uint16_t freq) {
+    uint16_t antCap = getAntCapValue(freq);
+    getCurrentBand().antCap = antCap;
+    appliedState.antCap = antCap;
+    chipStates[config.data.bandIdx].antCap = antCap;
+    si4735.setTuneFrequencyAntennaCapacitor(antCap);
+}
+
+/**
+ * Csak az eltérő parancsok kiküldése azonos mód családon belül (reset és patch letöltés nélkül)
+ */
+void Band::applyChipStateDelta(const BandChipState &target) {
+
+    BandTable &currentBand = getCurrentBand();
+    bool limitsChanged = target.minimumFreq != appliedState.minimumFreq || target.maximumFreq != appliedState.maximumFreq || target.step != appliedState.step;
+
+    if (target.antCap != appliedState.antCap) {
+        si4735.setTuneFrequencyAntennaCapacitor(target.antCap);
+    }
+
+    switch (target.modeFamily) {
+
+    case BAND_MODE_FAMILY_FM:
+        if (limitsChanged) {
+            si4735.setFM(target.minimumFreq, target.maximumFreq, currentBand.currFreq, target.step);
+        } else {
+            si4735.setFrequency(currentBand.currFreq);
+        }
+        break;
+
+    case BAND_MODE_FAMILY_AM:
+        // A könyvtár setAM()-je nem kapcsolja újra a chipet, ha már AM módban van
+        if (limitsChanged) {
+            si4735.setAM(target.minimumFreq, target.maximumFreq, currentBand.currFreq, target.step);
+        } else {
+            si4735.setFrequency(currentBand.currFreq);
+        }
+        rtv::bfoOn = false;
+        rtv::CWShift = false;
+        break;
+
+    case BAND_MODE_FAMILY_SSB: {
+        bool isCWMode = (target.modulation == CW);
+        if (limitsChanged || target.modulation != appliedState.modulation) {
+            si4735.setSSB(target.minimumFreq, target.maximumFreq, currentBand.currFreq, 1, isCWMode ? LSB : target.modulation);
+        } else {
+            si4735.setFrequency(currentBand.currFreq);
+        }
+        const int16_t cwBaseOffset = isCWMode ? configRef.data.cwReceiverOffsetHz : 0;
+        si4735.setSSBBfo(cwBaseOffset + config.data.currentBFO + config.data.currentBFOmanu);
+        rtv::CWShift = isCWMode;
+        break;
+    }
+    }
+
+    if (target.bandwidthIndex != appliedState.bandwidthIndex) {
+        setBandWidth();
+    }
+}
+
+/**
+ * Band váltás
+ */
+void Band::switchBand(uint8_t bandIdx, bool useDefaults) {
+
+    uint32_t start = micros();
+    int8_t fromIdx = appliedBandIdx;
+
+    if (config.data.bandIdx != bandIdx) {
+        config.data.bandIdx = bandIdx;
+        config.markDirty();
+    }
+    BandTable &currentBand = getCurrentBand();
+    if (useDefaults) {
+        currentBand.currMod = currentBand.prefMod;
+    }
+    uint8_t targetFamily = getModeFamily(currentBand.currMod);
+
+    const char *path;
+    if (fromIdx < 0 || (targetFamily == BAND_MODE_FAMILY_FM) != (appliedState.modeFamily == BAND_MODE_FAMILY_FM)) {
+        // FM <-> AM: a chipet újra kell indítani a másik módban
+        bandInit();
+        bandSet(false);
+        path = "reset";
+
+    } else if (targetFamily != appliedState.modeFamily || (targetFamily == BAND_MODE_FAMILY_SSB && !ssbLoaded)) {
+        // AM <-> SSB: AM -> SSB esetén a patch letöltése, SSB -> AM esetén a könyvtár kapcsolja újra a chipet
+        bandSet(false);
+        path = "mode";
+
+    } else {
+        // Azonos mód család: csak az eltérő parancsok
+        currentBand.antCap = getAntCapValue(currentBand.currFreq);
+        updateCurrentStep();
+        updateChipState(bandIdx);
+        applyChipStateDelta(chipStates[bandIdx]);
+        storeAppliedState();
+        path = "delta";
+    }
+
+    lastSwitchMicros = micros() - start;
+    if (path[0] == 'd') {
+        maxDeltaSwitchMicros = max(maxDeltaSwitchMicros, lastSwitchMicros);
+    } else {
+        maxFullSwitchMicros = max(maxFullSwitchMicros, lastSwitchMicros);
+    }
+
+    DEBUG("Band::switchBand() -> %s -> %s (%s): %lu us (max delta: %lu us, max full: %lu us)\n", fromIdx >= 0 ? bandTable[fromIdx].bandName : "-", currentBand.bandName, path,
+          lastSwitchMicros, maxDeltaSwitchMicros, maxFullSwitchMicros);
+}
+
+/**
+ * Memória állomás behangolása
+ * Ha a chipen már a tárolt sáv, moduláció és sávszélesség van beállítva, akkor csak a frekvenciát (és a BFO-t) küldjük ki,
+ * egyébként a switchBand a lehető legkevesebb paranccsal vált
  */
 void Band::tuneMemoryStation(uint16_t frequency, int16_t bfoOffset, uint8_t bandIndex, uint8_t demodModIndex, uint8_t bandwidthIndex) {
 
+    uint32_t start = micros();
+
+    // 0. Eltérés a chipen beállított állapottól: azonos sáv/mód/sávszélesség esetén elég a frekvencia
+    bool isSsb = getModeFamily(demodModIndex) == BAND_MODE_FAMILY_SSB;
+    bool fastPath = appliedBandIdx == bandIndex && appliedState.modulation == demodModIndex && appliedState.bandwidthIndex == bandwidthIndex && (!isSsb || ssbLoaded);
+
     // 1. Elkérjük a Band táblát
     config.data.bandIdx = bandIndex;                 // Band index beállítása
     BandTable &currentBand = this->getCurrentBand(); // 2. Demodulátor beállítása a chipen.  Ha CW módra váltunk, akkor nullázzuk a finomhangolási BFO-t
@@ -462,21 +684,32 @@ void Band::tuneMemoryStation(uint16_t frequency, int16_t bfoOffset, uint8_t band
         config.data.bwIdxSSB = savedBwIndex;
     }
 
-    // 4. Újra beállítjuk a sávot az új móddal (false -> ne a preferált adatokat töltse be)
-    this->bandSet(false); // 5. Explicit módon állítsd be a frekvenciát és a módot a chipen
-    currentBand.currFreq = frequency;
-    si4735.setFrequency(currentBand.currFreq);
+    // 4. Gyors út: csak a frekvencia (ha az is egyezik, akkor semmi)
+    //    Egyébként újra beállítjuk a sávot az új móddal, a switchBand csak FM <-> AM váltáskor resetel
+    bool bfoChanged = isSsb && config.data.currentBFO != bfoOffset;
+    if (fastPath) {
+        if (currentBand.currFreq != frequency) {
+            currentBand.currFreq = frequency;
+            applyAntCap(frequency);
+            si4735.setFrequency(frequency);
+        }
+    } else {
+        currentBand.currFreq = frequency;
+        this->switchBand(bandIndex, false); // 5. A frekvenciát is a switchBand állítja be a chipen
+    }
 
     // BFO eltolás visszaállítása SSB/CW esetén ---
-    if (demodModIndex == LSB || demodModIndex == USB || demodModIndex == CW) {
+    if (isSsb) {
         currentBand.lastBFO = bfoOffset;    // Mentett BFO visszaállítása a sáv változóba
         config.data.currentBFO = bfoOffset; // Mentett BFO visszaállítása az aktuális hangolási változóba
         rtv::freqDec = bfoOffset;           // Rotary változó szinkronizálása
 
-        const int16_t cwBaseOffset = (demodModIndex == CW) ? config.data.cwReceiverOffsetHz : 0;
-        // A visszaállított BFO (+ az AKTUÁLIS manuális finomítás) használata
-        int16_t bfoToSet = cwBaseOffset + config.data.currentBFO + config.data.currentBFOmanu;
-        si4735.setSSBBfo(bfoToSet);
+        if (!fastPath || bfoChanged) {
+            const int16_t cwBaseOffset = (demodModIndex == CW) ? config.data.cwReceiverOffsetHz : 0;
+            // A visszaállított BFO (+ az AKTUÁLIS manuális finomítás) használata
+            int16_t bfoToSet = cwBaseOffset + config.data.currentBFO + config.data.currentBFOmanu;
+            si4735.setSSBBfo(bfoToSet);
+        }
         rtv::CWShift = (demodModIndex == CW); // CW shift állapot frissítése
 
     } else {
@@ -487,6 +720,73 @@ void Band::tuneMemoryStation(uint16_t frequency, int16_t bfoOffset, uint8_t band
         rtv::CWShift = false;
     }
 
-    // 6. Hangerő visszaállítása
+    config.markDirty(); // Sáv, mód, sávszélesség és BFO egy módosításként
+
+    // 6. Hangerő visszaállítása (a gyors úton a chip nem indult újra, a hangerő nem változott)
+    if (!fastPath) {
+        si4735.setVolume(config.data.currVolume);
+    }
+
+    lastRecallMicros = micros() - start;
+    if (fastPath) {
+        maxFastRecallMicros = max(maxFastRecallMicros, lastRecallMicros);
+    }
+    DEBUG("Band::tuneMemoryStation() -> %s %u (%s): %lu us (max fast: %lu us)\n", currentBand.bandName, frequency, fastPath ? "fast" : "switch", lastRecallMicros,
+          maxFastRecallMicros);
+}
+
+/**
+ * Ideiglenes SSB/CW hangolás
+ * A chipen beállított állapotot (appliedState) követjük, így a restoreCurrentBand() switchBand-je csak az eltérő parancsokat küldi ki
+ */
+void Band::tuneTemporarySsb(uint8_t bandIndex, uint16_t frequency, uint8_t modulation, int16_t bfoOffset) {
+
+    const BandTable &b = bandTable[bandIndex];
+    bool isCWMode = (modulation == CW);
+
+    BandChipState target;
+    target.modeFamily = BAND_MODE_FAMILY_SSB;
+    target.modulation = modulation;
+    target.minimumFreq = b.minimumFreq;
+    target.maximumFreq = b.maximumFreq;
+    target.step = 1; // SSB/CW esetén a step mindig 1kHz a chipen belül
+    target.bandwidthIndex = config.data.bwIdxSSB;
+    target.antCap = antCapStore.lookup(bandIndex, b.minimumFreq, b.maximumFreq, frequency, b.bandType == SW_BAND_TYPE ? 1 : 0);
+
+    // FM/AM módból a patch letöltése (chip reset), utána minden parancsot ki kell küldeni
+    if (!ssbLoaded) {
+        loadSSB();
+        si4735.configureInterrupts(ssbLoaded);
+        si4735.setVolume(config.data.currVolume);
+        appliedBandIdx = -1;
+    }
+    bool full = appliedBandIdx < 0 || appliedState.modeFamily != BAND_MODE_FAMILY_SSB;
+
+    if (full || target.antCap != appliedState.antCap) {
+        si4735.setTuneFrequencyAntennaCapacitor(target.antCap);
+    }
+    if (full || target.minimumFreq != appliedState.minimumFreq || target.maximumFreq != appliedState.maximumFreq || target.step != appliedState.step ||
+        target.modulation != appliedState.modulation) {
+        si4735.setSSB(target.minimumFreq, target.maximumFreq, frequency, target.step, isCWMode ? LSB : modulation);
+    } else {
+        si4735.setFrequency(frequency);
+    }
+    const int16_t cwBaseOffset = isCWMode ? configRef.data.cwReceiverOffsetHz : 0;
+    si4735.setSSBBfo(cwBaseOffset + bfoOffset);
+    if (full || target.bandwidthIndex != appliedState.bandwidthIndex) {
+        setSsbBandWidth();
+    }
+
+    appliedState = target;
+    appliedBandIdx = bandIndex;
+
+    DEBUG("Band::tuneTemporarySsb() -> %s %u kHz (%s)\n", b.bandName, frequency, full ? "full" : "delta");
+}
+
+/**
+ * Vissza a konfig szerinti állapotra
+ */
+void Band::restoreCurrentBand() {
+    switchBand(config.data.bandIdx, false);
     si4735.setVolume(config.data.currVolume);
 }
@@ -0,0 +1,371 @@
+#include "BandActivityRecorder.h"
+
+#include <LittleFS.h>
+
+#include "RadioClock.h"
+#include "SignalQualitySampler.h"
+#include "defines.h"
+#include "rtVars.h"
+
+#define ACTIVITY_FILE_MAGIC 0x41435456 // "ACTV"
+#define ACTIVITY_FILE_VERSION 1
+#define ACTIVITY_MAX_ROW_SIZE (ACTIVITY_MAX_CHANNELS * 2) // |különbség| <= 63 -> a token legfeljebb 2 byte
+
+static_assert(ACTIVITY_MAX_ROW_SIZE <= 255, "A row length must fit into uint8_t");
+static_assert((127 >> ACTIVITY_RSSI_SHIFT) <= 63, "Level deltas must fit into a 2 byte varint token");
+
+/**
+ * Konstruktor
+ */
+BandActivityRecorder::BandActivityRecorder(Si4735Ext &si4735, Band &band) : si4735(si4735), band(band) {
+    memset(rowLength, 0, sizeof(rowLength));
+    memset(rowOffset, 0, sizeof(rowOffset));
+    memset(rowRevision, 0, sizeof(rowRevision));
+    resetAccumulator();
+}
+
+/**
+ * Az aktuális időrés gyűjtőjének törlése
+ */
+void BandActivityRecorder::resetAccumulator() {
+    memset(rssiSum, 0, sizeof(rssiSum));
+    memset(sampleCount, 0, sizeof(sampleCount));
+}
+
+/**
+ * Csatorna kiosztás
+ */
+void BandActivityRecorder::configure(uint8_t newBandIdx) {
+    if (dirty) {
+        flush();
+    }
+
+    const BandTable &b = band.getBandByIdx(newBandIdx);
+    uint16_t span = b.maximumFreq - b.minimumFreq;
+
+    // A sáv lépésköze, de legfeljebb ACTIVITY_MAX_CHANNELS csatorna (a lépésköz többszörösére kerekítve)
+    uint16_t step = max((uint16_t)b.defStep, (uint16_t)1);
+    uint16_t minSpacing = (span + ACTIVITY_MAX_CHANNELS - 2) / (ACTIVITY_MAX_CHANNELS - 1);
+    spacing = ((max(step, minSpacing) + step - 1) / step) * step;
+
+    bandIdx = newBandIdx;
+    firstFreq = b.minimumFreq;
+    channelCount = span / spacing + 1;
+    nextChannel = 0;
+    currentBin = -1;
+    resetAccumulator();
+
+    if (!load()) {
+        arenaUsed = 0;
+        memset(rowLength, 0, sizeof(rowLength));
+        memset(rowOffset, 0, sizeof(rowOffset));
+    }
+    dirty = false;
+    lastFlush = millis();
+    layoutRevision = ++revision;
+    for (uint8_t i = 0; i < ACTIVITY_BINS_PER_DAY; i++) {
+        rowRevision[i] = revision;
+    }
+
+    DEBUG("BandActivityRecorder::configure() -> %s: %u channels, spacing %u\n", b.bandName, channelCount, spacing);
+}
+
+/**
+ * Tétlen-e a rádió (csak ilyenkor mérünk)
+ */
+bool BandActivityRecorder::isIdle() const {
+    return !rtv::SEEK && !rtv::SCANbut && !rtv::BEACON && millis() - rtv::lastUserActivity >= ACTIVITY_IDLE_TIMEOUT && !signalQualitySampler.isTunerBusy();
+}
+
+/**
+ * Arduino loop
+ */
+void BandActivityRecorder::loop() {
+    if (!enabled || bandIdx < 0) {
+        return;
+    }
+
+    // Időrés váltás: a gyűjtött átlagok tömörítése
+    int8_t bin = radioClock.getMillisOfDay() / (RADIO_CLOCK_MS_PER_DAY / ACTIVITY_BINS_PER_DAY);
+    if (bin != currentBin) {
+        if (currentBin >= 0) {
+            commitBin();
+        }
+        currentBin = bin;
+        resetAccumulator();
+    }
+
+    if (dirty && millis() - lastFlush >= ACTIVITY_FLUSH_INTERVAL) {
+        flush();
+    }
+
+    // Csak a beállított sávon, tétlen időszakban mérünk
+    if (config.data.bandIdx != bandIdx || !isIdle() || millis() - lastProbe < ACTIVITY_PROBE_INTERVAL) {
+        return;
+    }
+    lastProbe = millis();
+    probeNext();
+}
+
+/**
+ * Némított áthangolás és RSSI mérés, fix időkerettel
+ */
+bool BandActivityRecorder::measure(uint16_t freq, uint8_t &rssi) {
+    si4735.setFrequencyNoWait(freq);
+    if (!si4735.waitTuneComplete(ACTIVITY_PROBE_BUDGET)) {
+        return false;
+    }
+    rssi = si4735.getReceivedSignalStrengthIndicator();
+    return true;
+}
+
+/**
+ * A következő csatorna megmérése
+ */
+void BandActivityRecorder::probeNext() {
+    uint8_t channel = nextChannel;
+    nextChannel = (nextChannel + 1) % channelCount;
+
+    uint16_t homeFreq = band.getCurrentBand().currFreq;
+    uint16_t freq = getChannelFrequency(channel);
+
+    uint8_t rssi;
+    si4735.setHardwareAudioMute(true);
+    bool measured = measure(freq, rssi);
+
+    // Vissza az eredeti frekvenciára
+    uint8_t dummyRssi;
+    measure(homeFreq, dummyRssi);
+    if (band.getCurrentBandType() == FM_BAND_TYPE) {
+        si4735.flushRdsFifo(); // A próba alatt érkezett csoportok nem a mi állomásunkéi
+    }
+    si4735.setHardwareAudioMute(false);
+
+    if (measured && sampleCount[channel] < UINT8_MAX) {
+        rssiSum[channel] += rssi;
+        sampleCount[channel]++;
+        probeCount++;
+    }
+}
+
+/**
+ * Az időrés átlagainak összefésülése a tárolt sorral és a sor újratömörítése
+ */
+void BandActivityRecorder::commitBin() {
+    uint8_t levels[ACTIVITY_MAX_CHANNELS];
+    memset(levels, 0, sizeof(levels));
+
+    RowCursor cursor;
+    bool hasOld = getRow(currentBin, cursor);
+    if (hasOld) {
+        for (uint8_t ch = 0; ch < channelCount && cursor.next(levels[ch]); ch++) {
+        }
+    }
+
+    bool changed = false;
+    for (uint8_t ch = 0; ch < channelCount; ch++) {
+        if (sampleCount[ch] == 0) {
+            continue; // Nem mértük, marad a régi
+        }
+        uint8_t level = (rssiSum[ch] / sampleCount[ch]) >> ACTIVITY_RSSI_SHIFT;
+        levels[ch] = hasOld ? (levels[ch] * ACTIVITY_MERGE_WEIGHT + level + ACTIVITY_MERGE_WEIGHT / 2) / (ACTIVITY_MERGE_WEIGHT + 1) : level;
+        changed = true;
+    }
+    if (!changed) {
+        return;
+    }
+
+    uint8_t row[ACTIVITY_MAX_ROW_SIZE];
+    uint8_t length = encodeRow(levels, row);
+    if (storeRow(currentBin, row, length)) {
+        dirty = true;
+    }
+}
+
+/**
+ * Varint írása (7 bit / byte)
+ */
+uint8_t BandActivityRecorder::writeVarint(uint32_t value, uint8_t *out) {
+    uint8_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    out[n++] = value;
+    return n;
+}
+
+/**
+ * Egy sor tömörítése
+ * Token: (zigzag(különbség) << 1) vagy ((nulla különbségek száma - 1) << 1) | 1, varint-ként
+ */
+uint8_t BandActivityRecorder::encodeRow(const uint8_t *levels, uint8_t *out) const {
+    uint8_t length = 0;
+    int16_t prev = 0;
+
+    for (uint8_t ch = 0; ch < channelCount;) {
+        int16_t delta = (int16_t)levels[ch] - prev;
+        if (delta == 0) {
+            uint8_t run = 1;
+            while (ch + run < channelCount && levels[ch + run] == prev) {
+                run++;
+            }
+            length += writeVarint(((uint32_t)(run - 1) << 1) | 1, out + length);
+            ch += run;
+        } else {
+            uint32_t zigzag = delta < 0 ? ((uint32_t)(-delta) << 1) - 1 : (uint32_t)delta << 1;
+            length += writeVarint(zigzag << 1, out + length);
+            prev = levels[ch];
+            ch++;
+        }
+    }
+    return length;
+}
+
+/**
+ * Egy sor elhelyezése az arénában (a mögötte lévő sorok eltolásával)
+ */
+bool BandActivityRecorder::storeRow(uint8_t bin, const uint8_t *data, uint8_t length) {
+    uint8_t oldLength = rowLength[bin];
+    if (arenaUsed - oldLength + length > ACTIVITY_ARENA_SIZE) {
+        droppedRows++;
+        DEBUG("BandActivityRecorder::storeRow() -> arena full, bin %u dropped\n", bin);
+        return false;
+    }
+
+    if (oldLength == 0) {
+        rowOffset[bin] = arenaUsed; // Új sor a végére
+    } else if (length != oldLength) {
+        uint16_t tail = rowOffset[bin] + oldLength;
+        memmove(arena + rowOffset[bin] + length, arena + tail, arenaUsed - tail);
+        for (uint8_t i = 0; i < ACTIVITY_BINS_PER_DAY; i++) {
+            if (rowLength[i] != 0 && rowOffset[i] > rowOffset[bin]) {
+                rowOffset[i] += length - oldLength;
+            }
+        }
+    }
+
+    memcpy(arena + rowOffset[bin], data, length);
+    arenaUsed += length - oldLength;
+    rowLength[bin] = length;
+    rowRevision[bin] = ++revision;
+    return true;
+}
+
+/**
+ * Egy időrés sorának olvasója
+ */
+bool BandActivityRecorder::getRow(uint8_t bin, RowCursor &cursor) const {
+    if (bin >= ACTIVITY_BINS_PER_DAY || rowLength[bin] == 0) {
+        return false;
+    }
+    cursor = RowCursor(arena + rowOffset[bin], rowLength[bin], channelCount);
+    return true;
+}
+
+/**
+ * Kiírás a flash-re (fejléc + az aréna használt része)
+ */
+bool BandActivityRecorder::flush() {
+    if (bandIdx < 0) {
+        return false;
+    }
+
+    FileHeader header;
+    header.magic = ACTIVITY_FILE_MAGIC;
+    header.version = ACTIVITY_FILE_VERSION;
+    header.bandIdx = bandIdx;
+    header.channelCount = channelCount;
+    header.binCount = ACTIVITY_BINS_PER_DAY;
+    header.firstFreq = firstFreq;
+    header.spacing = spacing;
+    header.arenaUsed = arenaUsed;
+    memcpy(header.rowOffset, rowOffset, sizeof(rowOffset));
+    memcpy(header.rowLength, rowLength, sizeof(rowLength));
+
+    File file = LittleFS.open(ACTIVITY_FILE_NAME, "w");
+    if (!file) {
+        DEBUG("BandActivityRecorder::flush() -> open failed\n");
+        return false;
+    }
+    bool ok = file.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header)) == sizeof(header) && file.write(arena, arenaUsed) == arenaUsed;
+    file.close();
+
+    dirty = !ok;
+    lastFlush = millis();
+    DEBUG("BandActivityRecorder::flush() -> %u bytes %s\n", sizeof(header) + arenaUsed, ok ? "written" : "FAILED");
+    return ok;
+}
+
+/**
+ * Betöltés a flash-ről, ha ugyanehhez a csatorna kiosztáshoz tartozik
+ */
+bool BandActivityRecorder::load() {
+    File file = LittleFS.open(ACTIVITY_FILE_NAME, "r");
+    if (!file) {
+        return false;
+    }
+
+    FileHeader header;
+    bool ok = file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) == sizeof(header) && header.magic == ACTIVITY_FILE_MAGIC &&
+              header.version == ACTIVITY_FILE_VERSION && header.bandIdx == bandIdx && header.channelCount == channelCount && header.binCount == ACTIVITY_BINS_PER_DAY &&
+              header.firstFreq == firstFreq && header.spacing == spacing && header.arenaUsed <= ACTIVITY_ARENA_SIZE;
+    if (ok) {
+        ok = file.read(arena, header.arenaUsed) == header.arenaUsed;
+    }
+    file.close();
+
+    if (ok) {
+        arenaUsed = header.arenaUsed;
+        memcpy(rowOffset, header.rowOffset, sizeof(rowOffset));
+        memcpy(rowLength, header.rowLength, sizeof(rowLength));
+    }
+    return ok;
+}
+
+/**
+ * Varint olvasása
+ */
+uint32_t BandActivityRecorder::RowCursor::readVarint() {
+    uint32_t value = 0;
+    uint8_t shift = 0;
+    while (pos < end) {
+        uint8_t b = *pos++;
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            break;
+        }
+        shift += 7;
+    }
+    return value;
+}
+
+/**
+ * A következő csatorna szintje
+ */
+bool BandActivityRecorder::RowCursor::next(uint8_t &value) {
+    if (remaining == 0) {
+        return false;
+    }
+
+    if (zeroRun == 0) {
+        if (pos >= end) {
+            return false; // Sérült sor
+        }
+        uint32_t token = readVarint();
+        if (token & 1) {
+            zeroRun = (token >> 1) + 1;
+        } else {
+            uint32_t zigzag = token >> 1;
+            level += (zigzag & 1) ? -(int16_t)((zigzag + 1) >> 1) : (int16_t)(zigzag >> 1);
+            remaining--;
+            value = level;
+            return true;
+        }
+    }
+
+    zeroRun--;
+    remaining--;
+    value = level;
+    return true;
+}
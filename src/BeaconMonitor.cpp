@@ -0,0 +1,190 @@
+#include "BeaconMonitor.h"
+
+#include "BandIndex.h"
+#include "RadioClock.h"
+#include "SignalQualitySampler.h"
+#include "defines.h"
+#include "rtVars.h"
+
+#define BEACON_SLOTS_PER_DAY (RADIO_CLOCK_MS_PER_DAY / BEACON_SLOT_MS)
+
+static_assert(RADIO_CLOCK_MS_PER_DAY % ((uint32_t)BEACON_SLOT_MS * BEACON_COUNT) == 0, "The beacon cycle must divide the day");
+static_assert(BEACON_MEASURE_END <= BEACON_SLOT_MS - BEACON_RETUNE_LEAD, "The measurement window must end before the retune");
+
+// A beaconok a menetrend sorrendjében (az s. slotban a 14100 kHz-en az s. beacon ad)
+const char *const BeaconMonitor::beaconCallsigns[BEACON_COUNT] = {"4U1UN", "VE8AT", "W6WX", "KH6RS", "ZL6B", "VK6RBP", "JA2IGY", "RR9O", "VR2B",
+                                                                  "4S7B",  "ZS6DN", "5Z4B", "4X6TU", "OH2B", "CS3B",   "LU4AA",  "OA4B", "YV5B"};
+
+// A beacon frekvenciák (kHz), a sávok sorrendjében
+const uint16_t BeaconMonitor::beaconFrequencies[BEACON_BAND_COUNT] = {14100, 18110, 21150, 24930, 28200};
+
+/**
+ * Konstruktor
+ */
+BeaconMonitor::BeaconMonitor(Si4735Ext &si4735, Band &band) : si4735(si4735), band(band) {
+    for (uint8_t beacon = 0; beacon < BEACON_COUNT; beacon++) {
+        for (uint8_t bandSlot = 0; bandSlot < BEACON_BAND_COUNT; bandSlot++) {
+            latest[beacon][bandSlot] = {BEACON_NOT_MEASURED, 0, 0};
+        }
+    }
+    memset(snrHistory, BEACON_NOT_MEASURED, sizeof(snrHistory));
+    memset(historyHead, 0, sizeof(historyHead));
+    memset(bandIndexes, BAND_INDEX_NOT_FOUND, sizeof(bandIndexes));
+}
+
+/**
+ * Melyik sávot figyeljük egy slotban
+ * Ciklusonként eggyel eltolva, így 5 ciklus alatt minden beacon minden sávon sorra kerül
+ */
+uint8_t BeaconMonitor::bandSlotFor(uint32_t slot) {
+    uint32_t cycle = slot / BEACON_COUNT;
+    return (slot % BEACON_COUNT + cycle) % BEACON_BAND_COUNT;
+}
+
+/**
+ * Indítás
+ */
+bool BeaconMonitor::start() {
+    if (running) {
+        return true;
+    }
+    if (!radioClock.isSynced()) {
+        DEBUG("BeaconMonitor::start() -> no UTC time, monitor not started\n");
+        return false;
+    }
+
+    // A beacon frekvenciák sávjai (a keskenyebb, azaz a HAM sáv nyer)
+    for (uint8_t i = 0; i < BEACON_BAND_COUNT; i++) {
+        bandIndexes[i] = band.getBandIdxByFrequency(beaconFrequencies[i], false);
+        if (bandIndexes[i] == BAND_INDEX_NOT_FOUND) {
+            DEBUG("BeaconMonitor::start() -> no band for %u kHz\n", beaconFrequencies[i]);
+            return false;
+        }
+    }
+
+    tunedSlot = -1;
+    running = true;
+    rtv::BEACON = true;
+    return true;
+}
+
+/**
+ * Leállítás
+ */
+void BeaconMonitor::stop() {
+    if (!running) {
+        return;
+    }
+    running = false;
+    rtv::BEACON = false;
+
+    // A figyelés alatt a konfig nem változott, abból áll vissza a teljes előző hangolás
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_BEACON, true);
+    band.restoreCurrentBand();
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_BEACON, false);
+}
+
+/**
+ * Áthangolás egy slot sávjára
+ */
+void BeaconMonitor::retune(uint32_t slot) {
+    uint8_t bandSlot = bandSlotFor(slot);
+
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_BEACON, true);
+    band.tuneTemporarySsb(bandIndexes[bandSlot], beaconFrequencies[bandSlot], CW, 0);
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_BEACON, false);
+    retunedAt = millis();
+
+    // Mennyivel a slot határa után (pozitív) vagy előtte (negatív) lettünk készen
+    int32_t late = (int32_t)radioClock.getMillisOfDay() - (int32_t)(slot * BEACON_SLOT_MS);
+    if (late > (int32_t)(RADIO_CLOCK_MS_PER_DAY / 2)) {
+        late -= RADIO_CLOCK_MS_PER_DAY; // Éjfél előtt hangoltunk a következő nap 0. slotjára
+    }
+    if (tunedSlot < 0 || late > maxRetuneLateMs) {
+        maxRetuneLateMs = late;
+    }
+
+    tunedSlot = slot;
+    tunedBandSlot = bandSlot;
+    peakRssi = 0;
+    peakSnr = 0;
+    peakValid = false;
+}
+
+/**
+ * A slot csúcsértékeinek rögzítése a mátrixban
+ */
+void BeaconMonitor::finishSlot() {
+    if (tunedSlot < 0 || !peakValid) {
+        return;
+    }
+
+    uint8_t beacon = beaconFor(tunedSlot, tunedBandSlot);
+    Measurement &m = latest[beacon][tunedBandSlot];
+    m.rssi = peakRssi;
+    m.snr = peakSnr;
+    m.minuteOfDay = (uint32_t)tunedSlot * BEACON_SLOT_MS / 60000UL;
+
+    uint8_t &head = historyHead[beacon][tunedBandSlot];
+    snrHistory[beacon][tunedBandSlot][head] = peakSnr;
+    head = (head + 1) % BEACON_HISTORY_DEPTH;
+
+    DEBUG("BeaconMonitor::finishSlot() -> %s @ %u kHz: RSSI %u, SNR %u\n", beaconCallsigns[beacon], beaconFrequencies[tunedBandSlot], peakRssi, peakSnr);
+
+    if (measurementCallback) {
+        measurementCallback(beacon, tunedBandSlot, m);
+    }
+}
+
+/**
+ * Arduino loop
+ */
+void BeaconMonitor::loop() {
+    if (!running) {
+        return;
+    }
+
+    uint32_t now = radioClock.getMillisOfDay();
+    uint32_t slot = now / BEACON_SLOT_MS;
+    uint32_t position = now % BEACON_SLOT_MS;
+
+    // A slot határa előtt átváltunk a következő slot sávjára, hogy a hívójel elejére már beálljon
+    if (position >= BEACON_SLOT_MS - BEACON_RETUNE_LEAD) {
+        uint32_t nextSlot = (slot + 1) % BEACON_SLOTS_PER_DAY;
+        if (tunedSlot != (int32_t)nextSlot) {
+            finishSlot();
+            retune(nextSlot);
+        }
+        return;
+    }
+
+    // Indításkor (vagy ha lemaradtunk) az aktuális slotra hangolunk
+    if (tunedSlot != (int32_t)slot) {
+        finishSlot();
+        retune(slot);
+        return;
+    }
+
+    // Csúcs RSSI/SNR a mérési ablakban, a mintavételező friss mintáiból
+    if (position < BEACON_MEASURE_START || position > BEACON_MEASURE_END) {
+        return;
+    }
+    SignalQualitySampler::Snapshot quality = signalQualitySampler.getSnapshot();
+    if (!quality.valid || quality.sampledAt == lastSampledAt) {
+        return;
+    }
+
+    // Csak a beállás (a mérési ablak kezdete, ill. a késve befejezett áthangolás) utáni minta számít
+    uint32_t settledAt = millis() - (position - BEACON_MEASURE_START);
+    if ((int32_t)(retunedAt - settledAt) > 0) {
+        settledAt = retunedAt;
+    }
+    if ((int32_t)(quality.sampledAt - settledAt) < 0) {
+        return;
+    }
+    lastSampledAt = quality.sampledAt;
+
+    peakRssi = max(peakRssi, quality.rssi);
+    peakSnr = max(peakSnr, quality.snr);
+    peakValid = true;
+}
@@ -0,0 +1,101 @@
+#include "ConfigSchema.h"
+
+#include <string.h>
+
+#include "defines.h"
+
+namespace ConfigSchema {
+
+/**
+ * Áthelyezett mezők: a régi tag -> a mező mostani tag-je
+ */
+static uint8_t currentTag(uint8_t storedTag) {
+    switch (storedTag) {
+        // case <régi tag>: return <új tag>;
+        default:
+            return storedTag;
+    }
+}
+
+/**
+ * Eltérő szélességű egész érték átváltása a mező mostani szélességére
+ */
+static bool convertInteger(const Field &field, const uint8_t *value, uint8_t length, uint8_t *target) {
+    if (length == 0 || length > sizeof(uint32_t)) {
+        return false;
+    }
+    uint32_t raw = 0;
+    memcpy(&raw, value, length); // Little endian
+    if (field.kind == Kind::Signed && length < sizeof(uint32_t) && (value[length - 1] & 0x80)) {
+        raw |= 0xFFFFFFFFUL << (length * 8); // Előjel kiterjesztés
+    }
+    memcpy(target, &raw, field.size);
+    return true;
+}
+
+/**
+ * A konfig kódolása a rekordba
+ */
+void encode(const Config_t &config, ConfigRecord_t &record) {
+    memset(&record, 0, sizeof(record));
+    const uint8_t *source = reinterpret_cast<const uint8_t *>(&config);
+    uint16_t pos = 0;
+    for (uint8_t i = 0; i < FIELD_COUNT; i++) {
+        const Field &field = fields[i];
+        if (field.kind == Kind::Removed) {
+            continue;
+        }
+        record.payload[pos++] = field.tag;
+        record.payload[pos++] = field.size;
+        memcpy(&record.payload[pos], source + field.offset, field.size);
+        pos += field.size;
+    }
+    record.header.version = CONFIG_SCHEMA_VERSION;
+    record.header.length = pos;
+}
+
+/**
+ * A rekord egyszeri bejárása
+ */
+bool decode(const ConfigRecord_t &record, Config_t &config) {
+    if (record.header.length > sizeof(record.payload)) {
+        DEBUG("ConfigSchema::decode() -> invalid length %u\n", record.header.length);
+        return false;
+    }
+
+    uint8_t *target = reinterpret_cast<uint8_t *>(&config);
+    uint8_t found = 0, skipped = 0;
+    uint16_t pos = 0;
+    while (pos < record.header.length) {
+        if (pos + 2 > record.header.length || pos + 2 + record.payload[pos + 1] > record.header.length) {
+            DEBUG("ConfigSchema::decode() -> truncated field at %u\n", pos);
+            return false;
+        }
+        uint8_t tag = currentTag(record.payload[pos]);
+        uint8_t length = record.payload[pos + 1];
+        const uint8_t *value = &record.payload[pos + 2];
+        pos += 2 + length;
+
+        // Ismeretlen (újabb firmware-ből származó) vagy törölt mező: átugorjuk
+        if (tag == 0 || tag > FIELD_COUNT || fields[tag - 1].kind == Kind::Removed) {
+            skipped++;
+            continue;
+        }
+
+        const Field &field = fields[tag - 1];
+        if (length == field.size) {
+            memcpy(target + field.offset, value, length);
+            found++;
+        } else if ((field.kind == Kind::Unsigned || field.kind == Kind::Signed) && convertInteger(field, value, length, target + field.offset)) {
+            found++;
+        } else {
+            DEBUG("ConfigSchema::decode() -> tag %u size %u != %u, default kept\n", tag, length, field.size);
+            skipped++;
+        }
+    }
+
+    DEBUG("ConfigSchema::decode() -> v%u: %u fields loaded, %u skipped, %u defaulted\n", record.header.version, found, skipped, FIELD_COUNT - min(found, FIELD_COUNT));
+    return true;
+}
+
+} // namespace ConfigSchema
@@ -0,0 +1,128 @@
+#include "Crc16.h"
+
+// A CRC számítás maga függőség nélküli (a natív tesztek is ezt fordítják), csak a DMA út kötődik az RP2040-hez
+#ifdef ARDUINO_ARCH_RP2040
+#include <hardware/dma.h>
+
+#include "defines.h"
+
+#define CRC16_SNIFF_MODE_CCITT 0x2 // DMA_SNIFF_CTRL_CALC: CRC-16-CCITT
+#endif
+
+namespace Crc16 {
+
+/**
+ * A byte-onkénti tábla, fordítási időben generálva (flash-ben marad)
+ */
+struct Table {
+    uint16_t values[256];
+    constexpr Table() : values() {
+        for (uint16_t i = 0; i < 256; i++) {
+            uint16_t crc = i << 8;
+            for (uint8_t j = 0; j < 8; j++) {
+                crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+            }
+            values[i] = crc;
+        }
+    }
+};
+static constexpr Table crcTable;
+static_assert(crcTable.values[1] == 0x1021 && crcTable.values[255] == 0x1EF0, "CRC16-CCITT table mismatch");
+
+#ifdef ARDUINO_ARCH_RP2040
+static int dmaChannel = -1;
+#endif
+static bool dmaReady = false;
+
+/**
+ * Bitenkénti (referencia) változat
+ */
+uint16_t bitwise(const uint8_t *data, size_t length, uint16_t crc) {
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i] << 8;
+        for (uint8_t j = 0; j < 8; j++) {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * Táblázatos változat: byte-onként egy tábla olvasás
+ */
+uint16_t table(const uint8_t *data, size_t length, uint16_t crc) {
+    for (size_t i = 0; i < length; i++) {
+        crc = (crc << 8) ^ crcTable.values[(crc >> 8) ^ data[i]];
+    }
+    return crc;
+}
+
+/**
+ * DMA sniffer változat: a DMA egy fix célcímre másol, a sniffer közben számolja a CRC-t
+ */
+uint16_t dma(const uint8_t *data, size_t length, uint16_t crc) {
+#ifdef ARDUINO_ARCH_RP2040
+    if (dmaChannel < 0 || length == 0) {
+        return table(data, length, crc);
+    }
+
+    static volatile uint8_t sink;
+    dma_channel_config channelConfig = dma_channel_get_default_config(dmaChannel);
+    channel_config_set_transfer_data_size(&channelConfig, DMA_SIZE_8);
+    channel_config_set_read_increment(&channelConfig, true);
+    channel_config_set_write_increment(&channelConfig, false);
+    channel_config_set_sniff_enable(&channelConfig, true);
+
+    dma_sniffer_set_data_accumulator(crc);
+    dma_sniffer_enable(dmaChannel, CRC16_SNIFF_MODE_CCITT, true);
+    dma_channel_configure(dmaChannel, &channelConfig, &sink, data, length, true);
+    dma_channel_wait_for_finish_blocking(dmaChannel);
+    uint16_t result = dma_sniffer_get_data_accumulator() & 0xFFFF;
+    dma_sniffer_disable();
+    return result;
+#else
+    return table(data, length, crc);
+#endif
+}
+
+/**
+ * DMA csatorna és önteszt
+ */
+bool init() {
+#ifdef ARDUINO_ARCH_RP2040
+    if (dmaChannel < 0) {
+        dmaChannel = dma_claim_unused_channel(false);
+    }
+    if (dmaChannel < 0) {
+        DEBUG("Crc16::init() -> no free DMA channel\n");
+        return false;
+    }
+
+    // A sniffer eredményét a táblázatos változathoz hasonlítjuk (bitsorrend, kezdőérték)
+    uint8_t probe[CRC16_DMA_THRESHOLD];
+    for (uint16_t i = 0; i < sizeof(probe); i++) {
+        probe[i] = i * 37 + 11;
+    }
+    dmaReady = dma(probe, sizeof(probe)) == table(probe, sizeof(probe)) && dma(probe, 7, 0x1234) == table(probe, 7, 0x1234);
+    if (!dmaReady) {
+        DEBUG("Crc16::init() -> DMA sniffer self-test failed, using the table\n");
+        dma_channel_unclaim(dmaChannel);
+        dmaChannel = -1;
+    }
+#endif
+    return dmaReady;
+}
+
+bool isDmaReady() { return dmaReady; }
+
+/**
+ * A méret alapján a leggyorsabb változat
+ */
+uint16_t calc(const uint8_t *data, size_t length, uint16_t crc) {
+    if (dmaReady && length >= CRC16_DMA_THRESHOLD) {
+        return dma(data, length, crc);
+    }
+    return table(data, length, crc);
+}
+
+} // namespace Crc16
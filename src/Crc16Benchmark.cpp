@@ -0,0 +1,45 @@
+#include "Crc16.h"
+
+#include "ConfigData.h"
+#include "StationData.h"
+#include "defines.h"
+
+namespace Crc16 {
+
+/**
+ * Egy változat mérése egy adott méretre (órajel ciklusban)
+ */
+static void measure(const char *name, uint16_t (*fn)(const uint8_t *, size_t, uint16_t), const uint8_t *data, size_t length, uint16_t expected) {
+    const uint8_t rounds = 16;
+    uint16_t crc = 0;
+    uint32_t start = rp2040.getCycleCount();
+    for (uint8_t i = 0; i < rounds; i++) {
+        crc = fn(data, length, 0xFFFF);
+    }
+    uint32_t elapsed = max((uint32_t)(rp2040.getCycleCount() - start) / rounds, (uint32_t)1);
+    DEBUG("  %-8s %5u bytes: %7lu cycle, %u.%03u bytes/cycle%s\n", name, (unsigned)length, (unsigned long)elapsed, (unsigned)(length / elapsed),
+          (unsigned)((length * 1000UL / elapsed) % 1000), crc == expected ? "" : " MISMATCH!");
+}
+
+/**
+ * Mérés a valódi tárolt méretekkel
+ */
+void benchmark() {
+    static uint8_t buffer[sizeof(PackedAmStationList_t)];
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = i * 131 + 7;
+    }
+
+    const size_t sizes[] = {sizeof(Config_t), sizeof(PackedFmStationList_t), sizeof(PackedAmStationList_t)};
+    DEBUG("CRC16 benchmark (%s):\n", isDmaReady() ? "DMA ready" : "no DMA");
+    for (size_t length : sizes) {
+        uint16_t expected = bitwise(buffer, length);
+        measure("bitwise", bitwise, buffer, length, expected);
+        measure("table", table, buffer, length, expected);
+        if (isDmaReady()) {
+            measure("dma", dma, buffer, length, expected);
+        }
+    }
+}
+
+} // namespace Crc16
@@ -10,8 +10,11 @@
 void DebugDataInspector::printFmStationData(const FmStationList_t &fmData) {
 #ifdef __DEBUG
     DEBUG("=== DebugDataInspector -> FM Station Store ===\n");
-    for (size_t i = 0; i < fmData.count; ++i) {
+    for (size_t i = 0; i < sizeof(fmData.stations) / sizeof(fmData.stations[0]); ++i) {
         const StationData &station = fmData.stations[i];
+        if (station.frequency == 0) {
+            continue; // Szabad slot
+        }
         DEBUG("  Station %d: Freq: %d, Name: %s, Mod: %d, BFO: %d, BW: %d\n", i, station.frequency, station.name, station.modulation, station.bfoOffset, station.bandwidthIndex);
     }
     DEBUG("====================\n");
@@ -25,8 +28,11 @@ void DebugDataInspector::printFmStationData(const FmStationList_t &fmData) {
 void DebugDataInspector::printAmStationData(const AmStationList_t &amData) {
 #ifdef __DEBUG
     Serial.println("=== DebugDataInspector -> AM Station Store ===");
-    for (size_t i = 0; i < amData.count; ++i) {
+    for (size_t i = 0; i < sizeof(amData.stations) / sizeof(amData.stations[0]); ++i) {
         const StationData &station = amData.stations[i];
+        if (station.frequency == 0) {
+            continue; // Szabad slot
+        }
         DEBUG("  Station %d: Freq: %d, Name: %s, Mod: %d, BFO: %d, BW: %d\n", i, station.frequency, station.name, station.modulation, station.bfoOffset, station.bandwidthIndex);
     }
     DEBUG("====================\n");
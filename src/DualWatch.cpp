@@ -0,0 +1,195 @@
+#include "DualWatch.h"
+
+#include "SignalQualitySampler.h"
+#include "defines.h"
+#include "rtVars.h"
+
+/**
+ * Konstruktor
+ */
+DualWatch::DualWatch(Si4735Ext &si4735, Band &band) : si4735(si4735), band(band) {}
+
+/**
+ * Indítás
+ */
+bool DualWatch::start(uint16_t secondary) {
+    BandTable &currentBand = band.getCurrentBand();
+    if (secondary < currentBand.minimumFreq || secondary > currentBand.maximumFreq || secondary == currentBand.currFreq) {
+        DEBUG("DualWatch::start() -> invalid secondary frequency %u\n", secondary);
+        return false;
+    }
+
+    bandIdx = config.data.bandIdx;
+    primaryFreq = currentBand.currFreq;
+    secondaryFreq = secondary;
+    activeCount = 0;
+    lastProbe = millis();
+    state = State::Primary;
+
+    DEBUG("DualWatch::start() -> %u / %u, interval %u ms\n", primaryFreq, secondaryFreq, interval);
+    return true;
+}
+
+/**
+ * Leállítás
+ */
+void DualWatch::stop() {
+    if (state == State::Secondary && config.data.bandIdx == bandIdx) {
+        listenTo(primaryFreq);
+    }
+    state = State::Off;
+}
+
+/**
+ * Szabad-e a tuner (a többi háttér feladat és a felhasználó nem használja)
+ */
+bool DualWatch::isTunerFree() const { return !rtv::SEEK && !rtv::SCANbut && !rtv::BEACON && !signalQualitySampler.isTunerBusy(); }
+
+/**
+ * Aktív-e a csatorna: ha van squelch, annak a szintje dönt, egyébként a fix küszöbök
+ */
+bool DualWatch::isActive(uint8_t rssi, uint8_t snr) const {
+    if (config.data.currentSquelch > 0) {
+        return (config.data.squelchUsesRSSI ? rssi : snr) >= config.data.currentSquelch;
+    }
+    return rssi >= DUALWATCH_ACTIVE_RSSI && snr >= DUALWATCH_ACTIVE_SNR;
+}
+
+/**
+ * Áthangolás fix időkerettel, csak a frekvencia és az antenna kapacitás változik
+ * Az RSSI/SNR a hangolás végi státuszból jön, nincs külön RSQ lekérdezés
+ */
+bool DualWatch::tune(uint16_t freq, uint8_t &rssi, uint8_t &snr) {
+    band.applyAntCap(freq);
+    si4735.setFrequencyNoWait(freq);
+    if (!si4735.waitTuneComplete(DUALWATCH_PROBE_BUDGET)) {
+        return false;
+    }
+    rssi = si4735.getReceivedSignalStrengthIndicator();
+    snr = si4735.getStatusSNR();
+    return true;
+}
+
+/**
+ * A hallgatott frekvencia váltása: csak a chipet hangoljuk (a sáv, a mód és a BFO marad)
+ * A band rekord frekvenciája végig az elsődleges, így a konfig nem változik és a felhasználó hangolása felismerhető
+ * A mintavételező a régi frekvencia mintáit eldobja, az új frekvenciáé azonnal jön
+ */
+void DualWatch::listenTo(uint16_t freq) {
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_DUALWATCH, true);
+    band.applyAntCap(freq);
+    si4735.setFrequency(freq);
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_DUALWATCH, false);
+    signalQualitySampler.invalidate();
+}
+
+/**
+ * Rövid némított próba a másodlagos frekvencián
+ */
+void DualWatch::probe() {
+    uint32_t startMicros = micros();
+
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_DUALWATCH, true);
+    si4735.setHardwareAudioMute(true);
+
+    uint8_t rssi, snr;
+    bool measured = tune(secondaryFreq, rssi, snr);
+
+    uint8_t dummyRssi, dummySnr;
+    tune(primaryFreq, dummyRssi, dummySnr);
+    if (band.getCurrentBandType() == FM_BAND_TYPE) {
+        si4735.flushRdsFifo(); // A próba alatt érkezett csoportok nem a mi állomásunkéi
+    }
+
+    si4735.setHardwareAudioMute(false);
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_DUALWATCH, false);
+
+    lastGapMicros = micros() - startMicros;
+    maxGapMicros = max(maxGapMicros, lastGapMicros);
+    probeCount++;
+
+    if (!measured) {
+        return;
+    }
+    secondaryRssi = rssi;
+    secondarySnr = snr;
+
+    activeCount = isActive(rssi, snr) ? activeCount + 1 : 0;
+    if (activeCount >= DUALWATCH_CONFIRM_COUNT) {
+        DEBUG("DualWatch::probe() -> %u active (RSSI %u, SNR %u), switching\n", secondaryFreq, rssi, snr);
+        listenTo(secondaryFreq);
+        lastActive = millis();
+        lastProbe = millis();
+        activeCount = 0;
+        state = State::Secondary;
+    }
+}
+
+/**
+ * A másodlagos csatorna figyelése, amíg hallgatjuk
+ */
+void DualWatch::checkSecondary() {
+    if (millis() - lastProbe < DUALWATCH_CHECK_INTERVAL) {
+        return;
+    }
+
+    // A hallgatott csatorna jelszintje a közös mintavételezőtől (az áthangolás utáni első mintáig nem döntünk)
+    SignalQualitySampler::Snapshot quality = signalQualitySampler.getSnapshot();
+    if (!quality.valid) {
+        return;
+    }
+    lastProbe = millis();
+
+    secondaryRssi = quality.rssi;
+    secondarySnr = quality.snr;
+    if (isActive(secondaryRssi, secondarySnr)) {
+        lastActive = millis();
+        return;
+    }
+
+    if (millis() - lastActive >= DUALWATCH_HANG_TIME) {
+        DEBUG("DualWatch::checkSecondary() -> %u quiet, back to %u\n", secondaryFreq, primaryFreq);
+        listenTo(primaryFreq);
+        lastProbe = millis();
+        state = State::Primary;
+    }
+}
+
+/**
+ * Arduino loop
+ */
+void DualWatch::loop() {
+    if (state == State::Off) {
+        return;
+    }
+
+    // Sávváltáskor leállunk
+    if (config.data.bandIdx != bandIdx) {
+        state = State::Off;
+        return;
+    }
+
+    if (!isTunerFree()) {
+        return;
+    }
+
+    if (state == State::Secondary) {
+        // Ha a felhasználó közben elhangolt (a band rekord az elsődlegesen állt), az lesz az új elsődleges
+        if (band.getCurrentBand().currFreq != primaryFreq) {
+            primaryFreq = band.getCurrentBand().currFreq;
+            lastProbe = millis();
+            state = State::Primary;
+            return;
+        }
+        checkSecondary();
+        return;
+    }
+
+    // Az elsődleges követi a felhasználó hangolását
+    primaryFreq = band.getCurrentBand().currFreq;
+    if (primaryFreq == secondaryFreq || millis() - lastProbe < interval) {
+        return;
+    }
+    lastProbe = millis();
+    probe();
+}
@@ -0,0 +1,419 @@
+#include "FMSceen.h"
+
+#include "Config.h"
+#include "RadioClock.h"
+#include "SignalQualitySampler.h"
+#include "rtVars.h"
+
+/**
+ * Adásban van-e most egy adatbázis rekord (szinkronizált óra nélkül nem szűrünk időre)
+ */
+static bool isOnAirNow(const StationDatabase::Record &record) {
+    if (!radioClock.isSynced()) {
+        return true;
+    }
+    return record.isOnAir(radioClock.getMillisOfDay() / 60000UL, radioClock.getWeekday());
+}
+
+/**
+ * Konstruktor (a Si4735Utils a sávot is beállítja)
+ */
+FMScreen::FMScreen(TFT_eSPI &tft) : UIScreen(tft, FMScreen::SCREEN_NAME), Si4735Utils(si4735, band) { layoutComponents(); }
+
+/**
+ * Egy gomb elhelyezése a képernyő alján lévő gombsorokban (balról jobbra, felülről lefelé)
+ */
+std::shared_ptr<UIButton> FMScreen::addButton(uint8_t id, const char *label, UIButton::ButtonType type) {
+    const int16_t buttonWidth = UIButton::DEFAULT_BUTTON_WIDTH;
+    const int16_t buttonHeight = UIButton::DEFAULT_BUTTON_HEIGHT;
+    const uint8_t buttonsPerRow = (tft.width() - 2 * BUTTON_MARGIN + BUTTON_GAP) / (buttonWidth + BUTTON_GAP);
+
+    uint8_t row = buttonCount / buttonsPerRow;
+    uint8_t column = buttonCount % buttonsPerRow;
+    buttonCount++;
+
+    int16_t x = BUTTON_MARGIN + column * (buttonWidth + BUTTON_GAP);
+    int16_t y = tft.height() - BUTTON_MARGIN - (BUTTON_ROWS - row) * buttonHeight - (BUTTON_ROWS - 1 - row) * BUTTON_GAP;
+
+    std::shared_ptr<UIButton> button = std::make_shared<UIButton>(tft, id, Rect(x, y), label, type);
+    button->setEventCallback([this](const UIButton::ButtonEvent &event) { this->handleButtonEvent(event); });
+    addChild(button);
+    return button;
+}
+
+/**
+ * UI komponensek létrehozása és elhelyezése
+ */
+void FMScreen::layoutComponents() {
+    // Seek lefelé / felfelé
+    addButton(BUTTON_ID_SEEK_DOWN, "Seek-");
+    addButton(BUTTON_ID_SEEK_UP, "Seek+");
+
+    // Memória scan: be / ki
+    scanButton = addButton(BUTTON_ID_SCAN, "Scan", UIButton::ButtonType::Toggleable);
+
+    // Antenna kapacitás: rövid nyomás az aktuális frekvencia, hosszú nyomás a teljes sáv
+    antCapButton = addButton(BUTTON_ID_ANTCAP, "ACap");
+
+    // Sáv aktivitás rögzítés: be / ki, bekapcsolva a heat-map is látszik
+    activityButton = addButton(BUTTON_ID_ACTIVITY, "Activ", UIButton::ButtonType::Toggleable);
+    activityHeatMap = std::make_shared<ActivityHeatMap>(tft, Rect(BUTTON_MARGIN, HEAT_MAP_Y, tft.width() - 2 * BUTTON_MARGIN, HEAT_MAP_HEIGHT), activityRecorder);
+    activityHeatMap->setVisible(activityRecorder.isEnabled());
+    addChild(activityHeatMap);
+
+    // Beacon figyelés: be / ki (pontos UTC idő kell)
+    beaconButton = addButton(BUTTON_ID_BEACON, "Becn", UIButton::ButtonType::Toggleable);
+
+    // FM állomáslista automatikus feltöltése: indítás / megszakítás
+    autoStoreButton = addButton(BUTTON_ID_AUTOSTORE, "AutoSt", UIButton::ButtonType::Toggleable);
+
+    // Kettős figyelés: hosszú nyomás a hallgatott frekvenciát jegyzi meg másodlagosnak, rövid nyomás be / ki
+    dualWatchButton = addButton(BUTTON_ID_DUALWATCH, "DWtch", UIButton::ButtonType::Toggleable);
+
+    // Az adatbázis szerint most adó állomás egy másik frekvenciája (ugyanabban a sávban)
+    addButton(BUTTON_ID_ALTFREQ, "AltF");
+}
+
+/**
+ * A felhasználó veszi át a hangolást: a scan, az automatikus tárolás és a beacon figyelés leáll
+ */
+void FMScreen::stopBackgroundTuning() {
+    memoryScanner.stop();
+    fmAutoStore.cancel();
+    beaconMonitor.stop();
+}
+
+/**
+ * Gomb események
+ */
+void FMScreen::handleButtonEvent(const UIButton::ButtonEvent &event) {
+    DEBUG("FMScreen: button event! ID: %d, Label: '%s', State: %s\n", event.id, event.label.c_str(), UIButton::buttonStateToString(event.state));
+
+    switch (event.id) {
+
+    case BUTTON_ID_SEEK_DOWN:
+    case BUTTON_ID_SEEK_UP:
+        if (event.state == UIButton::ButtonState::Pressed) {
+            stopBackgroundTuning();
+            seekEngine.start(event.id == BUTTON_ID_SEEK_UP);
+        }
+        break;
+
+    case BUTTON_ID_ANTCAP:
+        // Blokkoló mérés, seek/scan/beacon közben nincs értelme (a frekvencia úgyis változik)
+        if (seekEngine.isRunning() || memoryScanner.isRunning() || beaconMonitor.isRunning()) {
+            break;
+        }
+        if (event.state == UIButton::ButtonState::Pressed) {
+            antCapTuner.tuneCurrentFrequency();
+        } else if (event.state == UIButton::ButtonState::LongPressed) {
+            antCapTuner.tuneCurrentBand();
+        }
+        break;
+
+    case BUTTON_ID_SCAN:
+        if (event.state == UIButton::ButtonState::On) {
+            stopBackgroundTuning();
+            memoryScanner.start();
+        } else if (event.state == UIButton::ButtonState::Off) {
+            memoryScanner.stop();
+        }
+        break;
+
+    case BUTTON_ID_BEACON:
+        if (event.state == UIButton::ButtonState::On) {
+            seekEngine.abort();
+            stopBackgroundTuning();
+            beaconMonitor.start();
+        } else if (event.state == UIButton::ButtonState::Off) {
+            beaconMonitor.stop();
+        }
+        break;
+
+    case BUTTON_ID_DUALWATCH:
+        if (event.state == UIButton::ButtonState::LongPressed) {
+            dualWatch.stop();
+            dualWatchSecondary = band.getCurrentBand().currFreq;
+        } else if (event.state == UIButton::ButtonState::On) {
+            // A másodlagos frekvencia sávon kívüli (vagy még nincs megadva) -> a start elutasítja
+            dualWatch.start(dualWatchSecondary);
+        } else if (event.state == UIButton::ButtonState::Off) {
+            dualWatch.stop();
+        }
+        break;
+
+    case BUTTON_ID_ALTFREQ:
+        if (event.state == UIButton::ButtonState::Pressed) {
+            tuneAlternativeFrequency();
+        }
+        break;
+
+    case BUTTON_ID_AUTOSTORE:
+        if (event.state == UIButton::ButtonState::On) {
+            seekEngine.abort();
+            stopBackgroundTuning();
+            fmAutoStore.start();
+        } else if (event.state == UIButton::ButtonState::Off) {
+            fmAutoStore.cancel();
+        }
+        break;
+
+    case BUTTON_ID_ACTIVITY:
+        if (event.state == UIButton::ButtonState::On || event.state == UIButton::ButtonState::Off) {
+            bool enable = event.state == UIButton::ButtonState::On;
+            activityRecorder.setEnabled(enable);
+            activityHeatMap->setVisible(enable);
+            if (!enable) {
+                markForRedraw(); // A heat-map helyét a teljes újrarajzolás törli
+            }
+        }
+        break;
+    }
+
+    // A funkció el is utasíthatta az indítást (pl. nincs tárolt állomás)
+    updateButtonStates();
+}
+
+/**
+ * A váltógombok állapota a funkciók tényleges állapotát követi (azok maguktól is leállhatnak)
+ */
+void FMScreen::updateButtonStates() {
+    scanButton->setButtonState(memoryScanner.isRunning() ? UIButton::ButtonState::On : UIButton::ButtonState::Off);
+    dualWatchButton->setButtonState(dualWatch.isRunning() ? UIButton::ButtonState::On : UIButton::ButtonState::Off);
+    autoStoreButton->setButtonState(fmAutoStore.isRunning() ? UIButton::ButtonState::On : UIButton::ButtonState::Off);
+    beaconButton->setButtonState(beaconMonitor.isRunning() ? UIButton::ButtonState::On : UIButton::ButtonState::Off);
+    activityButton->setButtonState(activityRecorder.isEnabled() ? UIButton::ButtonState::On : UIButton::ButtonState::Off);
+
+    // A hosszú nyomás utáni felengedés a nyomógombot is On-ba teszi
+    if (antCapButton->getButtonState() == UIButton::ButtonState::On) {
+        antCapButton->setButtonState(UIButton::ButtonState::Off);
+    }
+}
+
+/**
+ * Az aktuális frekvencián most adó állomás neve az adatbázisból (AM sávokon, az adatbázis kHz-ben tárol)
+ * Csak frekvencia váltáskor és percenként kérdezünk, a rotary tekerése közben nem
+ */
+void FMScreen::updateDatabaseStation() {
+    BandTable &currentBand = band.getCurrentBand();
+    if (currentBand.bandType == FM_BAND_TYPE || !stationDatabase.isReady()) {
+        dbStationName[0] = '\0';
+        dbLookupFreq = 0;
+        return;
+    }
+    uint16_t minute = radioClock.getMillisOfDay() / 60000UL;
+    if (tuningEngine.isPending() || (currentBand.currFreq == dbLookupFreq && minute == dbLookupMinute)) {
+        return;
+    }
+    dbLookupFreq = currentBand.currFreq;
+    dbLookupMinute = minute;
+
+    dbStationName[0] = '\0';
+    stationDatabase.findByFrequency(
+        dbLookupFreq, dbLookupFreq,
+        [](const StationDatabase::Record &record, uint16_t recordNo, void *context) {
+            if (!isOnAirNow(record)) {
+                return true;
+            }
+            strcpy(static_cast<char *>(context), record.name);
+            return false; // Az első adásban lévő elég
+        },
+        dbStationName);
+}
+
+/**
+ * Ugrás az adatbázis szerint most adó állomás következő frekvenciájára az aktuális sávban (körbe)
+ */
+void FMScreen::tuneAlternativeFrequency() {
+    if (dbStationName[0] == '\0') {
+        return;
+    }
+
+    // A név index szerint az azonos nevű, most adó rekordok közül a következő nagyobb, vagy a legkisebb frekvencia
+    struct Alternatives {
+        const char *name;
+        uint16_t current, minimumFreq, maximumFreq;
+        uint16_t next, lowest; // 0: nincs
+    };
+    BandTable &currentBand = band.getCurrentBand();
+    Alternatives alternatives = {dbStationName, currentBand.currFreq, currentBand.minimumFreq, currentBand.maximumFreq, 0, 0};
+    stationDatabase.findByNamePrefix(
+        dbStationName,
+        [](const StationDatabase::Record &record, uint16_t recordNo, void *context) {
+            Alternatives &a = *static_cast<Alternatives *>(context);
+            if (strcasecmp(record.name, a.name) != 0 || record.frequency == a.current || record.frequency < a.minimumFreq || record.frequency > a.maximumFreq ||
+                !isOnAirNow(record)) {
+                return true;
+            }
+            if (record.frequency > a.current && (a.next == 0 || record.frequency < a.next)) {
+                a.next = record.frequency;
+            }
+            if (a.lowest == 0 || record.frequency < a.lowest) {
+                a.lowest = record.frequency;
+            }
+            return true;
+        },
+        &alternatives);
+
+    uint16_t target = alternatives.next != 0 ? alternatives.next : alternatives.lowest;
+    if (target == 0) {
+        DEBUG("FMScreen: no other frequency for %s\n", dbStationName);
+        return;
+    }
+
+    stopBackgroundTuning();
+    uint8_t bandwidthIndex = (currentBand.currMod == AM) ? config.data.bwIdxAM : config.data.bwIdxSSB;
+    band.tuneMemoryStation(target, config.data.currentBFO, config.data.bandIdx, currentBand.currMod, bandwidthIndex);
+    tuningEngine.invalidate();
+}
+
+/**
+ * Rotary encoder esemény
+ */
+bool FMScreen::handleRotary(const RotaryEvent &event) {
+    DEBUG("FMScreen handleRotary: direction=%d, button=%d, value=%d\n", (int)event.direction, (int)event.buttonState, event.value);
+
+    // Bármilyen rotary esemény megszakítja a futó seek-et
+    if (seekEngine.abort()) {
+        return true;
+    }
+
+    if (event.direction != RotaryEvent::Direction::None) {
+        // Tekerésre a háttérben hangoló funkciók leállnak, a felhasználó veszi át a hangolást
+        if (memoryScanner.isRunning() || fmAutoStore.isRunning() || beaconMonitor.isRunning()) {
+            stopBackgroundTuning();
+            updateButtonStates();
+        }
+
+        // A gyorsított lépésszámot a hangolás motor vonja össze
+        int16_t steps = event.value != 0 ? event.value : (event.direction == RotaryEvent::Direction::Up ? 1 : -1);
+        tuningEngine.addSteps(steps);
+        return true;
+    }
+
+    // Rotary gombnyomás: scan közben szünet / folytatás
+    if (event.buttonState == RotaryEvent::ButtonState::Clicked) {
+        if (memoryScanner.isRunning()) {
+            memoryScanner.setPaused(memoryScanner.getState() != MemoryScanner::State::Paused);
+        }
+        return true;
+    }
+
+    // Ha nem kezeltük, továbbítjuk a szülő implementációnak (gyerekkomponenseknek)
+    return UIScreen::handleRotary(event);
+}
+
+/**
+ * Érintés: seek közben az első érintés csak megszakít
+ */
+bool FMScreen::handleOwnTouch(const TouchEvent &event) { return event.pressed && seekEngine.abort(); }
+
+/**
+ * Loop: a chip kezelés és a háttér funkciók
+ */
+void FMScreen::handleOwnLoop() {
+    Si4735Utils::loop();
+    updateButtonStates();
+    updateDatabaseStation();
+}
+
+/**
+ * Teljes újrarajzolás esetén (képernyő törlés) minden sort újra ki kell rajzolni
+ */
+void FMScreen::draw() {
+    if (needsRedraw) {
+        drawnBand[0] = drawnFrequency[0] = drawnRds[0] = drawnStatus[0] = '\0';
+    }
+    UIScreen::draw();
+}
+
+/**
+ * A frekvencia kijelzés szövege (FM: MHz, AM: kHz, SSB/CW: kHz Hz felbontással)
+ */
+void FMScreen::formatFrequency(char *buffer, size_t size) {
+    BandTable &currentBand = band.getCurrentBand();
+
+    if (currentBand.bandType == FM_BAND_TYPE) {
+        snprintf(buffer, size, "%u.%02u MHz", currentBand.currFreq / 100, currentBand.currFreq % 100);
+    } else if (Band::getModeFamily(currentBand.currMod) == BAND_MODE_FAMILY_SSB) {
+        int32_t hz = (int32_t)currentBand.currFreq * 1000 + config.data.currentBFO;
+        snprintf(buffer, size, "%ld.%03ld kHz", (long)(hz / 1000), (long)(hz % 1000));
+    } else {
+        snprintf(buffer, size, "%u kHz", currentBand.currFreq);
+    }
+}
+
+/**
+ * Az állapot sor szövege: a futó funkció és a jelminőség
+ */
+void FMScreen::formatStatus(char *buffer, size_t size) {
+    char activity[24] = "";
+    const char *callsign = beaconMonitor.getTunedCallsign();
+    if (callsign) {
+        snprintf(activity, sizeof(activity), "%s %u kHz ", callsign, beaconMonitor.getTunedFrequency());
+    } else if (beaconMonitor.isRunning()) {
+        strcpy(activity, "Beacon ");
+    } else if (stationDatabase.isImporting()) {
+        snprintf(activity, sizeof(activity), "DB import %u%% ", stationDatabase.getImportProgress());
+    } else if (fmAutoStore.isRunning()) {
+        snprintf(activity, sizeof(activity), "AutoStore %u%% ", fmAutoStore.getProgress());
+    } else if (seekEngine.isRunning()) {
+        strcpy(activity, "Seek ");
+    } else if (memoryScanner.isRunning()) {
+        strcpy(activity, memoryScanner.getState() == MemoryScanner::State::Paused ? "Scan paused " : "Scan ");
+    } else if (dualWatch.isRunning()) {
+        // A másodlagos frekvencia, és hogy éppen azt hallgatjuk-e
+        uint16_t secondary = dualWatch.getSecondaryFrequency();
+        const char *listening = dualWatch.getState() == DualWatch::State::Secondary ? "RX " : "";
+        if (band.getCurrentBandType() == FM_BAND_TYPE) {
+            snprintf(activity, sizeof(activity), "DW %u.%02u %s", secondary / 100, secondary % 100, listening);
+        } else {
+            snprintf(activity, sizeof(activity), "DW %u %s", secondary, listening);
+        }
+    }
+
+    SignalQualitySampler::Snapshot quality = signalQualitySampler.getSnapshot();
+    if (quality.valid) {
+        snprintf(buffer, size, "%sRSSI %u dBuV  SNR %u dB", activity, quality.rssiAvg, quality.snrAvg);
+    } else {
+        snprintf(buffer, size, "%s", activity);
+    }
+}
+
+/**
+ * Egy szöveges sor kirajzolása, ha a tartalma változott
+ */
+void FMScreen::drawLine(char *drawn, size_t drawnSize, const char *text, int16_t y, uint8_t textSize, uint16_t color) {
+    if (strcmp(drawn, text) == 0) {
+        return;
+    }
+    strncpy(drawn, text, drawnSize - 1);
+    drawn[drawnSize - 1] = '\0';
+
+    // A régi szöveget a sor teljes szélességében töröljük (a hossza eltérhet)
+    tft.fillRect(0, y - textSize * 4, tft.width(), textSize * 8 + 2, TFT_COLOR_BACKGROUND);
+    tft.setTextDatum(MC_DATUM);
+    tft.setTextColor(color, TFT_COLOR_BACKGROUND);
+    tft.setTextSize(textSize);
+    tft.drawString(text, tft.width() / 2, y);
+}
+
+/**
+ * Kirajzolja a képernyő saját tartalmát
+ */
+void FMScreen::drawSelf() {
+    char text[48];
+
+    snprintf(text, sizeof(text), "%s  %s", band.getCurrentBandName(), band.getCurrentBandModeDesc());
+    drawLine(drawnBand, sizeof(drawnBand), text, LINE_BAND_Y, 2, TFT_CYAN);
+
+    formatFrequency(text, sizeof(text));
+    drawLine(drawnFrequency, sizeof(drawnFrequency), text, LINE_FREQUENCY_Y, 4, TFT_WHITE);
+
+    // FM-en az RDS PS név, AM sávokon az adatbázis szerint most adó állomás
+    const char *stationName = band.getCurrentBandType() == FM_BAND_TYPE ? getCurrentRdsProgramService() : dbStationName;
+    drawLine(drawnRds, sizeof(drawnRds), stationName, LINE_RDS_Y, 2, TFT_YELLOW);
+
+    formatStatus(text, sizeof(text));
+    drawLine(drawnStatus, sizeof(drawnStatus), text, LINE_STATUS_Y, 1, TFT_GREEN);
+}
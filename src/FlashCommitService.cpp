@@ -0,0 +1,239 @@
+#include "FlashCommitService.h"
+
+#include <EEPROM.h>
+#include <hardware/sync.h>
+
+#include "defines.h"
+#include "rtVars.h"
+
+// Az arduino-pico linker szkript szimbóluma (az EEPROM emuláció szektora)
+extern "C" uint8_t _EEPROM_start;
+
+// Globális példány
+FlashCommitService flashCommitService;
+
+/**
+ * Az EEPROMClass védett "módosult" jelzőjének elérése (a commit() helyett mi írunk, utána ezt töröljük,
+ * különben egy későbbi EEPROM.commit()/end() újra kiírná a szektort)
+ */
+struct EepromDirtyFlag : EEPROMClass {
+    static void clear(EEPROMClass &eeprom) { eeprom.*(&EepromDirtyFlag::_dirty) = false; }
+};
+
+/**
+ * Egy művelet végrehajtása a másik mag leállítása és a megszakítások tiltása mellett
+ * RAM-ból fut: a törlés/programozás alatt az XIP nem elérhető
+ * @return Az akadás ideje (us)
+ */
+uint32_t __not_in_flash_func(FlashCommitService::execute)(const Op &op) {
+    uint32_t start = micros();
+    noInterrupts();
+    rp2040.idleOtherCore();
+    if (op.type == OpType::Program) {
+        flash_range_program(op.flashOffset, op.source, FLASH_PAGE_SIZE);
+    } else {
+        flash_range_erase(op.flashOffset, FLASH_SECTOR_SIZE);
+        if (op.type == OpType::EepromCommit) {
+            // A törlés után azonnal, ugyanabban a tiltott szakaszban: nincs félig írt állapot a lapok között
+            flash_range_program(op.flashOffset, op.source, eepromLength);
+        }
+    }
+    rp2040.resumeOtherCore();
+    interrupts();
+    return micros() - start;
+}
+
+/**
+ * A sor első műveletének végrehajtása, statisztikával
+ */
+void FlashCommitService::runNext() {
+    Op op = queueAt(0);
+    uint32_t stallUs = execute(op);
+    queueHead = (queueHead + 1) % FLASH_COMMIT_QUEUE_SIZE;
+    queueCount--;
+    if (op.image >= 0) {
+        imageUsed[op.image] = false;
+    }
+
+    stats.totalStallUs += stallUs;
+    if (isEraseLike(op)) {
+        stats.sectorsErased++;
+        if (op.type == OpType::EepromCommit) {
+            eepromCommitQueued = false; // Az ezutáni EEPROM változás új commit-ot kér
+            stats.pagesProgrammed += eepromLength / FLASH_PAGE_SIZE;
+        }
+        if (stallUs > stats.maxEraseStallUs) {
+            stats.maxEraseStallUs = stallUs;
+            DEBUG("FlashCommitService: new max erase stall %lu us\n", stallUs);
+        }
+    } else {
+        stats.pagesProgrammed++;
+        if (stallUs > stats.maxProgramStallUs) {
+            stats.maxProgramStallUs = stallUs;
+            DEBUG("FlashCommitService: new max program stall %lu us\n", stallUs);
+        }
+    }
+
+    if (op.done != nullptr) {
+        op.done(op.context, op.flashOffset);
+    }
+}
+
+/**
+ * Művelet a sor végére (betelt sornál a legrégebbi azonnal lefut)
+ */
+void FlashCommitService::enqueue(const Op &op) {
+    while (queueCount >= FLASH_COMMIT_QUEUE_SIZE) {
+        stats.forcedOps++;
+        runNext();
+    }
+    queueAt(queueCount++) = op;
+}
+
+/**
+ * Szabad lap kép (ha nincs, a sor elejéről addig hajtunk végre, amíg fel nem szabadul egy)
+ */
+int8_t FlashCommitService::allocImage() {
+    while (true) {
+        for (uint8_t i = 0; i < FLASH_COMMIT_PAGE_IMAGES; i++) {
+            if (!imageUsed[i]) {
+                imageUsed[i] = true;
+                return i;
+            }
+        }
+        stats.forcedOps++;
+        runNext();
+    }
+}
+
+/**
+ * Lap programozás sorba állítása
+ */
+void FlashCommitService::queueProgram(uint32_t flashOffset, const uint8_t *page) {
+    // Ha a lap már sorban áll (és nincs utána törlés), a NOR flash AND szemantikája szerint összevonjuk
+    for (int8_t n = queueCount - 1; n >= 0; n--) {
+        Op &op = queueAt(n);
+        if (isEraseLike(op) && flashOffset - op.flashOffset < FLASH_SECTOR_SIZE) {
+            break;
+        }
+        if (op.type == OpType::Program && op.image >= 0 && op.flashOffset == flashOffset) {
+            for (uint16_t i = 0; i < FLASH_PAGE_SIZE; i++) {
+                images[op.image][i] &= page[i];
+            }
+            stats.pagesMerged++;
+            return;
+        }
+    }
+
+    int8_t image = allocImage();
+    memcpy(images[image], page, FLASH_PAGE_SIZE);
+    uint32_t now = millis();
+    enqueue({OpType::Program, image, flashOffset, images[image], now, nullptr, nullptr});
+}
+
+/**
+ * Szektor törlés sorba állítása
+ */
+void FlashCommitService::queueErase(uint32_t flashOffset, Callback done, void *context) {
+    uint32_t now = millis();
+    enqueue({OpType::Erase, -1, flashOffset, nullptr, now, done, context});
+}
+
+/**
+ * Azonnali szektor törlés
+ */
+void FlashCommitService::eraseNow(uint32_t flashOffset) {
+    flush(); // A sorrend miatt a korábbi írások előbb
+    queueErase(flashOffset);
+    runNext();
+}
+
+/**
+ * Az EEPROM puffer kiírása: a puffer pillanatképe, majd egyetlen törlés + programozás művelet
+ * (az arduino-pico EEPROM emulációja egy teljes szektort használ, a puffer ennek az eleje)
+ */
+void FlashCommitService::commitEeprom() {
+    if (eepromSnapshot == nullptr) {
+        eepromLength = min((size_t)EEPROM.length(), (size_t)FLASH_SECTOR_SIZE);
+        eepromSnapshot = new uint8_t[eepromLength];
+    }
+    // A sorban álló (még el nem kezdett) commit is a frissített pillanatképet írja ki
+    memcpy(eepromSnapshot, EEPROM.getConstDataPtr(), eepromLength);
+    EepromDirtyFlag::clear(EEPROM);
+    if (eepromCommitQueued) {
+        return;
+    }
+    uint32_t now = millis();
+    enqueue({OpType::EepromCommit, -1, (uint32_t)(&_EEPROM_start - (uint8_t *)XIP_BASE), eepromSnapshot, now, nullptr, nullptr});
+    eepromCommitQueued = true;
+}
+
+/**
+ * Olvasás a sorban álló műveletekkel együtt (sorrendben: törlés -> 0xFF, programozás -> AND, EEPROM commit -> a pillanatkép)
+ */
+void FlashCommitService::read(uint32_t flashOffset, void *data, uint16_t length) const {
+    uint8_t *bytes = reinterpret_cast<uint8_t *>(data);
+    memcpy(bytes, reinterpret_cast<const uint8_t *>(XIP_BASE + flashOffset), length);
+
+    for (uint8_t n = 0; n < queueCount; n++) {
+        const Op &op = queueAt(n);
+        uint32_t opSize = isEraseLike(op) ? FLASH_SECTOR_SIZE : FLASH_PAGE_SIZE;
+        uint32_t from = max(flashOffset, op.flashOffset);
+        uint32_t to = min(flashOffset + length, op.flashOffset + opSize);
+        for (uint32_t a = from; a < to; a++) {
+            uint8_t &byte = bytes[a - flashOffset];
+            switch (op.type) {
+            case OpType::Erase:
+                byte = 0xFF;
+                break;
+            case OpType::Program:
+                byte &= op.source[a - op.flashOffset];
+                break;
+            case OpType::EepromCommit:
+                byte = a - op.flashOffset < eepromLength ? op.source[a - op.flashOffset] : 0xFF;
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * Ütemezett végrehajtás: lap programozás az időkeretig, szektor törlés egyedül és csak tétlen felhasználónál
+ */
+void FlashCommitService::loop() {
+    if (queueCount == 0) {
+        return;
+    }
+
+    uint32_t now = millis();
+    uint32_t start = micros();
+    bool programmed = false;
+    while (queueCount > 0 && micros() - start < FLASH_COMMIT_SLICE_BUDGET) {
+        const Op &op = queueAt(0);
+        if (isEraseLike(op)) {
+            // A törlés (és az EEPROM commit) egyedül fut az ablakban
+            bool idle = now - rtv::lastUserActivity >= FLASH_COMMIT_ERASE_IDLE;
+            if (!programmed && (idle || now - op.queuedAt >= FLASH_COMMIT_MAX_DELAY)) {
+                runNext();
+            }
+            break;
+        }
+        runNext();
+        programmed = true;
+    }
+
+    uint32_t sliceUs = micros() - start;
+    if (sliceUs > stats.maxSliceUs) {
+        stats.maxSliceUs = sliceUs;
+    }
+}
+
+/**
+ * Minden várakozó művelet azonnal
+ */
+void FlashCommitService::flush() {
+    while (queueCount > 0) {
+        stats.forcedOps++;
+        runNext();
+    }
+}
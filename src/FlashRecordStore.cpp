@@ -0,0 +1,444 @@
+#include "FlashRecordStore.h"
+
+#include "defines.h"
+#include "utils.h"
+
+#define FLASH_LOG_MAGIC 0x474F4C46 // "FLOG"
+#define FLASH_LOG_SIZE (FLASH_LOG_SECTORS * FLASH_SECTOR_SIZE)
+#define FLASH_LOG_NO_OFFSET 0xFFFF
+
+static_assert(FLASH_LOG_SIZE < FLASH_LOG_NO_OFFSET, "Log offsets must fit into uint16_t");
+static_assert(FLASH_LOG_SPARE_SECTORS < FLASH_LOG_SECTORS, "At least one sector must hold data");
+static_assert((FLASH_LOG_MAX_KEYS & (FLASH_LOG_MAX_KEYS - 1)) == 0, "The index size must be a power of 2");
+
+// Az arduino-pico linker szkript szimbólumai
+extern "C" uint8_t _FS_start;
+extern "C" uint8_t __flash_binary_end;
+
+// Globális példány
+FlashRecordStore flashRecordStore;
+
+/**
+ * Index keresés (lineáris próbálkozás)
+ */
+FlashRecordStore::IndexEntry *FlashRecordStore::findEntry(uint16_t key) {
+    uint16_t slot = (key * 40503u) & (FLASH_LOG_MAX_KEYS - 1);
+    for (uint16_t i = 0; i < FLASH_LOG_MAX_KEYS; i++) {
+        IndexEntry &e = index[(slot + i) & (FLASH_LOG_MAX_KEYS - 1)];
+        if (e.key == key || e.offset == FLASH_LOG_NO_OFFSET) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Index bejegyzés felvétele/frissítése
+ */
+bool FlashRecordStore::putEntry(uint16_t key, uint16_t offset) {
+    IndexEntry *e = findEntry(key);
+    if (e == nullptr) {
+        DEBUG("FlashRecordStore: index full, key 0x%04x dropped\n", key);
+        return false;
+    }
+    if (e->offset == FLASH_LOG_NO_OFFSET) {
+        indexCount++;
+    }
+    e->key = key;
+    e->offset = offset;
+    return true;
+}
+
+/**
+ * Törölt (0xFF) szektorok száma
+ */
+uint8_t FlashRecordStore::erasedSectorCount() const {
+    uint8_t count = 0;
+    for (uint8_t s = 0; s < FLASH_LOG_SECTORS; s++) {
+        if (sectorSequence[s] == 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * Tömörített, törlésre váró szektorok száma
+ */
+uint8_t FlashRecordStore::pendingEraseCount() const {
+    uint8_t count = 0;
+    for (uint8_t s = 0; s < FLASH_LOG_SECTORS; s++) {
+        if (erasePending[s]) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * Mutat-e index bejegyzés a szektorba
+ */
+bool FlashRecordStore::hasLiveRecords(uint8_t sector) const {
+    for (uint16_t i = 0; i < FLASH_LOG_MAX_KEYS; i++) {
+        if (index[i].offset != FLASH_LOG_NO_OFFSET && index[i].offset / FLASH_SECTOR_SIZE == sector) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Üres-e (0xFF) a terület
+ */
+bool FlashRecordStore::isBlank(uint16_t offset, uint16_t length) const {
+    uint32_t words[16];
+    while (length >= 4) {
+        uint16_t count = min((uint16_t)sizeof(words), (uint16_t)(length & ~3));
+        readFlash(offset, words, count);
+        for (uint16_t i = 0; i < count / 4; i++) {
+            if (words[i] != 0xFFFFFFFF) {
+                return false;
+            }
+        }
+        offset += count;
+        length -= count;
+    }
+    return true;
+}
+
+/**
+ * Érvényes rekord van-e az adott helyen
+ */
+bool FlashRecordStore::validRecordAt(uint16_t offset, RecordHeader &header) const {
+    readFlash(offset, &header, sizeof(RecordHeader));
+    uint16_t sectorEnd = (offset / FLASH_SECTOR_SIZE + 1) * FLASH_SECTOR_SIZE;
+    if (header.length > FLASH_LOG_MAX_RECORD_SIZE || offset + alignedSize(header.length) > sectorEnd) {
+        return false;
+    }
+    uint8_t payload[FLASH_LOG_MAX_RECORD_SIZE];
+    readFlash(offset + sizeof(RecordHeader), payload, header.length);
+    uint16_t crc = Utils::calcCRC16(reinterpret_cast<const uint8_t *>(&header), 8);
+    crc = Utils::calcCRC16(payload, header.length, crc);
+    return crc == header.crc;
+}
+
+/**
+ * Egy szektor rekordjainak bejárása, az index frissítése
+ * A szektorokat sorszám szerint növekvő sorrendben kell bejárni, így a későbbi rekord nyer
+ */
+void FlashRecordStore::scanSector(uint8_t sector) {
+    uint16_t base = sector * FLASH_SECTOR_SIZE;
+    uint16_t pos = sizeof(SectorHeader);
+
+    while (pos + sizeof(RecordHeader) <= FLASH_SECTOR_SIZE) {
+        RecordHeader header;
+        if (isBlank(base + pos, sizeof(RecordHeader))) {
+            break; // A szektor írott részének vége
+        }
+        if (!validRecordAt(base + pos, header)) {
+            // Félbeszakadt írás: a szektor többi része nem megbízható, ide már nem írunk
+            DEBUG("FlashRecordStore: torn record in sector %u at %u\n", sector, pos);
+            if (sector == headSector) {
+                headClosed = true;
+            }
+            return;
+        }
+        putEntry(header.key, base + pos);
+        nextRecordSequence = max(nextRecordSequence, header.sequence + 1);
+        pos += alignedSize(header.length);
+    }
+
+    if (sector == headSector) {
+        headOffset = pos;
+        headClosed = pos + sizeof(RecordHeader) > FLASH_SECTOR_SIZE;
+    }
+}
+
+/**
+ * Indítás: a log terület helye a LittleFS előtt, szektorok és rekordok bejárása
+ */
+bool FlashRecordStore::begin() {
+    uint32_t fsStart = (uint32_t)(uintptr_t)&_FS_start - XIP_BASE;
+    uint32_t binaryEnd = (uint32_t)(uintptr_t)&__flash_binary_end - XIP_BASE;
+    flashOffset = (fsStart - FLASH_LOG_SIZE) & ~(FLASH_SECTOR_SIZE - 1);
+    if (binaryEnd > flashOffset) {
+        DEBUG("FlashRecordStore: no room below the file system (binary end 0x%lx, log 0x%lx)\n", binaryEnd, flashOffset);
+        return false;
+    }
+
+    for (uint16_t i = 0; i < FLASH_LOG_MAX_KEYS; i++) {
+        index[i] = {0xFFFF, FLASH_LOG_NO_OFFSET};
+    }
+    indexCount = 0;
+
+    // Szektor fejlécek: érvényes, törölt vagy (törlés közben megszakadt) szemét
+    bool anyValid = false;
+    for (uint8_t s = 0; s < FLASH_LOG_SECTORS; s++) {
+        SectorHeader header;
+        readFlash(s * FLASH_SECTOR_SIZE, &header, sizeof(SectorHeader));
+        sectorSequence[s] = 0;
+        eraseCounts[s] = 0;
+
+        if (header.magic == FLASH_LOG_MAGIC && header.crc == Utils::calcCRC16(reinterpret_cast<const uint8_t *>(&header), 12)) {
+            sectorSequence[s] = header.sequence;
+            eraseCounts[s] = header.eraseCount;
+            nextSectorSequence = max(nextSectorSequence, header.sequence + 1);
+            if (!anyValid || header.sequence > sectorSequence[headSector]) {
+                headSector = s;
+            }
+            anyValid = true;
+        } else if (!isBlank(s * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE)) {
+            eraseSector(s);
+        }
+    }
+
+    // Rekordok bejárása a szektorok sorrendjében
+    uint32_t lastSequence = 0;
+    for (uint8_t n = 0; n < FLASH_LOG_SECTORS; n++) {
+        int8_t next = -1;
+        for (uint8_t s = 0; s < FLASH_LOG_SECTORS; s++) {
+            if (sectorSequence[s] > lastSequence && (next < 0 || sectorSequence[s] < sectorSequence[next])) {
+                next = s;
+            }
+        }
+        if (next < 0) {
+            break;
+        }
+        scanSector(next);
+        lastSequence = sectorSequence[next];
+    }
+    if (!anyValid) {
+        headClosed = true;
+    }
+
+    // Tömörített, de a törlés előtt kikapcsolt szektor: nincs élő rekordja, most töröljük
+    for (uint8_t s = 0; s < FLASH_LOG_SECTORS; s++) {
+        if (sectorSequence[s] != 0 && s != headSector && !hasLiveRecords(s)) {
+            DEBUG("FlashRecordStore: sector %u has no live records, erasing\n", s);
+            eraseSector(s);
+        }
+    }
+
+    // A tartalék szektorok helyreállítása még a felület indulása előtt (szinkron tömörítés)
+    for (uint8_t n = 0; n < FLASH_LOG_SECTORS && erasedSectorCount() < FLASH_LOG_SPARE_SECTORS; n++) {
+        compact();
+        flashCommitService.flush();
+    }
+
+    ready = true;
+    DEBUG("FlashRecordStore::begin() -> 0x%lx, %u keys, head sector %u @ %u, %u erased\n", flashOffset, indexCount, headSector, headOffset, erasedSectorCount());
+    return true;
+}
+
+/**
+ * Lap-igazított programozás: a lap többi része 0xFF, ami a már írt byte-okat nem változtatja
+ * A lap képe a FlashCommitService sorába kerül, a programozás a felület két frissítése között fut.
+ */
+void FlashRecordStore::programBytes(uint16_t offset, const uint8_t *data, uint16_t length) {
+    uint8_t page[FLASH_PAGE_SIZE];
+
+    while (length > 0) {
+        uint16_t pageStart = offset & ~(FLASH_PAGE_SIZE - 1);
+        uint16_t inPage = offset - pageStart;
+        uint16_t count = min((uint16_t)(FLASH_PAGE_SIZE - inPage), length);
+
+        memset(page, 0xFF, sizeof(page));
+        memcpy(page + inPage, data, count);
+
+        flashCommitService.queueProgram(flashOffset + pageStart, page);
+
+        stats.pagesProgrammed++;
+        offset += count;
+        data += count;
+        length -= count;
+    }
+}
+
+/**
+ * Azonnali szektor törlés (induláskor)
+ */
+void FlashRecordStore::eraseSector(uint8_t sector) {
+    flashCommitService.eraseNow(flashOffset + sector * FLASH_SECTOR_SIZE);
+
+    sectorSequence[sector] = 0;
+    eraseCounts[sector]++;
+    stats.sectorsErased++;
+}
+
+/**
+ * A tömörített szektor törlésének ütemezése: addig nem nyitható meg, de az élő rekordjai már máshol vannak
+ */
+void FlashRecordStore::requestErase(uint8_t sector) {
+    erasePending[sector] = true;
+    flashCommitService.queueErase(flashOffset + sector * FLASH_SECTOR_SIZE, onSectorErased, this);
+}
+
+/**
+ * A FlashCommitService jelzése: a szektor törölve, újra nyitható
+ */
+void FlashRecordStore::onSectorErased(void *context, uint32_t flashOffset) {
+    FlashRecordStore *store = static_cast<FlashRecordStore *>(context);
+    uint8_t sector = (flashOffset - store->flashOffset) / FLASH_SECTOR_SIZE;
+    store->erasePending[sector] = false;
+    store->sectorSequence[sector] = 0;
+    store->eraseCounts[sector]++;
+    store->stats.sectorsErased++;
+}
+
+/**
+ * A következő törölt szektor megnyitása a gyűrűben (a kopás így egyenletes)
+ */
+bool FlashRecordStore::openNextSector() {
+    for (uint8_t i = 1; i <= FLASH_LOG_SECTORS; i++) {
+        uint8_t s = (headSector + i) % FLASH_LOG_SECTORS;
+        if (sectorSequence[s] != 0) {
+            continue;
+        }
+
+        SectorHeader header = {FLASH_LOG_MAGIC, nextSectorSequence++, eraseCounts[s], 0, 0xFFFF};
+        header.crc = Utils::calcCRC16(reinterpret_cast<const uint8_t *>(&header), 12);
+        programBytes(s * FLASH_SECTOR_SIZE, reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+
+        sectorSequence[s] = header.sequence;
+        headSector = s;
+        headOffset = sizeof(SectorHeader);
+        headClosed = false;
+        return true;
+    }
+    DEBUG("FlashRecordStore: no erased sector left!\n");
+    return false;
+}
+
+/**
+ * Rekord hozzáfűzése a log végéhez
+ */
+bool FlashRecordStore::append(uint16_t key, const uint8_t *data, uint16_t length) {
+    uint16_t size = alignedSize(length);
+
+    if (headClosed || headOffset + size > FLASH_SECTOR_SIZE) {
+        // Szektorváltás előtt biztosítjuk a tartalékot (szinkron tömörítés, ha a háttér nem érte utol)
+        // A tömörítés maga a tartalék szektorba írhat
+        if (!compacting && erasedSectorCount() + pendingEraseCount() < FLASH_LOG_SPARE_SECTORS) {
+            compact();
+        }
+        if (erasedSectorCount() == 0 && pendingEraseCount() > 0) {
+            flashCommitService.flush(); // Nincs nyitható szektor: a sorban álló törlés most fut le
+        }
+        if (!openNextSector()) {
+            return false;
+        }
+    }
+
+    uint8_t buffer[sizeof(RecordHeader) + FLASH_LOG_MAX_RECORD_SIZE + 3];
+    memset(buffer, 0xFF, size);
+    RecordHeader header = {key, length, nextRecordSequence++, 0, 0xFFFF};
+    header.crc = Utils::calcCRC16(data, length, Utils::calcCRC16(reinterpret_cast<const uint8_t *>(&header), 8));
+    memcpy(buffer, &header, sizeof(header));
+    memcpy(buffer + sizeof(header), data, length);
+
+    uint16_t offset = headSector * FLASH_SECTOR_SIZE + headOffset;
+    programBytes(offset, buffer, size);
+    headOffset += size;
+
+    stats.recordsWritten++;
+    stats.bytesWritten += size;
+    return putEntry(key, offset);
+}
+
+/**
+ * A legrégebbi szektor élő rekordjainak átmásolása, majd a szektor törlése
+ */
+void FlashRecordStore::compact() {
+    int8_t oldest = -1;
+    for (uint8_t s = 0; s < FLASH_LOG_SECTORS; s++) {
+        if (sectorSequence[s] != 0 && !erasePending[s] && s != headSector && (oldest < 0 || sectorSequence[s] < sectorSequence[oldest])) {
+            oldest = s;
+        }
+    }
+    if (oldest < 0) {
+        return;
+    }
+
+    uint16_t base = oldest * FLASH_SECTOR_SIZE;
+    uint16_t pos = sizeof(SectorHeader);
+    uint16_t moved = 0;
+    compacting = true;
+    while (pos + sizeof(RecordHeader) <= FLASH_SECTOR_SIZE && !isBlank(base + pos, sizeof(RecordHeader))) {
+        RecordHeader header;
+        if (!validRecordAt(base + pos, header)) {
+            break;
+        }
+
+        // Csak a legfrissebb változatot visszük át
+        IndexEntry *e = findEntry(header.key);
+        if (e != nullptr && e->offset == base + pos) {
+            uint8_t payload[FLASH_LOG_MAX_RECORD_SIZE];
+            readFlash(base + pos + sizeof(RecordHeader), payload, header.length);
+            if (!append(header.key, payload, header.length)) {
+                compacting = false;
+                return; // A régi szektort nem töröljük, amíg az élő rekordjai nincsenek biztonságban
+            }
+            moved++;
+        }
+        pos += alignedSize(header.length);
+    }
+
+    compacting = false;
+
+    requestErase(oldest);
+    stats.compactions++;
+    DEBUG("FlashRecordStore::compact() -> sector %u: %u live records moved\n", oldest, moved);
+}
+
+/**
+ * Rekord olvasása
+ */
+bool FlashRecordStore::read(uint16_t key, void *data, uint16_t length) const {
+    if (!ready) {
+        return false;
+    }
+    const IndexEntry *e = const_cast<FlashRecordStore *>(this)->findEntry(key);
+    if (e == nullptr || e->offset == FLASH_LOG_NO_OFFSET) {
+        return false;
+    }
+
+    RecordHeader header;
+    readFlash(e->offset, &header, sizeof(header));
+    if (header.length != length) {
+        return false;
+    }
+    readFlash(e->offset + sizeof(RecordHeader), data, length);
+    return true;
+}
+
+/**
+ * Rekord írása, ha változott
+ */
+bool FlashRecordStore::write(uint16_t key, const void *data, uint16_t length) {
+    if (!ready || length > FLASH_LOG_MAX_RECORD_SIZE) {
+        return false;
+    }
+
+    IndexEntry *e = findEntry(key);
+    if (e != nullptr && e->offset != FLASH_LOG_NO_OFFSET) {
+        RecordHeader header;
+        uint8_t stored[FLASH_LOG_MAX_RECORD_SIZE];
+        readFlash(e->offset, &header, sizeof(header));
+        readFlash(e->offset + sizeof(RecordHeader), stored, min(header.length, (uint16_t)FLASH_LOG_MAX_RECORD_SIZE));
+        if (header.length == length && memcmp(stored, data, length) == 0) {
+            stats.recordsSkipped++;
+            return true;
+        }
+    }
+
+    return append(key, reinterpret_cast<const uint8_t *>(data), length);
+}
+
+/**
+ * Háttér tömörítés
+ */
+void FlashRecordStore::loop() {
+    if (ready && erasedSectorCount() + pendingEraseCount() < FLASH_LOG_SPARE_SECTORS) {
+        compact();
+    }
+}
@@ -0,0 +1,315 @@
+#include "FmAutoStore.h"
+
+#include "SignalQualitySampler.h"
+#include "StationStore.h"
+#include "defines.h"
+#include "rtVars.h"
+#include "utils.h"
+
+/**
+ * Konstruktor
+ */
+FmAutoStore::FmAutoStore(Si4735Ext &si4735, Band &band, RdsDecoder &rdsDecoder) : si4735(si4735), band(band), rdsDecoder(rdsDecoder) {}
+
+/**
+ * Indítás
+ */
+bool FmAutoStore::start() {
+    if (state != State::Idle) {
+        return true;
+    }
+    if (band.getCurrentBandType() != FM_BAND_TYPE || rtv::SEEK || rtv::SCANbut || rtv::BEACON) {
+        DEBUG("FmAutoStore::start() -> not on FM or the tuner is busy\n");
+        return false;
+    }
+
+    const BandTable &b = band.getCurrentBand();
+    fmBandIdx = config.data.bandIdx;
+    stepSize = max((uint16_t)b.defStep, (uint16_t)1);
+    minFreq = b.minimumFreq;
+    scanFreq = minFreq;
+    maxFreq = b.maximumFreq;
+    homeFreq = b.currFreq;
+
+    candidateCount = 0;
+    lastStoredCount = 0;
+    tunePending = false;
+    scanStarted = millis();
+
+    rtv::SCANbut = true;
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_AUTOSTORE, true);
+    si4735.setHardwareAudioMute(true);
+
+    state = State::Scanning;
+    DEBUG("FmAutoStore::start() -> scanning %u..%u, step %u\n", scanFreq, maxFreq, stepSize);
+    return true;
+}
+
+/**
+ * Megszakítás
+ */
+void FmAutoStore::cancel(bool restoreTuning) {
+    if (state == State::Idle) {
+        return;
+    }
+    DEBUG("FmAutoStore::cancel()\n");
+    finish(restoreTuning);
+}
+
+/**
+ * Visszaállás az indítás előtti frekvenciára
+ */
+void FmAutoStore::finish(bool restoreTuning) {
+    if (restoreTuning) {
+        si4735.setFrequency(homeFreq);
+        si4735.flushRdsFifo(); // A bejárás alatt érkezett csoportok nem a mi állomásunkéi
+    }
+    rdsDecoder.reset();
+    tunePending = false;
+    si4735.setHardwareAudioMute(false);
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_AUTOSTORE, false);
+    rtv::SCANbut = false;
+
+    lastDurationMs = millis() - scanStarted;
+    state = State::Idle;
+}
+
+/**
+ * A folyamatban lévő hangolás lekérdezése (legfeljebb AUTOSTORE_POLL_INTERVAL-onként)
+ * @param complete true, ha a csatornával végeztünk (mért vagy lejárt az időkeret)
+ * @return true, ha van mérés
+ */
+bool FmAutoStore::pollMeasurement(bool &complete, uint8_t &rssi, uint8_t &snr) {
+    complete = false;
+    if (millis() - lastPoll < AUTOSTORE_POLL_INTERVAL) {
+        return false;
+    }
+    lastPoll = millis();
+
+    uint16_t frequency;
+    bool valid, bandLimit;
+    if (si4735.pollTuneStatus(frequency, valid, bandLimit)) {
+        complete = true;
+        rssi = si4735.getReceivedSignalStrengthIndicator(); // A tune státusz válasza
+        snr = si4735.getStatusSNR();
+        return true;
+    }
+    complete = millis() - tuneStarted >= AUTOSTORE_TUNE_BUDGET;
+    return false;
+}
+
+/**
+ * Jelölt felvétele, teli listánál a leggyengébb helyére
+ */
+void FmAutoStore::addCandidate(uint16_t freq, uint8_t rssi, uint8_t snr) {
+    Candidate c = {freq, rssi, snr, ""};
+
+    if (candidateCount < AUTOSTORE_MAX_CANDIDATES) {
+        candidates[candidateCount++] = c;
+        return;
+    }
+
+    uint8_t weakest = 0;
+    for (uint8_t i = 1; i < candidateCount; i++) {
+        if (score(candidates[i]) < score(candidates[weakest])) {
+            weakest = i;
+        }
+    }
+    if (score(c) > score(candidates[weakest])) {
+        candidates[weakest] = c;
+    }
+}
+
+/**
+ * A szomszédos csatornára átszűrődő erős állomások kiszűrése
+ * Csak a helyi maximumot tartjuk meg (egyenlőségnél az alacsonyabb frekvenciát)
+ */
+void FmAutoStore::dropAdjacentSpurs() {
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < candidateCount; i++) {
+        bool spur = false;
+        for (uint8_t j = 0; j < candidateCount && !spur; j++) {
+            uint16_t distance = candidates[i].frequency > candidates[j].frequency ? candidates[i].frequency - candidates[j].frequency
+                                                                                  : candidates[j].frequency - candidates[i].frequency;
+            if (i == j || distance != stepSize) {
+                continue;
+            }
+            uint16_t own = score(candidates[i]);
+            uint16_t other = score(candidates[j]);
+            spur = other > own || (other == own && candidates[j].frequency < candidates[i].frequency);
+        }
+        if (!spur) {
+            candidates[kept++] = candidates[i];
+        }
+    }
+    DEBUG("FmAutoStore::dropAdjacentSpurs() -> %u of %u kept\n", kept, candidateCount);
+    candidateCount = kept;
+}
+
+/**
+ * A legerősebb MAX_FM_STATIONS megtartása (pontszám szerint csökkenő sorrendben)
+ */
+void FmAutoStore::keepStrongest() {
+    for (uint8_t i = 1; i < candidateCount; i++) {
+        Candidate c = candidates[i];
+        uint8_t j = i;
+        while (j > 0 && score(candidates[j - 1]) < score(c)) {
+            candidates[j] = candidates[j - 1];
+            j--;
+        }
+        candidates[j] = c;
+    }
+    candidateCount = min(candidateCount, (uint8_t)MAX_FM_STATIONS);
+}
+
+/**
+ * Némított áthangolás a következő csatornára, illetve a folyamatban lévő hangolás mérése
+ */
+void FmAutoStore::scanNext() {
+    if (tunePending) {
+        bool complete;
+        uint8_t rssi, snr;
+        if (pollMeasurement(complete, rssi, snr) && rssi >= AUTOSTORE_MIN_RSSI && snr >= AUTOSTORE_MIN_SNR) {
+            addCandidate(scanFreq, rssi, snr);
+        }
+        if (!complete) {
+            return;
+        }
+        tunePending = false;
+        scanFreq += stepSize;
+    }
+
+    // A következő csatorna hangolását rögtön indítjuk, a mérés a következő loop()-okban
+    if (scanFreq <= maxFreq) {
+        si4735.setFrequencyNoWait(scanFreq);
+        tunePending = true;
+        tuneStarted = lastPoll = millis();
+        return;
+    }
+
+    // Végigértünk a sávon
+    dropAdjacentSpurs();
+    keepStrongest();
+
+    // Egy állomás sincs (pl. nincs antenna): a korábbi lista marad
+    if (candidateCount == 0) {
+        DEBUG("FmAutoStore::scanNext() -> no stations found, list kept\n");
+        finish();
+        return;
+    }
+
+    if (!config.data.rdsEnabled) {
+        storeResults();
+        return;
+    }
+
+    state = State::Naming;
+    namingBudgetStarted = millis();
+    startNaming(0);
+}
+
+/**
+ * Ráhangolás egy állomásra, az RDS név gyűjtésének kezdete
+ */
+void FmAutoStore::startNaming(uint8_t idx) {
+    namingIdx = idx;
+    si4735.setFrequencyNoWait(candidates[idx].frequency); // A végét nem várjuk, a név úgyis később jön
+    si4735.flushRdsFifo();
+    rdsDecoder.reset();
+    namingStarted = millis();
+}
+
+/**
+ * Várakozás a teljes PS névre (a FIFO-t a Si4735Utils loop()-ja üríti)
+ */
+void FmAutoStore::namingStep() {
+    Candidate &c = candidates[namingIdx];
+
+    if (rdsDecoder.isProgramServiceComplete()) {
+        Utils::safeStrCpy(c.name, rdsDecoder.getProgramService());
+        Utils::trimSpaces(c.name);
+    } else if (millis() - namingStarted < AUTOSTORE_RDS_TIMEOUT && millis() - namingBudgetStarted < AUTOSTORE_NAMING_BUDGET) {
+        return;
+    }
+
+    if (namingIdx + 1 < candidateCount && millis() - namingBudgetStarted < AUTOSTORE_NAMING_BUDGET) {
+        startNaming(namingIdx + 1);
+        return;
+    }
+    storeResults();
+}
+
+/**
+ * A lista cseréje egyetlen kötegelt módosítással (egyetlen EEPROM commit)
+ */
+void FmAutoStore::storeResults() {
+
+    // Frekvencia sorrend
+    for (uint8_t i = 1; i < candidateCount; i++) {
+        Candidate c = candidates[i];
+        uint8_t j = i;
+        while (j > 0 && candidates[j - 1].frequency > c.frequency) {
+            candidates[j] = candidates[j - 1];
+            j--;
+        }
+        candidates[j] = c;
+    }
+
+    fmStationStore.beginBatch();
+    fmStationStore.clearStations();
+    for (uint8_t i = 0; i < candidateCount; i++) {
+        const Candidate &c = candidates[i];
+
+        StationData station = {};
+        if (c.name[0] != '\0') {
+            Utils::safeStrCpy(station.name, c.name);
+        } else {
+            snprintf(station.name, sizeof(station.name), "%u.%02u MHz", c.frequency / 100, c.frequency % 100);
+        }
+        station.frequency = c.frequency;
+        station.bfoOffset = 0;
+        station.bandIndex = fmBandIdx;
+        station.modulation = FM;
+        station.bandwidthIndex = config.data.bwIdxFM;
+
+        if (fmStationStore.addStation(station)) {
+            lastStoredCount++;
+        }
+    }
+    fmStationStore.endBatch();
+
+    finish();
+    DEBUG("FmAutoStore::storeResults() -> %u stations stored in %lu ms\n", lastStoredCount, lastDurationMs);
+}
+
+/**
+ * Arduino loop
+ */
+void FmAutoStore::loop() {
+    switch (state) {
+        case State::Scanning:
+            scanNext();
+            break;
+        case State::Naming:
+            namingStep();
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Előrehaladás: a végigmérés az első 80%, a név gyűjtés a maradék
+ */
+uint8_t FmAutoStore::getProgress() const {
+    switch (state) {
+        case State::Scanning: {
+            uint16_t span = maxFreq - minFreq;
+            return span == 0 ? 80 : (uint32_t)min((uint16_t)(scanFreq - minFreq), span) * 80 / span;
+        }
+        case State::Naming:
+            return 80 + (uint16_t)namingIdx * 20 / max(candidateCount, (uint8_t)1);
+        default:
+            return 0;
+    }
+}
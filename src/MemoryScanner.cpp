@@ -0,0 +1,368 @@
+#include "MemoryScanner.h"
+
+#include "Config.h"
+#include "SignalQualitySampler.h"
+
+/**
+ * Konstruktor
+ */
+MemoryScanner::MemoryScanner(SI4735 &si4735, Band &band, FmStationStore &fmStore, AmStationStore &amStore)
+    : si4735(si4735), band(band), fmStore(fmStore), amStore(amStore) {}
+
+/**
+ * Rendezési reláció: mód család -> sáv -> moduláció -> sávszélesség -> frekvencia
+ * Így az egymás utáni csatornák a lehető legkevesebb chip konfiguráció váltást igénylik
+ */
+bool MemoryScanner::isLessThan(const ScanChannel &a, const ScanChannel &b) {
+    if (a.modeFamily != b.modeFamily)
+        return a.modeFamily < b.modeFamily;
+    if (a.bandIndex != b.bandIndex)
+        return a.bandIndex < b.bandIndex;
+    if (a.modulation != b.modulation)
+        return a.modulation < b.modulation;
+    if (a.bandwidthIndex != b.bandwidthIndex)
+        return a.bandwidthIndex < b.bandwidthIndex;
+    return a.frequency < b.frequency;
+}
+
+/**
+ * Csatornalista előkészítése a tárolókból
+ */
+uint8_t MemoryScanner::prepare() {
+
+    // A rendezés után az indexek megváltoznak: a prioritásos csatornát az azonosítója alapján keressük vissza
+    bool hadPriority = priorityIdx != NO_PRIORITY_CHANNEL;
+    bool priorityFromFm = hadPriority && channels[priorityIdx].fromFmStore;
+    uint8_t priorityStationId = hadPriority ? channels[priorityIdx].stationId : 0;
+    priorityIdx = NO_PRIORITY_CHANNEL;
+    channelCount = 0;
+
+    // Mindkét tároló állomásait összegyűjtjük
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        bool isFm = (pass == 0);
+        uint8_t count = isFm ? fmStore.getStationCount() : amStore.getStationCount();
+
+        for (uint8_t i = 0; i < count && channelCount < MAX_CHANNELS; i++) {
+            const StationData *station = isFm ? fmStore.getStationByIndex(i) : amStore.getStationByIndex(i);
+            if (station == nullptr) {
+                continue;
+            }
+
+            ScanChannel &ch = channels[channelCount++];
+            ch.frequency = station->frequency;
+            ch.bfoOffset = station->bfoOffset;
+            ch.bandIndex = station->bandIndex;
+            ch.modulation = station->modulation;
+            ch.bandwidthIndex = station->bandwidthIndex;
+            ch.modeFamily = Band::getModeFamily(station->modulation);
+            ch.stationId = isFm ? fmStore.getStationId(i) : amStore.getStationId(i);
+            ch.fromFmStore = isFm;
+            ch.sameConfigAsPrev = false;
+        }
+    }
+
+    // Rendezés (beszúrásos, max. 70 elem, nem kell hozzá több memória)
+    for (uint8_t i = 1; i < channelCount; i++) {
+        ScanChannel key = channels[i];
+        int16_t j = i - 1;
+        while (j >= 0 && isLessThan(key, channels[j])) {
+            channels[j + 1] = channels[j];
+            j--;
+        }
+        channels[j + 1] = key;
+    }
+
+    // Megjelöljük azokat a csatornákat, amelyeknél elég csak a frekvenciát állítani
+    for (uint8_t i = 1; i < channelCount; i++) {
+        const ScanChannel &prev = channels[i - 1];
+        ScanChannel &ch = channels[i];
+        ch.sameConfigAsPrev = (prev.bandIndex == ch.bandIndex && prev.modulation == ch.modulation && prev.bandwidthIndex == ch.bandwidthIndex);
+    }
+
+    if (hadPriority && !setPriorityChannel(priorityFromFm, priorityStationId)) {
+        DEBUG("MemoryScanner::prepare() -> priority channel no longer stored\n");
+    }
+
+    DEBUG("MemoryScanner::prepare() -> %d channels\n", channelCount);
+    return channelCount;
+}
+
+/**
+ * Prioritásos csatorna beállítása
+ */
+bool MemoryScanner::setPriorityChannel(bool fromFmStore, uint8_t stationId) {
+    for (uint8_t i = 0; i < channelCount; i++) {
+        if (channels[i].fromFmStore == fromFmStore && channels[i].stationId == stationId) {
+            priorityIdx = i;
+            hopsSincePriority = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Egy csatorna beállítása a chipen
+ * Ha a sáv, a moduláció és a sávszélesség egyezik a chipen lévővel, akkor csak a frekvenciát (és a BFO-t) állítjuk
+ */
+void MemoryScanner::tuneChannel(uint8_t idx) {
+
+    const ScanChannel &ch = channels[idx];
+    BandTable &currentBand = band.getCurrentBand();
+
+    // Gyors út: az előszámított flag alapján, vagy ha a chip konfiguráció épp egyezik
+    bool sameConfig = (tunedIdx >= 0 && tunedIdx == idx - 1 && ch.sameConfigAsPrev);
+    if (!sameConfig && config.data.bandIdx == ch.bandIndex && currentBand.currMod == ch.modulation) {
+        uint8_t currentBw = (ch.modulation == FM) ? config.data.bwIdxFM : (ch.modulation == AM) ? config.data.bwIdxAM : config.data.bwIdxSSB;
+        sameConfig = (currentBw == ch.bandwidthIndex);
+    }
+
+    if (sameConfig) {
+        currentBand.currFreq = ch.frequency;
+        band.applyAntCap(ch.frequency);
+        si4735.setFrequency(ch.frequency);
+
+        if (ch.modeFamily == BAND_MODE_FAMILY_SSB && config.data.currentBFO != ch.bfoOffset) {
+            currentBand.lastBFO = ch.bfoOffset;
+            config.data.currentBFO = ch.bfoOffset;
+            config.markDirty();
+            rtv::freqDec = ch.bfoOffset;
+            const int16_t cwBaseOffset = (ch.modulation == CW) ? config.data.cwReceiverOffsetHz : 0;
+            si4735.setSSBBfo(cwBaseOffset + config.data.currentBFO + config.data.currentBFOmanu);
+        }
+    } else {
+        // Teljes sáv/mód váltás
+        band.tuneMemoryStation(ch.frequency, ch.bfoOffset, ch.bandIndex, ch.modulation, ch.bandwidthIndex);
+        si4735.setAudioMute(true); // A tuneMemoryStation visszaállítja a hangerőt, de lépkedés közben némítunk
+    }
+
+    // A beállás alatt a közös mintavételező szünetel
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_SCANNER, true);
+
+    tunedIdx = idx;
+    state = State::Settling;
+    stateStartTime = millis();
+}
+
+/**
+ * Nyitva van a squelch? (ugyanaz a metrika, mint a Si4735Utils::manageSquelch()-ben)
+ * A közös mintavételező pillanatképét használjuk, saját RSQ lekérdezés nincs
+ */
+bool MemoryScanner::isSquelchOpen(const SignalQualitySampler::Snapshot &quality) {
+    uint8_t signalQuality = config.data.squelchUsesRSSI ? quality.rssi : quality.snr;
+    return signalQuality >= config.data.currentSquelch;
+}
+
+/**
+ * A lépkedéssel töltött idő akkumulálása (dwell/pause előtt hívjuk)
+ */
+void MemoryScanner::accumulateActiveTime() {
+    if (state == State::Settling) {
+        uint32_t now = millis();
+        scanActiveMillis += now - activeSince;
+        activeSince = now;
+    }
+}
+
+/**
+ * Lépés a következő csatornára (vagy a prioritásos csatornára)
+ */
+void MemoryScanner::nextChannel() {
+
+    hopCount++;
+
+    // Minden N. ugrás után a prioritásos csatornát nézzük meg
+    if (!onPriority && priorityIdx != NO_PRIORITY_CHANNEL && priorityHops > 0 && ++hopsSincePriority >= priorityHops) {
+        hopsSincePriority = 0;
+        onPriority = true;
+        tuneChannel(priorityIdx);
+        return;
+    }
+
+    // A prioritásos csatorna után onnan folytatjuk, ahol abbahagytuk
+    onPriority = false;
+    currentIdx = (currentIdx + 1) % channelCount;
+    tuneChannel(currentIdx);
+}
+
+/**
+ * Scan indítása
+ */
+bool MemoryScanner::start() {
+
+    // A tárolók az előző scan óta változhattak: a listát minden indításkor újraépítjük
+    if (prepare() == 0) {
+        DEBUG("MemoryScanner::start() -> No memory channels\n");
+        return false;
+    }
+
+    // Az aktuális sávon/frekvencián túli első csatornától indulunk
+    currentIdx = 0;
+    uint16_t currentFreq = band.getCurrentBand().currFreq;
+    for (uint8_t i = 0; i < channelCount; i++) {
+        if (channels[i].bandIndex == config.data.bandIdx && channels[i].frequency > currentFreq) {
+            currentIdx = i;
+            break;
+        }
+    }
+
+    hopCount = 0;
+    scanActiveMillis = 0;
+    hopsSincePriority = 0;
+    onPriority = false;
+    tunedIdx = -1;
+
+    rtv::SCANbut = true;
+    rtv::SCANpause = false; // Lépkedés közben a squelch nem nyithat
+    si4735.setAudioMute(true);
+
+    activeSince = millis();
+    tuneChannel(currentIdx);
+
+    DEBUG("MemoryScanner::start() -> from channel %d/%d\n", currentIdx, channelCount);
+    return true;
+}
+
+/**
+ * Scan leállítása
+ */
+void MemoryScanner::stop() {
+    if (state == State::Idle) {
+        return;
+    }
+
+    accumulateActiveTime();
+    state = State::Idle;
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_SCANNER, false);
+    rtv::SCANbut = false;
+    rtv::SCANpause = true;
+
+    if (!rtv::muteStat) {
+        si4735.setAudioMute(false);
+    }
+
+    DEBUG("MemoryScanner::stop() -> %lu hops, %.2f ch/s\n", hopCount, getChannelsPerSecond());
+}
+
+/**
+ * Szüneteltetés / folytatás
+ */
+void MemoryScanner::setPaused(bool paused) {
+    if (state == State::Idle) {
+        return;
+    }
+
+    if (paused) {
+        accumulateActiveTime();
+        state = State::Paused;
+        rtv::SCANpause = true;
+        if (!rtv::muteStat) {
+            si4735.setAudioMute(false);
+        }
+
+    } else if (state == State::Paused) {
+        // Az aktuális csatornát újramérjük, ha még mindig van jel, akkor ott maradunk
+        rtv::SCANpause = false;
+        si4735.setAudioMute(true);
+        activeSince = millis();
+        state = State::Settling;
+        stateStartTime = millis();
+    }
+}
+
+/**
+ * Loop - nem blokkoló állapotgép
+ */
+void MemoryScanner::loop() {
+
+    if (state == State::Idle || state == State::Paused || channelCount == 0) {
+        return;
+    }
+
+    uint32_t now = millis();
+
+    if (state == State::Settling) {
+
+        const ScanChannel &ch = channels[tunedIdx];
+        uint16_t settleTime = (ch.modeFamily == BAND_MODE_FAMILY_FM) ? SCAN_SETTLE_TIME_FM : SCAN_SETTLE_TIME_AM;
+        if (now - stateStartTime < settleTime) {
+            return;
+        }
+        if (signalQualitySampler.isTunerBusyBy(TUNER_OWNER_SCANNER)) {
+            // Beállt a jel: elengedjük a mintavételezőt, és megvárjuk az első új mintát
+            signalQualitySampler.setTunerBusy(TUNER_OWNER_SCANNER, false);
+            settledAt = now;
+            return;
+        }
+        SignalQualitySampler::Snapshot quality = signalQualitySampler.getSnapshot();
+        if (!quality.valid || (int32_t)(quality.sampledAt - settledAt) < 0) {
+            return;
+        }
+
+        if (isSquelchOpen(quality)) {
+            // Van jel -> megállunk a csatornán
+            accumulateActiveTime();
+            state = State::Dwelling;
+            lastSignalTime = now;
+            lastDwellCheck = now;
+            rtv::SCANpause = true;
+            if (!rtv::muteStat) {
+                si4735.setAudioMute(false);
+            }
+            DEBUG("MemoryScanner: dwell on %d (band: %d, freq: %d)%s\n", tunedIdx, ch.bandIndex, ch.frequency, onPriority ? " [priority]" : "");
+        } else {
+            nextChannel();
+        }
+
+    } else if (state == State::Dwelling) {
+
+        if (now - lastDwellCheck < SCAN_DWELL_CHECK_INTERVAL) {
+            return;
+        }
+        lastDwellCheck = now;
+
+        SignalQualitySampler::Snapshot quality = signalQualitySampler.getSnapshot();
+        if (!quality.valid) {
+            return;
+        }
+        if (isSquelchOpen(quality)) {
+            lastSignalTime = now;
+
+        } else if (now - lastSignalTime >= SCAN_RESUME_DELAY) {
+            // Elment a jel -> folytatjuk
+            rtv::SCANpause = false;
+            si4735.setAudioMute(true);
+            activeSince = now;
+            nextChannel();
+        }
+    }
+
+#ifdef __DEBUG
+    static uint32_t lastReport = 0;
+    if (now - lastReport >= SCAN_RATE_REPORT_INTERVAL) {
+        DEBUG("MemoryScanner: %lu hops, %.2f ch/s\n", hopCount, getChannelsPerSecond());
+        lastReport = now;
+    }
+#endif
+}
+
+/**
+ * Effektív scan sebesség (csatorna/másodperc)
+ */
+float MemoryScanner::getChannelsPerSecond() const {
+    uint32_t activeMillis = scanActiveMillis;
+    if (state == State::Settling) {
+        activeMillis += millis() - activeSince;
+    }
+    return activeMillis > 0 ? (hopCount * 1000.0f) / activeMillis : 0.0f;
+}
+
+/**
+ * Az aktuális csatorna
+ */
+const MemoryScanner::ScanChannel *MemoryScanner::getCurrentChannel() const {
+    if (state == State::Idle || tunedIdx < 0) {
+        return nullptr;
+    }
+    return &channels[tunedIdx];
+}
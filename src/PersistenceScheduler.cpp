@@ -0,0 +1,144 @@
+#include "PersistenceScheduler.h"
+
+#include "Config.h"
+#include "FlashCommitService.h"
+#include "defines.h"
+#include "rtVars.h"
+
+// Globális példány
+PersistenceScheduler persistenceScheduler;
+
+/**
+ * Tároló felvétele
+ */
+bool PersistenceScheduler::registerStore(PersistentStore &store) {
+    if (entryCount >= PERSISTENCE_MAX_STORES) {
+        DEBUG("PersistenceScheduler::registerStore() -> no room for %s\n", store.getStoreName());
+        return false;
+    }
+    uint32_t now = millis();
+    Entry &entry = entries[entryCount++];
+    entry = {};
+    entry.store = &store;
+    entry.changeCount = store.collectChanges();
+    if (store.needsSave()) {
+        // A betöltéskor javított adatok is mentésre várnak
+        entry.pendingChanges = 1;
+        entry.firstChangeTime = entry.lastChangeTime = now;
+    }
+    return true;
+}
+
+/**
+ * A módosítás számláló figyelése, mentés a csendes időszak vagy a maximális késleltetés után
+ */
+void PersistenceScheduler::poll(Entry &entry, uint32_t now) {
+    uint16_t changeCount = entry.store->collectChanges();
+    if (changeCount != entry.changeCount) {
+        uint16_t newChanges = changeCount - entry.changeCount;
+        if (entry.pendingChanges == 0) {
+            entry.firstChangeTime = now;
+        }
+        entry.pendingChanges += newChanges;
+        entry.lastChangeTime = now;
+        entry.changeCount = changeCount;
+        stats.changes += newChanges;
+    }
+
+    if (!entry.store->needsSave() || !entry.store->canSave()) {
+        return;
+    }
+    if (now - entry.lastChangeTime < PERSISTENCE_QUIET_PERIOD && now - entry.firstChangeTime < PERSISTENCE_MAX_DELAY) {
+        return;
+    }
+    if (entry.written && now - entry.lastWriteTime < PERSISTENCE_MIN_WRITE_INTERVAL) {
+        if (!entry.deferred) {
+            entry.deferred = true;
+            stats.rateLimited++;
+        }
+        return;
+    }
+    write(entry, now);
+}
+
+/**
+ * Egy tároló mentése, statisztikával
+ */
+bool PersistenceScheduler::write(Entry &entry, uint32_t now) {
+    entry.store->checkSave();
+    entry.lastWriteTime = now;
+    entry.written = true;
+    entry.deferred = false;
+
+    // Sikertelen mentés után is kivárjuk a minimális időközt (ne próbálkozzunk minden figyeléskor)
+    if (entry.store->needsSave()) {
+        stats.failures++;
+        return false;
+    }
+
+    stats.writes++;
+    // Azonnali mentés mellett minden jelzett módosítás egy írás lett volna (a Config összehasonlítással
+    // észlelt írásai észlelésenként egynek számítanak, ld. a PersistenceScheduler leírását)
+    if (entry.pendingChanges > 1) {
+        stats.writesAvoided += entry.pendingChanges - 1;
+    }
+    DEBUG("PersistenceScheduler: %s saved, %u changes coalesced (total: %lu writes, %lu avoided)\n", entry.store->getStoreName(), entry.pendingChanges, stats.writes,
+          stats.writesAvoided);
+    entry.pendingChanges = 0;
+    return true;
+}
+
+/**
+ * Időzített mentések
+ */
+void PersistenceScheduler::loop() {
+    uint32_t now = millis();
+    if (now - lastPollTime < PERSISTENCE_POLL_INTERVAL) {
+        return;
+    }
+    lastPollTime = now;
+
+    // A képernyővédő idejének lejártakor (tétlen rádió) mindent kiírunk
+    bool idle = now - rtv::lastUserActivity >= config.data.screenSaverTimeoutMinutes * 60 * 1000UL;
+    if (idle && !idleFlushed) {
+        flushAll("screen saver");
+    }
+    idleFlushed = idle;
+
+    for (uint8_t i = 0; i < entryCount; i++) {
+        poll(entries[i], now);
+    }
+}
+
+/**
+ * Az összes mentetlen módosítás azonnali kiírása
+ */
+void PersistenceScheduler::flushAll(const char *reason) {
+    uint32_t now = millis();
+    stats.forcedFlushes++;
+    for (uint8_t i = 0; i < entryCount; i++) {
+        Entry &entry = entries[i];
+        uint16_t changeCount = entry.store->collectChanges();
+        uint16_t newChanges = changeCount - entry.changeCount;
+        entry.pendingChanges += newChanges;
+        entry.changeCount = changeCount;
+        stats.changes += newChanges;
+        if (entry.store->needsSave() && entry.store->canSave()) {
+            DEBUG("PersistenceScheduler: flush %s (%s)\n", entry.store->getStoreName(), reason);
+            write(entry, now);
+        }
+    }
+    flashCommitService.flush(); // A sorban álló lapok is kerüljenek ki
+}
+
+/**
+ * Van-e még mentetlen módosítás
+ */
+bool PersistenceScheduler::hasPendingWrites() const {
+    for (uint8_t i = 0; i < entryCount; i++) {
+        if (entries[i].store->needsSave()) {
+            return true;
+        }
+    }
+    return false;
+}
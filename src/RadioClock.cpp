@@ -0,0 +1,58 @@
+#include "RadioClock.h"
+
+#include "defines.h"
+
+// Globális példány definíciója
+RadioClock radioClock;
+
+/**
+ * Szinkronizálás
+ */
+void RadioClock::syncUtc(uint8_t hour, uint8_t minute, uint8_t second, uint32_t atMillis) {
+    syncMsOfDay = ((uint32_t)hour * 3600UL + (uint32_t)minute * 60UL + second) * 1000UL;
+    syncMillis = atMillis;
+    synced = true;
+    DEBUG("RadioClock::syncUtc() -> %02u:%02u:%02u UTC\n", hour, minute, second);
+}
+
+/**
+ * Dátum: a hét napja (Sakamoto módszer, 0: vasárnap -> 0: hétfő)
+ */
+void RadioClock::syncDate(uint16_t year, uint8_t month, uint8_t day) {
+    static const uint8_t monthOffsets[12] = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
+    if (month < 1 || month > 12 || day < 1 || day > 31) {
+        return;
+    }
+    if (month < 3) {
+        year--;
+    }
+    uint8_t sundayBased = (year + year / 4 - year / 100 + year / 400 + monthOffsets[month - 1] + day) % 7;
+    syncWeekday = (sundayBased + 6) % 7;
+}
+
+/**
+ * A hét napja: a szinkron napja + az azóta eltelt napok
+ */
+uint8_t RadioClock::getWeekday() const {
+    if (syncWeekday == RADIO_CLOCK_WEEKDAY_UNKNOWN) {
+        return RADIO_CLOCK_WEEKDAY_UNKNOWN;
+    }
+    uint32_t days = (syncMsOfDay + (millis() - syncMillis)) / RADIO_CLOCK_MS_PER_DAY;
+    return (syncWeekday + days) % 7;
+}
+
+/**
+ * Napon belüli UTC idő
+ */
+uint32_t RadioClock::getMillisOfDay() const {
+    uint32_t elapsed = millis() - syncMillis;
+    return (syncMsOfDay + elapsed % RADIO_CLOCK_MS_PER_DAY) % RADIO_CLOCK_MS_PER_DAY;
+}
+
+/**
+ * Idő a következő napon belüli időpontig
+ */
+uint32_t RadioClock::millisUntil(uint32_t msOfDay) const {
+    uint32_t now = getMillisOfDay();
+    return (msOfDay + RADIO_CLOCK_MS_PER_DAY - now) % RADIO_CLOCK_MS_PER_DAY;
+}
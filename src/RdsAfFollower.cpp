@@ -0,0 +1,311 @@
+#include "RdsAfFollower.h"
+
+#include "Config.h"
+#include "SignalQualitySampler.h"
+#include "defines.h"
+
+/**
+ * Konstruktor
+ */
+RdsAfFollower::RdsAfFollower(Si4735Ext &si4735, Band &band, RdsDecoder &rdsDecoder) : si4735(si4735), band(band), rdsDecoder(rdsDecoder) { clear(); }
+
+/**
+ * Jelöltek és állapot törlése (frekvencia vagy állomás váltáskor)
+ */
+void RdsAfFollower::clear() {
+    candidateCount = 0;
+    nextProbeIdx = 0;
+    homePi = 0;
+    weakCount = 0;
+    homeFrequency = band.getCurrentBand().currFreq;
+}
+
+/**
+ * Az RDS dekóder AF listájának átvétele
+ * A dekóder listája csak bővül, PI váltáskor törlődik
+ */
+void RdsAfFollower::syncCandidates() {
+    uint8_t afCount;
+    const uint16_t *afList = rdsDecoder.getAfList(afCount);
+
+    for (uint8_t i = 0; i < afCount; i++) {
+        if (afList[i] == homeFrequency) {
+            continue;
+        }
+
+        bool found = false;
+        for (uint8_t j = 0; j < candidateCount; j++) {
+            if (candidates[j].frequency == afList[i]) {
+                found = true;
+                break;
+            }
+        }
+
+        if (!found && candidateCount < RDS_MAX_AF) {
+            AfCandidate &c = candidates[candidateCount++];
+            c.frequency = afList[i];
+            c.rssi = 0;
+            c.snr = 0;
+            c.measuredAt = 0;
+            c.piMismatchAt = 0;
+        }
+    }
+}
+
+/**
+ * Az aktuális frekvencia jelminőségének ellenőrzése
+ */
+void RdsAfFollower::checkHomeQuality() {
+    // A közös mintavételező simított értékeit használjuk, így egy-egy leesés nem vált
+    SignalQualitySampler::Snapshot quality = signalQualitySampler.getSnapshot();
+    if (!quality.valid) {
+        return;
+    }
+    homeRssi = quality.rssiAvg;
+    homeSnr = quality.snrAvg;
+
+    if (homeRssi < AF_WEAK_RSSI || homeSnr < AF_WEAK_SNR) {
+        if (weakCount < AF_WEAK_CONFIRM_COUNT) {
+            weakCount++;
+        }
+    } else {
+        weakCount = 0;
+    }
+}
+
+/**
+ * Némított áthangolás és jelminőség mérés, fix időkerettel
+ * @return true, ha a hangolás időben befejeződött
+ */
+bool RdsAfFollower::tuneMuted(uint16_t freq, uint8_t &rssi, uint8_t &snr) {
+    si4735.setFrequencyNoWait(freq);
+    if (!si4735.waitTuneComplete(AF_PROBE_BUDGET)) {
+        return false;
+    }
+    rssi = si4735.getReceivedSignalStrengthIndicator();
+    snr = si4735.getStatusSNR();
+    return true;
+}
+
+/**
+ * A következő AF jelölt megmérése egy rövid némított szünetben
+ */
+void RdsAfFollower::probeNext() {
+
+    // A rossz PI-jű jelölteket egy ideig kihagyjuk
+    for (uint8_t tries = 0; tries < candidateCount; tries++) {
+        AfCandidate &c = candidates[nextProbeIdx];
+        nextProbeIdx = (nextProbeIdx + 1) % candidateCount;
+
+        if (c.piMismatchAt != 0 && millis() - c.piMismatchAt < AF_PI_MISMATCH_HOLDOFF) {
+            continue;
+        }
+
+        uint32_t start = micros();
+        si4735.setHardwareAudioMute(true);
+        rdsDecoder.beginPiCheck(); // Egy elhúzódó visszahangolás alatt se keveredjenek az AF csoportjai az állomáséba
+
+        uint8_t rssi, snr;
+        if (tuneMuted(c.frequency, rssi, snr)) {
+            c.rssi = rssi;
+            c.snr = snr;
+            c.measuredAt = millis();
+        }
+
+        // Vissza az eredeti frekvenciára (ha nem sikerül, a hang némítva marad, a loop újrapróbálja)
+        returnHome();
+
+        uint32_t elapsed = micros() - start;
+        if (elapsed > maxProbeMicros) {
+            maxProbeMicros = elapsed;
+        }
+        probeCount++;
+
+        DEBUG("RdsAfFollower::probeNext() -> AF %u: RSSI %u, SNR %u (%lu us)\n", c.frequency, c.rssi, c.snr, elapsed);
+        return;
+    }
+}
+
+/**
+ * Vissza az otthoni frekvenciára
+ * A próba/ellenőrzés alatt érkezett RDS csoportok nem a mi állomásunkéi, ezeket eldobjuk.
+ * A dekóder az állomás PI, PS, RT és AF adataival folytatja, a jelöltek és a rossz PI jelölések megmaradnak.
+ * @return false, ha a hangolás nem fejeződött be időben: a hang némítva marad, a loop() újrapróbálja
+ */
+bool RdsAfFollower::returnHome() {
+    uint8_t rssi, snr;
+    if (!tuneMuted(homeFrequency, rssi, snr)) {
+        DEBUG("RdsAfFollower::returnHome() -> %u timed out, retrying\n", homeFrequency);
+        signalQualitySampler.setTunerBusy(TUNER_OWNER_AF, true);
+        state = State::Returning;
+        stateStartTime = millis();
+        return false;
+    }
+
+    si4735.flushRdsFifo();
+    finishSwitch();
+    return true;
+}
+
+/**
+ * Az átváltás/próba lezárása az aktuális frekvencián: hang vissza, mintavétel újra
+ */
+void RdsAfFollower::finishSwitch() {
+    state = State::Idle;
+    rdsDecoder.endPiCheck();
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_AF, false);
+    si4735.setHardwareAudioMute(false);
+}
+
+/**
+ * A legjobb, friss mérésű és a küszöbnél jobb AF jelölt kiválasztása
+ * @return a jelölt indexe, vagy -1, ha nincs megfelelő
+ */
+int8_t RdsAfFollower::findBestCandidate() {
+    int8_t best = -1;
+    uint32_t now = millis();
+
+    for (uint8_t i = 0; i < candidateCount; i++) {
+        const AfCandidate &c = candidates[i];
+        if (c.measuredAt == 0 || now - c.measuredAt > AF_CANDIDATE_MAX_AGE) {
+            continue;
+        }
+        if (c.piMismatchAt != 0 && now - c.piMismatchAt < AF_PI_MISMATCH_HOLDOFF) {
+            continue;
+        }
+        if (c.rssi < homeRssi + AF_SWITCH_MARGIN_RSSI || c.snr < AF_WEAK_SNR) {
+            continue;
+        }
+        if (best == -1 || c.rssi > candidates[best].rssi) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/**
+ * Átváltás egy AF jelöltre: áthangolás, a PI ellenőrzést a loopVerify() végzi
+ */
+void RdsAfFollower::switchTo(uint8_t idx) {
+    AfCandidate &c = candidates[idx];
+
+    si4735.setHardwareAudioMute(true);
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_AF, true); // A jelölt jelét ne mérjük az otthoni frekvenciáénak
+    rdsDecoder.beginPiCheck();
+
+    if (!tuneMuted(c.frequency, verifyRssi, verifySnr)) {
+        DEBUG("RdsAfFollower::switchTo() -> AF %u tune timeout\n", c.frequency);
+        returnHome();
+        return;
+    }
+
+    // Az AF-en az első hibátlan A blokk adja a PI kódot, a dekóder közben megőrzi az otthoni állomás adatait
+    si4735.flushRdsFifo();
+    verifyIdx = idx;
+    state = State::VerifyingPi;
+    stateStartTime = millis();
+}
+
+/**
+ * Átváltás közben: a PI ellenőrzés, ill. a sikertelen visszahangolás ismétlése
+ */
+void RdsAfFollower::loopVerify() {
+
+    if (state == State::Returning) {
+        if (millis() - stateStartTime >= AF_RETURN_RETRY_INTERVAL) {
+            returnHome();
+        }
+        return;
+    }
+
+    AfCandidate &c = candidates[verifyIdx];
+    uint16_t pi = rdsDecoder.getCheckedPi();
+
+    if (pi != 0 && pi == homePi) {
+        DEBUG("RdsAfFollower::loopVerify() -> %u -> %u, RSSI %u -> %u\n", homeFrequency, c.frequency, homeRssi, verifyRssi);
+
+        // A régi frekvencia lesz a jelölt a helyén, így visszafelé is követhető
+        uint16_t oldFrequency = homeFrequency;
+        homeFrequency = c.frequency;
+        band.getCurrentBand().currFreq = homeFrequency;
+
+        c.frequency = oldFrequency;
+        c.rssi = homeRssi;
+        c.snr = homeSnr;
+        c.measuredAt = millis();
+        c.piMismatchAt = 0;
+
+        homeRssi = verifyRssi;
+        homeSnr = verifySnr;
+        weakCount = 0;
+        switchCount++;
+        finishSwitch();
+        return;
+    }
+
+    if (pi == 0 && millis() - stateStartTime < AF_PI_CHECK_TIMEOUT) {
+        return; // Még nem jött hibátlan A blokk
+    }
+
+    // Más állomás (vagy nincs RDS): vissza az eredeti frekvenciára
+    DEBUG("RdsAfFollower::loopVerify() -> AF %u PI mismatch (%04X)\n", c.frequency, pi);
+    c.piMismatchAt = millis();
+    returnHome();
+}
+
+/**
+ * Arduino loop
+ */
+void RdsAfFollower::loop() {
+    bool allowed = enabled && config.data.rdsEnabled && band.getCurrentBandType() == FM_BAND_TYPE && !rtv::SEEK && !rtv::SCANbut && !rtv::BEACON;
+
+    if (state != State::Idle) {
+        // A felhasználó közben máshova hangolt: az ő hangolása érvényes, nem megyünk vissza
+        if (!allowed || band.getCurrentBand().currFreq != homeFrequency) {
+            finishSwitch();
+            clear();
+            return;
+        }
+        loopVerify();
+        return;
+    }
+
+    // Seek/scan közben a frekvencia úgyis változik, nem próbálunk
+    if (!allowed) {
+        return;
+    }
+
+    // A felhasználó áthangolt vagy a dekóder más állomást lát -> újrakezdjük
+    uint16_t pi = rdsDecoder.getPI();
+    if (band.getCurrentBand().currFreq != homeFrequency || (homePi != 0 && pi != 0 && pi != homePi)) {
+        clear();
+    }
+    if (pi == 0) {
+        return; // PI nélkül nem tudjuk ellenőrizni az AF-eket
+    }
+    homePi = pi;
+
+    syncCandidates();
+    if (candidateCount == 0) {
+        return;
+    }
+
+    if (millis() - lastCheck >= AF_CHECK_INTERVAL) {
+        lastCheck = millis();
+        checkHomeQuality();
+
+        if (weakCount >= AF_WEAK_CONFIRM_COUNT) {
+            int8_t best = findBestCandidate();
+            if (best >= 0) {
+                switchTo(best);
+                return;
+            }
+        }
+    }
+
+    uint32_t probeInterval = weakCount > 0 ? AF_PROBE_INTERVAL_WEAK : AF_PROBE_INTERVAL;
+    if (millis() - lastProbe >= probeInterval) {
+        lastProbe = millis();
+        probeNext();
+    }
+}
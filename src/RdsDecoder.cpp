@@ -0,0 +1,347 @@
+#include "RdsDecoder.h"
+
+#include "defines.h"
+
+// RDS csoport mezők (B blokk)
+#define RDS_GROUP_TYPE(b) (((b) >> 12) & 0x0F)
+#define RDS_GROUP_VERSION_B(b) (((b) >> 11) & 0x01)
+#define RDS_PTY(b) (((b) >> 5) & 0x1F)
+
+// AF kódok
+#define RDS_AF_CODE_MIN 1        // 87.6 MHz
+#define RDS_AF_CODE_MAX 204      // 107.9 MHz
+#define RDS_AF_CODE_LFMF 250     // A következő kód LF/MF frekvencia, azt nem követjük
+#define RDS_AF_BASE_FREQ 8750    // 87.5 MHz 10kHz egységben
+
+/**
+ * Konstruktor
+ */
+RdsDecoder::RdsDecoder(Si4735Ext &si4735) : si4735(si4735) { reset(); }
+
+/**
+ * Minden RDS állapot törlése
+ */
+void RdsDecoder::reset() {
+    pi = 0;
+    pty = 0;
+    ptyValid = false;
+
+    memset(psVotes, 0, sizeof(psVotes));
+    memset(ps, ' ', RDS_PS_LENGTH);
+    ps[RDS_PS_LENGTH] = '\0';
+    psValidMask = 0;
+
+    clearRadioText();
+    rtAbFlag = -1;
+
+    memset(&clock, 0, sizeof(clock));
+    afCount = 0;
+
+    // A kijelzőnek is jelezzük, hogy minden törlődött
+    pendingEvents |= RDS_EVENT_PI | RDS_EVENT_PS | RDS_EVENT_RT | RDS_EVENT_PTY | RDS_EVENT_AF;
+}
+
+/**
+ * RadioText törlése (A/B flag váltáskor)
+ */
+void RdsDecoder::clearRadioText() {
+    memset(rtVotes, 0, sizeof(rtVotes));
+    memset(rt, ' ', RDS_RT_LENGTH);
+    rt[RDS_RT_LENGTH] = '\0';
+    rtValidMask = 0;
+    rtLength = RDS_RT_LENGTH;
+}
+
+/**
+ * Csak megjeleníthető karaktereket engedünk a bufferekbe
+ */
+char RdsDecoder::sanitizeChar(uint8_t c) { return (c >= 0x20 && c < 0x7F) ? static_cast<char>(c) : ' '; }
+
+/**
+ * Karakter szavazás egy pozícióra
+ * A kijelzett karakter csak akkor változik, ha egy új jelölt elég szavazatot gyűjtött
+ *
+ * @return true, ha a kijelzett szöveg megváltozott
+ */
+bool RdsDecoder::voteChar(VotedChar *votes, char *text, uint8_t pos, char c) {
+    VotedChar &v = votes[pos];
+
+    if (v.candidate == c) {
+        if (v.votes < RDS_CHAR_MAX_VOTES) {
+            v.votes++;
+        }
+    } else if (v.votes > 1) {
+        v.votes--; // Egy eltérő karakter még nem írja felül a jelöltet
+    } else {
+        v.candidate = c;
+        v.votes = 1;
+    }
+
+    if (v.votes >= RDS_CHAR_CONFIRM_VOTES && text[pos] != v.candidate) {
+        text[pos] = v.candidate;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * A chip FIFO-jának kiürítése
+ */
+uint8_t RdsDecoder::drainFifo(bool intAck) {
+
+    uint8_t count = si4735.getRdsFifoCount(intAck);
+    if (count > RDS_MAX_GROUPS_PER_DRAIN) {
+        count = RDS_MAX_GROUPS_PER_DRAIN; // A maradékot a következő körben dolgozzuk fel
+    }
+
+    Si4735Ext::RdsGroup group;
+    for (uint8_t i = 0; i < count; i++) {
+        if (si4735.readRdsGroup(group)) {
+            decodeGroup(group);
+        } else {
+            droppedGroups++; // Nincs szinkron
+        }
+    }
+
+    // Események kiküldése
+    if (pendingEvents != 0 && eventCallback) {
+        uint8_t events = pendingEvents;
+        pendingEvents = 0;
+        eventCallback(events);
+    }
+
+    return count;
+}
+
+/**
+ * Arduino loop
+ */
+void RdsDecoder::loop() {
+    if (millis() - lastPoll < RDS_POLL_INTERVAL) {
+        return;
+    }
+    lastPoll = millis();
+    drainFifo();
+}
+
+/**
+ * Egy RDS csoport dekódolása
+ */
+void RdsDecoder::decodeGroup(const Si4735Ext::RdsGroup &group) {
+
+    groupCount++;
+
+    // PI ellenőrzés alatt a csoport egy másik frekvenciáról jön, a többi mezőt nem bántjuk
+    if (piCheckActive) {
+        if (checkedPi == 0 && group.errA == 0 && group.blockA != 0) {
+            checkedPi = group.blockA;
+        }
+        return;
+    }
+
+    // A B blokk nélkül a csoport típusa sem ismert
+    if (group.errB > RDS_MAX_BLOCK_ERRORS) {
+        droppedGroups++;
+        return;
+    }
+
+    // PI - ha megváltozik, akkor másik állomásra hangoltak, minden korábbi adat érvénytelen
+    if (group.errA == 0 && group.blockA != 0 && group.blockA != pi) {
+        if (pi != 0) {
+            reset();
+        }
+        pi = group.blockA;
+        pendingEvents |= RDS_EVENT_PI;
+    }
+
+    // PTY
+    uint8_t newPty = RDS_PTY(group.blockB);
+    if (group.errB == 0 && (!ptyValid || newPty != pty)) {
+        pty = newPty;
+        ptyValid = true;
+        pendingEvents |= RDS_EVENT_PTY;
+    }
+
+    bool versionB = RDS_GROUP_VERSION_B(group.blockB);
+    switch (RDS_GROUP_TYPE(group.blockB)) {
+    case 0:
+        decodeGroup0(group, versionB);
+        break;
+    case 2:
+        decodeGroup2(group, versionB);
+        break;
+    case 4:
+        if (!versionB) {
+            decodeGroup4A(group);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * 0A/0B csoport: Program Service név (+ AF a 0A C blokkjában)
+ */
+void RdsDecoder::decodeGroup0(const Si4735Ext::RdsGroup &group, bool versionB) {
+
+    // AF lista (csak 0A, a 0B C blokkja a PI ismétlése)
+    if (!versionB && group.errC <= RDS_MAX_BLOCK_ERRORS) {
+        uint8_t code1 = group.blockC >> 8;
+        uint8_t code2 = group.blockC & 0xFF;
+        if (code1 != RDS_AF_CODE_LFMF) {
+            decodeAfCode(code1);
+            decodeAfCode(code2);
+        }
+    }
+
+    if (group.errD > RDS_MAX_BLOCK_ERRORS) {
+        return;
+    }
+
+    uint8_t pos = (group.blockB & 0x03) * 2;
+    bool changed = voteChar(psVotes, ps, pos, sanitizeChar(group.blockD >> 8));
+    changed |= voteChar(psVotes, ps, pos + 1, sanitizeChar(group.blockD & 0xFF));
+
+    if (psVotes[pos].votes >= RDS_CHAR_CONFIRM_VOTES) {
+        psValidMask |= (1 << pos);
+    }
+    if (psVotes[pos + 1].votes >= RDS_CHAR_CONFIRM_VOTES) {
+        psValidMask |= (1 << (pos + 1));
+    }
+
+    if (changed) {
+        pendingEvents |= RDS_EVENT_PS;
+    }
+}
+
+/**
+ * 2A/2B csoport: RadioText
+ */
+void RdsDecoder::decodeGroup2(const Si4735Ext::RdsGroup &group, bool versionB) {
+
+    // A/B flag váltás -> új szöveg jön, a régit töröljük
+    int8_t abFlag = (group.blockB >> 4) & 0x01;
+    if (rtAbFlag != abFlag) {
+        if (rtAbFlag != -1) {
+            clearRadioText();
+            pendingEvents |= RDS_EVENT_RT;
+        }
+        rtAbFlag = abFlag;
+    }
+
+    uint8_t segment = group.blockB & 0x0F;
+    uint8_t chars[4];
+    uint8_t charCount;
+    uint8_t pos;
+
+    if (versionB) {
+        // 2B: 2 karakter a D blokkban, max. 32 karakter
+        if (group.errD > RDS_MAX_BLOCK_ERRORS) {
+            return;
+        }
+        pos = segment * 2;
+        chars[0] = group.blockD >> 8;
+        chars[1] = group.blockD & 0xFF;
+        charCount = 2;
+    } else {
+        // 2A: 4 karakter a C és D blokkban, max. 64 karakter
+        if (group.errC > RDS_MAX_BLOCK_ERRORS || group.errD > RDS_MAX_BLOCK_ERRORS) {
+            return;
+        }
+        pos = segment * 4;
+        chars[0] = group.blockC >> 8;
+        chars[1] = group.blockC & 0xFF;
+        chars[2] = group.blockD >> 8;
+        chars[3] = group.blockD & 0xFF;
+        charCount = 4;
+    }
+
+    bool changed = false;
+    for (uint8_t i = 0; i < charCount && (pos + i) < RDS_RT_LENGTH; i++) {
+
+        // 0x0D: a szöveg vége
+        if (chars[i] == 0x0D) {
+            if (rtLength != pos + i) {
+                rtLength = pos + i;
+                rt[rtLength] = '\0';
+                changed = true;
+            }
+            break;
+        }
+
+        changed |= voteChar(rtVotes, rt, pos + i, sanitizeChar(chars[i]));
+        if (rtVotes[pos + i].votes >= RDS_CHAR_CONFIRM_VOTES) {
+            rtValidMask |= (1ULL << (pos + i));
+        }
+    }
+
+    if (changed) {
+        pendingEvents |= RDS_EVENT_RT;
+    }
+}
+
+/**
+ * 4A csoport: Clock Time (CT)
+ * Mivel az idő percenként csak egyszer jön, itt nincs szavazás, de csak hibátlan blokkokat fogadunk el
+ */
+void RdsDecoder::decodeGroup4A(const Si4735Ext::RdsGroup &group) {
+
+    if (group.errB != 0 || group.errC != 0 || group.errD != 0) {
+        return;
+    }
+
+    uint32_t mjd = ((uint32_t)(group.blockB & 0x03) << 15) | (group.blockC >> 1);
+    uint8_t hour = ((group.blockC & 0x01) << 4) | (group.blockD >> 12);
+    uint8_t minute = (group.blockD >> 6) & 0x3F;
+    int8_t offset = group.blockD & 0x1F;
+    if (group.blockD & 0x20) {
+        offset = -offset;
+    }
+
+    if (hour > 23 || minute > 59 || mjd == 0) {
+        return;
+    }
+
+    // Modified Julian Date -> év/hó/nap (IEC 62106, Annex G)
+    uint32_t yp = (uint32_t)((mjd - 15078.2f) / 365.25f);
+    uint32_t mp = (uint32_t)((mjd - 14956.1f - (uint32_t)(yp * 365.25f)) / 30.6001f);
+    uint8_t day = mjd - 14956 - (uint32_t)(yp * 365.25f) - (uint32_t)(mp * 30.6001f);
+    uint8_t k = (mp == 14 || mp == 15) ? 1 : 0;
+    uint16_t year = 1900 + yp + k;
+    uint8_t month = mp - 1 - k * 12;
+
+    clock.receivedAt = millis();
+    if (!clock.valid || clock.year != year || clock.month != month || clock.day != day || clock.hour != hour || clock.minute != minute ||
+        clock.localOffsetHalfHours != offset) {
+        clock.year = year;
+        clock.month = month;
+        clock.day = day;
+        clock.hour = hour;
+        clock.minute = minute;
+        clock.localOffsetHalfHours = offset;
+        clock.valid = true;
+        pendingEvents |= RDS_EVENT_CT;
+    }
+}
+
+/**
+ * Egy AF kód feldolgozása (a lista fejléc és a kitöltő kódokat kihagyjuk)
+ */
+void RdsDecoder::decodeAfCode(uint8_t code) {
+    if (code < RDS_AF_CODE_MIN || code > RDS_AF_CODE_MAX) {
+        return;
+    }
+
+    uint16_t freq = RDS_AF_BASE_FREQ + code * 10;
+    for (uint8_t i = 0; i < afCount; i++) {
+        if (afList[i] == freq) {
+            return; // Már benne van
+        }
+    }
+
+    if (afCount < RDS_MAX_AF) {
+        afList[afCount++] = freq;
+        pendingEvents |= RDS_EVENT_AF;
+    }
+}
@@ -0,0 +1,114 @@
+#include "SeekEngine.h"
+
+#include "SignalQualitySampler.h"
+
+/**
+ * Konstruktor
+ */
+SeekEngine::SeekEngine(Si4735Ext &si4735, Band &band) : si4735(si4735), band(band) {}
+
+/**
+ * Seek indítása
+ */
+bool SeekEngine::start(bool up) {
+
+    BandTable &currentBand = band.getCurrentBand();
+    if (Band::getModeFamily(currentBand.currMod) == BAND_MODE_FAMILY_SSB) {
+        DEBUG("SeekEngine::start() -> SSB/CW módban nincs seek\n");
+        return false;
+    }
+
+    if (state != State::Idle) {
+        abort();
+    }
+
+    // A sávhatárok a bandTable szerint, hogy a wrap a sávon belül maradjon
+    if (currentBand.bandType == FM_BAND_TYPE) {
+        si4735.setSeekFmLimits(currentBand.minimumFreq, currentBand.maximumFreq);
+        si4735.setSeekFmSpacing(SEEK_FM_SPACING);
+    } else {
+        si4735.setSeekAmLimits(currentBand.minimumFreq, currentBand.maximumFreq);
+        si4735.setSeekAmSpacing(currentBand.currStep);
+    }
+
+    si4735.setAudioMute(true);
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_SEEK, true);
+
+    seekUp = up;
+    startFrequency = lastFrequency = currentBand.currFreq;
+    startTime = lastPoll = millis();
+    state = State::Seeking;
+    rtv::SEEK = true;
+
+    si4735.seekStart(up, true);
+
+    DEBUG("SeekEngine::start() -> %s from %u\n", up ? "up" : "down", startFrequency);
+    return true;
+}
+
+/**
+ * Seek megszakítása
+ */
+bool SeekEngine::abort() {
+    if (state != State::Seeking) {
+        return state == State::Cancelling;
+    }
+
+    si4735.seekCancel();
+    state = State::Cancelling;
+    return true;
+}
+
+/**
+ * Seek vége: frekvencia rögzítése a band rekordban, hang vissza
+ */
+void SeekEngine::finish(uint16_t frequency, bool found) {
+    state = State::Idle;
+    rtv::SEEK = false;
+
+    band.getCurrentBand().currFreq = frequency;
+    signalQualitySampler.setTunerBusy(TUNER_OWNER_SEEK, false);
+    if (!rtv::muteStat) {
+        si4735.setAudioMute(false);
+    }
+
+    if (progressCallback) {
+        progressCallback(frequency, true, found);
+    }
+
+    DEBUG("SeekEngine::finish() -> %u (%s, %lu ms)\n", frequency, found ? "found" : "not found", millis() - startTime);
+}
+
+/**
+ * Arduino loop
+ */
+void SeekEngine::loop() {
+    if (state == State::Idle || millis() - lastPoll < SEEK_POLL_INTERVAL) {
+        return;
+    }
+    lastPoll = millis();
+
+    uint16_t frequency;
+    bool valid, bandLimit;
+    bool complete = si4735.pollTuneStatus(frequency, valid, bandLimit);
+
+    if (complete) {
+        // Megszakításkor vagy eredménytelen körbeéréskor nincs állomás
+        finish(frequency, state == State::Seeking && valid && !bandLimit);
+        return;
+    }
+
+    // Köztes frekvencia a kijelzőnek
+    if (frequency != lastFrequency) {
+        lastFrequency = frequency;
+        band.getCurrentBand().currFreq = frequency;
+        if (progressCallback) {
+            progressCallback(frequency, false, false);
+        }
+    }
+
+    if (state == State::Seeking && millis() - startTime > SEEK_TIMEOUT) {
+        DEBUG("SeekEngine::loop() -> timeout\n");
+        abort();
+    }
+}
@@ -0,0 +1,313 @@
+#include "Si4735Ext.h"
+
+#include <hardware/gpio.h>
+
+#include "defines.h"
+
+// Si473x parancsok és property-k (AN332)
+#define SI4735_CMD_GET_INT_STATUS 0x14
+#define SI4735_CMD_FM_SEEK_START 0x21
+#define SI4735_CMD_AM_SEEK_START 0x41
+#define SI4735_SEEK_UP (1 << 3)
+#define SI4735_SEEK_WRAP (1 << 2)
+#define SI4735_PROP_GPO_IEN 0x0001
+#define SI4735_PROP_FM_RDS_INT_SOURCE 0x1500
+#define SI4735_PROP_FM_RDS_INT_FIFO_COUNT 0x1501
+#define SI4735_PROP_FM_RSQ_BASE 0x1200 // INT_SOURCE, SNR_HI, SNR_LO, RSSI_HI, RSSI_LO
+#define SI4735_PROP_AM_RSQ_BASE 0x3200
+
+#define RSQ_INT_RSSI_LOW 0x01 // RSSILIEN
+#define RSQ_INT_RSSI_HIGH 0x02 // RSSIHIEN
+#define RSQ_INT_SNR_LOW 0x04  // SNRLIEN
+#define RSQ_INT_SNR_HIGH 0x08 // SNRHIEN
+
+volatile bool Si4735Ext::irqPending = false;
+
+/**
+ * GPO2/INT ISR - csak jelez, az I2C a loop-ban történik
+ */
+void Si4735Ext::irqHandler() { irqPending = true; }
+
+/**
+ * Az RDS FIFO-ban várakozó csoportok száma
+ * STATUSONLY = 1 -> a FIFO tartalma nem változik, csak a státuszt kérdezzük le
+ */
+uint8_t Si4735Ext::getRdsFifoCount(bool intAck) {
+    getRdsStatus(intAck ? 1 : 0, 0, 1);
+    if (intAck) {
+        rdsLatched = false;
+    }
+    return currentRdsStatus.resp.RDSFIFOUSED;
+}
+
+/**
+ * A legrégebbi RDS csoport kivétele a FIFO-ból
+ */
+bool Si4735Ext::readRdsGroup(RdsGroup &group) {
+    getRdsStatus(0, 0, 0);
+
+    group.blockA = (currentRdsStatus.resp.BLOCKAH << 8) | currentRdsStatus.resp.BLOCKAL;
+    group.blockB = (currentRdsStatus.resp.BLOCKBH << 8) | currentRdsStatus.resp.BLOCKBL;
+    group.blockC = (currentRdsStatus.resp.BLOCKCH << 8) | currentRdsStatus.resp.BLOCKCL;
+    group.blockD = (currentRdsStatus.resp.BLOCKDH << 8) | currentRdsStatus.resp.BLOCKDL;
+    group.errA = currentRdsStatus.resp.BLEA;
+    group.errB = currentRdsStatus.resp.BLEB;
+    group.errC = currentRdsStatus.resp.BLEC;
+    group.errD = currentRdsStatus.resp.BLED;
+
+    return currentRdsStatus.resp.RDSSYNC;
+}
+
+/**
+ * Frekvencia beállítása a könyvtár fix késleltetése (maxDelaySetFrequency) nélkül
+ */
+void Si4735Ext::setFrequencyNoWait(uint16_t freq) {
+    uint16_t savedDelay = maxDelaySetFrequency;
+    maxDelaySetFrequency = 0;
+    stcLatched = false; // Egy korábbi hangolás nyugtázott STC-je nem ennek a vége
+    setFrequency(freq);
+    maxDelaySetFrequency = savedDelay;
+}
+
+/**
+ * Várakozás az STC bitre a tune státuszban
+ */
+bool Si4735Ext::waitTuneComplete(uint16_t timeoutMs) {
+    uint32_t start = millis();
+    uint32_t lastPoll = start;
+    do {
+        // Megszakítás esetén a jelzés után kérdezünk, de egy elveszett él miatt sem várunk a timeout-ig
+        if (interruptsActive && !irqPending && millis() - lastPoll < SI4735_IRQ_SAFETY_POLL) {
+            continue;
+        }
+        irqPending = false;
+        lastPoll = millis();
+
+        getStatus(0, 0);
+        if (currentStatus.resp.STCINT) {
+            getStatus(1, 0); // STC nyugtázása, a válasz az RSSI/SNR-t is frissíti
+            irqPending = interruptsActive; // A közben jelzett egyéb forrásokat a serviceInterrupts() dolgozza fel
+            return true;
+        }
+    } while (millis() - start < timeoutMs);
+
+    irqPending = interruptsActive;
+    return false;
+}
+
+/**
+ * Megszakítás láb bekötése
+ */
+void Si4735Ext::beginInterrupts(uint8_t pin) {
+    interruptPin = pin;
+    savedPinFunction = gpio_get_function(pin);
+    savedPinOutput = gpio_is_dir_out(pin);
+    savedPinPullUp = gpio_is_pulled_up(pin);
+    savedPinPullDown = gpio_is_pulled_down(pin);
+    pinMode(pin, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(pin), irqHandler, FALLING);
+}
+
+/**
+ * Megszakítások engedélyezése a chipen
+ */
+void Si4735Ext::configureInterrupts(bool patchLoaded) {
+    if (interruptPin < 0 || patchLoaded) {
+        interruptsActive = false;
+        return;
+    }
+
+    uint16_t ien = SI4735_INT_STC | SI4735_INT_RSQ;
+    if (lastMode == FM_CURRENT_MODE) {
+        ien |= SI4735_INT_RDS;
+        sendProperty(SI4735_PROP_FM_RDS_INT_SOURCE, 0x0001); // RDSRECV: a FIFO elérte a küszöböt
+        sendProperty(SI4735_PROP_FM_RDS_INT_FIFO_COUNT, SI4735_RDS_INT_FIFO_COUNT);
+    }
+    sendProperty(SI4735_PROP_GPO_IEN, ien);
+
+    if (!interruptLineChecked) {
+        interruptLineChecked = true;
+        if (!verifyInterruptLine()) {
+            DEBUG("Si4735Ext::configureInterrupts() -> no IRQ on pin %d, falling back to polling\n", interruptPin);
+            sendProperty(SI4735_PROP_GPO_IEN, 0);
+            releaseInterruptPin();
+            interruptsActive = false;
+            return;
+        }
+    }
+
+    rsqAbove = false; // Power-up után a felső éllel indulunk, a trackRsqLevel() igazítja
+    applyRsqThreshold();
+    rdsLatched = false; // A power-up a chip FIFO-ját is törölte
+
+    interruptsActive = true;
+    irqPending = true; // Az esetleg már függő források feldolgozása
+}
+
+/**
+ * Indításkori megszakítás teszt: újrahangolás ugyanarra a frekvenciára, az STC-nek a lábon is jeleznie kell
+ * A hangolás végét pollinggal várjuk meg (és nyugtázzuk), a láb jelzését az ISR által állított irqPending mutatja
+ */
+bool Si4735Ext::verifyInterruptLine() {
+    interruptsActive = false;
+    getStatus(1, 0); // A már függő STC nyugtázása, hogy a láb alaphelyzetbe álljon
+    irqPending = false;
+
+    setFrequencyNoWait(currentWorkFrequency);
+    bool tuned = waitTuneComplete(SI4735_IRQ_SELFTEST_TIMEOUT);
+    bool signalled = irqPending;
+    irqPending = false;
+
+    DEBUG("Si4735Ext::verifyInterruptLine() -> tune %s, IRQ %s\n", tuned ? "ok" : "timeout", signalled ? "ok" : "missing");
+    return tuned && signalled;
+}
+
+/**
+ * A megszakítás láb elengedése (polling mód): az ISR le, a láb a beginInterrupts() előtti beállításra
+ */
+void Si4735Ext::releaseInterruptPin() {
+    detachInterrupt(digitalPinToInterrupt(interruptPin));
+    gpio_set_pulls(interruptPin, savedPinPullUp, savedPinPullDown);
+    gpio_set_dir(interruptPin, savedPinOutput);
+    gpio_set_function(interruptPin, static_cast<decltype(gpio_get_function(0))>(savedPinFunction));
+    interruptPin = -1;
+}
+
+/**
+ * GET_INT_STATUS: csak a státusz bájt
+ */
+uint8_t Si4735Ext::readInterruptStatus() {
+    waitToSend();
+    Wire.beginTransmission(deviceAddress);
+    Wire.write(SI4735_CMD_GET_INT_STATUS);
+    Wire.endTransmission();
+
+    waitToSend();
+    Wire.requestFrom(deviceAddress, (uint8_t)1);
+    return Wire.read();
+}
+
+/**
+ * A függő megszakítás feldolgozása
+ */
+uint8_t Si4735Ext::serviceInterrupts() {
+    if (!interruptsActive) {
+        return 0;
+    }
+
+    uint8_t status = 0;
+    if (irqPending) {
+        irqPending = false;
+
+        status = readInterruptStatus() & (SI4735_INT_STC | SI4735_INT_RDS | SI4735_INT_RSQ);
+        if (status & SI4735_INT_STC) {
+            getStatus(1, 0); // STC nyugtázása
+            stcLatched = true;
+        }
+        if (status & SI4735_INT_RSQ) {
+            getCurrentReceivedSignalQuality(1); // RSQ nyugtázása, a friss mintát a mintavételező veszi
+        }
+        if (status & SI4735_INT_RDS) {
+            rdsLatched = true;
+        }
+    }
+
+    // Az RDS-t a FIFO ürítés nyugtázza, addig a jelzést szoftveresen tartjuk (újabb GET_INT_STATUS nélkül)
+    return status | (rdsLatched ? SI4735_INT_RDS : 0);
+}
+
+/**
+ * RSQ küszöb beállítása
+ */
+void Si4735Ext::setRsqThreshold(bool useRssi, uint8_t threshold) {
+    rsqUsesRssi = useRssi;
+    rsqThreshold = threshold;
+    if (interruptsActive) {
+        applyRsqThreshold();
+    }
+}
+
+/**
+ * Az élesített RSQ él követése: a küszöb felett az alsó, alatta a felső él figyel (hiszterézissel)
+ */
+void Si4735Ext::trackRsqLevel(uint8_t level) {
+    if (rsqThreshold == 0) {
+        return;
+    }
+    uint8_t low = rsqThreshold > SI4735_RSQ_HYSTERESIS ? rsqThreshold - SI4735_RSQ_HYSTERESIS : 0;
+    bool above = rsqAbove ? level > low : level >= rsqThreshold;
+    if (above != rsqAbove) {
+        rsqAbove = above;
+        if (interruptsActive) {
+            applyRsqThreshold();
+        }
+    }
+}
+
+/**
+ * RSQ küszöb kiküldése az aktuális módnak megfelelő property-kbe, egyszerre csak egy éllel
+ */
+void Si4735Ext::applyRsqThreshold() {
+    uint16_t base = (lastMode == FM_CURRENT_MODE) ? SI4735_PROP_FM_RSQ_BASE : SI4735_PROP_AM_RSQ_BASE;
+
+    if (rsqThreshold == 0) {
+        sendProperty(base, 0); // Nincs RSQ megszakítás
+        return;
+    }
+
+    uint8_t low = rsqThreshold > SI4735_RSQ_HYSTERESIS ? rsqThreshold - SI4735_RSQ_HYSTERESIS : 0;
+    if (rsqUsesRssi) {
+        sendProperty(base + 3, rsqThreshold); // RSSI_HI
+        sendProperty(base + 4, low);          // RSSI_LO
+        sendProperty(base, rsqAbove ? RSQ_INT_RSSI_LOW : RSQ_INT_RSSI_HIGH);
+    } else {
+        sendProperty(base + 1, rsqThreshold); // SNR_HI
+        sendProperty(base + 2, low);          // SNR_LO
+        sendProperty(base, rsqAbove ? RSQ_INT_SNR_LOW : RSQ_INT_SNR_HIGH);
+    }
+}
+
+/**
+ * Seek indítása
+ */
+void Si4735Ext::seekStart(bool up, bool wrap) {
+    uint8_t arg = (up ? SI4735_SEEK_UP : 0) | (wrap ? SI4735_SEEK_WRAP : 0);
+    stcLatched = false;
+
+    waitToSend();
+    Wire.beginTransmission(deviceAddress);
+    if (lastMode == FM_CURRENT_MODE) {
+        Wire.write(SI4735_CMD_FM_SEEK_START);
+        Wire.write(arg);
+    } else {
+        Wire.write(SI4735_CMD_AM_SEEK_START);
+        Wire.write(arg);
+        Wire.write(0x00);
+        Wire.write(0x00);
+        Wire.write(0x00); // ANTCAP: automatikus
+        Wire.write(0x00);
+    }
+    Wire.endTransmission();
+}
+
+/**
+ * Hangolás/seek állapot lekérdezése
+ */
+bool Si4735Ext::pollTuneStatus(uint16_t &frequency, bool &valid, bool &bandLimit) {
+    getStatus(0, 0);
+
+    frequency = (currentStatus.resp.READFREQH << 8) | currentStatus.resp.READFREQL;
+    valid = currentStatus.resp.VALID;
+    bandLimit = currentStatus.resp.BLTF;
+
+    // Megszakításos módban a serviceInterrupts() már nyugtázhatta
+    bool complete = currentStatus.resp.STCINT || stcLatched;
+    if (currentStatus.resp.STCINT) {
+        getStatus(1, 0);
+    }
+    stcLatched = false;
+    if (complete) {
+        currentWorkFrequency = frequency; // A seek végét a könyvtár nem látja, a tárolt frekvenciát mi igazítjuk
+    }
+    return complete;
+}
@@ -1,6 +1,9 @@
 #include "Si4735Utils.h"
 
 #include "Config.h"
+#include "RadioClock.h"
+#include "SignalQualitySampler.h"
+#include "StationStore.h"
 #include "rtVars.h" // Szükséges a band objektumhoz a getCurrentRdsProgramService-ben
 #include "utils.h"  // Szükséges a Utils::trimTrailingSpaces-hez
 
@@ -12,11 +15,13 @@ int8_t Si4735Utils::currentBandIdx = -1; // Induláskor nincs kiválasztvba band
 // Si4735Utils.cpp
 void Si4735Utils::manageSquelch() {
     if (!rtv::muteStat) { // Csak akkor fusson, ha a globális némítás ki van kapcsolva
-        si4735.getCurrentReceivedSignalQuality();
-        uint8_t rssi = si4735.getCurrentRSSI();
-        uint8_t snr = si4735.getCurrentSNR();
+        // A közös mintavételező utolsó mintája, nincs saját I2C lekérdezés
+        SignalQualitySampler::Snapshot quality = signalQualitySampler.getSnapshot();
+        if (!quality.valid) {
+            return; // Hangolás alatt / után még nincs minta, az állapot marad
+        }
 
-        uint8_t signalQuality = config.data.squelchUsesRSSI ? rssi : snr;
+        uint8_t signalQuality = config.data.squelchUsesRSSI ? quality.rssi : quality.snr;
 
         if (signalQuality >= config.data.currentSquelch) {
             // Jel a küszöb felett -> Némítás kikapcsolása (ha szükséges)
@@ -108,13 +113,114 @@ void Si4735Utils::checkAGC() {
     }
 }
 
+/**
+ * Központi hangolás figyelés
+ * A rotary, seek, scan, memória, AF váltás és a háttér funkciók mind máshogy hangolnak, ezért nem a hívóknál,
+ * hanem itt, egy helyen vesszük észre a sáv, a band rekord vagy a chip (könyvtár által tárolt) frekvencia változását.
+ * A visszatérő rövid próbák (AF, dual watch, aktivitás) egy loop-on belül visszaállnak, azokat nem látjuk.
+ */
+void Si4735Utils::checkTuningChange() {
+    uint16_t bandFreq = band.getCurrentBand().currFreq;
+    uint16_t chipFreq = si4735.getCurrentFrequency();
+    if (tunedBandIdx == config.data.bandIdx && tunedBandFreq == bandFreq && tunedChipFreq == chipFreq) {
+        return;
+    }
+    bool sameBand = tunedBandIdx == config.data.bandIdx;
+    tunedBandIdx = config.data.bandIdx;
+    tunedBandFreq = bandFreq;
+    tunedChipFreq = chipFreq;
+
+    // Az aktivitás rögzítő mindig az aktuális sáv csatornáit figyeli (az első loop-ban is ide jutunk)
+    if (!sameBand) {
+        activityRecorder.configure(config.data.bandIdx);
+        fmAutoStore.cancel(false); // Az FM sáv bejárása értelmét vesztette, a chip már az új sávon van
+    }
+
+    // Az AF váltás ugyanannak az állomásnak (PI) egy másik frekvenciája: az RDS adatok érvényesek maradnak
+    if (afFollower.getSwitchCount() != seenAfSwitches) {
+        seenAfSwitches = afFollower.getSwitchCount();
+        if (sameBand) {
+            return;
+        }
+    }
+
+    // Az előző állomás RDS adatai (PS, RT, AF lista, óra) már nem érvényesek
+    rdsDecoder.reset();
+    rdsProgramService[0] = '\0';
+    if (si4735.isCurrentTuneFM()) {
+        si4735.flushRdsFifo(); // A chip FIFO-jában még a régi állomás csoportjai lehetnek
+    }
+}
+
 /**
  * Loop függvény
  */
 void Si4735Utils::loop() {
+
+    // Hangolás után az RDS a nulláról indul
+    checkTuningChange();
+
+    // Chip megszakítások (csak ha az ISR jelzett, egyébként nincs I2C forgalom)
+    uint8_t interrupts = si4735.serviceInterrupts();
+    if (interrupts & SI4735_INT_STC) {
+        signalQualitySampler.invalidate(); // Hangolás vége -> azonnali friss minta
+    }
+    if (interrupts & SI4735_INT_RSQ) {
+        signalQualitySampler.requestSample();
+    }
+
+    // Az RSQ megszakítás küszöbe a squelch szintje, az élesített él a legutóbbi mintát követi
+    if (config.data.currentSquelch != rsqThreshold || config.data.squelchUsesRSSI != rsqUsesRssi) {
+        rsqThreshold = config.data.currentSquelch;
+        rsqUsesRssi = config.data.squelchUsesRSSI;
+        si4735.setRsqThreshold(rsqUsesRssi, rsqThreshold);
+    }
+    SignalQualitySampler::Snapshot quality = signalQualitySampler.getSnapshot();
+    if (quality.valid) {
+        si4735.trackRsqLevel(rsqUsesRssi ? quality.rssi : quality.snr);
+    }
+
     //
     this->manageSquelch();
 
+    // RDS FIFO ürítése, csak FM-ben (beacon figyelés közben a chip nem az FM sávon van)
+    if (band.getCurrentBandType() == FM_BAND_TYPE && !rtv::BEACON) {
+        if (config.data.rdsEnabled) {
+            if (!si4735.isInterruptDriven()) {
+                rdsDecoder.loop(); // Polling
+            } else if ((interrupts & SI4735_INT_RDS) || millis() - lastRdsDrain >= SI4735_RDS_IRQ_WATCHDOG) {
+                rdsDecoder.drainFifo(true); // Megszakításra, és egy elveszett él esetén is időnként
+                lastRdsDrain = millis();
+            }
+        } else if (interrupts & SI4735_INT_RDS) {
+            si4735.getRdsFifoCount(true); // Csak nyugtázzuk
+        }
+    }
+
+    // Az automatikus állomáslista a dekóder után (a PS nevet a dekóder gyűjti)
+    fmAutoStore.loop();
+
+    // Rotary hangolás (ütemenként legfeljebb egy chip frissítés)
+    tuningEngine.loop();
+
+    // Seek (időzített státusz lekérdezés)
+    seekEngine.loop();
+
+    // AF követés a dekóder után; sávon kívül is hívjuk, hogy egy félbeszakadt átváltást lezárjon
+    afFollower.loop();
+
+    // Memória scan (nem blokkoló állapotgép)
+    memoryScanner.loop();
+
+    // Kettős figyelés (rövid némított próbák a másodlagos frekvencián)
+    dualWatch.loop();
+
+    // Beacon figyelés (slot váltáskor áthangol)
+    beaconMonitor.loop();
+
+    // Sáv aktivitás rögzítés (csak tétlen időszakban mér)
+    activityRecorder.loop();
+
     // A némítás után a hangot vissza kell állítani
     this->manageHardwareAudioMute();
 }
@@ -122,18 +228,40 @@ void Si4735Utils::loop() {
 /**
  * Konstruktor
  */
-Si4735Utils::Si4735Utils(SI4735 &si4735, Band &band) : si4735(si4735), band(band), hardwareAudioMuteState(false), hardwareAudioMuteElapsed(millis()) {
+Si4735Utils::Si4735Utils(Si4735Ext &si4735, Band &band)
+    : hardwareAudioMuteState(false), hardwareAudioMuteElapsed(millis()), si4735(si4735), band(band), rdsDecoder(si4735), afFollower(si4735, band, rdsDecoder), activityRecorder(si4735, band), fmAutoStore(si4735, band, rdsDecoder), dualWatch(si4735, band),
+      memoryScanner(si4735, band, fmStationStore, amStationStore), seekEngine(si4735, band), tuningEngine(si4735, band), antCapTuner(si4735, band),
+      beaconMonitor(si4735, band) {
 
     DEBUG("Si4735Utils::Si4735Utils\n");
 
+    // PS változáskor frissítjük a levágott nevet, így a getCurrentRdsProgramService() nem másol
+    rdsDecoder.setEventCallback([this](uint8_t events) {
+        if (events & RDS_EVENT_PS) {
+            Utils::safeStrCpy(rdsProgramService, rdsDecoder.getProgramService());
+            Utils::trimSpaces(rdsProgramService);
+        }
+        // A CT csoport a perc elején érkezik, ehhez szinkronizáljuk az órát
+        if (events & RDS_EVENT_CT) {
+            const RdsDecoder::RdsClock &clock = rdsDecoder.getClock();
+            radioClock.syncUtc(clock.hour, clock.minute, 0, clock.receivedAt);
+            radioClock.syncDate(clock.year, clock.month, clock.day);
+        }
+    });
+
     // Band init, ha változott az épp használt band
     if (currentBandIdx != config.data.bandIdx) {
 
-        // A Band  visszaállítása a konfiogból
-        band.bandInit(currentBandIdx == -1); // Rendszer induláskor -1 a currentBandIdx változást figyelő flag
+        if (currentBandIdx == -1) {
+            // Rendszer induláskor teljes init a konfigból (-1 a currentBandIdx változást figyelő flag)
+            band.bandInit(true);
 
-        // A sávra preferált demodulációs mód betöltése
-        band.bandSet(true);
+            // A sávra preferált demodulációs mód betöltése
+            band.bandSet(true);
+        } else {
+            // Band váltás: reset csak FM <-> AM között, egyébként csak az eltérő chip parancsok
+            band.switchBand(config.data.bandIdx, true);
+        }
 
         // Hangerő beállítása
         si4735.setVolume(config.data.currVolume);
@@ -159,6 +287,7 @@ void Si4735Utils::setStep() { // This command should work only for SSB mode
             config.data.currentBFOStep = 25;
         else
             config.data.currentBFOStep = 1;
+        config.markDirty();
     }
 
     if (!rtv::SCANbut) {
@@ -194,24 +323,14 @@ void Si4735Utils::manageHardwareAudioMute() {
 /**
  * @brief Lekérdezi az aktuális RDS Program Service (PS) nevet.
  * @note Csak a MemmoryDisplay.cpp fájlban használjuk.
- * @return String Az állomásnév, vagy üres String, ha nem elérhető.
+ * @return Az állomásnév, vagy üres string, ha nem elérhető.
  */
-String Si4735Utils::getCurrentRdsProgramService() {
+const char *Si4735Utils::getCurrentRdsProgramService() {
     // Csak FM módban van értelme RDS-t keresni
     if (band.getCurrentBandType() != FM_BAND_TYPE) {
         return "";
     }
 
-    si4735.getRdsStatus();                                // Frissítsük az RDS állapotát
-    if (si4735.getRdsReceived() && si4735.getRdsSync()) { // Csak ha van érvényes RDS jel
-        char *rdsPsName = si4735.getRdsText0A();          // Program Service Name (állomásnév)
-        if (rdsPsName != nullptr && strlen(rdsPsName) > 0) {
-            char tempRdsName[STATION_NAME_BUFFER_SIZE]; // STATION_NAME_BUFFER_SIZE a StationData.h-ból
-            strncpy(tempRdsName, rdsPsName, STATION_NAME_BUFFER_SIZE - 1);
-            tempRdsName[STATION_NAME_BUFFER_SIZE - 1] = '\0'; // Biztos null-terminálás
-            Utils::trimSpaces(tempRdsName);                   // Esetleges felesleges szóközök eltávolítása mindkét oldalról
-            return String(tempRdsName);
-        }
-    }
-    return ""; // Nincs érvényes RDS PS név
+    // A dekóder eseménye tartja karban, itt már csak a buffert adjuk vissza
+    return rdsProgramService;
 }
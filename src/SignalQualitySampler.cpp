@@ -0,0 +1,138 @@
+#include "SignalQualitySampler.h"
+
+#include "defines.h"
+
+static_assert((SQ_HISTORY_SIZE & (SQ_HISTORY_SIZE - 1)) == 0, "SQ_HISTORY_SIZE must be a power of 2");
+
+/**
+ * Konstruktor
+ */
+SignalQualitySampler::SignalQualitySampler(SI4735 &si4735) : si4735(si4735) { memset(&published, 0, sizeof(published)); }
+
+/**
+ * Exponenciális simítás egy lépése (4 bites törtrésszel)
+ */
+uint16_t SignalQualitySampler::updateEma(uint16_t ema, uint8_t value) {
+    int32_t target = (int32_t)value << 4;
+    return (uint16_t)((int32_t)ema + ((target - (int32_t)ema) >> SQ_EMA_SHIFT));
+}
+
+/**
+ * Pillanatkép publikálása (seqlock író oldal, csak a core0 ír)
+ */
+void SignalQualitySampler::publish(const Snapshot &snapshot) {
+    uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    published = snapshot;
+    sequence.store(seq + 2, std::memory_order_release);
+}
+
+/**
+ * Pillanatkép olvasása (seqlock olvasó oldal), íráskor újrapróbálkozunk
+ */
+SignalQualitySampler::Snapshot SignalQualitySampler::getSnapshot() const {
+    Snapshot snapshot;
+    uint32_t seqBefore, seqAfter;
+    do {
+        seqBefore = sequence.load(std::memory_order_acquire);
+        snapshot = published;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        seqAfter = sequence.load(std::memory_order_relaxed);
+    } while ((seqBefore & 1) || seqBefore != seqAfter);
+
+    return snapshot;
+}
+
+/**
+ * Hangolás jelzése
+ */
+void SignalQualitySampler::setTunerBusy(uint8_t owner, bool busy) {
+    uint8_t owners = busy ? (tunerOwners | owner) : (tunerOwners & ~owner);
+    if (tunerOwners != 0 && owners == 0) {
+        tunerOwners = 0;
+        invalidate(); // Új frekvencián vagyunk, a régi átlag már nem érvényes
+        return;
+    }
+    tunerOwners = owners;
+}
+
+/**
+ * Simítás és előzmények eldobása
+ */
+void SignalQualitySampler::invalidate() {
+    emaSeeded = false;
+    historyCount = 0;
+    historyHead = 0;
+
+    Snapshot snapshot = getSnapshot();
+    snapshot.valid = false;
+    publish(snapshot);
+
+    // A következő loop azonnal mintát vesz
+    lastSample = millis() - interval;
+}
+
+/**
+ * Előzmény lekérdezése
+ */
+bool SignalQualitySampler::getHistory(uint8_t age, HistoryEntry &entry) const {
+    if (age >= historyCount) {
+        return false;
+    }
+    entry = history[(historyHead + SQ_HISTORY_SIZE - 1 - age) & (SQ_HISTORY_SIZE - 1)];
+    return true;
+}
+
+/**
+ * Arduino loop
+ */
+void SignalQualitySampler::loop() {
+
+    // Hangolás közben a kérés elveszhet, az RSQ megszakítást már a Si4735Ext nyugtázta
+    bool requested = sampleRequested && millis() - lastSample >= SQ_MIN_INTERVAL;
+    if (requested) {
+        sampleRequested = false;
+    }
+
+    if (tunerOwners != 0 || (!requested && millis() - lastSample < interval)) {
+        return;
+    }
+    sample();
+}
+
+/**
+ * Egy RSQ lekérdezés és a pillanatkép publikálása
+ */
+void SignalQualitySampler::sample() {
+    lastSample = millis();
+
+    si4735.getCurrentReceivedSignalQuality(0);
+
+    Snapshot snapshot;
+    snapshot.rssi = si4735.getCurrentRSSI();
+    snapshot.snr = si4735.getCurrentSNR();
+    snapshot.multipath = si4735.getCurrentMultipath();
+    snapshot.freqOffset = si4735.getCurrentSignedFrequencyOffset();
+    snapshot.sampledAt = lastSample;
+    snapshot.valid = true;
+
+    if (!emaSeeded) {
+        rssiEma = snapshot.rssi << 4;
+        snrEma = snapshot.snr << 4;
+        emaSeeded = true;
+    } else {
+        rssiEma = updateEma(rssiEma, snapshot.rssi);
+        snrEma = updateEma(snrEma, snapshot.snr);
+    }
+    snapshot.rssiAvg = (rssiEma + 8) >> 4; // Kerekítés
+    snapshot.snrAvg = (snrEma + 8) >> 4;
+
+    history[historyHead] = {snapshot.rssi, snapshot.snr};
+    historyHead = (historyHead + 1) & (SQ_HISTORY_SIZE - 1);
+    if (historyCount < SQ_HISTORY_SIZE) {
+        historyCount++;
+    }
+
+    publish(snapshot);
+}
@@ -0,0 +1,696 @@
+#include "StationDatabase.h"
+
+#include <new>
+
+#include "Band.h"
+#include "defines.h"
+
+#define STATION_DB_MAGIC 0x42445453 // "STDB"
+#define STATION_DB_VERSION 1
+#define STATION_DB_TEMP_FILE "/stations.tmp"
+#define STATION_DB_RUNS_FILE "/names.tmp"
+#define STATION_DB_MAX_LINE 192
+
+static_assert(sizeof(StationDatabase::Record) == 32, "A record must be 32 bytes");
+static_assert(STATION_DB_PAGE_SIZE % sizeof(StationDatabase::Record) == 0, "Records must not span pages");
+static_assert(STATION_DB_MAX_RECORDS <= 0xFFFF, "Record numbers are 16 bit");
+
+StationDatabase stationDatabase;
+
+/**
+ * Adásban van-e az adott időpontban (weekday: 0 = hétfő, >= 7: ismeretlen)
+ */
+bool StationDatabase::Record::isOnAir(uint16_t minuteOfDay, uint8_t weekday) const {
+    if (weekday < 7 && !(days & (1 << weekday))) {
+        return false;
+    }
+    if (startMinute <= endMinute) {
+        return minuteOfDay >= startMinute && minuteOfDay < endMinute;
+    }
+    return minuteOfDay >= startMinute || minuteOfDay < endMinute; // Éjfélen átnyúló adás
+}
+
+/**
+ * Konstruktor
+ */
+StationDatabase::StationDatabase() { invalidateCache(); }
+
+/**
+ * A gyorsítótár ürítése
+ */
+void StationDatabase::invalidateCache() {
+    for (uint8_t i = 0; i < STATION_DB_CACHE_PAGES; i++) {
+        cache[i].pageNo = 0xFFFF;
+        cache[i].lastUse = 0;
+    }
+}
+
+/**
+ * Egy lap a gyorsítótárból, szükség esetén a legrégebben használt helyére olvasva
+ */
+const uint8_t *StationDatabase::getPage(uint16_t pageNo) {
+    CachedPage *victim = &cache[0];
+    for (uint8_t i = 0; i < STATION_DB_CACHE_PAGES; i++) {
+        if (cache[i].pageNo == pageNo) {
+            cache[i].lastUse = ++useCounter;
+            stats.cacheHits++;
+            return cache[i].data;
+        }
+        if (cache[i].lastUse < victim->lastUse) {
+            victim = &cache[i];
+        }
+    }
+
+    if (!file.seek((uint32_t)pageNo * STATION_DB_PAGE_SIZE) || file.read(victim->data, STATION_DB_PAGE_SIZE) != STATION_DB_PAGE_SIZE) {
+        DEBUG("StationDatabase::getPage() -> read failed (page %u)\n", pageNo);
+        victim->pageNo = 0xFFFF;
+        victim->lastUse = 0;
+        return nullptr;
+    }
+    victim->pageNo = pageNo;
+    victim->lastUse = ++useCounter;
+    stats.pageReads++;
+    return victim->data;
+}
+
+/**
+ * Az adatbázis megnyitása: fejléc és lap-könyvtár
+ */
+bool StationDatabase::begin() {
+    ready = false;
+    invalidateCache();
+    if (file) {
+        file.close();
+    }
+
+    file = LittleFS.open(STATION_DB_FILE_NAME, "r");
+    if (!file) {
+        return false;
+    }
+
+    bool ok = file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) == sizeof(header) && header.magic == STATION_DB_MAGIC &&
+              header.version == STATION_DB_VERSION && header.pageSize == STATION_DB_PAGE_SIZE && header.recordCount <= STATION_DB_MAX_RECORDS &&
+              header.dataPages == (header.recordCount + RECORDS_PER_PAGE - 1) / RECORDS_PER_PAGE &&
+              header.namePages == (header.recordCount + NAMES_PER_PAGE - 1) / NAMES_PER_PAGE;
+    ok = ok && file.seek(STATION_DB_PAGE_SIZE) && file.read(reinterpret_cast<uint8_t *>(frequencyFences), sizeof(frequencyFences)) == sizeof(frequencyFences) &&
+         file.read(reinterpret_cast<uint8_t *>(nameFences), sizeof(nameFences)) == sizeof(nameFences);
+    if (!ok) {
+        DEBUG("StationDatabase::begin() -> invalid database file\n");
+        file.close();
+        return false;
+    }
+
+    ready = true;
+    DEBUG("StationDatabase::begin() -> %u records, %u + %u pages\n", header.recordCount, header.dataPages, header.namePages);
+    return true;
+}
+
+/**
+ * Egy rekord olvasása sorszám alapján
+ */
+bool StationDatabase::getRecord(uint16_t recordNo, Record &record) {
+    if (!ready || recordNo >= header.recordCount) {
+        return false;
+    }
+    const uint8_t *page = getPage(FIRST_DATA_PAGE + recordNo / RECORDS_PER_PAGE);
+    if (page == nullptr) {
+        return false;
+    }
+    memcpy(&record, page + (recordNo % RECORDS_PER_PAGE) * sizeof(Record), sizeof(Record));
+    return true;
+}
+
+/**
+ * Frekvencia tartomány szerinti lekérdezés
+ */
+uint16_t StationDatabase::findByFrequency(uint16_t minFrequency, uint16_t maxFrequency, Visitor visitor, void *context) {
+    if (!ready || header.recordCount == 0 || minFrequency > maxFrequency) {
+        return 0;
+    }
+
+    // Az első lap, amelynek az első frekvenciája >= minFrequency; az azonos frekvenciák az előző lapon is kezdődhetnek
+    uint16_t low = 0, high = header.dataPages;
+    while (low < high) {
+        uint16_t mid = (low + high) / 2;
+        if (frequencyFences[mid] < minFrequency) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    uint16_t found = 0;
+    for (uint16_t pageIdx = low > 0 ? low - 1 : 0; pageIdx < header.dataPages; pageIdx++) {
+        const uint8_t *page = getPage(FIRST_DATA_PAGE + pageIdx);
+        if (page == nullptr) {
+            break;
+        }
+        uint16_t first = pageIdx * RECORDS_PER_PAGE;
+        uint16_t count = min((uint16_t)RECORDS_PER_PAGE, (uint16_t)(header.recordCount - first));
+        for (uint16_t i = 0; i < count; i++) {
+            Record record;
+            memcpy(&record, page + i * sizeof(Record), sizeof(Record));
+            if (record.frequency < minFrequency) {
+                continue;
+            }
+            if (record.frequency > maxFrequency) {
+                return found;
+            }
+            found++;
+            if (!visitor(record, first + i, context)) {
+                return found;
+            }
+            // A visszahívás más lapot is olvashatott: a lapot újra elkérjük (gyorsítótár találat)
+            page = getPage(FIRST_DATA_PAGE + pageIdx);
+            if (page == nullptr) {
+                return found;
+            }
+        }
+    }
+    return found;
+}
+
+/**
+ * Név eleje szerinti lekérdezés
+ */
+uint16_t StationDatabase::findByNamePrefix(const char *prefix, Visitor visitor, void *context) {
+    if (!ready || header.recordCount == 0 || prefix == nullptr) {
+        return 0;
+    }
+
+    char key[STATION_DB_NAME_KEY_LEN];
+    makeNameKey(prefix, key);
+    size_t prefixLength = strlen(prefix);
+    size_t keyLength = min(prefixLength, (size_t)STATION_DB_NAME_KEY_LEN);
+
+    uint16_t low = 0, high = header.namePages;
+    while (low < high) {
+        uint16_t mid = (low + high) / 2;
+        if (memcmp(nameFences[mid], key, keyLength) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    uint16_t found = 0;
+    for (uint16_t pageIdx = low > 0 ? low - 1 : 0; pageIdx < header.namePages; pageIdx++) {
+        uint16_t first = pageIdx * NAMES_PER_PAGE;
+        uint16_t count = min((uint16_t)NAMES_PER_PAGE, (uint16_t)(header.recordCount - first));
+        for (uint16_t i = 0; i < count; i++) {
+            const uint8_t *page = getPage(FIRST_DATA_PAGE + header.dataPages + pageIdx);
+            if (page == nullptr) {
+                return found;
+            }
+            NameEntry entry;
+            memcpy(&entry, page + i * sizeof(NameEntry), sizeof(NameEntry));
+            int cmp = memcmp(entry.key, key, keyLength);
+            if (cmp < 0) {
+                continue;
+            }
+            if (cmp > 0) {
+                return found;
+            }
+
+            Record record;
+            if (!getRecord(entry.recordNo, record)) {
+                return found;
+            }
+            // A kulcsnál hosszabb előtagot a teljes néven ellenőrizzük
+            if (prefixLength > STATION_DB_NAME_KEY_LEN && strncasecmp(record.name, prefix, prefixLength) != 0) {
+                continue;
+            }
+            found++;
+            if (!visitor(record, entry.recordNo, context)) {
+                return found;
+            }
+        }
+    }
+    return found;
+}
+
+/**
+ * Név index kulcs: a név eleje nagybetűsen, 0-val kiegészítve
+ */
+void StationDatabase::makeNameKey(const char *name, char *key) {
+    memset(key, 0, STATION_DB_NAME_KEY_LEN);
+    for (uint8_t i = 0; i < STATION_DB_NAME_KEY_LEN && name[i] != '\0'; i++) {
+        key[i] = toupper((unsigned char)name[i]);
+    }
+}
+
+/**
+ * Napok mező: üres = minden nap, számjegyek (1 = hétfő) vagy napnevek (Mo,Tu,...) tartományokkal
+ */
+static uint8_t parseDays(const char *text) {
+    static const char *const names[] = {"MO", "TU", "WE", "TH", "FR", "SA", "SU"};
+    if (*text == '\0') {
+        return 0x7F;
+    }
+
+    uint8_t days = 0;
+    int8_t rangeStart = -1;
+    for (const char *p = text; *p != '\0';) {
+        int8_t day = -1;
+        if (*p >= '1' && *p <= '7') {
+            day = *p - '1';
+            p++;
+        } else if (isalpha((unsigned char)p[0]) && isalpha((unsigned char)p[1])) {
+            for (uint8_t d = 0; d < 7; d++) {
+                if (toupper((unsigned char)p[0]) == names[d][0] && toupper((unsigned char)p[1]) == names[d][1]) {
+                    day = d;
+                }
+            }
+            p += 2;
+        } else {
+            p++;
+            continue;
+        }
+        if (day < 0) {
+            return 0x7F; // Ismeretlen jelölés (pl. "irr"): minden nap
+        }
+
+        if (rangeStart >= 0) {
+            for (int8_t d = rangeStart; d != day; d = (d + 1) % 7) {
+                days |= 1 << d;
+            }
+            rangeStart = -1;
+        }
+        days |= 1 << day;
+        if (*p == '-') {
+            rangeStart = day;
+        }
+    }
+    return days != 0 ? days : 0x7F;
+}
+
+/**
+ * Egy CSV sor feldolgozása (kHz;Time(UTC);Days;ITU;Station;Lng;...)
+ * @return false, ha nem adat sor (fejléc, üres, hibás)
+ */
+bool StationDatabase::parseCsvLine(char *line, Record &record) {
+    char *fields[6] = {};
+    uint8_t fieldCount = 0;
+    for (char *p = line; fieldCount < 6; fieldCount++) {
+        fields[fieldCount] = p;
+        p = strchr(p, ';');
+        if (p == nullptr) {
+            fieldCount++;
+            break;
+        }
+        *p++ = '\0';
+    }
+    if (fieldCount < 5) {
+        return false;
+    }
+
+    float khz = atof(fields[0]);
+    if (khz < 1.0f || khz > 65535.0f) {
+        return false;
+    }
+
+    memset(&record, 0, sizeof(record));
+    record.frequency = (uint16_t)(khz + 0.5f);
+    record.modulation = AM;
+    record.days = parseDays(fields[2]);
+
+    // "hhmm-hhmm"
+    uint16_t start = 0, end = 2400;
+    if (strlen(fields[1]) >= 9 && fields[1][4] == '-') {
+        start = atoi(fields[1]);
+        end = atoi(fields[1] + 5);
+    }
+    record.startMinute = min((start / 100) * 60 + start % 100, 1440);
+    record.endMinute = min((end / 100) * 60 + end % 100, 1440);
+
+    strncpy(record.itu, fields[3], sizeof(record.itu));
+    strncpy(record.name, fields[4], STATION_DB_NAME_LEN);
+    if (fieldCount > 5) {
+        strncpy(record.language, fields[5], sizeof(record.language));
+    }
+    return record.name[0] != '\0';
+}
+
+/**
+ * Név index bejegyzések sorrendje
+ */
+static int compareNameEntries(const void *a, const void *b) {
+    int cmp = memcmp(a, b, STATION_DB_NAME_KEY_LEN);
+    if (cmp != 0) {
+        return cmp;
+    }
+    uint16_t ra, rb;
+    memcpy(&ra, (const uint8_t *)a + STATION_DB_NAME_KEY_LEN, sizeof(uint16_t));
+    memcpy(&rb, (const uint8_t *)b + STATION_DB_NAME_KEY_LEN, sizeof(uint16_t));
+    return (int)ra - (int)rb;
+}
+
+/**
+ * Az adatbázis felépítésének indítása
+ *
+ * 1. A rekord lapokat sorban írjuk (a CSV frekvencia szerint rendezett), közben a név index
+ *    bejegyzéseket STATION_DB_RUN_SIZE méretű, rendezett futásokként egy ideiglenes fájlba.
+ * 2. A futásokat összefésüljük a név index lapokba.
+ * 3. A fejlécet és a lap-könyvtárat a fájl elejére írjuk, majd az ideiglenes fájlt átnevezzük
+ *    (a LittleFS rename atomikusan cseréli a régi adatbázist).
+ * Az első két fázis az importStep() hívásokban, időkerettel halad.
+ */
+bool StationDatabase::beginImport(const char *csvPath) {
+    if (isImporting()) {
+        return false;
+    }
+    File source = LittleFS.open(csvPath, "r");
+    if (!source) {
+        return false;
+    }
+    importChunked = source.isDirectory();
+    strncpy(importSource, csvPath, sizeof(importSource) - 1);
+    importSource[sizeof(importSource) - 1] = '\0';
+
+    // A darabok száma és összmérete (az előrehaladáshoz és a hiányzó darab felismeréséhez)
+    importChunkTotal = importChunksDone = 0;
+    importTotalBytes = importDoneBytes = 0;
+    if (importChunked) {
+        source.close();
+        Dir dir = LittleFS.openDir(importSource);
+        while (dir.next()) {
+            if (dir.isFile()) {
+                importChunkTotal++;
+                importTotalBytes += dir.fileSize();
+            }
+        }
+        if (importChunkTotal == 0 || !openNextChunk()) {
+            return false;
+        }
+    } else {
+        strcpy(importChunk, importSource);
+        importChunkTotal = 1;
+        importTotalBytes = source.size();
+        importCsv = source;
+    }
+    importOut = LittleFS.open(STATION_DB_TEMP_FILE, "w+");
+    importRuns = LittleFS.open(STATION_DB_RUNS_FILE, "w+");
+    runBuffer = new (std::nothrow) NameEntry[STATION_DB_RUN_SIZE];
+    if (!importOut || !importRuns || runBuffer == nullptr) {
+        importPhase = ImportPhase::Records; // Az abortImport() mindent lezár
+        abortImport();
+        return false;
+    }
+
+    // Az import alatt a gyorsítótár az írási puffer, az adatbázis nem kérdezhető le
+    ready = false;
+    if (file) {
+        file.close();
+    }
+    invalidateCache();
+    uint8_t *pageBuffer = cache[0].data;
+    memset(pageBuffer, 0, STATION_DB_PAGE_SIZE);
+    memset(frequencyFences, 0, sizeof(frequencyFences));
+    memset(nameFences, 0, sizeof(nameFences));
+
+    // Helyfoglalás a fejlécnek és a lap-könyvtárnak (a végén írjuk ki)
+    bool ok = true;
+    for (uint16_t i = 0; i < FIRST_DATA_PAGE && ok; i++) {
+        ok = importOut.write(pageBuffer, STATION_DB_PAGE_SIZE) == STATION_DB_PAGE_SIZE;
+    }
+
+    importRecordCount = runFill = runCount = previousFrequency = mergedCount = 0;
+    importPhase = ImportPhase::Records;
+    if (!ok) {
+        abortImport();
+        return false;
+    }
+    DEBUG("StationDatabase::beginImport() -> %s, %u file(s), %lu bytes\n", csvPath, importChunkTotal, (unsigned long)importTotalBytes);
+    return true;
+}
+
+/**
+ * A következő (név szerint legkisebb) CSV darab megnyitása; a beolvasottakat már töröltük
+ */
+bool StationDatabase::openNextChunk() {
+    char next[STATION_DB_PATH_LEN] = "";
+    Dir dir = LittleFS.openDir(importSource);
+    while (dir.next()) {
+        if (dir.isFile() && (next[0] == '\0' || strcmp(dir.fileName().c_str(), next) < 0)) {
+            strncpy(next, dir.fileName().c_str(), sizeof(next) - 1);
+        }
+    }
+    if (next[0] == '\0') {
+        return false;
+    }
+    snprintf(importChunk, sizeof(importChunk), "%s/%s", importSource, next);
+    importCsv = LittleFS.open(importChunk, "r");
+    return importCsv;
+}
+
+/**
+ * A CSV maradékának törlése (sikeres import után, ill. ha a darabok egy része már elfogyott)
+ */
+void StationDatabase::removeImportSource() {
+    if (!importChunked) {
+        LittleFS.remove(importSource);
+        return;
+    }
+    Dir dir = LittleFS.openDir(importSource);
+    while (dir.next()) {
+        if (dir.isFile()) {
+            snprintf(importChunk, sizeof(importChunk), "%s/%s", importSource, dir.fileName().c_str());
+            LittleFS.remove(importChunk);
+        }
+    }
+    LittleFS.rmdir(importSource);
+}
+
+/**
+ * Az import folytatása
+ */
+StationDatabase::ImportStatus StationDatabase::importStep(uint16_t budgetMs) {
+    uint32_t deadline = millis() + budgetMs;
+
+    switch (importPhase) {
+    case ImportPhase::Records:
+        if (!importRecords(deadline)) {
+            return abortImport();
+        }
+        if (importCsv) {
+            return ImportStatus::Running; // Még van sor
+        }
+        return startMerge() ? ImportStatus::Running : abortImport();
+
+    case ImportPhase::Merge:
+        if (!mergeNames(deadline)) {
+            return abortImport();
+        }
+        return mergedCount < importRecordCount ? ImportStatus::Running : finishImport();
+
+    default:
+        return ImportStatus::Failed;
+    }
+}
+
+/**
+ * 1. fázis: CSV sorok a határidőig (legalább egy)
+ * A beolvasott darabot töröljük (a helyét az épülő adatbázis kapja), az utolsó után a CSV lezárva marad
+ * @return false hiba esetén
+ */
+bool StationDatabase::importRecords(uint32_t deadline) {
+    uint8_t *pageBuffer = cache[0].data;
+    char line[STATION_DB_MAX_LINE];
+
+    do {
+        if (!importCsv.available()) {
+            importDoneBytes += importCsv.size();
+            importCsv.close();
+            LittleFS.remove(importChunk);
+            if (++importChunksDone == importChunkTotal) {
+                return true;
+            }
+            if (!openNextChunk()) {
+                DEBUG("StationDatabase::importRecords() -> CSV chunk %u missing\n", importChunksDone + 1);
+                return false;
+            }
+            continue;
+        }
+        size_t length = importCsv.readBytesUntil('\n', line, sizeof(line) - 1);
+        line[length] = '\0';
+        if (length > 0 && line[length - 1] == '\r') {
+            line[length - 1] = '\0';
+        }
+        Record record;
+        if (!parseCsvLine(line, record)) {
+            continue;
+        }
+        if (record.frequency < previousFrequency || importRecordCount >= STATION_DB_MAX_RECORDS) {
+            DEBUG("StationDatabase::importRecords() -> %s at line for %u kHz\n",
+                  importRecordCount >= STATION_DB_MAX_RECORDS ? "too many records" : "input not sorted by frequency", record.frequency);
+            return false;
+        }
+        previousFrequency = record.frequency;
+
+        uint16_t slot = importRecordCount % RECORDS_PER_PAGE;
+        if (slot == 0) {
+            frequencyFences[importRecordCount / RECORDS_PER_PAGE] = record.frequency;
+        }
+        memcpy(pageBuffer + slot * sizeof(Record), &record, sizeof(Record));
+        if (slot == RECORDS_PER_PAGE - 1) {
+            if (importOut.write(pageBuffer, STATION_DB_PAGE_SIZE) != STATION_DB_PAGE_SIZE) {
+                return false;
+            }
+            memset(pageBuffer, 0, STATION_DB_PAGE_SIZE);
+        }
+
+        makeNameKey(record.name, runBuffer[runFill].key);
+        runBuffer[runFill].recordNo = importRecordCount;
+        importRecordCount++;
+        if (++runFill == STATION_DB_RUN_SIZE) {
+            qsort(runBuffer, runFill, sizeof(NameEntry), compareNameEntries);
+            if (importRuns.write(reinterpret_cast<const uint8_t *>(runBuffer), runFill * sizeof(NameEntry)) != runFill * sizeof(NameEntry)) {
+                return false;
+            }
+            runCount++;
+            runFill = 0;
+        }
+    } while ((int32_t)(millis() - deadline) < 0);
+    return true;
+}
+
+/**
+ * Az 1. fázis lezárása (utolsó lap, utolsó futás) és az összefésülés előkészítése
+ * Futásonként egy bejegyzés van a RAM-ban (a runBuffer elején)
+ */
+bool StationDatabase::startMerge() {
+    uint8_t *pageBuffer = cache[0].data;
+    if (importRecordCount % RECORDS_PER_PAGE != 0 && importOut.write(pageBuffer, STATION_DB_PAGE_SIZE) != STATION_DB_PAGE_SIZE) {
+        return false;
+    }
+    if (runFill > 0) {
+        qsort(runBuffer, runFill, sizeof(NameEntry), compareNameEntries);
+        if (importRuns.write(reinterpret_cast<const uint8_t *>(runBuffer), runFill * sizeof(NameEntry)) != runFill * sizeof(NameEntry)) {
+            return false;
+        }
+        runCount++;
+    }
+
+    for (uint16_t r = 0; r < runCount; r++) {
+        runPos[r] = (uint32_t)r * STATION_DB_RUN_SIZE * sizeof(NameEntry);
+        runEnd[r] = min(runPos[r] + STATION_DB_RUN_SIZE * sizeof(NameEntry), (uint32_t)importRecordCount * sizeof(NameEntry));
+        if (!importRuns.seek(runPos[r]) || importRuns.read(reinterpret_cast<uint8_t *>(&runBuffer[r]), sizeof(NameEntry)) != sizeof(NameEntry)) {
+            return false;
+        }
+    }
+    memset(pageBuffer, 0, STATION_DB_PAGE_SIZE);
+    mergedCount = 0;
+    importPhase = ImportPhase::Merge;
+    return true;
+}
+
+/**
+ * 2. fázis: név index bejegyzések a határidőig
+ * @return false hiba esetén
+ */
+bool StationDatabase::mergeNames(uint32_t deadline) {
+    uint8_t *pageBuffer = cache[0].data;
+
+    while (mergedCount < importRecordCount) {
+        int16_t best = -1;
+        for (uint16_t r = 0; r < runCount; r++) {
+            if (runPos[r] < runEnd[r] && (best < 0 || compareNameEntries(&runBuffer[r], &runBuffer[best]) < 0)) {
+                best = r;
+            }
+        }
+        uint16_t n = mergedCount++;
+        uint16_t slot = n % NAMES_PER_PAGE;
+        if (slot == 0) {
+            memcpy(nameFences[n / NAMES_PER_PAGE], runBuffer[best].key, STATION_DB_NAME_KEY_LEN);
+        }
+        memcpy(pageBuffer + slot * sizeof(NameEntry), &runBuffer[best], sizeof(NameEntry));
+        if (slot == NAMES_PER_PAGE - 1 || n == importRecordCount - 1) {
+            if (importOut.write(pageBuffer, STATION_DB_PAGE_SIZE) != STATION_DB_PAGE_SIZE) {
+                return false;
+            }
+            memset(pageBuffer, 0, STATION_DB_PAGE_SIZE);
+        }
+
+        runPos[best] += sizeof(NameEntry);
+        if (runPos[best] < runEnd[best] &&
+            (!importRuns.seek(runPos[best]) || importRuns.read(reinterpret_cast<uint8_t *>(&runBuffer[best]), sizeof(NameEntry)) != sizeof(NameEntry))) {
+            return false;
+        }
+        if ((int32_t)(millis() - deadline) >= 0) {
+            break;
+        }
+    }
+    return true;
+}
+
+/**
+ * 3. fázis: fejléc, lap-könyvtár, majd az új adatbázis a régi helyére
+ */
+StationDatabase::ImportStatus StationDatabase::finishImport() {
+    importRuns.close();
+    LittleFS.remove(STATION_DB_RUNS_FILE);
+    delete[] runBuffer;
+    runBuffer = nullptr;
+
+    FileHeader newHeader = {STATION_DB_MAGIC,
+                            STATION_DB_VERSION,
+                            STATION_DB_PAGE_SIZE,
+                            importRecordCount,
+                            (uint16_t)((importRecordCount + RECORDS_PER_PAGE - 1) / RECORDS_PER_PAGE),
+                            (uint16_t)((importRecordCount + NAMES_PER_PAGE - 1) / NAMES_PER_PAGE),
+                            0};
+    bool ok = importOut.seek(0) && importOut.write(reinterpret_cast<const uint8_t *>(&newHeader), sizeof(newHeader)) == sizeof(newHeader);
+    ok = ok && importOut.seek(STATION_DB_PAGE_SIZE) &&
+         importOut.write(reinterpret_cast<const uint8_t *>(frequencyFences), sizeof(frequencyFences)) == sizeof(frequencyFences) &&
+         importOut.write(reinterpret_cast<const uint8_t *>(nameFences), sizeof(nameFences)) == sizeof(nameFences);
+    importOut.close();
+    importPhase = ImportPhase::Idle;
+    removeImportSource(); // A darabok már elfogytak, csak a könyvtár maradt
+
+    // A rename a meglévő adatbázist atomikusan cseréli: táp elvesztésekor vagy a régi, vagy az új marad
+    if (!ok || !LittleFS.rename(STATION_DB_TEMP_FILE, STATION_DB_FILE_NAME)) {
+        DEBUG("StationDatabase::finishImport() -> %s FAILED\n", ok ? "rename" : "header write");
+        LittleFS.remove(STATION_DB_TEMP_FILE);
+        begin(); // A korábbi adatbázis (ha volt)
+        return ImportStatus::Failed;
+    }
+
+    DEBUG("StationDatabase::finishImport() -> %u records, %u name runs\n", importRecordCount, runCount);
+    return begin() ? ImportStatus::Done : ImportStatus::Failed;
+}
+
+/**
+ * Sikertelen import: az ideiglenes fájlok törlése, vissza a korábbi adatbázisra
+ */
+StationDatabase::ImportStatus StationDatabase::abortImport() {
+    DEBUG("StationDatabase::abortImport() -> FAILED after %u records\n", importRecordCount);
+    importCsv.close();
+    if (importChunksDone > 0) {
+        removeImportSource(); // A törölt darabok nélkül a maradékból csak hiányos adatbázis lenne
+    }
+    importOut.close();
+    importRuns.close();
+    delete[] runBuffer;
+    runBuffer = nullptr;
+    LittleFS.remove(STATION_DB_RUNS_FILE);
+    LittleFS.remove(STATION_DB_TEMP_FILE);
+    importPhase = ImportPhase::Idle;
+    begin();
+    return ImportStatus::Failed;
+}
+
+/**
+ * Az import előrehaladása
+ */
+uint8_t StationDatabase::getImportProgress() {
+    switch (importPhase) {
+    case ImportPhase::Records: {
+        uint64_t done = importDoneBytes + (importCsv ? importCsv.position() : 0);
+        return importTotalBytes == 0 ? 80 : done * 80 / importTotalBytes;
+    }
+    case ImportPhase::Merge:
+        return 80 + (uint32_t)mergedCount * 20 / max(importRecordCount, (uint16_t)1);
+    default:
+        return 0;
+    }
+}
@@ -0,0 +1,139 @@
+#include "StationData.h"
+
+#include "defines.h"
+
+namespace StationPacking {
+
+// Bit szélességek (összesen 96 bit)
+#define PACKED_NAME_CHAR_BITS 6
+#define PACKED_FREQUENCY_BITS 15
+#define PACKED_BAND_BITS 5
+#define PACKED_MODULATION_BITS 3
+#define PACKED_BANDWIDTH_BITS 3
+#define PACKED_BFO_BITS 10 // 1 bit lépték + 9 bit előjeles érték
+#define PACKED_BFO_COARSE_STEP 5 // A durva lépték (Hz), ha a BFO nem fér el 1 Hz-es lépésekben
+
+static_assert(PACKED_STATION_NAME_LEN * PACKED_NAME_CHAR_BITS + PACKED_FREQUENCY_BITS + PACKED_BAND_BITS + PACKED_MODULATION_BITS + PACKED_BANDWIDTH_BITS + PACKED_BFO_BITS ==
+                  PACKED_STATION_SIZE * 8,
+              "The packed station layout must fill PACKED_STATION_SIZE exactly");
+
+// A név karakterkészlete: 0 a lezáró, a kisbetűk nagybetűként tárolódnak, az ismeretlen karakter '?'
+static const char NAME_CHARSET[] = "\0 ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.-/+&'!():,#*?_@=\"$%<>[];~";
+static_assert(sizeof(NAME_CHARSET) - 1 == 1 << PACKED_NAME_CHAR_BITS, "The name charset must have exactly 64 entries");
+
+/**
+ * Bitfolyam írása/olvasása (LSB először)
+ */
+static void putBits(PackedStation &packed, uint8_t &pos, uint8_t width, uint16_t value) {
+    for (uint8_t i = 0; i < width; i++, pos++) {
+        if (value & (1 << i)) {
+            packed.bits[pos / 8] |= 1 << (pos % 8);
+        }
+    }
+}
+
+static uint16_t getBits(const PackedStation &packed, uint8_t &pos, uint8_t width) {
+    uint16_t value = 0;
+    for (uint8_t i = 0; i < width; i++, pos++) {
+        if (packed.bits[pos / 8] & (1 << (pos % 8))) {
+            value |= 1 << i;
+        }
+    }
+    return value;
+}
+
+static uint8_t encodeChar(char c) {
+    c = toupper((unsigned char)c);
+    const char *found = strchr(NAME_CHARSET + 1, c);
+    if (found == nullptr) {
+        found = strchr(NAME_CHARSET + 1, '?');
+    }
+    return found - NAME_CHARSET;
+}
+
+/**
+ * A BFO tárolt értéke: pontos -256..255 Hz között, azon túl 5 Hz-es lépésben (+-1275 Hz-ig, a többi levágva)
+ */
+static int16_t encodeBfo(int16_t bfoOffset, bool &coarse) {
+    const int16_t bfoMax = (1 << (PACKED_BFO_BITS - 2)) - 1;
+    coarse = bfoOffset < -bfoMax - 1 || bfoOffset > bfoMax;
+    if (!coarse) {
+        return bfoOffset;
+    }
+    return constrain((bfoOffset + (bfoOffset < 0 ? -PACKED_BFO_COARSE_STEP / 2 : PACKED_BFO_COARSE_STEP / 2)) / PACKED_BFO_COARSE_STEP, -bfoMax - 1, bfoMax);
+}
+
+/**
+ * Állomás tömörítése
+ * A név legfeljebb PACKED_STATION_NAME_LEN nagybetűs karakter, a +-255 Hz-en túli BFO 5 Hz-es lépésben tárolódik.
+ */
+void pack(const StationData &station, PackedStation &packed) {
+    memset(&packed, 0, sizeof(packed));
+    uint8_t pos = 0;
+
+    bool ended = false;
+    for (uint8_t i = 0; i < PACKED_STATION_NAME_LEN; i++) {
+        ended = ended || station.name[i] == '\0';
+        putBits(packed, pos, PACKED_NAME_CHAR_BITS, ended ? 0 : encodeChar(station.name[i]));
+    }
+
+    if (station.frequency >= 1 << PACKED_FREQUENCY_BITS || station.bandIndex >= 1 << PACKED_BAND_BITS || station.modulation >= 1 << PACKED_MODULATION_BITS ||
+        station.bandwidthIndex >= 1 << PACKED_BANDWIDTH_BITS) {
+        DEBUG("StationPacking::pack() -> '%s' %u does not fit, truncated!\n", station.name, station.frequency);
+    }
+    putBits(packed, pos, PACKED_FREQUENCY_BITS, station.frequency);
+    putBits(packed, pos, PACKED_BAND_BITS, station.bandIndex);
+    putBits(packed, pos, PACKED_MODULATION_BITS, station.modulation);
+    putBits(packed, pos, PACKED_BANDWIDTH_BITS, station.bandwidthIndex);
+
+    bool coarse;
+    int16_t bfo = encodeBfo(station.bfoOffset, coarse);
+    putBits(packed, pos, PACKED_BFO_BITS - 1, bfo & ((1 << (PACKED_BFO_BITS - 1)) - 1));
+    putBits(packed, pos, 1, coarse);
+}
+
+/**
+ * Állomás kibontása
+ */
+void unpack(const PackedStation &packed, StationData &station) {
+    memset(&station, 0, sizeof(station));
+    uint8_t pos = 0;
+
+    bool ended = false;
+    for (uint8_t i = 0; i < PACKED_STATION_NAME_LEN; i++) {
+        uint8_t code = getBits(packed, pos, PACKED_NAME_CHAR_BITS);
+        ended = ended || code == 0;
+        station.name[i] = ended ? '\0' : NAME_CHARSET[code];
+    }
+
+    station.frequency = getBits(packed, pos, PACKED_FREQUENCY_BITS);
+    station.bandIndex = getBits(packed, pos, PACKED_BAND_BITS);
+    station.modulation = getBits(packed, pos, PACKED_MODULATION_BITS);
+    station.bandwidthIndex = getBits(packed, pos, PACKED_BANDWIDTH_BITS);
+
+    int16_t bfo = getBits(packed, pos, PACKED_BFO_BITS - 1);
+    if (bfo & (1 << (PACKED_BFO_BITS - 2))) {
+        bfo -= 1 << (PACKED_BFO_BITS - 1); // Előjel kiterjesztés
+    }
+    station.bfoOffset = getBits(packed, pos, 1) ? bfo * PACKED_BFO_COARSE_STEP : bfo;
+}
+
+/**
+ * Az állomás a tárolás utáni alakjára hozva (név, BFO lépték), így a RAM másolat megegyezik a visszatöltöttel
+ */
+void normalize(StationData &station) {
+    PackedStation packed;
+    pack(station, packed);
+    unpack(packed, station);
+}
+
+/**
+ * A BFO eltolás a tárolás utáni értékére kerekítve (a tárolt állomások kereséséhez)
+ */
+int16_t normalizeBfo(int16_t bfoOffset) {
+    bool coarse;
+    int16_t bfo = encodeBfo(bfoOffset, coarse);
+    return coarse ? bfo * PACKED_BFO_COARSE_STEP : bfo;
+}
+
+} // namespace StationPacking
@@ -0,0 +1,128 @@
+#include "TuningEngine.h"
+
+#include "SignalQualitySampler.h"
+
+/**
+ * Konstruktor
+ */
+TuningEngine::TuningEngine(Si4735Ext &si4735, Band &band) : si4735(si4735), band(band) {}
+
+/**
+ * A cél felvétele a band rekordból és a konfigból
+ */
+void TuningEngine::syncFromBand() {
+    BandTable &currentBand = band.getCurrentBand();
+
+    targetFreq = currentBand.currFreq;
+    targetHz = (int32_t)currentBand.currFreq * 1000 + config.data.currentBFO;
+    targetBfoManu = config.data.currentBFOmanu;
+
+    appliedFreq = currentBand.currFreq;
+    appliedBandIdx = config.data.bandIdx;
+    targetValid = true;
+}
+
+/**
+ * Átfordulás a sávhatárokon (mint a könyvtár frequencyUp/Down-ja)
+ */
+uint16_t TuningEngine::wrapFrequency(int32_t freq) {
+    BandTable &currentBand = band.getCurrentBand();
+    if (freq > currentBand.maximumFreq) {
+        return currentBand.minimumFreq;
+    }
+    if (freq < currentBand.minimumFreq) {
+        return currentBand.maximumFreq;
+    }
+    return freq;
+}
+
+/**
+ * Rotary lépések hozzáadása
+ */
+void TuningEngine::addSteps(int16_t steps) {
+    if (steps == 0) {
+        return;
+    }
+
+    BandTable &currentBand = band.getCurrentBand();
+
+    // Ha közben más hangolt (seek, memória, AF, band váltás), onnan folytatjuk
+    if (!targetValid || (!pending && (currentBand.currFreq != appliedFreq || config.data.bandIdx != appliedBandIdx))) {
+        syncFromBand();
+    }
+    stepsReceived += abs(steps);
+
+    if (Band::getModeFamily(currentBand.currMod) == BAND_MODE_FAMILY_SSB) {
+        if (rtv::bfoOn) {
+            // Manuális BFO (kristály korrekció) állítás
+            targetBfoManu = constrain(targetBfoManu + steps * config.data.currentBFOStep, -TUNING_BFO_MANU_LIMIT, TUNING_BFO_MANU_LIMIT);
+        } else {
+            // Hz felbontású hangolás, a lépés a kijelzőn kiválasztott digit szerint
+            targetHz = constrain(targetHz + (int32_t)steps * rtv::freqstep, (int32_t)currentBand.minimumFreq * 1000, (int32_t)currentBand.maximumFreq * 1000);
+        }
+    } else {
+        targetFreq = wrapFrequency((int32_t)targetFreq + (int32_t)steps * currentBand.currStep);
+    }
+
+    pending = true;
+}
+
+/**
+ * Arduino loop
+ */
+void TuningEngine::loop() {
+
+    // A tekerés végén a jelminőség mintavétel újraindul
+    if (tunerBusy && !pending && millis() - lastCarrierChange >= TUNING_SETTLE_TIME) {
+        signalQualitySampler.setTunerBusy(TUNER_OWNER_TUNING, false);
+        tunerBusy = false;
+    }
+
+    if (!pending || millis() - lastTick < TUNING_TICK_INTERVAL) {
+        return;
+    }
+    lastTick = millis();
+    pending = false;
+    chipUpdates++;
+
+    BandTable &currentBand = band.getCurrentBand();
+    uint16_t carrier = targetFreq;
+    bool isSsb = Band::getModeFamily(currentBand.currMod) == BAND_MODE_FAMILY_SSB;
+    int32_t bfo = 0;
+
+    if (isSsb) {
+        // A vivőt csak akkor léptetjük, ha a BFO kifutna a tartományból
+        carrier = currentBand.currFreq;
+        bfo = targetHz - (int32_t)carrier * 1000;
+        if (abs(bfo) > TUNING_BFO_LIMIT) {
+            carrier = (targetHz + TUNING_BFO_LIMIT) / 1000;
+            bfo = targetHz - (int32_t)carrier * 1000;
+        }
+    }
+
+    if (carrier != currentBand.currFreq) {
+        currentBand.currFreq = carrier;
+        band.applyAntCap(carrier);          // Táblából, mérés nélkül
+        si4735.setFrequencyNoWait(carrier); // A következő parancs úgyis a CTS-re vár
+
+        lastCarrierChange = millis();
+        if (!tunerBusy) {
+            signalQualitySampler.setTunerBusy(TUNER_OWNER_TUNING, true);
+            tunerBusy = true;
+        }
+    }
+    appliedFreq = carrier;
+    appliedBandIdx = config.data.bandIdx;
+
+    if (isSsb && (bfo != config.data.currentBFO || targetBfoManu != config.data.currentBFOmanu)) {
+        config.data.currentBFO = bfo;
+        config.data.currentBFOmanu = targetBfoManu;
+        config.markDirty();
+        currentBand.lastBFO = bfo;
+        currentBand.lastmanuBFO = targetBfoManu;
+        rtv::freqDec = bfo;
+
+        const int16_t cwBaseOffset = (currentBand.currMod == CW) ? config.data.cwReceiverOffsetHz : 0;
+        si4735.setSSBBfo(cwBaseOffset + config.data.currentBFO + config.data.currentBFOmanu);
+    }
+}
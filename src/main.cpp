@@ -12,8 +12,10 @@
 #include "utils.h"
 
 //------------------- si4735
-#include <SI4735.h>
-SI4735 si4735;
+#include "Si4735Ext.h"
+Si4735Ext si4735;
+#include "SignalQualitySampler.h"
+SignalQualitySampler signalQualitySampler(si4735);
 
 //------------------ TFT
 #include <TFT_eSPI.h>
@@ -27,13 +29,25 @@ RotaryEncoder rotaryEncoder = RotaryEncoder(PIN_ENCODER_CLK, PIN_ENCODER_DT, PIN
 #define ROTARY_ENCODER_SERVICE_INTERVAL_IN_MSEC 1 // 1msec
 
 //-------------------- Config
+#include <LittleFS.h>
+
+#include "AntCapStore.h"
 #include "Config.h"
+#include "Crc16.h"
+#include "FlashCommitService.h"
+#include "FlashRecordStore.h"
+#include "PersistenceScheduler.h"
+#include "StationDatabase.h"
 #include "StationStore.h"
 #include "StoreEepromBase.h"
 extern Config config;
 extern FmStationStore fmStationStore;
 extern AmStationStore amStationStore;
 
+//-------------------- Band
+#include "Band.h"
+Band band(si4735, config);
+
 //-------------------- Screens
 // Globális képernyőkezelő
 ScreenManager screenManager(tft);
@@ -110,7 +124,18 @@ void setup() {
 
     // EEPROM inicializálása (A fordítónak muszáj megadni egy típust, itt most egy Config_t-t használunk, igaziból mindegy)
     tft.drawString("Loading EEPROM...", tft.width() / 2, 160);
-    StoreEepromBase<Config_t>::init(); // Meghívjuk a statikus init metódust
+    StoreEepromBase<Config_t>::init(); // Meghívjuk a statikus init metódust (a régi EEPROM kép átvételéhez kell)
+
+    // CRC16 DMA sniffer (a flash log és a tárolók ellenőrző összegeihez)
+    Crc16::init();
+#ifdef SHOW_CRC_BENCHMARK
+    Crc16::benchmark();
+#endif
+
+    // Flash log a konfignak és az állomáslistáknak (ha nem használható, marad az EEPROM)
+    if (!flashRecordStore.begin()) {
+        DEBUG("Flash record store unavailable, using EEPROM\n");
+    }
 
     // Ha a bekapcsolás alatt nyomva tartjuk a rotary gombját, akkor töröljük a konfigot
     if (digitalRead(PIN_ENCODER_SW) == LOW) {
@@ -140,6 +165,25 @@ void setup() {
     tft.drawString("Loading stations...", tft.width() / 2, 200);
     fmStationStore.load();
     amStationStore.load();
+    antCapStore.load(); // Antenna kapacitás tábla (a band beállítása előtt!)
+
+    // Késleltetett mentés: a tárolók módosításait az ütemező vonja össze és írja ki
+    persistenceScheduler.registerStore(config);
+    persistenceScheduler.registerStore(fmStationStore);
+    persistenceScheduler.registerStore(amStationStore);
+    persistenceScheduler.registerStore(antCapStore);
+
+    // Fájlrendszer (sáv aktivitás napló, állomás adatbázis)
+    if (!LittleFS.begin()) {
+        DEBUG("LittleFS mount failed!\n");
+    }
+
+    // Ha új műsorrend CSV-t töltöttek fel (egy fájlban vagy darabolva), abból építjük újra az állomás adatbázist
+    // a loop()-ban, lépésenként (a felület közben használható, az előrehaladást az FM képernyő állapot sora mutatja)
+    const char *importSource = LittleFS.exists(STATION_DB_IMPORT_DIR) ? STATION_DB_IMPORT_DIR : STATION_DB_IMPORT_FILE;
+    if (!LittleFS.exists(importSource) || !stationDatabase.beginImport(importSource)) {
+        stationDatabase.begin();
+    }
 
     // Splash screen megjelenítése inicializálás közben
     // Most átváltunk a teljes splash screen-re az SI4735 infókkal
@@ -174,6 +218,9 @@ void setup() {
     si4735.setDeviceI2CAddress(si4735Addr == 0x11 ? 0 : 1); // Sets the I2C Bus Address, erre is szükség van...
     splash.drawSI4735Info(si4735);
     si4735.setAudioMuteMcuPin(PIN_AUDIO_MUTE); // Audio Mute pin
+#ifdef PIN_SI4735_INT
+    si4735.beginInterrupts(PIN_SI4735_INT); // GPO2/INT megszakítás (a chip oldali engedélyezés és a láb tesztje a band beállításakor)
+#endif
     delay(300);
     //--------------------------------------------------------------------
 
@@ -208,14 +255,15 @@ void setup() {
  */
 void loop() {
 
-    //------------------- EEPROM mentés figyelése
-#define EEPROM_SAVE_CHECK_INTERVAL 1000 * 60 * 5 // 5 perc
-    static uint32_t lastEepromSaveCheck = 0;
-    if (millis() - lastEepromSaveCheck >= EEPROM_SAVE_CHECK_INTERVAL) {
-        config.checkSave();
-        fmStationStore.checkSave();
-        amStationStore.checkSave();
-        lastEepromSaveCheck = millis();
+    //------------------- Módosított beállítások/állomások késleltetett mentése
+    persistenceScheduler.loop();
+
+    // Flash log tömörítés, ha fogytak a törölt szektorok
+    flashRecordStore.loop();
+
+    // Állomás adatbázis import (időkerettel); a beolvasott CSV-t maga az import törli
+    if (stationDatabase.isImporting()) {
+        stationDatabase.importStep(STATION_DB_IMPORT_STEP_BUDGET);
     }
 //------------------- Memória információk megjelenítése
 #ifdef SHOW_MEMORY_INFO
@@ -237,6 +285,7 @@ void loop() {
         // DEBUG("Touch PRESS at (%d,%d)\n", touchX, touchY);
         TouchEvent touchEvent(touchX, touchY, true);
         screenManager.handleTouch(touchEvent);
+        rtv::lastUserActivity = millis();
         // bool handled = screenManager.handleTouch(touchEvent);
         //  DEBUG("Touch PRESS handled: %s\n", handled ? "YES" : "NO");
         lastTouchX = touchX;
@@ -247,6 +296,7 @@ void loop() {
         // DEBUG("Touch RELEASE at (%d,%d)\n", lastTouchX, lastTouchY);
         TouchEvent touchEvent(lastTouchX, lastTouchY, false);
         screenManager.handleTouch(touchEvent);
+        rtv::lastUserActivity = millis(); // A gombok a felengedéskor hajtják végre a beállításokat
         // bool handled = screenManager.handleTouch(touchEvent);
         //  DEBUG("Touch RELEASE handled: %s\n", handled ? "YES" : "NO");
     }
@@ -277,11 +327,15 @@ void loop() {
         }
 
         // Esemény továbbítása a ScreenManager-nek
-        RotaryEvent rotaryEvent(direction, buttonState);
+        RotaryEvent rotaryEvent(direction, buttonState, encoderState.value);
+        rtv::lastUserActivity = millis();
         bool handled = screenManager.handleRotary(rotaryEvent);
         DEBUG("Rotary event handled by screen: %s\n", handled ? "YES" : "NO");
     }
 
+    // Jelminőség mintavétel (a squelch és a kijelzők ebből olvasnak)
+    signalQualitySampler.loop();
+
     // Deferred actions feldolgozása - biztonságos képernyőváltások végrehajtása
     screenManager.processDeferredActions();
 
@@ -295,6 +349,9 @@ void loop() {
     if (millis() - lastDrawTime >= DRAW_INTERVAL) {
         screenManager.draw();
         lastDrawTime = millis();
+
+        // Flash írások a két képkocka között (időkerettel)
+        flashCommitService.loop();
     }
 }
 
@@ -36,7 +36,13 @@ bool SCANpause = true;  // LWH - SCANpause must be initialized to a value else t
 // Seek
 bool SEEK = false;
 
+// Beacon figyelés
+bool BEACON = false;
+
 // CW shift
 bool CWShift = false;
 
+// Felhasználói aktivitás
+uint32_t lastUserActivity = 0;
+
 }  // namespace rtv
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "utils.h"
 
 #include "Config.h" // Szükséges a config objektum eléréséhez
+#include "Crc16.h"
 #include "defines.h"
 
 namespace Utils {
@@ -214,17 +215,12 @@ void trimSpaces(char *str) {
  *
  * @param data Adat pointer
  * @param length Adat hossza bájtokban
+ * @param crc Kezdőérték (több darabban számolt CRC-nél az előző darab eredménye)
  * @return Számított CRC16 érték
  */
-uint16_t calcCRC16(const uint8_t *data, size_t length) {
-    uint16_t crc = 0xFFFF;
-    for (size_t i = 0; i < length; i++) {
-        crc ^= data[i] << 8;
-        for (uint8_t j = 0; j < 8; j++) {
-            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
-        }
-    }
-    return crc;
+uint16_t calcCRC16(const uint8_t *data, size_t length, uint16_t crc) {
+    // Táblázatos, nagy pufferre DMA sniffer (lásd Crc16.h)
+    return Crc16::calc(data, length, crc);
 }
 
 } // namespace Utils
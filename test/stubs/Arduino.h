@@ -0,0 +1,48 @@
+#ifndef __TEST_STUB_ARDUINO_H
+#define __TEST_STUB_ARDUINO_H
+
+// Minimális Arduino felület a natív (host) tesztekhez: csak amit a tesztelt fordítási egységek használnak
+
+#include <algorithm>
+#include <cctype>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define __not_in_flash_func(func) func
+
+// Az idő a teszt kezében van (szimulált óra)
+uint32_t millis();
+uint32_t micros();
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+// Debug kimenet: csak TEST_VERBOSE környezeti változóval
+struct SerialStub {
+    int printf(const char *format, ...) {
+        if (getenv("TEST_VERBOSE") == nullptr) {
+            return 0;
+        }
+        va_list args;
+        va_start(args, format);
+        int written = vprintf(format, args);
+        va_end(args);
+        return written;
+    }
+};
+inline SerialStub Serial;
+
+struct RP2040Stub {
+    void idleOtherCore() {}
+    void resumeOtherCore() {}
+};
+inline RP2040Stub rp2040;
+
+#endif // __TEST_STUB_ARDUINO_H
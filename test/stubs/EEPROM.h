@@ -0,0 +1,46 @@
+#ifndef __TEST_STUB_EEPROM_H
+#define __TEST_STUB_EEPROM_H
+
+#include <Arduino.h>
+
+/**
+ * Az arduino-pico EEPROM emuláció RAM pufferes megfelelője (a védett mezők neve is azonos)
+ */
+class EEPROMClass {
+  public:
+    void begin(size_t size) {
+        _size = (size + 255) & ~255;
+        _data = _buffer;
+        memset(_buffer, 0xFF, sizeof(_buffer));
+    }
+    template <typename T> T &get(int address, T &t) {
+        memcpy(&t, _data + address, sizeof(T));
+        return t;
+    }
+    template <typename T> const T &put(int address, const T &t) {
+        if (memcmp(_data + address, &t, sizeof(T)) != 0) {
+            _dirty = true;
+            memcpy(_data + address, &t, sizeof(T));
+        }
+        return t;
+    }
+    bool commit() {
+        _dirty = false;
+        return true;
+    }
+    const uint8_t *getConstDataPtr() const { return _data; }
+    size_t length() { return _size; }
+    bool isDirty() const { return _dirty; }
+
+  protected:
+    uint8_t *_sector = nullptr;
+    uint8_t *_data = nullptr;
+    size_t _size = 0;
+    bool _dirty = false;
+
+  private:
+    uint8_t _buffer[4096];
+};
+inline EEPROMClass EEPROM;
+
+#endif // __TEST_STUB_EEPROM_H
@@ -0,0 +1,7 @@
+#ifndef __TEST_STUB_TFT_ESPI_H
+#define __TEST_STUB_TFT_ESPI_H
+
+// A utils.h csak referenciaként használja
+class TFT_eSPI {};
+
+#endif // __TEST_STUB_TFT_ESPI_H
@@ -0,0 +1,17 @@
+#ifndef __TEST_STUB_HARDWARE_FLASH_H
+#define __TEST_STUB_HARDWARE_FLASH_H
+
+#include <Arduino.h>
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+
+// A szimulált flash (a teszt definiálja): az XIP ablak ennek az elejére mutat
+extern "C" uint8_t simFlash[];
+#define XIP_BASE ((uintptr_t)simFlash)
+
+// A teszt valósítja meg (NOR szemantika, táp kimaradás szimuláció)
+void flash_range_erase(uint32_t flashOffset, size_t count);
+void flash_range_program(uint32_t flashOffset, const uint8_t *data, size_t count);
+
+#endif // __TEST_STUB_HARDWARE_FLASH_H
@@ -0,0 +1,6 @@
+#ifndef __TEST_STUB_HARDWARE_SYNC_H
+#define __TEST_STUB_HARDWARE_SYNC_H
+
+// A natív teszteknél nincs mit tiltani (egy szál, megszakítások nélkül)
+
+#endif // __TEST_STUB_HARDWARE_SYNC_H
@@ -0,0 +1,165 @@
+#include <unity.h>
+
+#include "ConfigSchema.h"
+
+void setUp() {}
+void tearDown() {}
+
+/**
+ * Nem alapértelmezett értékekkel kitöltött konfig (a kitöltő byte-ok 0-k, így memcmp-pel összevethető)
+ */
+static void fillConfig(Config_t &config) {
+    memset(&config, 0, sizeof(config));
+    config.bandIdx = 7;
+    config.bwIdxAM = 2;
+    config.currentBFO = -1234;
+    config.currentBFOStep = 25;
+    config.currentBFOmanu = 567;
+    config.squelchUsesRSSI = true;
+    config.currVolume = 42;
+    for (uint8_t i = 0; i < 5; i++) {
+        config.tftCalibrateData[i] = 1000 + i;
+    }
+    config.screenSaverTimeoutMinutes = 15;
+    config.miniAudioFftConfigAm = 1.5f;
+    config.rttyShiftHz = 170.0f;
+}
+
+/**
+ * Egy mező hozzáfűzése egy kézzel épített rekordhoz
+ */
+static void appendField(ConfigRecord_t &record, uint8_t tag, const void *value, uint8_t length) {
+    uint16_t pos = record.header.length;
+    record.payload[pos] = tag;
+    record.payload[pos + 1] = length;
+    memcpy(&record.payload[pos + 2], value, length);
+    record.header.length = pos + 2 + length;
+}
+
+static void emptyRecord(ConfigRecord_t &record) {
+    memset(&record, 0, sizeof(record));
+    record.header.version = CONFIG_SCHEMA_VERSION;
+}
+
+/**
+ * Kódolás, majd visszafejtés: minden mező visszakerül
+ */
+void test_round_trip() {
+    Config_t original, decoded;
+    fillConfig(original);
+    memset(&decoded, 0, sizeof(decoded));
+
+    ConfigRecord_t record;
+    ConfigSchema::encode(original, record);
+    TEST_ASSERT_EQUAL_UINT8(CONFIG_SCHEMA_VERSION, record.header.version);
+    TEST_ASSERT_EQUAL_UINT16(ConfigSchema::encodedSize(), record.header.length);
+
+    TEST_ASSERT_TRUE(ConfigSchema::decode(record, decoded));
+    TEST_ASSERT_EQUAL_MEMORY(&original, &decoded, sizeof(Config_t));
+}
+
+/**
+ * Az ismeretlen (újabb firmware-ből származó) tag-et átugorjuk, a mögötte lévő mezők betöltődnek
+ */
+void test_unknown_tag_is_skipped() {
+    ConfigRecord_t record;
+    emptyRecord(record);
+    const uint8_t future[3] = {0xAA, 0xBB, 0xCC};
+    appendField(record, 200, future, sizeof(future));
+    uint8_t volume = 33;
+    appendField(record, 15, &volume, sizeof(volume));
+
+    Config_t config;
+    fillConfig(config);
+    TEST_ASSERT_TRUE(ConfigSchema::decode(record, config));
+    TEST_ASSERT_EQUAL_UINT8(33, config.currVolume);
+}
+
+/**
+ * A rekordból hiányzó mezők megtartják az előtte beállított (alap)értéket
+ */
+void test_missing_fields_keep_defaults() {
+    ConfigRecord_t record;
+    emptyRecord(record);
+    uint8_t bandIdx = 3;
+    appendField(record, 1, &bandIdx, sizeof(bandIdx));
+
+    Config_t config, defaults;
+    fillConfig(config);
+    fillConfig(defaults);
+    TEST_ASSERT_TRUE(ConfigSchema::decode(record, config));
+    TEST_ASSERT_EQUAL_UINT8(3, config.bandIdx);
+    config.bandIdx = defaults.bandIdx;
+    TEST_ASSERT_EQUAL_MEMORY(&defaults, &config, sizeof(Config_t));
+}
+
+/**
+ * Eltérő szélességű egész: előjel kiterjesztés (Signed), nullával bővítés és csonkolás (Unsigned)
+ */
+void test_integer_width_conversion() {
+    ConfigRecord_t record;
+    emptyRecord(record);
+    int16_t narrowBfo = -5;
+    appendField(record, 9, &narrowBfo, sizeof(narrowBfo)); // currentBFO: int
+    uint16_t wideTimeout = 30;
+    appendField(record, 21, &wideTimeout, sizeof(wideTimeout)); // screenSaverTimeoutMinutes: uint8_t
+
+    Config_t config;
+    fillConfig(config);
+    TEST_ASSERT_TRUE(ConfigSchema::decode(record, config));
+    TEST_ASSERT_EQUAL_INT32(-5, config.currentBFO);
+    TEST_ASSERT_EQUAL_UINT8(30, config.screenSaverTimeoutMinutes);
+}
+
+/**
+ * Nem egész (Raw/Float) mező eltérő mérettel: az alapérték marad
+ */
+void test_size_mismatch_keeps_default() {
+    ConfigRecord_t record;
+    emptyRecord(record);
+    const uint16_t shortCalibration[3] = {1, 2, 3};
+    appendField(record, 18, shortCalibration, sizeof(shortCalibration)); // tftCalibrateData[5]
+    double wideFloat = 2.5;
+    appendField(record, 31, &wideFloat, sizeof(wideFloat)); // rttyShiftHz: float
+
+    Config_t config, defaults;
+    fillConfig(config);
+    fillConfig(defaults);
+    TEST_ASSERT_TRUE(ConfigSchema::decode(record, config));
+    TEST_ASSERT_EQUAL_MEMORY(&defaults, &config, sizeof(Config_t));
+}
+
+/**
+ * Hibás szerkezet: túl nagy hossz, illetve a rekord végén túlnyúló mező
+ */
+void test_malformed_records_are_rejected() {
+    Config_t config;
+    fillConfig(config);
+
+    ConfigRecord_t record;
+    emptyRecord(record);
+    record.header.length = sizeof(record.payload) + 1;
+    TEST_ASSERT_FALSE(ConfigSchema::decode(record, config));
+
+    emptyRecord(record);
+    uint8_t volume = 1;
+    appendField(record, 15, &volume, sizeof(volume));
+    record.payload[1] = 10; // A mező hossza a rekord végén túl
+    TEST_ASSERT_FALSE(ConfigSchema::decode(record, config));
+
+    emptyRecord(record);
+    appendField(record, 15, &volume, sizeof(volume));
+    record.header.length = 1; // Félbevágott fejléc
+    TEST_ASSERT_FALSE(ConfigSchema::decode(record, config));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_unknown_tag_is_skipped);
+    RUN_TEST(test_missing_fields_keep_defaults);
+    RUN_TEST(test_integer_width_conversion);
+    RUN_TEST(test_size_mismatch_keeps_default);
+    RUN_TEST(test_malformed_records_are_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,73 @@
+#include <unity.h>
+
+#include "Crc16.h"
+
+// CRC-16/CCITT-FALSE ellenőrző érték: "123456789" -> 0x29B1
+static const uint8_t checkInput[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+void setUp() {}
+void tearDown() {}
+
+/**
+ * A szabványos ellenőrző érték mindhárom változattal
+ */
+void test_check_value() {
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, Crc16::bitwise(checkInput, sizeof(checkInput)));
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, Crc16::table(checkInput, sizeof(checkInput)));
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, Crc16::calc(checkInput, sizeof(checkInput)));
+}
+
+/**
+ * Üres puffer: a kezdőérték marad
+ */
+void test_empty_buffer() {
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, Crc16::table(checkInput, 0));
+    TEST_ASSERT_EQUAL_HEX16(0x1234, Crc16::calc(checkInput, 0, 0x1234));
+}
+
+/**
+ * A táblázatos változat minden méretre a bitenkénti referenciával egyezik (a DMA küszöbön túl is)
+ */
+void test_table_matches_bitwise() {
+    static uint8_t buffer[CRC16_DMA_THRESHOLD * 4 + 3];
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = i * 131 + 7;
+    }
+    for (size_t length = 0; length <= sizeof(buffer); length += 17) {
+        TEST_ASSERT_EQUAL_HEX16(Crc16::bitwise(buffer, length), Crc16::table(buffer, length));
+        TEST_ASSERT_EQUAL_HEX16(Crc16::bitwise(buffer, length, 0x1D0F), Crc16::table(buffer, length, 0x1D0F));
+        TEST_ASSERT_EQUAL_HEX16(Crc16::bitwise(buffer, length), Crc16::calc(buffer, length));
+    }
+}
+
+/**
+ * Darabokban számolva (az előző eredmény a következő kezdőértéke) ugyanaz, mint egyben
+ */
+void test_chained() {
+    uint8_t buffer[300];
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = i ^ 0x5A;
+    }
+    uint16_t whole = Crc16::calc(buffer, sizeof(buffer));
+    uint16_t first = Crc16::calc(buffer, 100);
+    TEST_ASSERT_EQUAL_HEX16(whole, Crc16::calc(buffer + 100, sizeof(buffer) - 100, first));
+}
+
+/**
+ * DMA nélkül az init() a táblára esik vissza, a dma() is a táblával számol
+ */
+void test_no_dma_fallback() {
+    TEST_ASSERT_FALSE(Crc16::init());
+    TEST_ASSERT_FALSE(Crc16::isDmaReady());
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, Crc16::dma(checkInput, sizeof(checkInput)));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_check_value);
+    RUN_TEST(test_empty_buffer);
+    RUN_TEST(test_table_matches_bitwise);
+    RUN_TEST(test_chained);
+    RUN_TEST(test_no_dma_fallback);
+    return UNITY_END();
+}
@@ -0,0 +1,72 @@
+#include <unity.h>
+
+#include <chrono>
+#include <cstdio>
+
+#include "ConfigSchema.h"
+#include "Crc16.h"
+#include "StationData.h"
+
+// A Crc16::benchmark() host párja: ugyanazokkal a tárolt méretekkel a bitenkénti és a táblázatos változat
+// (a DMA út csak az RP2040-en mérhető, ott a benchmark() a debug kimenetre írja a ciklusszámokat)
+
+#define BENCHMARK_TRIALS 5          // Ennyi mérésből a legjobb számít (a többi folyamat zaja ellen)
+#define BENCHMARK_MIN_BYTES 1000000 // Egy mérésben legalább ennyi byte-ot számolunk végig
+
+static uint8_t buffer[sizeof(PackedAmStationList_t)];
+static volatile uint16_t sink; // Az eredményt felhasználjuk, hogy a fordító ne hagyja el a ciklust
+
+void setUp() {
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = i * 131 + 7;
+    }
+}
+void tearDown() {}
+
+/**
+ * Egy változat mérése: a legjobb próbálkozás ns / byte értéke
+ */
+static double measure(uint16_t (*fn)(const uint8_t *, size_t, uint16_t), size_t length) {
+    size_t rounds = BENCHMARK_MIN_BYTES / length + 1;
+    double best = 0;
+    for (uint8_t trial = 0; trial < BENCHMARK_TRIALS; trial++) {
+        auto start = std::chrono::steady_clock::now();
+        uint16_t crc = 0xFFFF;
+        for (size_t i = 0; i < rounds; i++) {
+            crc = fn(buffer, length, crc);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        sink = crc;
+
+        double nsPerByte = std::chrono::duration<double, std::nano>(elapsed).count() / ((double)rounds * length);
+        if (trial == 0 || nsPerByte < best) {
+            best = nsPerByte;
+        }
+    }
+    return best;
+}
+
+/**
+ * Egy tárolt méret: a két változat ideje és aránya, a tábla nem lehet lassabb a referenciánál
+ */
+static void compareAt(const char *name, size_t length) {
+    TEST_ASSERT_EQUAL_HEX16(Crc16::bitwise(buffer, length), Crc16::table(buffer, length));
+
+    double bitwiseNs = measure(Crc16::bitwise, length);
+    double tableNs = measure(Crc16::table, length);
+    printf("  %-12s %5u bytes: bitwise %6.3f ns/byte, table %6.3f ns/byte, %4.1fx\n", name, (unsigned)length, bitwiseNs, tableNs, bitwiseNs / tableNs);
+
+    TEST_ASSERT_TRUE(tableNs < bitwiseNs);
+}
+
+void test_config_size() { compareAt("Config_t", sizeof(Config_t)); }
+void test_fm_station_list_size() { compareAt("FM stations", sizeof(PackedFmStationList_t)); }
+void test_am_station_list_size() { compareAt("AM stations", sizeof(PackedAmStationList_t)); }
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_config_size);
+    RUN_TEST(test_fm_station_list_size);
+    RUN_TEST(test_am_station_list_size);
+    return UNITY_END();
+}
@@ -0,0 +1,292 @@
+#include <unity.h>
+
+// A tesztelt fordítási egységek (a native környezet közösen csak a függőség nélküli egységeket fordítja)
+#include "../../src/FlashCommitService.cpp"
+#include "../../src/FlashRecordStore.cpp"
+
+#include "Crc16.h"
+#include "StoreFlashLog.h"
+
+// Szimulált flash: [program | EEPROM szektor | log szektorok | fájlrendszer]
+#define SIM_EEPROM_OFFSET 0x1000
+#define SIM_FS_OFFSET (SIM_EEPROM_OFFSET + FLASH_SECTOR_SIZE + FLASH_LOG_SECTORS * FLASH_SECTOR_SIZE)
+#define SIM_FLASH_SIZE (SIM_FS_OFFSET + FLASH_SECTOR_SIZE)
+#define SIM_STR(x) #x
+#define SIM_XSTR(x) SIM_STR(x)
+
+extern "C" {
+uint8_t simFlash[SIM_FLASH_SIZE] __attribute__((aligned(FLASH_SECTOR_SIZE)));
+}
+
+// A linker szkript szimbólumai a szimulált flash-en belül (ELF)
+asm(".globl __flash_binary_end\n.set __flash_binary_end, simFlash + " SIM_XSTR(SIM_EEPROM_OFFSET) "\n"
+    ".globl _EEPROM_start\n.set _EEPROM_start, simFlash + " SIM_XSTR(SIM_EEPROM_OFFSET) "\n"
+    ".globl _FS_start\n.set _FS_start, simFlash + " SIM_XSTR(SIM_FS_OFFSET) "\n");
+
+// A program többi részének itt szükséges darabjai
+namespace rtv {
+uint32_t lastUserActivity = 0;
+}
+namespace Utils {
+uint16_t calcCRC16(const uint8_t *data, size_t length, uint16_t crc) { return Crc16::calc(data, length, crc); }
+} // namespace Utils
+
+// Szimulált óra
+static uint32_t simMillis = 0;
+uint32_t millis() { return simMillis; }
+uint32_t micros() { return simMillis * 1000; }
+
+// Táp kimaradás: a számláló lejártakor a folyamatban lévő flash művelet félbeszakad
+struct PowerFail {};
+static int32_t opsUntilPowerFail = -1; // -1: nincs kimaradás
+static bool tearMidway = false;         // A programozás a változó byte-ok felénél szakad meg (különben véletlen helyen)
+static uint32_t randomState = 1;
+
+static uint32_t nextRandom() {
+    randomState = randomState * 1103515245u + 12345u;
+    return randomState >> 8;
+}
+
+static bool powerFailsNow() { return opsUntilPowerFail >= 0 && opsUntilPowerFail-- == 0; }
+
+/**
+ * NOR flash törlés (félbeszakadva a szektornak csak az eleje törlődik)
+ */
+void flash_range_erase(uint32_t flashOffset, size_t count) {
+    if (powerFailsNow()) {
+        memset(simFlash + flashOffset, 0xFF, nextRandom() % count);
+        throw PowerFail();
+    }
+    memset(simFlash + flashOffset, 0xFF, count);
+}
+
+/**
+ * A lapon változó byte-ok felezőpontja (a félbeszakított rekord közepe)
+ */
+static size_t changedMidpoint(uint32_t flashOffset, const uint8_t *data, size_t count) {
+    size_t first = count, last = 0;
+    for (size_t i = 0; i < count; i++) {
+        if ((simFlash[flashOffset + i] & data[i]) != simFlash[flashOffset + i]) {
+            first = min(first, i);
+            last = i;
+        }
+    }
+    return first < count ? (first + last + 1) / 2 : 0;
+}
+
+/**
+ * NOR flash programozás: csak 1 -> 0 bitváltás (félbeszakadva a lapnak csak az eleje íródik)
+ */
+void flash_range_program(uint32_t flashOffset, const uint8_t *data, size_t count) {
+    bool fails = powerFailsNow();
+    size_t programmed = !fails ? count : tearMidway ? changedMidpoint(flashOffset, data, count) : nextRandom() % count;
+    for (size_t i = 0; i < programmed; i++) {
+        simFlash[flashOffset + i] &= data[i];
+    }
+    if (fails) {
+        throw PowerFail();
+    }
+}
+
+/**
+ * Újraindítás: a RAM állapot (sor, index) elveszik, a flash tartalma marad
+ */
+static void reboot() {
+    opsUntilPowerFail = -1;
+    tearMidway = false;
+    flashCommitService = FlashCommitService();
+    flashRecordStore = FlashRecordStore();
+    TEST_ASSERT_TRUE(flashRecordStore.begin());
+}
+
+void setUp() {
+    memset(simFlash, 0xFF, sizeof(simFlash));
+    simMillis = 0;
+    randomState = 1;
+    reboot();
+}
+
+void tearDown() {}
+
+/**
+ * Írás, olvasás a sorból (még ki nem írva), majd újraindítás után a flash-ről
+ */
+void test_write_read_and_reboot() {
+    uint32_t value = 0x12345678;
+    TEST_ASSERT_TRUE(flashRecordStore.write(FLASH_LOG_KEY(1, 0), &value, sizeof(value)));
+    TEST_ASSERT_FALSE(flashCommitService.isIdle());
+
+    uint32_t readBack = 0;
+    TEST_ASSERT_TRUE(flashRecordStore.read(FLASH_LOG_KEY(1, 0), &readBack, sizeof(readBack)));
+    TEST_ASSERT_EQUAL_HEX32(value, readBack);
+
+    flashCommitService.flush();
+    reboot();
+    readBack = 0;
+    TEST_ASSERT_TRUE(flashRecordStore.read(FLASH_LOG_KEY(1, 0), &readBack, sizeof(readBack)));
+    TEST_ASSERT_EQUAL_HEX32(value, readBack);
+    TEST_ASSERT_FALSE(flashRecordStore.read(FLASH_LOG_KEY(1, 1), &readBack, sizeof(readBack)));
+}
+
+/**
+ * A változatlan tartalom írása kimarad
+ */
+void test_unchanged_write_is_skipped() {
+    uint32_t value = 42;
+    flashRecordStore.write(FLASH_LOG_KEY(1, 0), &value, sizeof(value));
+    flashRecordStore.write(FLASH_LOG_KEY(1, 0), &value, sizeof(value));
+    TEST_ASSERT_EQUAL_UINT32(1, flashRecordStore.getStats().recordsWritten);
+    TEST_ASSERT_EQUAL_UINT32(1, flashRecordStore.getStats().recordsSkipped);
+}
+
+/**
+ * Félbeszakadt rekord írás után a korábbi változat marad érvényes, és a log tovább írható
+ */
+void test_torn_record_keeps_previous_value() {
+    uint32_t value = 1;
+    flashRecordStore.write(FLASH_LOG_KEY(1, 0), &value, sizeof(value));
+    flashCommitService.flush();
+
+    value = 2;
+    flashRecordStore.write(FLASH_LOG_KEY(1, 0), &value, sizeof(value));
+    opsUntilPowerFail = 0;
+    tearMidway = true;
+    try {
+        flashCommitService.flush();
+        TEST_FAIL_MESSAGE("The power fail was not injected");
+    } catch (const PowerFail &) {
+    }
+
+    reboot();
+    uint32_t readBack = 0;
+    TEST_ASSERT_TRUE(flashRecordStore.read(FLASH_LOG_KEY(1, 0), &readBack, sizeof(readBack)));
+    TEST_ASSERT_EQUAL_UINT32(1, readBack);
+
+    value = 3;
+    TEST_ASSERT_TRUE(flashRecordStore.write(FLASH_LOG_KEY(1, 0), &value, sizeof(value)));
+    flashCommitService.flush();
+    reboot();
+    TEST_ASSERT_TRUE(flashRecordStore.read(FLASH_LOG_KEY(1, 0), &readBack, sizeof(readBack)));
+    TEST_ASSERT_EQUAL_UINT32(3, readBack);
+}
+
+/**
+ * Sok írás: a gyűrű többször körbeér (tömörítés, ütemezett törlések), minden kulcs a legutóbbi értéket adja
+ */
+void test_compaction_keeps_latest_values() {
+    const uint8_t keys = 20;
+    uint32_t values[keys] = {};
+    for (uint32_t n = 0; n < 3000; n++) {
+        uint8_t key = nextRandom() % keys;
+        values[key] = n + 1;
+        TEST_ASSERT_TRUE(flashRecordStore.write(FLASH_LOG_KEY(2, key), &values[key], sizeof(values[key])));
+        simMillis += 50;
+        flashRecordStore.loop();
+        flashCommitService.loop();
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(0, flashRecordStore.getStats().compactions);
+
+    flashCommitService.flush();
+    reboot();
+    for (uint8_t key = 0; key < keys; key++) {
+        uint32_t readBack = 0;
+        if (values[key] != 0) {
+            TEST_ASSERT_TRUE(flashRecordStore.read(FLASH_LOG_KEY(2, key), &readBack, sizeof(readBack)));
+            TEST_ASSERT_EQUAL_UINT32(values[key], readBack);
+        }
+    }
+}
+
+/**
+ * Az EEPROM commit a sorba állításkori tartalmat írja ki, és törli az EEPROM saját "módosult" jelzőjét
+ */
+void test_eeprom_commit_uses_snapshot() {
+    EEPROM.begin(2048);
+    uint32_t value = 0xCAFEBABE;
+    EEPROM.put(16, value);
+    TEST_ASSERT_TRUE(EEPROM.isDirty());
+    flashCommitService.commitEeprom();
+    TEST_ASSERT_FALSE(EEPROM.isDirty());
+
+    uint32_t later = 0x11111111;
+    EEPROM.put(16, later); // Commit nélkül: nem kerülhet a flash-re
+    flashCommitService.flush();
+
+    uint32_t stored;
+    memcpy(&stored, simFlash + SIM_EEPROM_OFFSET + 16, sizeof(stored));
+    TEST_ASSERT_EQUAL_HEX32(value, stored);
+}
+
+// Több darabos struktúra az A/B példányos mentéshez
+struct TestRecord {
+    uint32_t counter;
+    uint8_t payload[92];
+};
+
+static void fillRecord(TestRecord &record, uint32_t counter) {
+    record.counter = counter;
+    for (uint8_t i = 0; i < sizeof(record.payload); i++) {
+        record.payload[i] = counter * 31 + i;
+    }
+}
+
+/**
+ * Táp kimaradás szimuláció: véletlen ponton félbeszakadó flash műveletek, újraindítás után
+ * mindig van érvényes példány, és nem régebbi a legutóbb biztosan kiírtnál
+ */
+void test_power_fail_recovery() {
+    const uint16_t boots = 3000;
+    const uint8_t storeId = 9;
+    uint32_t durable = 0; // A legutóbbi, biztosan a flash-re került mentés
+    uint32_t saved = 0;   // A legutóbbi kért mentés
+    uint16_t interrupted = 0;
+
+    for (uint16_t boot = 0; boot < boots; boot++) {
+        opsUntilPowerFail = -1;
+        flashCommitService = FlashCommitService();
+        flashRecordStore = FlashRecordStore();
+        opsUntilPowerFail = nextRandom() % 60;
+        try {
+            TEST_ASSERT_TRUE(flashRecordStore.begin());
+            TestRecord record;
+            uint16_t crc = StoreFlashLog<TestRecord>::read(record, storeId);
+            if (durable != 0) {
+                TEST_ASSERT_NOT_EQUAL(0, crc);
+            }
+            if (crc != 0) {
+                TestRecord expected;
+                fillRecord(expected, record.counter);
+                TEST_ASSERT_EQUAL_MEMORY(&expected, &record, sizeof(record));
+                TEST_ASSERT_TRUE(record.counter >= durable && record.counter <= saved);
+                durable = record.counter;
+            }
+
+            while (true) {
+                fillRecord(record, ++saved);
+                StoreFlashLog<TestRecord>::save(record, storeId, 0);
+                if (nextRandom() % 3 == 0) {
+                    flashCommitService.flush();
+                    durable = saved;
+                }
+                simMillis += 200;
+                flashRecordStore.loop();
+                flashCommitService.loop();
+            }
+        } catch (const PowerFail &) {
+            interrupted++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT16(boots, interrupted);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, durable);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_write_read_and_reboot);
+    RUN_TEST(test_unchanged_write_is_skipped);
+    RUN_TEST(test_torn_record_keeps_previous_value);
+    RUN_TEST(test_compaction_keeps_latest_values);
+    RUN_TEST(test_eeprom_commit_uses_snapshot);
+    RUN_TEST(test_power_fail_recovery);
+    return UNITY_END();
+}
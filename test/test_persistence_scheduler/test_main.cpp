@@ -0,0 +1,222 @@
+#include <unity.h>
+
+#include <stdint.h>
+
+// A Config.h helyett (a tárolók és a kijelző nélkül) csak a képernyővédő ideje kell
+#define __CONFIG_H
+struct TestConfig {
+    struct {
+        uint8_t screenSaverTimeoutMinutes;
+    } data;
+};
+static TestConfig config;
+
+// A tesztelt fordítási egység
+#include "../../src/PersistenceScheduler.cpp"
+
+// A program többi részének itt szükséges darabjai
+namespace rtv {
+uint32_t lastUserActivity = 0;
+}
+static uint16_t commitFlushes = 0;
+void FlashCommitService::flush() { commitFlushes++; }
+FlashCommitService flashCommitService;
+
+// Szimulált óra
+static uint32_t simMillis = 0;
+uint32_t millis() { return simMillis; }
+uint32_t micros() { return simMillis * 1000; }
+
+/**
+ * A StoreBase módosítás jelzését utánzó tároló, a mentések számlálásával
+ */
+class FakeStore : public PersistentStore {
+  public:
+    uint16_t changeCount = 0;
+    bool dirty = false;
+    bool batch = false;   // Kötegelt módosítás (canSave() == false)
+    bool failing = false; // A mentés sikertelen
+    uint16_t saves = 0;
+    uint32_t lastSaveTime = 0;
+
+    void change() {
+        changeCount++;
+        dirty = true;
+    }
+
+    const char *getStoreName() const override { return "FakeStore"; }
+    uint16_t collectChanges() override { return changeCount; }
+    bool needsSave() const override { return dirty; }
+    bool canSave() const override { return !batch; }
+    void checkSave() override {
+        if (dirty && !failing) {
+            dirty = false;
+            saves++;
+            lastSaveTime = simMillis;
+        }
+    }
+};
+
+static FakeStore store;
+
+/**
+ * Az idő léptetése a fő ciklus hívásaival (10 ms-onként)
+ */
+static void runUntil(uint32_t time) {
+    while (simMillis < time) {
+        simMillis += 10;
+        persistenceScheduler.loop();
+    }
+}
+
+void setUp() {
+    simMillis = 0;
+    commitFlushes = 0;
+    rtv::lastUserActivity = 0;
+    config.data.screenSaverTimeoutMinutes = 60;
+    store = FakeStore();
+    persistenceScheduler = PersistenceScheduler();
+    TEST_ASSERT_TRUE(persistenceScheduler.registerStore(store));
+}
+
+void tearDown() {}
+
+/**
+ * Egy módosítás a csendes időszak után (a figyelés felbontásán belül) kerül mentésre
+ */
+void test_saves_after_quiet_period() {
+    runUntil(1000);
+    store.change();
+    runUntil(1000 + PERSISTENCE_QUIET_PERIOD - PERSISTENCE_POLL_INTERVAL);
+    TEST_ASSERT_EQUAL_UINT16(0, store.saves);
+
+    runUntil(1000 + PERSISTENCE_QUIET_PERIOD + PERSISTENCE_POLL_INTERVAL);
+    TEST_ASSERT_EQUAL_UINT16(1, store.saves);
+    TEST_ASSERT_UINT32_WITHIN(PERSISTENCE_POLL_INTERVAL, 1000 + PERSISTENCE_QUIET_PERIOD, store.lastSaveTime);
+}
+
+/**
+ * Gyors egymásutáni módosítások egyetlen mentéssé olvadnak
+ */
+void test_coalesces_bursts() {
+    for (uint8_t i = 0; i < 10; i++) {
+        store.change();
+        runUntil(simMillis + 400);
+    }
+    runUntil(simMillis + PERSISTENCE_QUIET_PERIOD + PERSISTENCE_POLL_INTERVAL);
+    TEST_ASSERT_EQUAL_UINT16(1, store.saves);
+    TEST_ASSERT_EQUAL_UINT32(1, persistenceScheduler.getStats().writes);
+    TEST_ASSERT_EQUAL_UINT32(9, persistenceScheduler.getStats().writesAvoided);
+}
+
+/**
+ * Folyamatos módosítás mellett is mentünk a maximális késleltetés után
+ */
+void test_max_delay_under_continuous_changes() {
+    while (store.saves == 0 && simMillis < 2 * PERSISTENCE_MAX_DELAY) {
+        store.change();
+        runUntil(simMillis + 1000);
+    }
+    TEST_ASSERT_EQUAL_UINT16(1, store.saves);
+    TEST_ASSERT_UINT32_WITHIN(1000 + PERSISTENCE_POLL_INTERVAL, PERSISTENCE_MAX_DELAY, store.lastSaveTime);
+}
+
+/**
+ * Két mentés között legalább PERSISTENCE_MIN_WRITE_INTERVAL telik el
+ */
+void test_min_write_interval() {
+    store.change();
+    runUntil(PERSISTENCE_QUIET_PERIOD + PERSISTENCE_POLL_INTERVAL);
+    TEST_ASSERT_EQUAL_UINT16(1, store.saves);
+    uint32_t firstSave = store.lastSaveTime;
+
+    store.change();
+    runUntil(firstSave + PERSISTENCE_MIN_WRITE_INTERVAL - PERSISTENCE_POLL_INTERVAL);
+    TEST_ASSERT_EQUAL_UINT16(1, store.saves);
+    TEST_ASSERT_EQUAL_UINT32(1, persistenceScheduler.getStats().rateLimited);
+
+    runUntil(firstSave + PERSISTENCE_MIN_WRITE_INTERVAL + PERSISTENCE_POLL_INTERVAL);
+    TEST_ASSERT_EQUAL_UINT16(2, store.saves);
+    TEST_ASSERT_TRUE(store.lastSaveTime - firstSave >= PERSISTENCE_MIN_WRITE_INTERVAL);
+}
+
+/**
+ * Kötegelt módosítás közben nem mentünk, utána igen
+ */
+void test_batch_defers_save() {
+    store.batch = true;
+    store.change();
+    runUntil(PERSISTENCE_MAX_DELAY + 1000);
+    TEST_ASSERT_EQUAL_UINT16(0, store.saves);
+
+    store.batch = false;
+    runUntil(simMillis + PERSISTENCE_POLL_INTERVAL * 2);
+    TEST_ASSERT_EQUAL_UINT16(1, store.saves);
+}
+
+/**
+ * A flushAll() azonnal ment (a csendes időszak és a ritkítás nélkül), és a flash sort is kiüríti
+ */
+void test_flush_all() {
+    store.change();
+    runUntil(100);
+    persistenceScheduler.flushAll("test");
+    TEST_ASSERT_EQUAL_UINT16(1, store.saves);
+    TEST_ASSERT_EQUAL_UINT16(1, commitFlushes);
+    TEST_ASSERT_FALSE(persistenceScheduler.hasPendingWrites());
+
+    store.change();
+    persistenceScheduler.flushAll("test");
+    TEST_ASSERT_EQUAL_UINT16(2, store.saves);
+    TEST_ASSERT_EQUAL_UINT32(2, persistenceScheduler.getStats().forcedFlushes);
+}
+
+/**
+ * Tétlen rádió: a képernyővédő idejének lejártakor egyszer mindent kiírunk
+ */
+void test_idle_flush_once() {
+    config.data.screenSaverTimeoutMinutes = 1;
+    store.change();
+    runUntil(60 * 1000UL - PERSISTENCE_POLL_INTERVAL);
+    uint16_t savesBeforeIdle = store.saves;
+    TEST_ASSERT_EQUAL_UINT32(0, persistenceScheduler.getStats().forcedFlushes);
+
+    store.change();
+    runUntil(60 * 1000UL + PERSISTENCE_POLL_INTERVAL);
+    TEST_ASSERT_EQUAL_UINT32(1, persistenceScheduler.getStats().forcedFlushes);
+    TEST_ASSERT_EQUAL_UINT16(savesBeforeIdle + 1, store.saves);
+
+    runUntil(120 * 1000UL);
+    TEST_ASSERT_EQUAL_UINT32(1, persistenceScheduler.getStats().forcedFlushes);
+}
+
+/**
+ * Sikertelen mentés: nem próbálkozunk minden figyeléskor, a minimális időköz után újra
+ */
+void test_failed_save_retries_after_interval() {
+    store.failing = true;
+    store.change();
+    runUntil(PERSISTENCE_QUIET_PERIOD + PERSISTENCE_POLL_INTERVAL);
+    TEST_ASSERT_EQUAL_UINT32(1, persistenceScheduler.getStats().failures);
+
+    runUntil(PERSISTENCE_QUIET_PERIOD + PERSISTENCE_MIN_WRITE_INTERVAL - PERSISTENCE_POLL_INTERVAL);
+    TEST_ASSERT_EQUAL_UINT32(1, persistenceScheduler.getStats().failures);
+
+    store.failing = false;
+    runUntil(PERSISTENCE_QUIET_PERIOD + PERSISTENCE_MIN_WRITE_INTERVAL + 2 * PERSISTENCE_POLL_INTERVAL);
+    TEST_ASSERT_EQUAL_UINT16(1, store.saves);
+    TEST_ASSERT_FALSE(persistenceScheduler.hasPendingWrites());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_saves_after_quiet_period);
+    RUN_TEST(test_coalesces_bursts);
+    RUN_TEST(test_max_delay_under_continuous_changes);
+    RUN_TEST(test_min_write_interval);
+    RUN_TEST(test_batch_defers_save);
+    RUN_TEST(test_flush_all);
+    RUN_TEST(test_idle_flush_once);
+    RUN_TEST(test_failed_save_retries_after_interval);
+    return UNITY_END();
+}
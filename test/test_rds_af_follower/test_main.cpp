@@ -0,0 +1,297 @@
+#include <unity.h>
+
+#include <stdint.h>
+
+// Az SI4735 könyvtár, a sáv tábla, a konfiguráció és a mintavételező helyett csak
+// a follower által használt felület: szimulált adók, kézzel beállított otthoni jelminőség
+
+// Szimulált óra
+static uint32_t simMillis = 0;
+uint32_t millis() { return simMillis; }
+uint32_t micros() { return simMillis * 1000; }
+
+namespace rtv {
+bool SEEK = false;
+bool SCANbut = false;
+bool BEACON = false;
+} // namespace rtv
+
+#define __SI4735EXT_H
+/**
+ * Szimulált hangoló: frekvenciánként egy adó (PI, jelszint), a FIFO-ba hívásonként egy 0A csoportot tesz
+ */
+class Si4735Ext {
+  public:
+    struct RdsGroup {
+        uint16_t blockA;
+        uint16_t blockB;
+        uint16_t blockC;
+        uint16_t blockD;
+        uint8_t errA;
+        uint8_t errB;
+        uint8_t errC;
+        uint8_t errD;
+    };
+
+    struct Transmitter {
+        uint16_t frequency;
+        uint16_t pi;
+        uint8_t rssi;
+        uint8_t snr;
+        const char *ps;
+        uint8_t afCode1; // A 0A csoport C blokkjában küldött AF kódok
+        uint8_t afCode2;
+    };
+
+    static constexpr uint8_t MAX_TRANSMITTERS = 4;
+    Transmitter transmitters[MAX_TRANSMITTERS];
+    uint8_t transmitterCount = 0;
+
+    uint16_t tunedFrequency = 0;
+    uint8_t psSegment = 0;
+    uint16_t tunesTo[MAX_TRANSMITTERS] = {}; // Hangolások száma adónként
+
+    void addTransmitter(const Transmitter &transmitter) { transmitters[transmitterCount++] = transmitter; }
+
+    const Transmitter *tuned() const {
+        for (uint8_t i = 0; i < transmitterCount; i++) {
+            if (transmitters[i].frequency == tunedFrequency) {
+                return &transmitters[i];
+            }
+        }
+        return nullptr;
+    }
+
+    uint16_t tuneCount(uint16_t frequency) const {
+        for (uint8_t i = 0; i < transmitterCount; i++) {
+            if (transmitters[i].frequency == frequency) {
+                return tunesTo[i];
+            }
+        }
+        return 0;
+    }
+
+    void setFrequencyNoWait(uint16_t freq) {
+        tunedFrequency = freq;
+        for (uint8_t i = 0; i < transmitterCount; i++) {
+            if (transmitters[i].frequency == freq) {
+                tunesTo[i]++;
+            }
+        }
+    }
+    bool waitTuneComplete(uint16_t) { return true; }
+    uint8_t getReceivedSignalStrengthIndicator() { return tuned() ? tuned()->rssi : 0; }
+    uint8_t getStatusSNR() { return tuned() ? tuned()->snr : 0; }
+    void setHardwareAudioMute(bool) {}
+    void flushRdsFifo() {}
+
+    uint8_t getRdsFifoCount(bool) { return (tuned() && tuned()->pi != 0) ? 1 : 0; }
+
+    bool readRdsGroup(RdsGroup &group) {
+        const Transmitter *t = tuned();
+        memset(&group, 0, sizeof(group));
+        group.blockA = t->pi;
+        group.blockB = psSegment; // 0A csoport, PS szegmens
+        group.blockC = (t->afCode1 << 8) | t->afCode2;
+        group.blockD = (t->ps[psSegment * 2] << 8) | t->ps[psSegment * 2 + 1];
+        psSegment = (psSegment + 1) & 0x03;
+        return true;
+    }
+};
+
+#define __BAND_H
+#define FM_BAND_TYPE 0
+struct BandTable {
+    uint16_t currFreq;
+};
+class Band {
+  public:
+    BandTable current = {0};
+    uint8_t bandType = FM_BAND_TYPE;
+    BandTable &getCurrentBand() { return current; }
+    uint8_t getCurrentBandType() { return bandType; }
+};
+
+#define __CONFIG_H
+struct TestConfig {
+    struct {
+        bool rdsEnabled;
+    } data;
+};
+static TestConfig config;
+
+#define __SIGNAL_QUALITY_SAMPLER_H
+#define TUNER_OWNER_AF 0x80
+class SignalQualitySampler {
+  public:
+    struct Snapshot {
+        uint8_t rssiAvg;
+        uint8_t snrAvg;
+        bool valid;
+    };
+    Snapshot snapshot = {0, 0, false};
+    uint8_t busyOwners = 0;
+
+    Snapshot getSnapshot() const { return snapshot; }
+    void setTunerBusy(uint8_t owner, bool busy) { busyOwners = busy ? (busyOwners | owner) : (busyOwners & ~owner); }
+};
+static SignalQualitySampler signalQualitySampler;
+
+// A tesztelt fordítási egységek
+#include "../../src/RdsAfFollower.cpp"
+#include "../../src/RdsDecoder.cpp"
+
+// Frekvenciák 10kHz egységben, AF kód = (frekvencia - 87.5 MHz) / 100 kHz
+#define HOME_FREQ 9000    // AF kód 25
+#define FOREIGN_FREQ 9500 // AF kód 75
+#define SAME_FREQ 10000   // AF kód 125
+#define HOME_PI 0x2001
+
+static Si4735Ext si4735;
+static Band band;
+
+/**
+ * Az idő léptetése a fő ciklus hívásaival (10 ms-onként): előbb a dekóder, utána a follower
+ */
+static void runUntil(RdsDecoder &decoder, RdsAfFollower &follower, uint32_t time) {
+    while (simMillis < time) {
+        simMillis += 10;
+        decoder.loop();
+        follower.loop();
+    }
+}
+
+static int8_t findCandidate(const RdsAfFollower &follower, uint16_t frequency) {
+    for (uint8_t i = 0; i < follower.getCandidateCount(); i++) {
+        if (follower.getCandidate(i).frequency == frequency) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void setUp() {
+    simMillis = 0;
+    si4735 = Si4735Ext();
+    band = Band();
+    config.data.rdsEnabled = true;
+    signalQualitySampler = SignalQualitySampler();
+
+    // Gyenge otthoni adó, egy erős idegen és egy közepes, azonos PI-jű AF
+    si4735.addTransmitter({HOME_FREQ, HOME_PI, 10, 3, "HOME FM ", 75, 125});
+    si4735.addTransmitter({FOREIGN_FREQ, 0x3003, 50, 30, "OTHER FM", 0, 0});
+    si4735.addTransmitter({SAME_FREQ, HOME_PI, 30, 20, "HOME FM ", 25, 0});
+    band.current.currFreq = HOME_FREQ;
+    si4735.setFrequencyNoWait(HOME_FREQ);
+    si4735.tunesTo[0] = 0;
+
+    signalQualitySampler.snapshot = {10, 3, true};
+}
+void tearDown() {}
+
+/**
+ * A rossz PI-jű AF-re a visszatérés után a teljes tiltási idő alatt nem hangolunk újra,
+ * és az otthoni állomás PI, PS adatai sem vesznek el
+ */
+void test_mismatched_af_skipped_for_whole_holdoff() {
+    // Az azonos PI-jű AF ne legyen jobb jelölt az idegennél
+    si4735.transmitters[2].rssi = 0;
+
+    RdsDecoder decoder(si4735);
+    RdsAfFollower follower(si4735, band, decoder);
+
+    // Próba, majd a gyenge vétel megerősítése után átváltás az idegen AF-re, ahol a PI nem egyezik
+    uint32_t mismatchAt = 0;
+    while (simMillis < 20000 && mismatchAt == 0) {
+        runUntil(decoder, follower, simMillis + 10);
+        int8_t idx = findCandidate(follower, FOREIGN_FREQ);
+        if (idx >= 0) {
+            mismatchAt = follower.getCandidate(idx).piMismatchAt;
+        }
+    }
+    TEST_ASSERT_NOT_EQUAL(0, mismatchAt);
+    TEST_ASSERT_FALSE(follower.isSwitching());
+    TEST_ASSERT_EQUAL(HOME_FREQ, si4735.tunedFrequency);
+    TEST_ASSERT_EQUAL(HOME_FREQ, band.current.currFreq);
+    TEST_ASSERT_EQUAL(0, signalQualitySampler.busyOwners);
+
+    // Az idegen csoportok nem írták felül az otthoni állomást
+    TEST_ASSERT_EQUAL_HEX16(HOME_PI, decoder.getPI());
+    TEST_ASSERT_EQUAL_STRING("HOME FM ", decoder.getProgramService());
+
+    // A tiltás teljes ideje alatt nem próbáljuk, nem váltunk rá, és a jelölés sem vész el
+    uint16_t tunesAtMismatch = si4735.tuneCount(FOREIGN_FREQ);
+    runUntil(decoder, follower, mismatchAt + AF_PI_MISMATCH_HOLDOFF - 10);
+    TEST_ASSERT_EQUAL(tunesAtMismatch, si4735.tuneCount(FOREIGN_FREQ));
+    int8_t idx = findCandidate(follower, FOREIGN_FREQ);
+    TEST_ASSERT_TRUE(idx >= 0);
+    TEST_ASSERT_EQUAL(mismatchAt, follower.getCandidate(idx).piMismatchAt);
+    TEST_ASSERT_EQUAL(0, follower.getSwitchCount());
+    TEST_ASSERT_EQUAL_STRING("HOME FM ", decoder.getProgramService());
+
+    // Utána újra megmérjük
+    runUntil(decoder, follower, mismatchAt + AF_PI_MISMATCH_HOLDOFF + AF_PROBE_INTERVAL_WEAK + AF_CHECK_INTERVAL);
+    TEST_ASSERT_GREATER_THAN_UINT32(tunesAtMismatch, si4735.tuneCount(FOREIGN_FREQ));
+}
+
+/**
+ * Egyező PI esetén átváltunk, a dekóder az állomás adataival folytatja
+ */
+void test_switch_to_matching_af_keeps_station_data() {
+    // Az idegen AF ne legyen jobb jelölt
+    si4735.transmitters[1].rssi = 0;
+
+    RdsDecoder decoder(si4735);
+    RdsAfFollower follower(si4735, band, decoder);
+
+    while (simMillis < 20000 && follower.getSwitchCount() == 0) {
+        runUntil(decoder, follower, simMillis + 10);
+    }
+    TEST_ASSERT_EQUAL(1, follower.getSwitchCount());
+    TEST_ASSERT_FALSE(follower.isSwitching());
+    TEST_ASSERT_EQUAL(SAME_FREQ, band.current.currFreq);
+    TEST_ASSERT_EQUAL(SAME_FREQ, si4735.tunedFrequency);
+    TEST_ASSERT_EQUAL_HEX16(HOME_PI, decoder.getPI());
+    TEST_ASSERT_EQUAL_STRING("HOME FM ", decoder.getProgramService());
+
+    // A régi frekvencia visszafelé követhető jelölt lett
+    TEST_ASSERT_TRUE(findCandidate(follower, HOME_FREQ) >= 0);
+}
+
+/**
+ * PI ellenőrzés alatt a dekóder csak a PI kódot veszi ki a csoportokból
+ */
+void test_pi_check_leaves_decoder_state() {
+    RdsDecoder decoder(si4735);
+    for (uint8_t i = 0; i < 12; i++) {
+        decoder.drainFifo();
+    }
+    TEST_ASSERT_EQUAL_HEX16(HOME_PI, decoder.getPI());
+
+    decoder.beginPiCheck();
+    si4735.setFrequencyNoWait(FOREIGN_FREQ);
+    for (uint8_t i = 0; i < 12; i++) {
+        decoder.drainFifo();
+    }
+    TEST_ASSERT_EQUAL_HEX16(0x3003, decoder.getCheckedPi());
+    TEST_ASSERT_EQUAL_HEX16(HOME_PI, decoder.getPI());
+    TEST_ASSERT_EQUAL_STRING("HOME FM ", decoder.getProgramService());
+
+    uint8_t afCount;
+    decoder.getAfList(afCount);
+    TEST_ASSERT_EQUAL(2, afCount);
+
+    decoder.endPiCheck();
+    si4735.setFrequencyNoWait(HOME_FREQ);
+    decoder.drainFifo();
+    TEST_ASSERT_EQUAL_HEX16(HOME_PI, decoder.getPI());
+    TEST_ASSERT_EQUAL_STRING("HOME FM ", decoder.getProgramService());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_mismatched_af_skipped_for_whole_holdoff);
+    RUN_TEST(test_switch_to_matching_af_keeps_station_data);
+    RUN_TEST(test_pi_check_leaves_decoder_state);
+    return UNITY_END();
+}
@@ -0,0 +1,241 @@
+#include <unity.h>
+
+// A Band.h helyett (az SI4735 könyvtár nélkül) csak a moduláció kódjai kellenek
+#define __BAND_H
+#define FM 0
+#define LSB 1
+#define USB 2
+#define AM 3
+#define CW 4
+
+#include "BaseStationStore.h"
+#include "Crc16.h"
+
+// A StoreBase alapértelmezett EEPROM mentésének függőségei (a teszt tárolója nem ment)
+FlashCommitService flashCommitService;
+void FlashCommitService::commitEeprom() {}
+namespace Utils {
+uint16_t calcCRC16(const uint8_t *data, size_t length, uint16_t crc) { return Crc16::calc(data, length, crc); }
+} // namespace Utils
+
+/**
+ * Tároló mentés nélkül, az indexek vizsgálatához
+ */
+class TestStationStore : public BaseStationStore<AmStationList_t, MAX_AM_STATIONS> {
+  protected:
+    const char *getClassName() const override { return "TestStationStore"; }
+    uint16_t performSave() override { return 1; }
+    uint16_t performLoad() override { return 1; }
+
+  public:
+    TestStationStore() { clearStations(); }
+    void loadDefaults() override { clearStations(); }
+
+    /**
+     * A RAM indexek újraépítése (mint betöltés után)
+     */
+    void reindex() { rebuildIndex(); }
+};
+
+static TestStationStore store;
+
+void setUp() { store.clearStations(); }
+void tearDown() {}
+
+static StationData makeStation(uint16_t frequency, uint8_t bandIndex = 1, uint8_t modulation = AM, int16_t bfoOffset = 0) {
+    StationData station;
+    memset(&station, 0, sizeof(station));
+    snprintf(station.name, sizeof(station.name), "S%u", frequency);
+    station.frequency = frequency;
+    station.bandIndex = bandIndex;
+    station.modulation = modulation;
+    station.bfoOffset = bfoOffset;
+    return station;
+}
+
+/**
+ * A rendezett sorrend ellenőrzése (frekvencia szerint növekvő)
+ */
+static void assertSorted() {
+    for (uint8_t i = 1; i < store.getStationCount(); i++) {
+        TEST_ASSERT_TRUE(store.getStationByIndex(i - 1)->frequency <= store.getStationByIndex(i)->frequency);
+    }
+}
+
+/**
+ * Felvétel, duplikátum elutasítás, keresés
+ */
+void test_add_and_find() {
+    TEST_ASSERT_TRUE(store.addStation(makeStation(540)));
+    TEST_ASSERT_TRUE(store.addStation(makeStation(1116)));
+    TEST_ASSERT_FALSE(store.addStation(makeStation(540)));
+    TEST_ASSERT_TRUE(store.addStation(makeStation(540, 2))); // Másik sáv
+    TEST_ASSERT_FALSE(store.addStation(makeStation(0)));
+
+    TEST_ASSERT_EQUAL_UINT8(3, store.getStationCount());
+    TEST_ASSERT_NOT_EQUAL(-1, store.findStation(540, 1));
+    TEST_ASSERT_NOT_EQUAL(-1, store.findStation(540, 2));
+    TEST_ASSERT_EQUAL(-1, store.findStation(541, 1));
+    assertSorted();
+}
+
+/**
+ * SSB/CW állomásnál a BFO is a kulcs része, AM-nél nem
+ */
+void test_bfo_is_part_of_ssb_key() {
+    TEST_ASSERT_TRUE(store.addStation(makeStation(7100, 3, LSB, 100)));
+    TEST_ASSERT_TRUE(store.addStation(makeStation(7100, 3, LSB, -100)));
+    TEST_ASSERT_FALSE(store.addStation(makeStation(7100, 3, LSB, 100)));
+    TEST_ASSERT_NOT_EQUAL(-1, store.findStation(7100, 3, -100));
+    TEST_ASSERT_EQUAL(-1, store.findStation(7100, 3, 50));
+
+    TEST_ASSERT_TRUE(store.addStation(makeStation(9500, 3, AM)));
+    TEST_ASSERT_NOT_EQUAL(-1, store.findStation(9500, 3, 50)); // AM állomás: a BFO nem számít
+}
+
+/**
+ * Törlés: a slot azonosítók nem tolódnak el, a felszabadult slotot a következő felvétel kapja
+ */
+void test_delete_keeps_ids() {
+    store.addStation(makeStation(600));
+    store.addStation(makeStation(700));
+    store.addStation(makeStation(800));
+    int id600 = store.findStation(600, 1);
+    int id800 = store.findStation(800, 1);
+
+    TEST_ASSERT_TRUE(store.deleteStationById(store.findStation(700, 1)));
+    TEST_ASSERT_EQUAL(id600, store.findStation(600, 1));
+    TEST_ASSERT_EQUAL(id800, store.findStation(800, 1));
+    TEST_ASSERT_EQUAL(-1, store.findStation(700, 1));
+    TEST_ASSERT_EQUAL_UINT8(2, store.getStationCount());
+    assertSorted();
+}
+
+/**
+ * Visszaléptetéses törlés: egy ütköző lánc közepéről törölve a lánc többi eleme továbbra is megtalálható
+ * (sírkő nélkül, a tábla ismételt feltöltése/ürítése után sem romlik el)
+ */
+void test_backward_shift_deletion() {
+    uint32_t seed = 11;
+    bool present[4000] = {};
+    for (uint16_t round = 0; round < 20000; round++) {
+        seed = seed * 1103515245u + 12345u;
+        uint16_t frequency = 100 + (seed >> 8) % 3000;
+        if (present[frequency]) {
+            TEST_ASSERT_TRUE(store.deleteStationById(store.findStation(frequency, 1)));
+            present[frequency] = false;
+        } else if (store.getStationCount() < MAX_AM_STATIONS) {
+            TEST_ASSERT_TRUE(store.addStation(makeStation(frequency)));
+            present[frequency] = true;
+        }
+
+        // Időnként minden jelen lévő és néhány hiányzó kulcs ellenőrzése
+        if (round % 500 == 0) {
+            uint8_t count = 0;
+            for (uint16_t f = 100; f < 3100; f++) {
+                int id = store.findStation(f, 1);
+                TEST_ASSERT_EQUAL(present[f], id != -1);
+                if (id != -1) {
+                    TEST_ASSERT_EQUAL_UINT16(f, store.getStationById(id)->frequency);
+                    count++;
+                }
+            }
+            TEST_ASSERT_EQUAL_UINT8(count, store.getStationCount());
+            assertSorted();
+        }
+    }
+}
+
+/**
+ * Betelt tároló: a felvétel elutasítva, törlés után újra van hely
+ */
+void test_full_store() {
+    for (uint16_t i = 0; i < MAX_AM_STATIONS; i++) {
+        TEST_ASSERT_TRUE(store.addStation(makeStation(500 + i * 9)));
+    }
+    TEST_ASSERT_FALSE(store.addStation(makeStation(5000)));
+    TEST_ASSERT_TRUE(store.deleteStation(0));
+    TEST_ASSERT_TRUE(store.addStation(makeStation(5000)));
+    TEST_ASSERT_EQUAL_UINT16(5000, store.getStationByIndex(MAX_AM_STATIONS - 1)->frequency);
+}
+
+/**
+ * Következő/előző tárolt állomás (körbefordulással)
+ */
+void test_find_next_station() {
+    TEST_ASSERT_EQUAL_UINT8(TestStationStore::NO_STATION, store.findNextStation(1000, true));
+    store.addStation(makeStation(600));
+    store.addStation(makeStation(900));
+    store.addStation(makeStation(1200));
+
+    TEST_ASSERT_EQUAL_UINT16(900, store.getStationById(store.findNextStation(600, true))->frequency);
+    TEST_ASSERT_EQUAL_UINT16(900, store.getStationById(store.findNextStation(700, true))->frequency);
+    TEST_ASSERT_EQUAL_UINT16(600, store.getStationById(store.findNextStation(1200, true))->frequency);
+    TEST_ASSERT_EQUAL_UINT16(600, store.getStationById(store.findNextStation(900, false))->frequency);
+    TEST_ASSERT_EQUAL_UINT16(1200, store.getStationById(store.findNextStation(600, false))->frequency);
+}
+
+/**
+ * Az indexek újraépítése (betöltés után) ugyanazt a keresési eredményt adja
+ */
+void test_rebuild_index() {
+    store.addStation(makeStation(600));
+    store.addStation(makeStation(900));
+    store.addStation(makeStation(1200));
+    store.deleteStationById(store.findStation(900, 1));
+    int id1200 = store.findStation(1200, 1);
+
+    store.reindex();
+    TEST_ASSERT_EQUAL_UINT8(2, store.getStationCount());
+    TEST_ASSERT_EQUAL(id1200, store.findStation(1200, 1));
+    TEST_ASSERT_EQUAL(-1, store.findStation(900, 1));
+    TEST_ASSERT_TRUE(store.addStation(makeStation(900)));
+}
+
+/**
+ * Frissítés: egy másik állomás kulcsára nem lehet átírni, a régi adat és az index változatlan marad
+ */
+void test_update_rejects_duplicate() {
+    store.addStation(makeStation(600));
+    store.addStation(makeStation(900));
+    store.addStation(makeStation(1200));
+    int id600 = store.findStation(600, 1);
+    int id900 = store.findStation(900, 1);
+
+    TEST_ASSERT_FALSE(store.updateStationById(id600, makeStation(900)));
+    TEST_ASSERT_EQUAL(id600, store.findStation(600, 1));
+    TEST_ASSERT_EQUAL(id900, store.findStation(900, 1));
+    TEST_ASSERT_EQUAL_UINT16(600, store.getStationById(id600)->frequency);
+    TEST_ASSERT_EQUAL_UINT8(3, store.getStationCount());
+    TEST_ASSERT_EQUAL_UINT16(600, store.getStationByIndex(0)->frequency);
+    assertSorted();
+
+    // A saját kulcsára (pl. csak a név változik) és egy szabad kulcsra frissíthető
+    StationData renamed = makeStation(600);
+    strcpy(renamed.name, "NEW");
+    TEST_ASSERT_TRUE(store.updateStationById(id600, renamed));
+    TEST_ASSERT_TRUE(store.updateStationById(id600, makeStation(1500)));
+    TEST_ASSERT_EQUAL(-1, store.findStation(600, 1));
+    TEST_ASSERT_EQUAL(id600, store.findStation(1500, 1));
+    TEST_ASSERT_EQUAL_UINT16(1500, store.getStationByIndex(2)->frequency);
+    assertSorted();
+
+    // Törlés után a rendezett lista is rendben (a bináris keresés a helyes elemet veszi ki)
+    TEST_ASSERT_TRUE(store.deleteStationById(id900));
+    TEST_ASSERT_EQUAL_UINT8(2, store.getStationCount());
+    TEST_ASSERT_EQUAL_UINT16(1200, store.getStationByIndex(0)->frequency);
+    TEST_ASSERT_EQUAL_UINT16(1500, store.getStationByIndex(1)->frequency);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_add_and_find);
+    RUN_TEST(test_bfo_is_part_of_ssb_key);
+    RUN_TEST(test_delete_keeps_ids);
+    RUN_TEST(test_backward_shift_deletion);
+    RUN_TEST(test_full_store);
+    RUN_TEST(test_find_next_station);
+    RUN_TEST(test_rebuild_index);
+    RUN_TEST(test_update_rejects_duplicate);
+    return UNITY_END();
+}
@@ -0,0 +1,129 @@
+#include <unity.h>
+
+#include "StationData.h"
+
+// Moduláció kódok (Band.h)
+#define TEST_MOD_USB 2
+#define TEST_MOD_AM 3
+
+void setUp() {}
+void tearDown() {}
+
+static StationData makeStation(const char *name, uint16_t frequency, int16_t bfoOffset) {
+    StationData station;
+    memset(&station, 0, sizeof(station));
+    strncpy(station.name, name, MAX_STATION_NAME_LEN);
+    station.frequency = frequency;
+    station.bfoOffset = bfoOffset;
+    station.bandIndex = 17;
+    station.modulation = TEST_MOD_USB;
+    station.bandwidthIndex = 5;
+    return station;
+}
+
+static StationData roundTrip(const StationData &station) {
+    PackedStation packed;
+    StationData unpacked;
+    StationPacking::pack(station, packed);
+    StationPacking::unpack(packed, unpacked);
+    return unpacked;
+}
+
+/**
+ * A tárolható alakú állomás bitre pontosan visszajön
+ */
+void test_exact_round_trip() {
+    StationData station = makeStation("KOSSUTH 1", 540, -256);
+    StationData unpacked = roundTrip(station);
+    TEST_ASSERT_EQUAL_MEMORY(&station, &unpacked, sizeof(StationData));
+
+    station = makeStation("", 32767, 255);
+    station.bandIndex = 31;
+    station.modulation = 7;
+    station.bandwidthIndex = 7;
+    unpacked = roundTrip(station);
+    TEST_ASSERT_EQUAL_MEMORY(&station, &unpacked, sizeof(StationData));
+}
+
+/**
+ * A név: nagybetűsítés, PACKED_STATION_NAME_LEN karakterre vágás, ismeretlen karakter helyett '?'
+ */
+void test_name_folding() {
+    StationData unpacked = roundTrip(makeStation("Radio Kossuth", 540, 0));
+    TEST_ASSERT_EQUAL_STRING("RADIO KOSS", unpacked.name);
+    TEST_ASSERT_EQUAL(PACKED_STATION_NAME_LEN, strlen(unpacked.name));
+
+    unpacked = roundTrip(makeStation("a\tb", 540, 0));
+    TEST_ASSERT_EQUAL_STRING("A?B", unpacked.name);
+}
+
+/**
+ * A BFO +-255 Hz-en túl 5 Hz-es lépésben, +-1275 Hz-nél levágva tárolódik
+ */
+void test_bfo_quantization() {
+    const int16_t cases[][2] = {
+        {0, 0}, {255, 255}, {-256, -256}, {256, 255}, {1002, 1000}, {1003, 1005}, {-1002, -1000}, {-1003, -1005}, {1275, 1275}, {5000, 1275}, {-5000, -1280},
+    };
+    for (const auto &c : cases) {
+        TEST_ASSERT_EQUAL_INT16(c[1], roundTrip(makeStation("X", 7100, c[0])).bfoOffset);
+        TEST_ASSERT_EQUAL_INT16(c[1], StationPacking::normalizeBfo(c[0]));
+    }
+}
+
+/**
+ * A normalize() után a tárolás már nem változtat (a RAM és a flash másolat azonos)
+ */
+void test_normalize_is_stable() {
+    uint32_t seed = 7;
+    for (uint16_t n = 0; n < 500; n++) {
+        seed = seed * 1103515245u + 12345u;
+        char name[STATION_NAME_BUFFER_SIZE];
+        for (uint8_t i = 0; i < MAX_STATION_NAME_LEN; i++) {
+            name[i] = 32 + (seed >> (i % 16)) % 95;
+        }
+        name[MAX_STATION_NAME_LEN] = '\0';
+        StationData station = makeStation(name, seed % 30000 + 1, (int16_t)(seed >> 8) % 2000);
+        station.modulation = n % 2 ? TEST_MOD_USB : TEST_MOD_AM;
+
+        StationPacking::normalize(station);
+        StationData again = roundTrip(station);
+        TEST_ASSERT_EQUAL_MEMORY(&station, &again, sizeof(StationData));
+    }
+}
+
+/**
+ * A korábbi, azonos méretű nyers lista képében a formátum byte helyén az állomásszám áll:
+ * egyetlen lehetséges érték sem egyezhet a PACKED_STATION_FORMAT jellel
+ */
+void test_legacy_image_is_not_packed_format() {
+    TEST_ASSERT_EQUAL(sizeof(LegacyFmStationList_t), sizeof(PackedFmStationList_t));
+    TEST_ASSERT_EQUAL(sizeof(LegacyAmStationList_t), sizeof(PackedAmStationList_t));
+
+    static LegacyAmStationList_t legacy;
+    static PackedAmStationList_t packed;
+    for (uint16_t count = 0; count <= LEGACY_MAX_AM_STATIONS; count++) {
+        memset(&legacy, 0, sizeof(legacy));
+        legacy.count = count;
+        memcpy(&packed, &legacy, sizeof(packed));
+        TEST_ASSERT_NOT_EQUAL(PACKED_STATION_FORMAT, packed.format);
+    }
+
+    static LegacyFmStationList_t legacyFm;
+    static PackedFmStationList_t packedFm;
+    for (uint16_t count = 0; count <= LEGACY_MAX_FM_STATIONS; count++) {
+        memset(&legacyFm, 0, sizeof(legacyFm));
+        legacyFm.count = count;
+        memcpy(&packedFm, &legacyFm, sizeof(packedFm));
+        TEST_ASSERT_NOT_EQUAL(PACKED_STATION_FORMAT, packedFm.format);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_exact_round_trip);
+    RUN_TEST(test_name_folding);
+    RUN_TEST(test_bfo_quantization);
+    RUN_TEST(test_normalize_is_stable);
+    RUN_TEST(test_legacy_image_is_not_packed_format);
+    return UNITY_END();
+}